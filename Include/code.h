@@ -24,6 +24,10 @@ struct _PyShadowCode;
 
 typedef struct {
     unsigned int ncalls, curcalls; /* incremented for each execution */
+    unsigned int nbackedges; /* backward jumps taken, for JIT OSR */
+    /* calls to wait before creating shadow code again after it was evicted
+       or didn't fit in the budget */
+    unsigned int shadow_backoff;
     struct _PyShadowCode *shadow;
 } PyCode_Cache;
 /* facebook end */
@@ -140,6 +140,11 @@ _PyDict_IncVersionForSet(PyDictObject *dp, PyObject *key, PyObject *value);
 
 PyAPI_FUNC(PyObject *) _PyDict_GetItemMissing(PyObject *mp, PyObject *key);
 
+/* Advance a dict items iterator without packing the item into a tuple.
+ * Returns 1 and sets *key and *value to new references, or 0 when the
+ * iterator is exhausted or an error is set. */
+int _PyDictIter_NextItem(PyObject *iter, PyObject **key, PyObject **value);
+
 PyObject *_PyCheckedDict_New(PyTypeObject *type);
 PyObject *_PyCheckedDict_NewPresized(PyTypeObject *type, Py_ssize_t minused);
 
@@ -101,6 +101,10 @@ struct gc_generation {
                   generations */
 };
 
+/* Number of buckets in the pause time histograms. Bucket i counts pauses
+   shorter than 100us * 10**i, and the last bucket counts all the rest. */
+#define GC_PAUSE_BUCKETS 6
+
 /* Running stats per generation */
 struct gc_generation_stats {
     /* total number of collections */
@@ -109,6 +113,39 @@ struct gc_generation_stats {
     Py_ssize_t collected;
     /* total number of uncollectable objects (put into gc.garbage) */
     Py_ssize_t uncollectable;
+    /* total number of incremental collections (oldest generation only) */
+    Py_ssize_t increments;
+    /* how long collections and increments took */
+    Py_ssize_t pauses[GC_PAUSE_BUCKETS];
+};
+
+/* Phases of a collection timed by GC telemetry. */
+enum gc_phase {
+    GC_PHASE_DEDUCE_UNREACHABLE,
+    GC_PHASE_LEGACY_FINALIZERS,
+    GC_PHASE_HANDLE_WEAKREFS,
+    GC_PHASE_FINALIZE_GARBAGE,
+    GC_PHASE_DELETE_GARBAGE,
+    GC_NUM_PHASES
+};
+
+/* What GC telemetry records about one collection or increment. */
+struct gc_collection_record {
+    int generation;
+    /* true for an increment of the oldest generation */
+    char incremental;
+    /* net number of containers allocated since the last collection */
+    int allocations;
+    /* when the collection started, on the monotonic clock */
+    _PyTime_t start;
+    _PyTime_t duration;
+    _PyTime_t phases[GC_NUM_PHASES];
+    /* number of objects examined */
+    Py_ssize_t visited;
+    /* number of objects found to be unreachable */
+    Py_ssize_t unreachable;
+    Py_ssize_t collected;
+    Py_ssize_t uncollectable;
 };
 
 struct _gc_runtime_state {
@@ -143,6 +180,33 @@ struct _gc_runtime_state {
        collections, and are awaiting to undergo a full collection for
        the first time. */
     Py_ssize_t long_lived_pending;
+    /* Target duration of one increment when the oldest generation is
+       collected incrementally, or 0 to collect it all at once. */
+    _PyTime_t increment_budget;
+    /* Number of objects to examine in the next increment; adjusted after
+       each increment to fit the budget. */
+    Py_ssize_t increment_size;
+    /* Estimated number of objects left to examine before the current pass
+       over the oldest generation is done, or 0 if no pass is running. */
+    Py_ssize_t increment_remaining;
+    /* Objects that survived the increments of the current pass. */
+    Py_ssize_t increment_survivors;
+    /* Number of passes started, used to shift increment boundaries. */
+    Py_ssize_t increment_passes;
+    /* Passes started since the last full collection of the oldest
+       generation, and long_lived_total right after it. */
+    Py_ssize_t passes_since_full;
+    Py_ssize_t long_lived_at_full;
+    /* Ring buffer of records of recent collections, or NULL if telemetry
+       is disabled. */
+    struct gc_collection_record *telemetry;
+    Py_ssize_t telemetry_capacity;
+    /* Number of records written since telemetry was enabled. */
+    Py_ssize_t telemetry_written;
+    /* Only one in every telemetry_sample_every collections is recorded. */
+    Py_ssize_t telemetry_sample_every;
+    /* Collections left to skip before the next one that is recorded. */
+    Py_ssize_t telemetry_countdown;
 };
 
 PyAPI_FUNC(void) _PyGC_Initialize(struct _gc_runtime_state *);
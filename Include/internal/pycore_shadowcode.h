@@ -184,6 +184,15 @@ typedef struct _PyShadowCode {
     PyObject ***functions;
     Py_ssize_t functions_size;
 
+    /* Bytes allocated for this shadow code and all of its caches */
+    Py_ssize_t nbytes;
+    /* Calls since creation, halved each time an eviction sweep passes over
+     * this shadow code; zero means it hasn't run since the last sweep */
+    Py_ssize_t ncalls;
+    /* Owning code object (borrowed), and links in the eviction list */
+    PyCodeObject *co;
+    struct _PyShadowCode *lru_prev, *lru_next;
+
     _Py_CODEUNIT code[];
 } _PyShadowCode;
 
@@ -254,6 +263,14 @@ int _PyShadow_PatchByteCode(_PyShadow_EvalState *shadow,
 
 PyAPI_FUNC(int) _PyShadow_InitCache(PyCodeObject *co);
 
+/* Limit the total size of shadow code in this process to budget bytes, or
+ * lift the limit if budget is 0. Once the limit is reached, shadow code for
+ * functions that have gone cold is freed to make room for newly warm ones. */
+PyAPI_FUNC(void) _PyShadow_SetMemoryBudget(Py_ssize_t budget);
+
+/* Returns a dict describing how much memory shadow code is using */
+PyAPI_FUNC(PyObject *) _PyShadow_GetMemoryStats(void);
+
 static inline PyObject **
 _PyShadow_GetGlobal(_PyShadow_EvalState *state, int offset)
 {
@@ -390,6 +407,19 @@ PyObject *_PyShadow_BinarySubscrWithCache(_PyShadow_EvalState *shadow,
                                           PyObject *sub,
                                           int oparg);
 
+void _PyShadow_BinaryOpWithTypes(_PyShadow_EvalState *shadow,
+                                 const _Py_CODEUNIT *next_instr,
+                                 int opcode,
+                                 PyObject *left,
+                                 PyObject *right,
+                                 int oparg);
+
+void _PyShadow_IterWithTypes(_PyShadow_EvalState *shadow,
+                             const _Py_CODEUNIT *next_instr,
+                             int opcode,
+                             PyObject *obj,
+                             int oparg);
+
 Py_ssize_t _Py_NO_INLINE _PyShadow_FixDictOffset(PyObject *obj,
                                                  Py_ssize_t dictoffset);
 
@@ -31,6 +31,23 @@ extern "C" {
   X(BINARY_TRUE_DIVIDE,               27) \
   X(INPLACE_FLOOR_DIVIDE,             28) \
   X(INPLACE_TRUE_DIVIDE,              29) \
+  X(BINARY_ADD_INT,                   30) \
+  X(BINARY_ADD_FLOAT,                 31) \
+  X(BINARY_ADD_UNICODE,               32) \
+  X(BINARY_SUBTRACT_INT,              33) \
+  X(BINARY_SUBTRACT_FLOAT,            34) \
+  X(BINARY_MULTIPLY_INT,              35) \
+  X(BINARY_MULTIPLY_FLOAT,            36) \
+  X(INPLACE_ADD_INT,                  37) \
+  X(INPLACE_ADD_FLOAT,                38) \
+  X(INPLACE_ADD_UNICODE,              39) \
+  X(CALL_FUNCTION_PY_EXACT_ARGS,      40) \
+  X(CALL_FUNCTION_BUILTIN_FAST,       41) \
+  X(CALL_FUNCTION_BUILTIN_O,          42) \
+  X(CALL_FUNCTION_TYPE_ALLOC,         43) \
+  X(CALL_METHOD_PY,                   44) \
+  X(CALL_METHOD_DESCR_FAST,           45) \
+  X(CALL_METHOD_DESCR_O,              46) \
   X(GET_AITER,                        50) \
   X(GET_ANEXT,                        51) \
   X(BEFORE_ASYNC_WITH,                52) \
@@ -78,6 +95,7 @@ extern "C" {
   X(DELETE_ATTR,                      96) \
   X(STORE_GLOBAL,                     97) \
   X(DELETE_GLOBAL,                    98) \
+  X(FOR_ITER_LIST,                    99) \
   X(LOAD_CONST,                      100) \
   X(LOAD_NAME,                       101) \
   X(BUILD_TUPLE,                     102) \
@@ -97,14 +115,22 @@ extern "C" {
   X(LOAD_GLOBAL,                     116) \
   X(CAST_CACHED_EXACT,               117) \
   X(CAST_CACHED_OPTIONAL_EXACT,      118) \
+  X(COMPARE_OP_INT,                  119) \
+  X(COMPARE_OP_FLOAT,                120) \
+  X(COMPARE_OP_STR_EQ,               121) \
   X(SETUP_FINALLY,                   122) \
+  X(FOR_ITER_TUPLE,                  123) \
   X(LOAD_FAST,                       124) \
   X(STORE_FAST,                      125) \
   X(DELETE_FAST,                     126) \
+  X(FOR_ITER_RANGE,                  127) \
+  X(FOR_ITER_DICT_ITEMS,             128) \
+  X(UNPACK_SEQUENCE_TUPLE2,          129) \
   X(RAISE_VARARGS,                   130) \
   X(CALL_FUNCTION,                   131) \
   X(MAKE_FUNCTION,                   132) \
   X(BUILD_SLICE,                     133) \
+  X(UNPACK_SEQUENCE_LIST,            134) \
   X(LOAD_CLOSURE,                    135) \
   X(LOAD_DEREF,                      136) \
   X(STORE_DEREF,                     137) \
@@ -3,8 +3,11 @@
 #include "Jit/pyjit.h"
 #include "Jit/threaded_compile.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 
 using namespace jit::codegen;
@@ -14,12 +17,25 @@ namespace jit {
 // 2MiB to match Linux's huge-page size.
 const size_t kAllocSize = 1024 * 1024 * 2;
 
+// Granularity of copy-on-write sharing, and of /proc/self/pagemap entries.
+const size_t kSmallPageSize = 4096;
+
+// Leftovers smaller than this aren't worth keeping on the free list; they stay
+// attached to the block that was handed out.
+const size_t kMinFreeBlockSize = 64;
+
 CodeAllocator* CodeAllocator::s_global_code_allocator_ = nullptr;
 
-std::vector<void*> CodeAllocatorCinder::s_allocations_{};
+std::vector<std::pair<void*, size_t>> CodeAllocatorCinder::s_allocations_{};
+size_t CodeAllocatorCinder::s_num_sealed_ = 0;
 uint8_t* CodeAllocatorCinder::s_current_alloc_ = nullptr;
 size_t CodeAllocatorCinder::s_current_alloc_free_ = 0;
 
+std::map<uint8_t*, size_t> CodeAllocatorCinder::s_live_blocks_{};
+std::map<uint8_t*, size_t> CodeAllocatorCinder::s_free_blocks_{};
+std::multimap<size_t, uint8_t*> CodeAllocatorCinder::s_free_sizes_{};
+size_t CodeAllocatorCinder::s_free_bytes_ = 0;
+
 size_t CodeAllocatorCinder::s_used_bytes_ = 0;
 size_t CodeAllocatorCinder::s_lost_bytes_ = 0;
 size_t CodeAllocatorCinder::s_huge_allocs_ = 0;
@@ -27,6 +43,44 @@ size_t CodeAllocatorCinder::s_fragmented_allocs_ = 0;
 
 CodeAllocator::~CodeAllocator() {}
 
+CodeAllocator::SealedPageStats CodeAllocator::sealedPageStats() const {
+  SealedPageStats stats;
+  int fd = open("/proc/self/pagemap", O_RDONLY);
+  if (fd < 0) {
+    return stats;
+  }
+  for (auto& [start, size] : sealed_ranges_) {
+    auto first = reinterpret_cast<uintptr_t>(start) / kSmallPageSize;
+    auto last = (reinterpret_cast<uintptr_t>(start) + size - 1) / kSmallPageSize;
+    for (uintptr_t page = first; page <= last; page++) {
+      uint64_t entry;
+      if (pread(fd, &entry, sizeof(entry), page * sizeof(entry)) !=
+          sizeof(entry)) {
+        break;
+      }
+      // Bit 63 is "page present" and bit 56 is "page exclusively mapped"; see
+      // Documentation/admin-guide/mm/pagemap.rst.
+      if (!(entry & (uint64_t{1} << 63))) {
+        continue;
+      }
+      stats.resident_pages++;
+      if (!(entry & (uint64_t{1} << 56))) {
+        stats.shared_pages++;
+      }
+    }
+  }
+  close(fd);
+  return stats;
+}
+
+size_t CodeAllocator::sealedBytes() const {
+  size_t total = 0;
+  for (auto& range : sealed_ranges_) {
+    total += range.second;
+  }
+  return total;
+}
+
 void CodeAllocator::makeGlobalCodeAllocator() {
   JIT_CHECK(
       s_global_code_allocator_ == nullptr, "Global allocator already set");
@@ -45,14 +99,38 @@ void CodeAllocator::freeGlobalCodeAllocator() {
   s_global_code_allocator_ = nullptr;
 }
 
+asmjit::Error CodeAllocatorAsmJit::addCode(
+    void** dst,
+    asmjit::CodeHolder* code) noexcept {
+  ThreadedCompileSerialize guard;
+  ASMJIT_PROPAGATE(_runtime->add(dst, code));
+  code_starts_.emplace(static_cast<uint8_t*>(*dst));
+  return asmjit::kErrorOk;
+}
+
+void CodeAllocatorAsmJit::releaseCode(void* addr) {
+  ThreadedCompileSerialize guard;
+  auto it = code_starts_.upper_bound(static_cast<uint8_t*>(addr));
+  JIT_CHECK(it != code_starts_.begin(), "Releasing unknown code %p", addr);
+  --it;
+  _runtime->release(*it);
+  code_starts_.erase(it);
+}
+
 CodeAllocatorCinder::~CodeAllocatorCinder() {
-  for (void* alloc : s_allocations_) {
-    JIT_CHECK(munmap(alloc, kAllocSize) == 0, "Freeing code memory failed");
+  for (auto& [alloc, size] : s_allocations_) {
+    JIT_CHECK(munmap(alloc, size) == 0, "Freeing code memory failed");
   }
   s_allocations_.clear();
+  s_num_sealed_ = 0;
   s_current_alloc_ = nullptr;
   s_current_alloc_free_ = 0;
 
+  s_live_blocks_.clear();
+  s_free_blocks_.clear();
+  s_free_sizes_.clear();
+  s_free_bytes_ = 0;
+
   s_used_bytes_ = 0;
   s_lost_bytes_ = 0;
   s_huge_allocs_ = 0;
@@ -70,35 +148,41 @@ asmjit::Error CodeAllocatorCinder::addCode(
   ASMJIT_PROPAGATE(code->resolveUnresolvedLinks());
 
   size_t max_code_size = code->codeSize();
-  size_t alloc_size = ((max_code_size / kAllocSize) + 1) * kAllocSize;
-  if (s_current_alloc_free_ < max_code_size) {
-    s_lost_bytes_ += s_current_alloc_free_;
-    void* res = mmap(
-        NULL,
-        alloc_size,
-        PROT_EXEC | PROT_READ | PROT_WRITE,
-        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
-        -1,
-        0);
-    if (res == MAP_FAILED) {
-      res = mmap(
+  size_t block_size = 0;
+  uint8_t* block = takeFreeBlock(max_code_size, &block_size);
+  bool from_free_list = block != nullptr;
+  if (!from_free_list) {
+    size_t alloc_size = ((max_code_size / kAllocSize) + 1) * kAllocSize;
+    if (s_current_alloc_free_ < max_code_size) {
+      s_lost_bytes_ += s_current_alloc_free_;
+      void* res = mmap(
           NULL,
           alloc_size,
           PROT_EXEC | PROT_READ | PROT_WRITE,
-          MAP_PRIVATE | MAP_ANONYMOUS,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
           -1,
           0);
-      JIT_CHECK(res != MAP_FAILED, "Failed to allocate memory for code");
-      s_fragmented_allocs_++;
-    } else {
-      s_huge_allocs_++;
+      if (res == MAP_FAILED) {
+        res = mmap(
+            NULL,
+            alloc_size,
+            PROT_EXEC | PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0);
+        JIT_CHECK(res != MAP_FAILED, "Failed to allocate memory for code");
+        s_fragmented_allocs_++;
+      } else {
+        s_huge_allocs_++;
+      }
+      s_current_alloc_ = static_cast<uint8_t*>(res);
+      s_allocations_.emplace_back(res, alloc_size);
+      s_current_alloc_free_ = alloc_size;
     }
-    s_current_alloc_ = static_cast<uint8_t*>(res);
-    s_allocations_.emplace_back(res);
-    s_current_alloc_free_ = alloc_size;
+    block = s_current_alloc_;
   }
 
-  ASMJIT_PROPAGATE(code->relocateToBase(uintptr_t(s_current_alloc_)));
+  ASMJIT_PROPAGATE(code->relocateToBase(uintptr_t(block)));
 
   size_t actual_code_size = code->codeSize();
   JIT_CHECK(actual_code_size <= max_code_size, "Code grew during relocation");
@@ -110,27 +194,135 @@ asmjit::Error CodeAllocatorCinder::addCode(
 
     JIT_CHECK(
         offset + buffer_size <= actual_code_size, "Inconsistent code size");
-    std::memcpy(s_current_alloc_ + offset, section->data(), buffer_size);
+    std::memcpy(block + offset, section->data(), buffer_size);
 
     if (virtual_size > buffer_size) {
       JIT_CHECK(
           offset + virtual_size <= actual_code_size, "Inconsistent code size");
-      std::memset(
-          s_current_alloc_ + offset + buffer_size,
-          0,
-          virtual_size - buffer_size);
+      std::memset(block + offset + buffer_size, 0, virtual_size - buffer_size);
     }
   }
 
-  *dst = s_current_alloc_;
+  *dst = block;
 
-  s_current_alloc_ += actual_code_size;
-  s_current_alloc_free_ -= actual_code_size;
-  s_used_bytes_ += actual_code_size;
+  if (!from_free_list) {
+    block_size = actual_code_size;
+    s_current_alloc_ += actual_code_size;
+    s_current_alloc_free_ -= actual_code_size;
+  }
+  s_live_blocks_.emplace(block, block_size);
+  s_used_bytes_ += block_size;
 
   return asmjit::kErrorOk;
 }
 
+void CodeAllocatorCinder::releaseCode(void* addr) {
+  ThreadedCompileSerialize guard;
+  auto it = s_live_blocks_.upper_bound(static_cast<uint8_t*>(addr));
+  JIT_CHECK(it != s_live_blocks_.begin(), "Releasing unknown code %p", addr);
+  --it;
+  auto [start, size] = *it;
+  JIT_CHECK(
+      static_cast<uint8_t*>(addr) < start + size,
+      "Releasing unknown code %p",
+      addr);
+  s_live_blocks_.erase(it);
+  s_used_bytes_ -= size;
+  if (isSealed(start)) {
+    // Reusing the block would unshare its pages from forked processes.
+    s_lost_bytes_ += size;
+    return;
+  }
+  addFreeBlock(start, size);
+}
+
+size_t CodeAllocatorCinder::fragmentedBytes() {
+  if (s_free_sizes_.empty()) {
+    return 0;
+  }
+  return s_free_bytes_ - s_free_sizes_.rbegin()->first;
+}
+
+uint8_t* CodeAllocatorCinder::takeFreeBlock(size_t size, size_t* block_size) {
+  auto size_it = s_free_sizes_.lower_bound(size);
+  if (size_it == s_free_sizes_.end()) {
+    return nullptr;
+  }
+  uint8_t* start = size_it->second;
+  size_t free_size = size_it->first;
+  removeFreeBlock(s_free_blocks_.find(start));
+  if (free_size - size >= kMinFreeBlockSize) {
+    // The block after this one is in use (or we would have merged with it),
+    // so the leftover can go straight back without merging.
+    s_free_blocks_.emplace(start + size, free_size - size);
+    s_free_sizes_.emplace(free_size - size, start + size);
+    s_free_bytes_ += free_size - size;
+    free_size = size;
+  }
+  *block_size = free_size;
+  return start;
+}
+
+void CodeAllocatorCinder::addFreeBlock(uint8_t* start, size_t size) {
+  auto next = s_free_blocks_.lower_bound(start);
+  if (next != s_free_blocks_.end() && start + size == next->first) {
+    size += next->second;
+    next = std::next(next);
+    removeFreeBlock(std::prev(next));
+  }
+  if (next != s_free_blocks_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == start) {
+      start = prev->first;
+      size += prev->second;
+      removeFreeBlock(prev);
+    }
+  }
+  s_free_blocks_.emplace(start, size);
+  s_free_sizes_.emplace(size, start);
+  s_free_bytes_ += size;
+}
+
+void CodeAllocatorCinder::removeFreeBlock(
+    std::map<uint8_t*, size_t>::iterator it) {
+  auto [start, size] = *it;
+  auto range = s_free_sizes_.equal_range(size);
+  for (auto size_it = range.first; size_it != range.second; ++size_it) {
+    if (size_it->second == start) {
+      s_free_sizes_.erase(size_it);
+      break;
+    }
+  }
+  s_free_bytes_ -= size;
+  s_free_blocks_.erase(it);
+}
+
+bool CodeAllocatorCinder::isSealed(const uint8_t* addr) const {
+  for (auto& [start, size] : sealed_ranges_) {
+    if (addr >= start && addr < start + size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CodeAllocatorCinder::seal() {
+  ThreadedCompileSerialize guard;
+  // Each chunk may be a single huge page, so writing anywhere in it after
+  // fork() would copy the whole chunk. Give up on the rest of the current one.
+  s_lost_bytes_ += s_current_alloc_free_;
+  s_current_alloc_free_ = 0;
+  // Likewise for anything on the free list.
+  s_lost_bytes_ += s_free_bytes_;
+  s_free_blocks_.clear();
+  s_free_sizes_.clear();
+  s_free_bytes_ = 0;
+  for (; s_num_sealed_ < s_allocations_.size(); s_num_sealed_++) {
+    auto& [alloc, size] = s_allocations_[s_num_sealed_];
+    sealed_ranges_.emplace_back(static_cast<uint8_t*>(alloc), size);
+  }
+}
+
 MultipleSectionCodeAllocator::~MultipleSectionCodeAllocator() {
   if (code_alloc_ == nullptr) {
     return;
@@ -250,4 +442,27 @@ asmjit::Error MultipleSectionCodeAllocator::addCode(
   return asmjit::kErrorOk;
 }
 
+void MultipleSectionCodeAllocator::seal() {
+  ThreadedCompileSerialize guard;
+  if (code_sections_.empty()) {
+    return;
+  }
+  // The hot section is backed by huge pages where the kernel allows it.
+  const size_t kHugePageSize = 1024 * 1024 * 2;
+  uint8_t* sealed_end = code_alloc_;
+  for (auto& [section, cursor] : code_sections_) {
+    size_t align =
+        section == CodeSection::kHot ? kHugePageSize : kSmallPageSize;
+    uint8_t* page_end = reinterpret_cast<uint8_t*>(
+        asmjit::Support::alignUp(reinterpret_cast<uintptr_t>(cursor), align));
+    size_t& free_size = code_section_free_sizes_[section];
+    size_t skipped = std::min<size_t>(page_end - cursor, free_size);
+    cursor += skipped;
+    free_size -= skipped;
+    sealed_end = std::max(sealed_end, cursor);
+  }
+  sealed_ranges_.clear();
+  sealed_ranges_.emplace_back(code_alloc_, sealed_end - code_alloc_);
+}
+
 }; // namespace jit
@@ -5,7 +5,10 @@
 #include "Jit/codegen/code_section.h"
 #include "Jit/log.h"
 
+#include <map>
 #include <memory>
+#include <set>
+#include <utility>
 #include <vector>
 
 namespace jit {
@@ -47,7 +50,34 @@ class CodeAllocator {
       void** dst,
       asmjit::CodeHolder* code) noexcept = 0;
 
+  // Give back the memory holding the code that contains addr, which must have
+  // been placed by addCode(). The caller is responsible for making sure that
+  // nothing can execute or jump into the code anymore. Allocators that can't
+  // reuse memory ignore this.
+  virtual void releaseCode(void* /* addr */) {}
+
+  // Stop placing new code on any page that already holds code, so that the
+  // pages filled so far are never written again. Used before forking worker
+  // processes, which can then share those pages with the parent.
+  virtual void seal() {}
+
+  struct SealedPageStats {
+    // Number of sealed pages that are backed by memory in this process.
+    size_t resident_pages{0};
+    // Number of resident sealed pages that are still shared with another
+    // process (i.e. haven't been copied on write since fork()).
+    size_t shared_pages{0};
+  };
+
+  // Inspect /proc/self/pagemap to see how many sealed pages are still shared.
+  SealedPageStats sealedPageStats() const;
+
+  size_t sealedBytes() const;
+
  protected:
+  // Memory ranges that hold code and have been sealed.
+  std::vector<std::pair<uint8_t*, size_t>> sealed_ranges_;
+
   std::unique_ptr<asmjit::JitRuntime> _runtime{
       std::make_unique<asmjit::JitRuntime>()};
 
@@ -60,22 +90,44 @@ class CodeAllocatorAsmJit : public CodeAllocator {
   virtual ~CodeAllocatorAsmJit() {}
 
   asmjit::Error addCode(void** dst, asmjit::CodeHolder* code) noexcept
-      override {
-    return _runtime->add(dst, code);
-  }
+      override;
+
+  void releaseCode(void* addr) override;
+
+ private:
+  // Start addresses of the code added through _runtime, which only accepts
+  // those back.
+  std::set<uint8_t*> code_starts_;
 };
 
 // A code allocator which tries to allocate all code on huge pages.
+//
+// Code is bump-allocated from each chunk. Released code goes on a free list,
+// which is searched (best fit) before carving out more of the current chunk.
 class CodeAllocatorCinder : public CodeAllocator {
  public:
   virtual ~CodeAllocatorCinder();
 
   asmjit::Error addCode(void** dst, asmjit::CodeHolder* code) noexcept override;
 
+  void releaseCode(void* addr) override;
+
+  void seal() override;
+
+  // Bytes currently holding live code.
   static size_t usedBytes() {
     return s_used_bytes_;
   }
 
+  // Bytes of released code waiting on the free list to be reused.
+  static size_t freeBytes() {
+    return s_free_bytes_;
+  }
+
+  // Free bytes that aren't part of the largest free block, i.e. that can only
+  // serve allocations smaller than that block.
+  static size_t fragmentedBytes();
+
   static size_t lostBytes() {
     return s_lost_bytes_;
   }
@@ -89,14 +141,38 @@ class CodeAllocatorCinder : public CodeAllocator {
   }
 
  private:
-  // List of chunks allocated for use in deallocation
-  static std::vector<void*> s_allocations_;
+  // Remove the smallest free block of at least size bytes from the free list,
+  // putting back whatever is left over if it's big enough to be useful.
+  // Returns nullptr if there is no such block; otherwise *block_size is set to
+  // the number of bytes handed out.
+  static uint8_t* takeFreeBlock(size_t size, size_t* block_size);
+
+  // Put a block on the free list, merging it with any free neighbours.
+  static void addFreeBlock(uint8_t* start, size_t size);
+
+  static void removeFreeBlock(std::map<uint8_t*, size_t>::iterator it);
+
+  bool isSealed(const uint8_t* addr) const;
+
+  // List of chunks allocated, and their sizes, for use in deallocation
+  static std::vector<std::pair<void*, size_t>> s_allocations_;
+  // Number of chunks in s_allocations_ that have been sealed
+  static size_t s_num_sealed_;
 
   // Pointer to next free address in the current chunk
   static uint8_t* s_current_alloc_;
   // Free space in the current chunk
   static size_t s_current_alloc_free_;
 
+  // Blocks handed out by addCode(), keyed by start address.
+  static std::map<uint8_t*, size_t> s_live_blocks_;
+  // Released blocks, keyed by start address so that neighbours can be
+  // merged, and by size for best-fit lookup. Blocks on sealed pages are never
+  // put here.
+  static std::map<uint8_t*, size_t> s_free_blocks_;
+  static std::multimap<size_t, uint8_t*> s_free_sizes_;
+  static size_t s_free_bytes_;
+
   static size_t s_used_bytes_;
   // Number of bytes in total lost when allocations didn't fit neatly into
   // the bytes remaining in a chunk so a new one was allocated.
@@ -115,6 +191,8 @@ class MultipleSectionCodeAllocator : public CodeAllocator {
 
   asmjit::Error addCode(void** dst, asmjit::CodeHolder* code) noexcept override;
 
+  void seal() override;
+
  private:
   void createSlabs() noexcept;
 
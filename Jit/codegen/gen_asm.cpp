@@ -546,16 +546,21 @@ void NativeGenerator::loadOrGenerateLinkFrame(
         as_->push(x86::rax);
       }
 
-      as_->mov(
-          x86::rdi,
-          reinterpret_cast<intptr_t>(
-              codeRuntime()->frameState()->code().get()));
-      as_->mov(
-          x86::rsi,
-          reinterpret_cast<intptr_t>(
-              codeRuntime()->frameState()->globals().get()));
-
-      as_->call(reinterpret_cast<uint64_t>(JITRT_AllocateAndLinkFrame));
+      if (GetFunction()->osr_entry.has_value()) {
+        // The interpreter's frame is already linked in; keep running on it.
+        as_->call(reinterpret_cast<uint64_t>(JITRT_AdoptFrameForOSR));
+      } else {
+        as_->mov(
+            x86::rdi,
+            reinterpret_cast<intptr_t>(
+                codeRuntime()->frameState()->code().get()));
+        as_->mov(
+            x86::rsi,
+            reinterpret_cast<intptr_t>(
+                codeRuntime()->frameState()->globals().get()));
+
+        as_->call(reinterpret_cast<uint64_t>(JITRT_AllocateAndLinkFrame));
+      }
       as_->mov(tstate_reg, x86::rax);
 
       if (align_stack) {
@@ -735,7 +740,14 @@ void NativeGenerator::generatePrologue(
     }
   }
 
-  if (!func_->has_primitive_args) {
+  // OSR entries are only called by the interpreter, with exactly the values
+  // they expect, so there's nothing to check. They're never static.
+  bool is_osr = func_->osr_entry.has_value();
+  JIT_CHECK(
+      !is_osr || !(code->co_flags & CO_STATICALLY_COMPILED),
+      "Unexpected OSR entry into static code");
+
+  if (!func_->has_primitive_args && !is_osr) {
     as_->test(x86::rcx, x86::rcx); // test for kwargs
     if (!((code->co_flags & (CO_VARARGS | CO_VARKEYWORDS)) ||
           code->co_kwonlyargcount)) {
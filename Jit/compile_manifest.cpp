@@ -0,0 +1,106 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include "Jit/compile_manifest.h"
+
+#include "Jit/containers.h"
+#include "Jit/log.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace jit {
+
+namespace {
+
+const char* kManifestHeader = "# cinderjit compile manifest v1";
+
+UnorderedSet<CodeKey> s_manifest_keys;
+
+} // namespace
+
+bool readCompileManifest(const std::string& filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    JIT_LOG("Failed to open %s for reading", filename);
+    return false;
+  }
+  if (readCompileManifest(file)) {
+    JIT_LOG(
+        "Loaded compile manifest with %d code objects from %s",
+        s_manifest_keys.size(),
+        filename);
+    return true;
+  }
+  return false;
+}
+
+bool readCompileManifest(std::istream& stream) {
+  std::string line;
+  if (!std::getline(stream, line) || line != kManifestHeader) {
+    JIT_LOG("Bad header in compile manifest stream");
+    return false;
+  }
+  while (std::getline(stream, line)) {
+    if (!line.empty()) {
+      s_manifest_keys.emplace(std::move(line));
+    }
+  }
+  return !stream.bad();
+}
+
+bool writeCompileManifest(
+    const std::string& filename,
+    const std::vector<BorrowedRef<PyCodeObject>>& compiled) {
+  // Many processes may write the same manifest at exit, so write to a private
+  // file and rename it into place.
+  std::string tmp_filename = fmt::format("{}.{}.tmp", filename, getpid());
+  {
+    std::ofstream file(tmp_filename);
+    if (!file) {
+      JIT_LOG("Failed to open %s for writing", tmp_filename);
+      return false;
+    }
+    if (!writeCompileManifest(file, compiled)) {
+      return false;
+    }
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    JIT_LOG("Failed to rename %s to %s", tmp_filename, filename);
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool writeCompileManifest(
+    std::ostream& stream,
+    const std::vector<BorrowedRef<PyCodeObject>>& compiled) {
+  UnorderedSet<CodeKey> keys = s_manifest_keys;
+  for (BorrowedRef<PyCodeObject> code : compiled) {
+    keys.emplace(codeKey(code));
+  }
+  stream << kManifestHeader << '\n';
+  for (const CodeKey& key : keys) {
+    stream << key << '\n';
+  }
+  stream.flush();
+  return !stream.fail();
+}
+
+bool inCompileManifest(PyCodeObject* code) {
+  if (s_manifest_keys.empty()) {
+    return false;
+  }
+  return s_manifest_keys.count(codeKey(code)) != 0;
+}
+
+size_t compileManifestSize() {
+  return s_manifest_keys.size();
+}
+
+void clearCompileManifest() {
+  s_manifest_keys.clear();
+}
+
+} // namespace jit
@@ -0,0 +1,57 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#pragma once
+
+#include "Python.h"
+
+#include "Jit/profile_data.h"
+#include "Jit/ref.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace jit {
+
+// A compile manifest records the code keys (see codeKey()) of every code
+// object that was JIT-compiled by a process. When a later process loads the
+// manifest, auto-JIT compiles matching code objects on their first call
+// instead of waiting for them to cross the call-count threshold again. Since
+// code keys include a hash of the bytecode, entries for code that has changed
+// since the manifest was written never match.
+//
+// This is not a code cache: nothing compiled by an earlier process is reused,
+// so a manifest moves compilation earlier (and, with -X jit-auto-async, off
+// the calling thread) without reducing it. Persisting machine code would need
+// relocation of every embedded object, type and cache address plus
+// revalidation of the speculation it was compiled under, which the backend
+// does not support.
+//
+// The format is plain text: a header line followed by one code key per line.
+
+// Load a compile manifest from the given filename or stream, returning true on
+// success. Loaded keys are added to any that were already loaded.
+bool readCompileManifest(const std::string& filename);
+bool readCompileManifest(std::istream& stream);
+
+// Write a compile manifest containing all loaded keys plus the keys of the
+// given code objects to the given filename or stream, returning true on
+// success. Writing to a filename is atomic with respect to concurrent readers
+// and writers.
+bool writeCompileManifest(
+    const std::string& filename,
+    const std::vector<BorrowedRef<PyCodeObject>>& compiled);
+bool writeCompileManifest(
+    std::ostream& stream,
+    const std::vector<BorrowedRef<PyCodeObject>>& compiled);
+
+// Return true if the given code object was present in a loaded manifest.
+bool inCompileManifest(PyCodeObject* code);
+
+// Return the number of loaded keys.
+size_t compileManifestSize();
+
+// Clear all loaded keys.
+void clearCompileManifest();
+
+} // namespace jit
@@ -106,6 +106,9 @@ void Compiler::runPasses(
     runPass<jit::hir::BeginInlinedFunctionElimination>(irfunc, callback);
   }
   runPass<jit::hir::BuiltinLoadMethodElimination>(irfunc, callback);
+  runPass<jit::hir::GlobalValueNumbering>(irfunc, callback);
+  runPass<jit::hir::LoopInvariantCodeMotion>(irfunc, callback);
+  runPass<jit::hir::ScalarReplacement>(irfunc, callback);
   runPass<jit::hir::DeadCodeElimination>(irfunc, callback);
   runPass<jit::hir::RefcountInsertion>(irfunc, callback);
   JIT_LOGIF(
@@ -122,7 +125,8 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
 }
 
 std::unique_ptr<CompiledFunction> Compiler::Compile(
-    const jit::hir::Preloader& preloader) {
+    const jit::hir::Preloader& preloader,
+    const jit::hir::OSREntry* osr_entry) {
   const std::string& fullname = preloader.fullname();
   if (!PyDict_CheckExact(preloader.globals())) {
     JIT_DLOG(
@@ -132,12 +136,11 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
     return nullptr;
   }
 
-  PyObject* builtins = PyEval_GetBuiltins();
   if (!PyDict_CheckExact(preloader.builtins())) {
     JIT_DLOG(
         "Refusing to compile %s: builtins is a %.200s, not a dict",
         fullname,
-        Py_TYPE(builtins)->tp_name);
+        Py_TYPE(preloader.builtins())->tp_name);
     return nullptr;
   }
   JIT_DLOG(
@@ -153,7 +156,9 @@ std::unique_ptr<CompiledFunction> Compiler::Compile(
     compilation_phase_timer->start("Lowering into HIR");
   }
 
-  std::unique_ptr<jit::hir::Function> irfunc(jit::hir::buildHIR(preloader));
+  std::unique_ptr<jit::hir::Function> irfunc(
+      osr_entry == nullptr ? jit::hir::buildHIR(preloader)
+                           : jit::hir::buildOSRHIR(preloader, *osr_entry));
   if (nullptr != compilation_phase_timer) {
     compilation_phase_timer->end();
   }
@@ -114,8 +114,12 @@ class Compiler {
  public:
   Compiler() = default;
 
-  // Compile the function / code object preloaded by the given Preloader.
-  std::unique_ptr<CompiledFunction> Compile(const hir::Preloader& preloader);
+  // Compile the function / code object preloaded by the given Preloader. If
+  // osr_entry is given, compile an OSR entry into the code at that point
+  // instead of a normal entry.
+  std::unique_ptr<CompiledFunction> Compile(
+      const hir::Preloader& preloader,
+      const hir::OSREntry* osr_entry = nullptr);
 
   // Convenience wrapper to create and compile a preloader from a
   // PyFunctionObject.
@@ -0,0 +1,183 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include "Jit/gen_data_allocator.h"
+
+#include "Jit/log.h"
+#include "Jit/runtime.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace jit {
+
+namespace {
+
+// Lives at the start of each slab, followed by its blocks.
+struct Slab {
+  // Links in the size class's list of slabs with at least one free block.
+  Slab* prev;
+  Slab* next;
+
+  // Blocks that have been released, linked through their first word.
+  void* free_list;
+  // Index of the first block that has never been handed out.
+  size_t num_carved;
+  size_t live_blocks;
+  size_t size_class;
+};
+
+constexpr size_t kBlockAlign = 16;
+constexpr size_t kSlabHeaderSize =
+    (sizeof(Slab) + kBlockAlign - 1) & ~(kBlockAlign - 1);
+
+struct SizeClass {
+  Slab* avail{nullptr};
+  size_t slabs{0};
+  size_t live_blocks{0};
+};
+
+std::array<SizeClass, GenDataAllocator::kNumSizeClasses> s_size_classes;
+size_t s_large_blocks = 0;
+
+size_t blockSize(size_t size_class) {
+  size_t size = GenDataAllocator::kSizeClassWords[size_class] *
+          sizeof(uint64_t) +
+      sizeof(GenDataFooter);
+  return (size + kBlockAlign - 1) & ~(kBlockAlign - 1);
+}
+
+size_t slabCapacity(size_t size_class) {
+  return (GenDataAllocator::kSlabSize - kSlabHeaderSize) /
+      blockSize(size_class);
+}
+
+bool isFull(const Slab* slab) {
+  return slab->free_list == nullptr &&
+      slab->num_carved == slabCapacity(slab->size_class);
+}
+
+void pushAvail(SizeClass& cls, Slab* slab) {
+  slab->prev = nullptr;
+  slab->next = cls.avail;
+  if (cls.avail != nullptr) {
+    cls.avail->prev = slab;
+  }
+  cls.avail = slab;
+}
+
+void unlinkAvail(SizeClass& cls, Slab* slab) {
+  if (slab->prev != nullptr) {
+    slab->prev->next = slab->next;
+  } else {
+    cls.avail = slab->next;
+  }
+  if (slab->next != nullptr) {
+    slab->next->prev = slab->prev;
+  }
+  slab->prev = slab->next = nullptr;
+}
+
+size_t sizeClassFor(size_t spill_words) {
+  for (size_t i = 0; i < GenDataAllocator::kNumSizeClasses; i++) {
+    if (spill_words <= GenDataAllocator::kSizeClassWords[i]) {
+      return i;
+    }
+  }
+  return GenDataAllocator::kNumSizeClasses;
+}
+
+} // namespace
+
+size_t GenDataAllocator::roundUp(size_t spill_words) {
+  size_t size_class = sizeClassFor(spill_words);
+  return size_class == kNumSizeClasses ? spill_words
+                                       : kSizeClassWords[size_class];
+}
+
+void* GenDataAllocator::allocate(size_t spill_words) {
+  size_t size_class = sizeClassFor(spill_words);
+  if (size_class == kNumSizeClasses) {
+    void* data =
+        std::malloc(spill_words * sizeof(uint64_t) + sizeof(GenDataFooter));
+    if (data != nullptr) {
+      s_large_blocks++;
+    }
+    return data;
+  }
+
+  SizeClass& cls = s_size_classes[size_class];
+  Slab* slab = cls.avail;
+  if (slab == nullptr) {
+    slab = static_cast<Slab*>(std::aligned_alloc(kSlabSize, kSlabSize));
+    if (slab == nullptr) {
+      return nullptr;
+    }
+    slab->free_list = nullptr;
+    slab->num_carved = 0;
+    slab->live_blocks = 0;
+    slab->size_class = size_class;
+    pushAvail(cls, slab);
+    cls.slabs++;
+  }
+
+  void* block;
+  if (slab->free_list != nullptr) {
+    block = slab->free_list;
+    slab->free_list = *static_cast<void**>(block);
+  } else {
+    block = reinterpret_cast<char*>(slab) + kSlabHeaderSize +
+        slab->num_carved * blockSize(size_class);
+    slab->num_carved++;
+  }
+  slab->live_blocks++;
+  cls.live_blocks++;
+  if (isFull(slab)) {
+    unlinkAvail(cls, slab);
+  }
+  return block;
+}
+
+void GenDataAllocator::release(void* data, size_t spill_words) {
+  size_t size_class = sizeClassFor(spill_words);
+  if (size_class == kNumSizeClasses) {
+    std::free(data);
+    s_large_blocks--;
+    return;
+  }
+  JIT_DCHECK(
+      spill_words == kSizeClassWords[size_class],
+      "%d spill words isn't a size class",
+      spill_words);
+
+  auto slab = reinterpret_cast<Slab*>(
+      reinterpret_cast<uintptr_t>(data) & ~(kSlabSize - 1));
+  JIT_DCHECK(slab->size_class == size_class, "block from the wrong slab");
+  SizeClass& cls = s_size_classes[size_class];
+  bool was_full = isFull(slab);
+  *static_cast<void**>(data) = slab->free_list;
+  slab->free_list = data;
+  slab->live_blocks--;
+  cls.live_blocks--;
+
+  if (slab->live_blocks == 0 && cls.slabs > 1) {
+    if (!was_full) {
+      unlinkAvail(cls, slab);
+    }
+    std::free(slab);
+    cls.slabs--;
+  } else if (was_full) {
+    pushAvail(cls, slab);
+  }
+}
+
+GenDataAllocator::SizeClassStats GenDataAllocator::sizeClassStats(
+    size_t size_class) {
+  JIT_CHECK(size_class < kNumSizeClasses, "Bad size class %d", size_class);
+  const SizeClass& cls = s_size_classes[size_class];
+  return {kSizeClassWords[size_class], cls.live_blocks, cls.slabs};
+}
+
+size_t GenDataAllocator::largeBlocks() {
+  return s_large_blocks;
+}
+
+} // namespace jit
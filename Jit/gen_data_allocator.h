@@ -0,0 +1,57 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace jit {
+
+// Allocates the memory holding a JIT generator's spill area, which is
+// immediately followed by its GenDataFooter.
+//
+// Requests are rounded up to one of a few size classes. Blocks of each class
+// are carved out of fixed-size, aligned slabs with a free list per slab, so
+// generators of similar size share pages and a block can find its slab from
+// its address. A slab goes back to the system once all of its blocks are free,
+// unless it's the last slab of its class. Requests bigger than the largest
+// class are passed to malloc().
+//
+// Not thread-safe; callers must hold the GIL.
+class GenDataAllocator {
+ public:
+  static constexpr size_t kSlabSize = 64 * 1024;
+  static constexpr size_t kNumSizeClasses = 6;
+
+  // Spill words available to blocks of each size class.
+  static constexpr std::array<size_t, kNumSizeClasses> kSizeClassWords{
+      8,
+      16,
+      32,
+      64,
+      128,
+      256};
+
+  // Return the number of spill words that a request for spill_words will
+  // actually get. The footer lives right after that many words.
+  static size_t roundUp(size_t spill_words);
+
+  // Allocate a block with room for roundUp(spill_words) words followed by a
+  // GenDataFooter. Returns nullptr if out of memory.
+  static void* allocate(size_t spill_words);
+
+  // Release a block from allocate(). spill_words must be the rounded-up size.
+  static void release(void* data, size_t spill_words);
+
+  struct SizeClassStats {
+    size_t spill_words{0};
+    size_t live_blocks{0};
+    size_t slabs{0};
+  };
+
+  static SizeClassStats sizeClassStats(size_t size_class);
+
+  // Number of live blocks that were too big for any size class.
+  static size_t largeBlocks();
+};
+
+} // namespace jit
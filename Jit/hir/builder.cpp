@@ -18,6 +18,7 @@
 #include "Jit/hir/type.h"
 #include "Jit/pyjit.h"
 #include "Jit/ref.h"
+#include "Jit/runtime.h"
 #include "Jit/threaded_compile.h"
 
 #include <algorithm>
@@ -367,6 +368,23 @@ void HIRBuilder::addLoadArgs(TranslationContext& tc, int num_args) {
   }
 }
 
+void HIRBuilder::addOSRLoadArgs(TranslationContext& tc) {
+  int arg_idx = 0;
+  // Locals may be unbound at the loop header, unlike arguments on entry.
+  for (Register* dst : tc.frame.locals) {
+    tc.emit<LoadArg>(dst, arg_idx++, TOptObject);
+  }
+  // Cells and freevars are already materialized in the interpreter frame.
+  for (Register* dst : tc.frame.cells) {
+    tc.emit<LoadArg>(dst, arg_idx++, TObject);
+  }
+  for (int i = 0; i < osr_entry_->stack_depth; i++) {
+    Register* dst = temps_.GetOrAllocateStack(i);
+    tc.emit<LoadArg>(dst, arg_idx++, TObject);
+    tc.frame.stack.push(dst);
+  }
+}
+
 // Add a MakeCell for each cellvar and load each freevar from closure.
 void HIRBuilder::addInitializeCells(
     TranslationContext& tc,
@@ -565,6 +583,12 @@ std::unique_ptr<Function> buildHIR(const Preloader& preloader) {
   return HIRBuilder{preloader}.buildHIR();
 }
 
+std::unique_ptr<Function> buildOSRHIR(
+    const Preloader& preloader,
+    const OSREntry& osr_entry) {
+  return HIRBuilder{preloader, osr_entry}.buildHIR();
+}
+
 // This performs an abstract interpretation over the bytecode for func in order
 // to translate it from a stack to register machine. The translation proceeds
 // in two passes over the bytecode. First, basic block boundaries are
@@ -584,6 +608,13 @@ std::unique_ptr<Function> HIRBuilder::buildHIR() {
   }
 
   std::unique_ptr<Function> irfunc = preloader_.makeFunction();
+  if (osr_entry_ != nullptr) {
+    // The interpreter frame already exists and owns the cells, so there is no
+    // need for the PyFunctionObject, and we always run on that frame.
+    irfunc->osr_entry = *osr_entry_;
+    irfunc->frameMode = FrameMode::kNormal;
+    irfunc->uses_runtime_func = false;
+  }
   buildHIRImpl(irfunc.get(), /*frame_state=*/nullptr);
   // Use RemoveTrampolineBlocks and RemoveUnreachableBlocks directly instead of
   // Run because the rest of CleanCFG requires SSA.
@@ -600,6 +631,32 @@ BasicBlock* HIRBuilder::buildHIRImpl(
   BytecodeInstructionBlock bc_instrs{code_};
   block_map_ = createBlocks(*irfunc, bc_instrs);
 
+  if (osr_entry_ != nullptr) {
+    JIT_CHECK(frame_state == nullptr, "Can't inline an OSR entry");
+    BasicBlock* entry_block = irfunc->cfg.AllocateBlock();
+    irfunc->cfg.entry_block = entry_block;
+    TranslationContext entry_tc{
+        entry_block,
+        FrameState{
+            code_,
+            preloader_.globals(),
+            preloader_.builtins(),
+            /*parent=*/nullptr}};
+    AllocateRegistersForLocals(&irfunc->env, entry_tc.frame);
+    AllocateRegistersForCells(&irfunc->env, entry_tc.frame);
+    entry_tc.frame.next_instr_offset = osr_entry_->offset;
+    entry_tc.frame.block_stack = osr_entry_->block_stack;
+    addOSRLoadArgs(entry_tc);
+
+    // Blocks that are only reachable before the loop header are never
+    // translated; buildHIR() removes them as unreachable.
+    BasicBlock* header = getBlockAtOff(osr_entry_->offset);
+    entry_block->appendWithOff<Branch>(osr_entry_->offset, header);
+    entry_tc.block = header;
+    translate(*irfunc, bc_instrs, entry_tc);
+    return entry_block;
+  }
+
   // Ensure that the entry block isn't a loop header
   BasicBlock* entry_block = getBlockAtOff(0);
   for (const auto& bci : bc_instrs) {
@@ -713,8 +770,13 @@ void HIRBuilder::emitProfiledTypes(
   ssize_t stack_idx = first_profile.size() - 1;
   if (bc_instr.opcode() == CALL_FUNCTION) {
     stack_idx = bc_instr.oparg();
+  } else if (bc_instr.opcode() == CALL_FUNCTION_KW) {
+    stack_idx = bc_instr.oparg() + 1;
   }
-  if (types.size() == 1) {
+  // A monomorphic guard that failed too often at runtime is demoted to a
+  // hint, so the recompiled code takes the generic path for this bytecode.
+  if (types.size() == 1 &&
+      !Runtime::get()->hasFailedSpeculation(tc.frame.code, bc_instr.offset())) {
     for (auto type : first_profile) {
       if (type != nullptr) {
         Register* value = tc.frame.stack.top(stack_idx);
@@ -2219,6 +2281,25 @@ void HIRBuilder::emitCompareOp(
   stack.push(result);
 }
 
+// Copy the interpreter's profile of the conditional jump at offset in code,
+// if there is one, to the CondBranch that was built from it.
+static void setBranchHits(
+    CondBranch* branch,
+    BorrowedRef<PyCodeObject> code,
+    BytecodeOffset offset) {
+  ThreadedCompileSerialize guard;
+  TypeProfiles& profiles = Runtime::get()->typeProfiles();
+  auto code_it = profiles.find(Ref<PyCodeObject>{code});
+  if (code_it == profiles.end()) {
+    return;
+  }
+  auto& branch_hits = code_it->second.branch_hits;
+  auto hit_it = branch_hits.find(offset);
+  if (hit_it != branch_hits.end()) {
+    branch->setHits(hit_it->second.true_hits, hit_it->second.false_hits);
+  }
+}
+
 void HIRBuilder::emitJumpIf(
     TranslationContext& tc,
     const jit::BytecodeInstruction& bc_instr) {
@@ -2254,16 +2335,18 @@ void HIRBuilder::emitJumpIf(
   BasicBlock* true_block = getBlockAtOff(true_offset);
   BasicBlock* false_block = getBlockAtOff(false_offset);
 
+  CondBranch* branch;
   if (check_truthy) {
     Register* tval = temps_.AllocateNonStack();
     // Registers that hold the result of `IsTruthy` are guaranteed to never be
     // the home of a value left on the stack at the end of a basic block, so we
     // don't need to worry about potentially storing a PyObject in them.
     tc.emit<IsTruthy>(tval, var, tc.frame);
-    tc.emit<CondBranch>(tval, true_block, false_block);
+    branch = tc.emit<CondBranch>(tval, true_block, false_block);
   } else {
-    tc.emit<CondBranch>(var, true_block, false_block);
+    branch = tc.emit<CondBranch>(var, true_block, false_block);
   }
+  setBranchHits(branch, tc.frame.code, bc_instr.offset());
 }
 
 void HIRBuilder::emitDeleteAttr(
@@ -3161,7 +3244,9 @@ void HIRBuilder::emitLoadGlobal(
 
   auto try_fast_path = [&] {
     BorrowedRef<> value = preloader_.global(name_idx);
-    if (value == nullptr) {
+    if (value == nullptr ||
+        Runtime::get()->hasFailedSpeculation(
+            tc.frame.code, bc_instr.offset())) {
       return false;
     }
     tc.emit<LoadGlobalCached>(result, code_, preloader_.globals(), name_idx);
@@ -3455,14 +3540,16 @@ void HIRBuilder::emitPopJumpIf(
   BasicBlock* true_block = getBlockAtOff(true_offset);
   BasicBlock* false_block = getBlockAtOff(false_offset);
 
+  CondBranch* branch;
   if (bc_instr.opcode() == POP_JUMP_IF_FALSE ||
       bc_instr.opcode() == POP_JUMP_IF_TRUE) {
     Register* tval = temps_.AllocateNonStack();
     tc.emit<IsTruthy>(tval, var, tc.frame);
-    tc.emit<CondBranch>(tval, true_block, false_block);
+    branch = tc.emit<CondBranch>(tval, true_block, false_block);
   } else {
-    tc.emit<CondBranch>(var, true_block, false_block);
+    branch = tc.emit<CondBranch>(var, true_block, false_block);
   }
+  setBranchHits(branch, tc.frame.code, bc_instr.offset());
 }
 
 void HIRBuilder::emitStoreAttr(
@@ -95,6 +95,13 @@ std::unique_ptr<Function> buildHIR(BorrowedRef<PyFunctionObject> func);
 // analysis.
 std::unique_ptr<Function> buildHIR(const Preloader& preloader);
 
+// Like buildHIR, but produce an OSR entry that starts executing at the loop
+// header described by osr_entry, using values from an interpreter frame
+// instead of the function's arguments. See OSREntry and Function::osr_entry.
+std::unique_ptr<Function> buildOSRHIR(
+    const Preloader& preloader,
+    const OSREntry& osr_entry);
+
 // Inlining merges all of the different callee Returns (which terminate blocks,
 // leading to a bunch of distinct exit blocks) into Branches to one Return
 // block (one exit block), which the caller can transform into an Assign to the
@@ -114,6 +121,10 @@ class HIRBuilder {
  public:
   HIRBuilder(const Preloader& preloader)
       : code_(preloader.code()), preloader_(preloader){};
+  HIRBuilder(const Preloader& preloader, const OSREntry& osr_entry)
+      : code_(preloader.code()),
+        preloader_(preloader),
+        osr_entry_(&osr_entry){};
 
   // Translate the bytecode for code_ into HIR, in the context of the preloaded
   // globals and classloader lookups from preloader_.
@@ -474,6 +485,9 @@ class HIRBuilder {
       const FrameState& frame);
   void addInitialYield(TranslationContext& tc);
   void addLoadArgs(TranslationContext& tc, int num_args);
+  // Load the frame's locals, cells, and value stack from the arguments of an
+  // OSR entry.
+  void addOSRLoadArgs(TranslationContext& tc);
   void addInitializeCells(TranslationContext& tc, Register* cur_func);
   void AllocateRegistersForLocals(Environment* env, FrameState& state);
   void AllocateRegistersForCells(Environment* env, FrameState& state);
@@ -513,6 +527,7 @@ class HIRBuilder {
   BorrowedRef<PyCodeObject> code_;
   BlockMap block_map_;
   const Preloader& preloader_;
+  const OSREntry* osr_entry_{nullptr};
 
   TempAllocator temps_{nullptr};
 };
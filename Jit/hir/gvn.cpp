@@ -0,0 +1,312 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include "Jit/hir/hir.h"
+#include "Jit/hir/memory_effects.h"
+#include "Jit/hir/optimization.h"
+#include "Jit/hir/ssa.h"
+#include "Jit/util.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace jit {
+namespace hir {
+
+// This file contains the GlobalValueNumbering pass, which replaces
+// instructions that recompute a value that is already available in a
+// register.
+//
+// Each eligible instruction is described by a ValueKey made of its opcode,
+// operands, and any immediates that affect its result. A forward dataflow
+// analysis computes, for each block, the set of ValueKeys that have been
+// computed on every path to the block, along with the registers holding their
+// values. Loads are removed from the set by instructions that may store to
+// the memory they read, as reported by memoryEffects(). A StoreField makes the
+// stored value available to later LoadFields of the same field, so loads of
+// recently-written attributes are forwarded from the store.
+//
+// Eligible instructions are pure arithmetic, loads from locations modeled by
+// AliasClass, and GuardType and GuardIs. Redundant guards are safe to remove
+// because a guard on the same SSA value must already have passed for the
+// earlier instruction to be available.
+
+namespace {
+
+struct ValueKey {
+  Opcode opcode;
+  std::vector<Register*> operands;
+  std::vector<intptr_t> immediates;
+  Type type{TBottom};
+
+  bool operator==(const ValueKey& other) const {
+    return opcode == other.opcode && operands == other.operands &&
+        immediates == other.immediates && type == other.type;
+  }
+};
+
+struct ValueKeyHash {
+  std::size_t operator()(const ValueKey& key) const {
+    std::size_t hash = static_cast<std::size_t>(key.opcode);
+    for (Register* reg : key.operands) {
+      hash = combineHash(hash, std::hash<Register*>{}(reg));
+    }
+    for (intptr_t imm : key.immediates) {
+      hash = combineHash(hash, std::hash<intptr_t>{}(imm));
+    }
+    return combineHash(hash, std::hash<Type>{}(key.type));
+  }
+};
+
+struct AvailableValue {
+  Register* reg;
+
+  // The memory locations this value was loaded from, or AEmpty for values
+  // that don't depend on memory.
+  AliasClass loaded;
+
+  bool operator==(const AvailableValue& other) const {
+    return reg == other.reg && loaded == other.loaded;
+  }
+};
+
+using ValueMap = std::unordered_map<ValueKey, AvailableValue, ValueKeyHash>;
+
+// If instr produces a value that may be reused, fill in key and loaded and
+// return true. Otherwise, return false.
+bool describeValue(const Instr& instr, ValueKey& key, AliasClass& loaded) {
+  key.opcode = instr.opcode();
+  loaded = AEmpty;
+  switch (instr.opcode()) {
+    case Opcode::kDoubleBinaryOp:
+      key.immediates.emplace_back(static_cast<intptr_t>(
+          static_cast<const DoubleBinaryOp&>(instr).op()));
+      break;
+    case Opcode::kIntBinaryOp:
+      key.immediates.emplace_back(
+          static_cast<intptr_t>(static_cast<const IntBinaryOp&>(instr).op()));
+      break;
+    case Opcode::kIntConvert:
+      key.type = static_cast<const IntConvert&>(instr).type();
+      break;
+    case Opcode::kLoadFieldAddress:
+      break;
+    case Opcode::kPrimitiveCompare:
+      key.immediates.emplace_back(static_cast<intptr_t>(
+          static_cast<const PrimitiveCompare&>(instr).op()));
+      break;
+    case Opcode::kPrimitiveUnaryOp:
+      key.immediates.emplace_back(static_cast<intptr_t>(
+          static_cast<const PrimitiveUnaryOp&>(instr).op()));
+      break;
+
+    case Opcode::kGuardIs:
+      key.immediates.emplace_back(reinterpret_cast<intptr_t>(
+          static_cast<const GuardIs&>(instr).target()));
+      break;
+    case Opcode::kGuardType:
+      key.type = static_cast<const GuardType&>(instr).target();
+      break;
+
+    // LoadField and LoadVarObjectSize are used for interpreter-managed fields
+    // like ob_item and ob_size, which are written by instructions that don't
+    // store to AInObjectAttr, so treat them as reading the whole heap.
+    case Opcode::kLoadField: {
+      // A LoadField that doesn't borrow its output takes ownership of the
+      // field's reference ahead of a StoreField, so it must stay unique. The
+      // type of the field is checked against the available value when it's
+      // used, so that StoreField can forward to LoadField.
+      auto& load = static_cast<const LoadField&>(instr);
+      if (!load.borrowed()) {
+        return false;
+      }
+      key.immediates.emplace_back(load.offset());
+      loaded = AManagedHeapAny;
+      break;
+    }
+    case Opcode::kLoadVarObjectSize:
+      loaded = AManagedHeapAny;
+      break;
+    case Opcode::kLoadArrayItem: {
+      auto& load = static_cast<const LoadArrayItem&>(instr);
+      key.immediates.emplace_back(load.offset());
+      key.type = load.type();
+      loaded = AArrayItem | AListItem;
+      break;
+    }
+    case Opcode::kLoadCellItem:
+      loaded = ACellItem;
+      break;
+    case Opcode::kLoadGlobalCached: {
+      auto& load = static_cast<const LoadGlobalCached&>(instr);
+      key.immediates.emplace_back(
+          reinterpret_cast<intptr_t>(load.code().get()));
+      key.immediates.emplace_back(
+          reinterpret_cast<intptr_t>(load.globals().get()));
+      key.immediates.emplace_back(load.name_idx());
+      loaded = AGlobal;
+      break;
+    }
+    case Opcode::kLoadTupleItem:
+      key.immediates.emplace_back(
+          static_cast<const LoadTupleItem&>(instr).idx());
+      loaded = ATupleItem;
+      break;
+    case Opcode::kLoadTypeAttrCacheItem: {
+      auto& load = static_cast<const LoadTypeAttrCacheItem&>(instr);
+      key.immediates.emplace_back(load.cache_id());
+      key.immediates.emplace_back(load.item_idx());
+      loaded = ATypeAttrCache;
+      break;
+    }
+
+    default:
+      return false;
+  }
+
+  for (std::size_t i = 0, n = instr.NumOperands(); i < n; ++i) {
+    key.operands.emplace_back(instr.GetOperand(i));
+  }
+  return true;
+}
+
+// Return true if value may be used in place of the output of instr.
+bool canReplace(const Instr& instr, Register* value) {
+  return value->type() <= instr.GetOutput()->type();
+}
+
+// Update values to reflect the effects of instr. If replace is true and instr
+// computes a value that is already available, replace it with an Assign and
+// return the original instruction, which the caller is responsible for
+// deleting.
+Instr* processInstr(Instr& instr, ValueMap& values, bool replace) {
+  ValueKey key;
+  AliasClass loaded{AEmpty};
+  bool has_key = describeValue(instr, key, loaded);
+  if (has_key) {
+    auto it = values.find(key);
+    if (it != values.end() && canReplace(instr, it->second.reg)) {
+      if (!replace) {
+        return nullptr;
+      }
+      auto assign = Assign::create(instr.GetOutput(), it->second.reg);
+      assign->copyBytecodeOffset(instr);
+      instr.ReplaceWith(*assign);
+      return &instr;
+    }
+  }
+
+  // Phis and terminators don't write memory that's visible to any
+  // instruction processed after them.
+  if (instr.IsPhi() || instr.IsTerminator()) {
+    return nullptr;
+  }
+  AliasClass may_store = memoryEffects(instr).may_store;
+  if (may_store != AEmpty) {
+    for (auto it = values.begin(); it != values.end();) {
+      if ((it->second.loaded & may_store) != AEmpty) {
+        it = values.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  if (instr.IsStoreField()) {
+    auto& store = static_cast<const StoreField&>(instr);
+    ValueKey load_key;
+    load_key.opcode = Opcode::kLoadField;
+    load_key.operands.emplace_back(store.receiver());
+    load_key.immediates.emplace_back(store.offset());
+    values.insert_or_assign(
+        std::move(load_key), AvailableValue{store.value(), AManagedHeapAny});
+  } else if (has_key) {
+    values.insert_or_assign(
+        std::move(key), AvailableValue{instr.GetOutput(), loaded});
+  }
+  return nullptr;
+}
+
+// Remove all values from values that aren't also in other.
+void intersectValues(ValueMap& values, const ValueMap& other) {
+  for (auto it = values.begin(); it != values.end();) {
+    auto other_it = other.find(it->first);
+    if (other_it == other.end() || !(other_it->second == it->second)) {
+      it = values.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+// Run one round of value numbering over the function, returning true if any
+// instructions were replaced.
+bool replaceRedundantValues(Function& irfunc) {
+  std::vector<BasicBlock*> rpo = irfunc.cfg.GetRPOTraversal();
+  std::unordered_map<BasicBlock*, ValueMap> out_values;
+
+  // Predecessors that haven't been visited yet are reached through a back
+  // edge, and are optimistically assumed to make everything available. This
+  // is corrected on the next iteration of the analysis.
+  auto in_values = [&](BasicBlock* block) {
+    ValueMap values;
+    bool first = true;
+    for (auto edge : block->in_edges()) {
+      auto it = out_values.find(edge->from());
+      if (it == out_values.end()) {
+        continue;
+      }
+      if (first) {
+        values = it->second;
+        first = false;
+      } else {
+        intersectValues(values, it->second);
+      }
+    }
+    return values;
+  };
+
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (BasicBlock* block : rpo) {
+      ValueMap values = in_values(block);
+      for (auto& instr : *block) {
+        processInstr(instr, values, false);
+      }
+      auto it = out_values.find(block);
+      if (it == out_values.end()) {
+        out_values.emplace(block, std::move(values));
+        changed = true;
+      } else if (it->second != values) {
+        it->second = std::move(values);
+        changed = true;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Instr>> replaced;
+  for (BasicBlock* block : rpo) {
+    ValueMap values = in_values(block);
+    for (auto it = block->begin(); it != block->end();) {
+      auto& instr = *it;
+      ++it;
+      if (Instr* old_instr = processInstr(instr, values, true)) {
+        replaced.emplace_back(old_instr);
+      }
+    }
+  }
+  return !replaced.empty();
+}
+
+} // namespace
+
+void GlobalValueNumbering::Run(Function& irfunc) {
+  // Replacing a value can make instructions that use it redundant, so repeat
+  // until nothing changes.
+  while (replaceRedundantValues(irfunc)) {
+    CopyPropagation{}.Run(irfunc);
+  }
+  reflowTypes(irfunc);
+}
+
+} // namespace hir
+} // namespace jit
@@ -807,6 +807,7 @@ Function::~Function() {
   ThreadedCompileSerialize guard;
   code.reset();
   globals.reset();
+  env.clearReferences();
 }
 
 Register* Environment::addRegister(std::unique_ptr<Register> reg) {
@@ -820,6 +821,10 @@ BorrowedRef<> Environment::addReference(Ref<> obj) {
   return references_.emplace(std::move(obj)).first->get();
 }
 
+void Environment::clearReferences() {
+  references_.clear();
+}
+
 const Environment::ReferenceSet& Environment::references() const {
   return references_;
 }
@@ -875,6 +880,9 @@ int Function::numArgs() const {
     // code might be null if we parsed from textual ir
     return 0;
   }
+  if (osr_entry.has_value()) {
+    return numVars() + osr_entry->stack_depth;
+  }
   return code->co_argcount + code->co_kwonlyargcount +
       bool(code->co_flags & CO_VARARGS) + bool(code->co_flags & CO_VARKEYWORDS);
 }
@@ -2555,9 +2555,26 @@ class CondBranchBase : public Instr {
     return i == 0 ? &true_edge_ : &false_edge_;
   }
 
+  // How many times the interpreter was seen going to each successor, if the
+  // branch was profiled. Used to decide which blocks are cold.
+  int64_t trueHits() const {
+    return true_hits_;
+  }
+
+  int64_t falseHits() const {
+    return false_hits_;
+  }
+
+  void setHits(int64_t true_hits, int64_t false_hits) {
+    true_hits_ = true_hits;
+    false_hits_ = false_hits;
+  }
+
  private:
   Edge true_edge_;
   Edge false_edge_;
+  int64_t true_hits_{0};
+  int64_t false_hits_{0};
 };
 
 // Transfer control to `true_bb` if `reg` is nonzero, otherwise `false_bb`.
@@ -4037,6 +4054,9 @@ class Environment {
 
   const ReferenceSet& references() const;
 
+  // Drop every reference added with addReference().
+  void clearReferences();
+
   // Returns nullptr if a register with the given `id` isn't found
   Register* getRegister(int id);
 
@@ -4103,6 +4123,19 @@ struct TypedArgument {
 // runtime?
 bool usesRuntimeFunc(BorrowedRef<PyCodeObject> code);
 
+// Where an on-stack replacement (OSR) entry starts executing, and the shape of
+// the interpreter state it receives there.
+struct OSREntry {
+  // Bytecode offset of the loop header to start at.
+  int offset{0};
+
+  // Depth of the interpreter's value stack at offset.
+  int stack_depth{0};
+
+  // Execution blocks that are active at offset.
+  BlockStack block_stack;
+};
+
 class Function {
  public:
   Function();
@@ -4138,6 +4171,11 @@ class Function {
 
   FrameMode frameMode{FrameMode::kNormal};
 
+  // Set if this function is an OSR entry into the middle of code, rather than
+  // a normal entry at the start of it. OSR entries take all of the frame's
+  // locals, cells, and value stack as arguments, in that order.
+  std::optional<OSREntry> osr_entry;
+
   CFG cfg;
 
   Environment env;
@@ -4146,7 +4184,7 @@ class Function {
   // phases
   std::unique_ptr<CompilationPhaseTimer> compilation_phase_timer{nullptr};
   // Return the total number of arguments (positional + kwonly + varargs +
-  // varkeywords)
+  // varkeywords), or the number of values an OSR entry is called with.
   int numArgs() const;
 
   // Return the number of locals + cellvars + freevars
@@ -0,0 +1,412 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include "Jit/hir/analysis.h"
+#include "Jit/hir/hir.h"
+#include "Jit/hir/memory_effects.h"
+#include "Jit/hir/optimization.h"
+#include "Jit/hir/ssa.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jit {
+namespace hir {
+
+// This file contains the LoopInvariantCodeMotion pass, which moves
+// instructions that compute the same value on every iteration of a loop into
+// a preheader block that runs once before the loop is entered.
+//
+// An instruction is hoisted when all of its operands are defined outside of
+// the loop, its block executes on every iteration of the loop, and it is one
+// of:
+// - Pure arithmetic that can't fault.
+// - A load from a memory location that nothing in the loop may store to.
+//   LoadField trusts that its receiver has the right type, which may only be
+//   established by a check in the loop, so it is only hoisted if its block
+//   also runs before any exit from the loop, or if its receiver comes from
+//   outside the loop or from a hoisted guard.
+// - A Guard, GuardIs, or GuardType. The preheader gets a new Snapshot
+//   describing the frame on entry to the loop, so a failing guard resumes the
+//   interpreter at the top of the loop, before any iterations have run.
+//
+// LoadConsts are only hoisted when a hoisted instruction uses them, to avoid
+// extending the live ranges of constants that would otherwise be materialized
+// where they're used.
+
+namespace {
+
+struct Loop {
+  BasicBlock* header{nullptr};
+
+  // All blocks in the loop, including the header.
+  std::unordered_set<BasicBlock*> blocks;
+
+  // Sources of the loop's back edges.
+  std::vector<BasicBlock*> latches;
+
+  // Predecessors of the header that are outside of the loop, sorted by id.
+  std::vector<BasicBlock*> entries;
+
+  bool contains(const BasicBlock* block) const {
+    return blocks.count(const_cast<BasicBlock*>(block)) != 0;
+  }
+
+  bool contains(const Register* reg) const {
+    return contains(reg->instr()->block());
+  }
+
+  // Return the block that control always passes through on its way into the
+  // loop, or nullptr if there isn't one.
+  BasicBlock* preheader() const {
+    if (entries.size() != 1 || entries[0]->GetTerminator()->numEdges() != 1) {
+      return nullptr;
+    }
+    return entries[0];
+  }
+};
+
+// Find all natural loops in the function, ordered so that inner loops come
+// before the loops containing them.
+std::vector<Loop> findLoops(
+    const std::vector<BasicBlock*>& rpo,
+    DominatorAnalysis& doms) {
+  std::vector<Loop> loops;
+  std::unordered_map<BasicBlock*, size_t> header_idx;
+  std::unordered_set<BasicBlock*> reachable(rpo.begin(), rpo.end());
+  for (BasicBlock* block : rpo) {
+    auto term = block->GetTerminator();
+    for (std::size_t i = 0, n = term->numEdges(); i < n; ++i) {
+      BasicBlock* succ = term->successor(i);
+      if (doms.getBlocksDominatedBy(succ).count(block) == 0) {
+        continue;
+      }
+      auto result = header_idx.emplace(succ, loops.size());
+      if (result.second) {
+        loops.emplace_back();
+        loops.back().header = succ;
+      }
+      Loop& loop = loops[result.first->second];
+      if (std::find(loop.latches.begin(), loop.latches.end(), block) ==
+          loop.latches.end()) {
+        loop.latches.emplace_back(block);
+      }
+    }
+  }
+
+  for (Loop& loop : loops) {
+    loop.blocks.emplace(loop.header);
+    std::vector<BasicBlock*> worklist(loop.latches.begin(), loop.latches.end());
+    while (!worklist.empty()) {
+      BasicBlock* block = worklist.back();
+      worklist.pop_back();
+      if (reachable.count(block) == 0 || !loop.blocks.emplace(block).second) {
+        continue;
+      }
+      for (auto edge : block->in_edges()) {
+        worklist.emplace_back(edge->from());
+      }
+    }
+    for (auto edge : loop.header->in_edges()) {
+      BasicBlock* pred = edge->from();
+      if (!loop.contains(pred) &&
+          std::find(loop.entries.begin(), loop.entries.end(), pred) ==
+              loop.entries.end()) {
+        loop.entries.emplace_back(pred);
+      }
+    }
+    std::sort(
+        loop.entries.begin(),
+        loop.entries.end(),
+        [](const BasicBlock* a, const BasicBlock* b) { return a->id < b->id; });
+  }
+
+  std::stable_sort(
+      loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+        return a.blocks.size() < b.blocks.size();
+      });
+  return loops;
+}
+
+// Give the loop a dedicated preheader if it doesn't already have one,
+// returning true if the CFG was changed. Phis in the header that have more
+// than one distinct input from outside the loop get a new Phi in the
+// preheader to merge those inputs.
+bool insertPreheader(Function& irfunc, const Loop& loop) {
+  if (loop.entries.empty() || loop.preheader() != nullptr) {
+    return false;
+  }
+
+  BasicBlock* header = loop.header;
+  BasicBlock* preheader = irfunc.cfg.AllocateBlock();
+  std::vector<Phi*> phis;
+  header->forEachPhi([&](Phi& phi) { phis.emplace_back(&phi); });
+  for (Phi* phi : phis) {
+    std::unordered_map<BasicBlock*, Register*> entry_args;
+    std::unordered_map<BasicBlock*, Register*> loop_args;
+    for (size_t i = 0, n = phi->NumOperands(); i < n; ++i) {
+      BasicBlock* pred = phi->basic_blocks()[i];
+      (loop.contains(pred) ? loop_args : entry_args)[pred] = phi->GetOperand(i);
+    }
+
+    JIT_DCHECK(!entry_args.empty(), "Phi has no inputs from outside the loop");
+    Register* entry_value = entry_args.begin()->second;
+    for (auto& pair : entry_args) {
+      if (pair.second != entry_value) {
+        entry_value = irfunc.env.AllocateRegister();
+        preheader->append<Phi>(entry_value, entry_args);
+        break;
+      }
+    }
+    loop_args[preheader] = entry_value;
+    phi->ReplaceWith(*Phi::create(phi->GetOutput(), loop_args));
+    delete phi;
+  }
+
+  for (BasicBlock* entry : loop.entries) {
+    auto term = entry->GetTerminator();
+    for (std::size_t i = 0, n = term->numEdges(); i < n; ++i) {
+      if (term->successor(i) == header) {
+        term->set_successor(i, preheader);
+      }
+    }
+  }
+  preheader->appendWithOff<Branch>(
+      loop.entries[0]->GetTerminator()->bytecodeOffset(), header);
+  return true;
+}
+
+// Return true if instr may be hoisted out of a loop that may store to
+// loop_stores, assuming its operands are loop-invariant.
+bool isHoistable(const Instr& instr, AliasClass loop_stores) {
+  auto loadIsInvariant = [&](AliasClass loaded) {
+    return (loop_stores & loaded) == AEmpty;
+  };
+
+  switch (instr.opcode()) {
+    case Opcode::kDoubleBinaryOp:
+    case Opcode::kIntConvert:
+    case Opcode::kLoadFieldAddress:
+    case Opcode::kPrimitiveCompare:
+    case Opcode::kPrimitiveUnaryOp:
+      return true;
+
+    case Opcode::kIntBinaryOp: {
+      // Division by zero faults, and is checked for by a guard or branch in
+      // the loop.
+      switch (static_cast<const IntBinaryOp&>(instr).op()) {
+        case BinaryOpKind::kFloorDivide:
+        case BinaryOpKind::kFloorDivideUnsigned:
+        case BinaryOpKind::kModulo:
+        case BinaryOpKind::kModuloUnsigned:
+          return false;
+        default:
+          return true;
+      }
+    }
+
+    // LoadField is used for interpreter-managed fields like ob_item and
+    // ob_size as well as attributes, so any store to the heap may change it.
+    case Opcode::kLoadField:
+      return loadIsInvariant(AManagedHeapAny);
+    case Opcode::kLoadCellItem:
+      return loadIsInvariant(ACellItem);
+    case Opcode::kLoadGlobalCached:
+      return loadIsInvariant(AGlobal);
+    case Opcode::kLoadTypeAttrCacheItem:
+      return loadIsInvariant(ATypeAttrCache);
+
+    case Opcode::kGuard:
+    case Opcode::kGuardIs:
+    case Opcode::kGuardType:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// Return the FrameState describing the interpreter state on entry to the
+// loop, or nullptr if it can't be determined.
+const FrameState* loopEntryFrameState(BasicBlock* header) {
+  if (Snapshot* snapshot = header->entrySnapshot()) {
+    return snapshot->frameState();
+  }
+
+  // The builder gives every loop an eval breaker check as its header, which
+  // has no Snapshot of its own. When the eval breaker isn't set, it continues
+  // to the block holding the loop's entry Snapshot.
+  auto term = header->GetTerminator();
+  if (!term->IsCondBranch() ||
+      !term->GetOperand(0)->instr()->IsLoadEvalBreaker()) {
+    return nullptr;
+  }
+  for (auto& instr : *header) {
+    if (!instr.IsPhi() && !instr.IsTerminator() && !instr.isReplayable()) {
+      return nullptr;
+    }
+  }
+  auto succ = static_cast<CondBranch*>(term)->false_bb();
+  Snapshot* snapshot = succ->entrySnapshot();
+  return snapshot == nullptr ? nullptr : snapshot->frameState();
+}
+
+// Create a Snapshot at the end of the loop's preheader, with the same
+// FrameState as the entry to the loop header. Values that flow into the
+// header's Phis are replaced with their inputs from the preheader. Returns
+// nullptr if the FrameState refers to other values defined in the loop.
+Snapshot* insertEntrySnapshot(const Loop& loop, BasicBlock* preheader) {
+  const FrameState* entry_fs = loopEntryFrameState(loop.header);
+  if (entry_fs == nullptr) {
+    return nullptr;
+  }
+
+  std::unordered_map<Register*, Register*> entry_values;
+  loop.header->forEachPhi([&](Phi& phi) {
+    entry_values[phi.GetOutput()] =
+        phi.GetOperand(phi.blockIndex(preheader));
+  });
+  auto is_invariant = [&](Register*& reg) { return !loop.contains(reg); };
+
+  // The parent FrameState of an inlined function is shared, so only the
+  // innermost frame is rewritten.
+  FrameState fs{*entry_fs};
+  FrameState* parent = fs.parent;
+  fs.parent = nullptr;
+  bool ok = fs.visitUses([&](Register*& reg) {
+    auto it = entry_values.find(reg);
+    if (it != entry_values.end()) {
+      reg = it->second;
+    }
+    return is_invariant(reg);
+  });
+  fs.parent = parent;
+  if (!ok || (parent != nullptr && !parent->visitUses(is_invariant))) {
+    return nullptr;
+  }
+
+  auto snapshot = Snapshot::create(fs);
+  preheader->insert(snapshot, preheader->iterator_to(preheader->back()));
+  return snapshot;
+}
+
+bool hoistInvariants(
+    const Loop& loop,
+    const std::vector<BasicBlock*>& rpo,
+    DominatorAnalysis& doms) {
+  BasicBlock* preheader = loop.preheader();
+  if (preheader == nullptr) {
+    return false;
+  }
+
+  AliasClass loop_stores = AEmpty;
+  for (BasicBlock* block : loop.blocks) {
+    for (auto& instr : *block) {
+      if (!instr.IsPhi() && !instr.IsTerminator()) {
+        loop_stores = loop_stores | memoryEffects(instr).may_store;
+      }
+    }
+  }
+
+  std::vector<BasicBlock*> exiting;
+  for (BasicBlock* block : loop.blocks) {
+    auto term = block->GetTerminator();
+    for (std::size_t i = 0, n = term->numEdges(); i < n; ++i) {
+      if (!loop.contains(term->successor(i))) {
+        exiting.emplace_back(block);
+        break;
+      }
+    }
+  }
+
+  auto dominates_all = [&](const BasicBlock* block, const auto& blocks) {
+    auto& dominated = doms.getBlocksDominatedBy(block);
+    return std::all_of(blocks.begin(), blocks.end(), [&](BasicBlock* other) {
+      return dominated.count(other) != 0;
+    });
+  };
+  auto runs_every_iteration = [&](const BasicBlock* block) {
+    return dominates_all(block, loop.latches);
+  };
+
+  std::unordered_set<const Instr*> hoisted;
+  auto receiver_checked = [&](const Instr& instr) {
+    const Instr* def = instr.GetOperand(0)->instr();
+    return hoisted.count(def) == 0 || def->IsLoadConst() || def->IsGuard() ||
+        def->IsGuardIs() || def->IsGuardType();
+  };
+  auto hoist = [&](Instr& instr) {
+    instr.unlink();
+    preheader->insert(&instr, preheader->iterator_to(preheader->back()));
+    hoisted.emplace(&instr);
+  };
+
+  bool changed = false;
+  bool tried_snapshot = false;
+  Snapshot* snapshot = nullptr;
+  for (BasicBlock* block : rpo) {
+    if (!loop.contains(block) || !runs_every_iteration(block)) {
+      continue;
+    }
+    for (auto it = block->begin(); it != block->end();) {
+      Instr& instr = *it;
+      ++it;
+      if (!isHoistable(instr, loop_stores)) {
+        continue;
+      }
+      bool invariant = instr.visitUses([&](Register*& reg) {
+        return !loop.contains(reg) || reg->instr()->IsLoadConst();
+      });
+      if (!invariant) {
+        continue;
+      }
+      if (instr.IsLoadField() && !receiver_checked(instr) &&
+          !dominates_all(block, exiting)) {
+        continue;
+      }
+      if (instr.IsGuard() || instr.IsGuardIs() || instr.IsGuardType()) {
+        if (!tried_snapshot) {
+          tried_snapshot = true;
+          snapshot = insertEntrySnapshot(loop, preheader);
+        }
+        if (snapshot == nullptr) {
+          continue;
+        }
+      }
+      instr.visitUses([&](Register*& reg) {
+        if (loop.contains(reg)) {
+          hoist(*reg->instr());
+        }
+        return true;
+      });
+      hoist(instr);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+} // namespace
+
+void LoopInvariantCodeMotion::Run(Function& irfunc) {
+  bool changed = false;
+  {
+    DominatorAnalysis doms{irfunc};
+    for (const Loop& loop : findLoops(irfunc.cfg.GetRPOTraversal(), doms)) {
+      changed |= insertPreheader(irfunc, loop);
+    }
+  }
+
+  std::vector<BasicBlock*> rpo = irfunc.cfg.GetRPOTraversal();
+  DominatorAnalysis doms{irfunc};
+  for (const Loop& loop : findLoops(rpo, doms)) {
+    changed |= hoistInvariants(loop, rpo, doms);
+  }
+
+  if (changed) {
+    reflowTypes(irfunc);
+  }
+}
+
+} // namespace hir
+} // namespace jit
@@ -212,10 +212,15 @@ MemoryEffects memoryEffects(const Instr& inst) {
 
     case Opcode::kLoadArrayItem:
       return borrowFrom(inst, AArrayItem | AListItem);
-    case Opcode::kStoreArrayItem:
-      // we steal a ref to our third operand, the value being stored
-      return {
-          false, AEmpty, {inst.NumOperands(), 1 << 2}, AArrayItem | AListItem};
+    case Opcode::kStoreArrayItem: {
+      // we steal a ref to our third operand, the value being stored. Storing
+      // an object releases the one it replaces, which can run arbitrary code.
+      auto may_store =
+          static_cast<const StoreArrayItem&>(inst).type() <= TObject
+          ? AManagedHeapAny
+          : AArrayItem | AListItem;
+      return {false, AEmpty, {inst.NumOperands(), 1 << 2}, may_store};
+    }
     case Opcode::kLoadTypeAttrCacheItem:
       return borrowFrom(inst, ATypeAttrCache);
 
@@ -13,11 +13,14 @@
 #include "Jit/hir/printer.h"
 #include "Jit/hir/ssa.h"
 #include "Jit/jit_rt.h"
+#include "Jit/profile_data.h"
 #include "Jit/pyjit.h"
+#include "Jit/runtime.h"
 #include "Jit/util.h"
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <unordered_map>
@@ -42,6 +45,9 @@ PassRegistry::PassRegistry() {
   addPass(GuardTypeRemoval::Factory);
   addPass(BeginInlinedFunctionElimination::Factory);
   addPass(BuiltinLoadMethodElimination::Factory);
+  addPass(GlobalValueNumbering::Factory);
+  addPass(LoopInvariantCodeMotion::Factory);
+  addPass(ScalarReplacement::Factory);
 }
 
 std::unique_ptr<Pass> PassRegistry::MakePass(const std::string& name) {
@@ -94,6 +100,7 @@ void DynamicComparisonElimination::InitBuiltins() {
   // modules which can be mutated.  First find builtins, which we have
   // to do a search for because PyEval_GetBuiltins() returns the
   // module dict.
+  ThreadedCompileSerialize guard;
   PyObject* mods = _PyThreadState_GET()->interp->modules_by_index;
   PyModuleDef* builtins = nullptr;
   for (Py_ssize_t i = 0; i < PyList_GET_SIZE(mods); i++) {
@@ -691,11 +698,16 @@ struct AbstractCall {
   AbstractCall(PyFunctionObject* func, size_t nargs, DeoptBase* instr)
       : func(func), nargs(nargs), instr(instr) {}
 
-  AbstractCall(Register* target, size_t nargs, DeoptBase* instr)
+  AbstractCall(
+      Register* target,
+      size_t nargs,
+      DeoptBase* instr,
+      BorrowedRef<PyTupleObject> kwnames = nullptr)
       : target(target),
         func(reinterpret_cast<PyFunctionObject*>(target->type().objectSpec())),
         nargs(nargs),
-        instr(instr) {}
+        instr(instr),
+        kwnames(kwnames) {}
 
   Register* arg(std::size_t i) const {
     if (instr->opcode() == Opcode::kInvokeStaticFunction) {
@@ -710,30 +722,18 @@ struct AbstractCall {
 
   Register* target{nullptr};
   BorrowedRef<PyFunctionObject> func{nullptr};
+  // Number of arguments passed, including keyword arguments.
   size_t nargs{0};
   DeoptBase* instr{nullptr};
+  // Names of the trailing keyword arguments, if any.
+  BorrowedRef<PyTupleObject> kwnames{nullptr};
 };
 
 // Most of these checks are only temporary and do not in perpetuity prohibit
 // inlining. They are here to simplify bringup of the inliner and can be
 // treated as TODOs.
-static bool canInline(
-    AbstractCall* call_instr,
-    PyFunctionObject* func,
-    const std::string& fullname) {
-  if (func->func_defaults != nullptr) {
-    JIT_DLOG("Can't inline %s because it has defaults", fullname);
-    return false;
-  }
-  if (func->func_kwdefaults != nullptr) {
-    JIT_DLOG("Can't inline %s because it has kwdefaults", fullname);
-    return false;
-  }
+static bool canInline(PyFunctionObject* func, const std::string& fullname) {
   PyCodeObject* code = reinterpret_cast<PyCodeObject*>(func->func_code);
-  if (code->co_kwonlyargcount > 0) {
-    JIT_DLOG("Can't inline %s because it has keyword-only args", fullname);
-    return false;
-  }
   if (code->co_flags & CO_VARARGS) {
     JIT_DLOG("Can't inline %s because it has varargs", fullname);
     return false;
@@ -742,13 +742,6 @@ static bool canInline(
     JIT_DLOG("Can't inline %s because it has varkwargs", fullname);
     return false;
   }
-  JIT_DCHECK(code->co_argcount >= 0, "argcount must be positive");
-  if (call_instr->nargs != static_cast<size_t>(code->co_argcount)) {
-    JIT_DLOG(
-        "Can't inline %s because it is called with mismatched arguments",
-        fullname);
-    return false;
-  }
   if (code->co_flags & kCoFlagsAnyGenerator) {
     JIT_DLOG("Can't inline %s because it is a generator", fullname);
     return false;
@@ -780,6 +773,84 @@ static bool canInline(
   return true;
 }
 
+// Match the arguments of call_instr to the parameters of func the way
+// _PyFunction_Vectorcall would. On success, args holds one entry per
+// positional and keyword-only parameter, in LoadArg order: the register the
+// caller passes, or nullptr if the parameter takes its value from
+// func->func_defaults. Keyword-only parameters must be passed explicitly,
+// since __kwdefaults__ is a dict that can be mutated behind our back.
+static bool bindArguments(
+    AbstractCall* call_instr,
+    PyFunctionObject* func,
+    const std::string& fullname,
+    std::vector<Register*>& args) {
+  PyCodeObject* code = reinterpret_cast<PyCodeObject*>(func->func_code);
+  JIT_DCHECK(code->co_argcount >= 0, "argcount must be positive");
+  size_t argcount = code->co_argcount;
+  size_t nparams = argcount + code->co_kwonlyargcount;
+  size_t nkwargs =
+      call_instr->kwnames == nullptr ? 0 : PyTuple_GET_SIZE(call_instr->kwnames);
+  size_t npositional = call_instr->nargs - nkwargs;
+  if (npositional > argcount) {
+    JIT_DLOG(
+        "Can't inline %s because it is called with mismatched arguments",
+        fullname);
+    return false;
+  }
+  args.assign(nparams, nullptr);
+  for (size_t i = 0; i < npositional; i++) {
+    args[i] = call_instr->arg(i);
+  }
+  for (size_t i = 0; i < nkwargs; i++) {
+    PyObject* name = PyTuple_GET_ITEM(call_instr->kwnames, i);
+    size_t param = code->co_posonlyargcount;
+    for (; param < nparams; param++) {
+      PyObject* varname = PyTuple_GET_ITEM(code->co_varnames, param);
+      if (name == varname || PyUnicode_Compare(name, varname) == 0) {
+        break;
+      }
+    }
+    if (param == nparams || args[param] != nullptr) {
+      JIT_DLOG(
+          "Can't inline %s because keyword argument '%s' does not bind to a "
+          "free parameter",
+          fullname,
+          PyUnicode_AsUTF8(name));
+      return false;
+    }
+    args[param] = call_instr->arg(npositional + i);
+  }
+  size_t ndefaults = func->func_defaults == nullptr
+      ? 0
+      : PyTuple_GET_SIZE(func->func_defaults);
+  bool uses_defaults = false;
+  for (size_t i = 0; i < nparams; i++) {
+    if (args[i] != nullptr) {
+      continue;
+    }
+    if (i >= argcount) {
+      JIT_DLOG(
+          "Can't inline %s because keyword-only argument %d is not passed",
+          fullname,
+          i);
+      return false;
+    }
+    if (i < argcount - ndefaults) {
+      JIT_DLOG(
+          "Can't inline %s because it is called with mismatched arguments",
+          fullname);
+      return false;
+    }
+    uses_defaults = true;
+  }
+  if (uses_defaults && call_instr->target == nullptr) {
+    JIT_DLOG(
+        "Can't inline %s because its defaults can't be guarded on", fullname);
+    return false;
+  }
+  return true;
+}
+
 // As canInline() for checks which require a preloader.
 static bool canInlineWithPreloader(
     AbstractCall* call_instr,
@@ -794,7 +865,8 @@ static bool canInlineWithPreloader(
     return false;
   };
   if ((call_instr->instr->IsVectorCall() ||
-       call_instr->instr->IsVectorCallStatic()) &&
+       call_instr->instr->IsVectorCallStatic() ||
+       call_instr->instr->IsVectorCallKW()) &&
       (preloader.code()->co_flags & CO_STATICALLY_COMPILED) &&
       (preloader.returnType() <= TPrimitive || has_primitive_args())) {
     // TODO(T122371281) remove this constraint
@@ -807,7 +879,7 @@ static bool canInlineWithPreloader(
   return true;
 }
 
-void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
+bool inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
   PyFunctionObject* func = call_instr->func;
   PyCodeObject* code = reinterpret_cast<PyCodeObject*>(func->func_code);
   JIT_CHECK(PyCode_Check(code), "Expected PyCodeObject");
@@ -818,23 +890,34 @@ void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
         "Refusing to inline %s: globals is a %.200s, not a dict",
         fullname,
         Py_TYPE(globals)->tp_name);
-    return;
+    return false;
   }
-  PyObject* builtins = PyEval_GetBuiltins();
+  PyObject* builtins = THREADED_COMPILE_SERIALIZED_CALL(PyEval_GetBuiltins());
   if (!PyDict_CheckExact(builtins)) {
     JIT_DLOG(
         "Refusing to inline %s: builtins is a %.200s, not a dict",
         fullname,
         Py_TYPE(builtins)->tp_name);
-    return;
+    return false;
   }
-  if (!canInline(call_instr, func, fullname)) {
+  std::vector<Register*> args;
+  if (!canInline(func, fullname) ||
+      !bindArguments(call_instr, func, fullname, args)) {
     JIT_DLOG("Cannot inline %s into %s", fullname, caller.fullname);
-    return;
+    return false;
   }
 
   auto caller_frame_state =
       std::make_unique<FrameState>(*call_instr->instr->frameState());
+  if (call_instr->target != nullptr &&
+      Runtime::get()->hasFailedSpeculation(
+          caller_frame_state->code, caller_frame_state->instr_offset())) {
+    JIT_DLOG(
+        "Refusing to inline %s into %s: __code__ guard failed at runtime",
+        fullname,
+        caller.fullname);
+    return false;
+  }
   // Multi-threaded compilation must use an existing Preloader, whereas
   // single-threaded compilation can make Preloaders on the fly.
   InlineResult result;
@@ -842,7 +925,7 @@ void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
     const Preloader& preloader{getPreloader(func)};
     if (!canInlineWithPreloader(call_instr, fullname, preloader)) {
       JIT_DLOG("Cannot inline %s into %s", fullname, caller.fullname);
-      return;
+      return false;
     }
     HIRBuilder hir_builder(preloader);
     result = hir_builder.inlineHIR(&caller, caller_frame_state.get());
@@ -853,14 +936,14 @@ void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
     Preloader preloader(func);
     if (!canInlineWithPreloader(call_instr, fullname, preloader)) {
       JIT_DLOG("Cannot inline %s into %s", fullname, caller.fullname);
-      return;
+      return false;
     }
     HIRBuilder hir_builder(preloader);
     result = hir_builder.inlineHIR(&caller, caller_frame_state.get());
   }
   if (result.entry == nullptr) {
     JIT_DLOG("Cannot inline %s into %s", fullname, caller.fullname);
-    return;
+    return false;
   }
 
   BasicBlock* head = call_instr->instr->block();
@@ -885,8 +968,42 @@ void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
     Register* guarded_code = caller.env.AllocateRegister();
     auto guard_code = GuardIs::create(
         guarded_code, reinterpret_cast<PyObject*>(code), code_obj);
-    call_instr->instr->ExpandInto(
-        {load_code, guard_code, begin_inlined_function, callee_branch});
+    std::vector<Instr*> prologue{load_code, guard_code};
+    if (std::count(args.begin(), args.end(), nullptr) > 0) {
+      // Missing arguments come from __defaults__. The tuple is immutable, so
+      // checking its identity is enough to make its items constants.
+      BorrowedRef<> defaults;
+      {
+        ThreadedCompileSerialize guard;
+        defaults =
+            caller.env.addReference(Ref<>(func->func_defaults));
+      }
+      Register* defaults_obj = caller.env.AllocateRegister();
+      prologue.push_back(LoadField::create(
+          defaults_obj,
+          call_instr->target,
+          "func_defaults",
+          offsetof(PyFunctionObject, func_defaults),
+          TOptTuple));
+      prologue.push_back(GuardIs::create(
+          caller.env.AllocateRegister(), defaults, defaults_obj));
+      size_t first_default =
+          code->co_argcount - PyTuple_GET_SIZE(func->func_defaults);
+      for (size_t i = first_default; i < static_cast<size_t>(code->co_argcount);
+           i++) {
+        if (args[i] != nullptr) {
+          continue;
+        }
+        args[i] = caller.env.AllocateRegister();
+        prologue.push_back(LoadConst::create(
+            args[i],
+            Type::fromObject(PyTuple_GET_ITEM(
+                func->func_defaults, i - first_default))));
+      }
+    }
+    prologue.push_back(begin_inlined_function);
+    prologue.push_back(callee_branch);
+    call_instr->instr->ExpandInto(prologue);
   } else {
     call_instr->instr->ExpandInto({begin_inlined_function, callee_branch});
   }
@@ -899,8 +1016,8 @@ void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
 
     if (instr.IsLoadArg()) {
       auto load_arg = static_cast<LoadArg*>(&instr);
-      auto assign = Assign::create(
-          instr.GetOutput(), call_instr->arg(load_arg->arg_idx()));
+      auto assign =
+          Assign::create(instr.GetOutput(), args.at(load_arg->arg_idx()));
       instr.ReplaceWith(*assign);
       delete &instr;
     }
@@ -919,25 +1036,78 @@ void inlineFunctionCall(Function& caller, AbstractCall* call_instr) {
 
   delete call_instr->instr;
   caller.num_inlined_functions++;
+  return true;
 }
 
-void InlineFunctionCalls::Run(Function& irfunc) {
-  if (irfunc.code == nullptr) {
-    // In tests, irfunc may not have bytecode.
-    return;
+// Inlining stops at this many levels of nested inlined frames, and a function
+// is inlined into an inlined copy of itself at most this many times.
+static constexpr int kMaxInlineDepth = 3;
+static constexpr int kMaxRecursiveInlineDepth = 1;
+
+// Callees at most this many bytecode instructions long are inlined even at
+// call sites that profiling says are cold.
+static constexpr size_t kSmallCalleeCost = 16;
+
+// The cost of inlining code, measured in bytecode instructions. This is what
+// the per-function inlining budget is spent on.
+static size_t inlineCost(BorrowedRef<PyCodeObject> code) {
+  return PyBytes_GET_SIZE(code->co_code) / sizeof(_Py_CODEUNIT);
+}
+
+// How many times the interpreter executed the call at the current instruction
+// of frame, according to the in-process type profiles or, failing that, the
+// profile data loaded at startup (which only records whether the call ran at
+// all). Returns -1 if there is no profile for frame's code object.
+static int64_t callSiteHits(const FrameState& frame) {
+  BytecodeOffset offset = frame.instr_offset();
+  ThreadedCompileSerialize guard;
+  TypeProfiles& profiles = Runtime::get()->typeProfiles();
+  auto code_it = profiles.find(Ref<PyCodeObject>{frame.code});
+  if (code_it != profiles.end()) {
+    auto& typed_hits = code_it->second.typed_hits;
+    auto hit_it = typed_hits.find(offset);
+    if (hit_it == typed_hits.end()) {
+      return 0;
+    }
+    const TypeProfiler& profiler = *hit_it->second;
+    int64_t hits = profiler.other();
+    for (int row = 0; row < profiler.rows() && profiler.count(row) > 0;
+         row++) {
+      hits += profiler.count(row);
+    }
+    return hits;
   }
-  if (irfunc.code->co_flags & kCoFlagsAnyGenerator) {
-    // TODO(T109706798): Support inlining into generators
-    JIT_DLOG(
-        "Refusing to inline functions into %s: function is a generator",
-        irfunc.fullname);
-    return;
+  if (const CodeProfileData* data = getProfileData(frame.code)) {
+    return data->count(offset) ? 1 : 0;
+  }
+  return -1;
+}
+
+// Number of frames in the inlining chain of frame, itself included, that are
+// executing code.
+static int recursiveDepth(const FrameState* frame, PyCodeObject* code) {
+  int depth = 0;
+  for (; frame != nullptr; frame = frame->parent) {
+    depth += frame->code == code;
   }
-  std::vector<AbstractCall> to_inline;
+  return depth;
+}
+
+static std::vector<AbstractCall> collectCalls(Function& irfunc, int depth) {
+  std::vector<AbstractCall> calls;
   for (auto& block : irfunc.cfg.blocks) {
     for (auto& instr : block) {
+      auto deopt = instr.asDeoptBase();
+      if (deopt == nullptr) {
+        continue;
+      }
+      FrameState* frame = deopt->frameState();
+      if ((frame == nullptr ? 0 : frame->inlineDepth()) != depth) {
+        continue;
+      }
       // TODO(emacs): Support InvokeMethod
-      if (instr.IsVectorCall() || instr.IsVectorCallStatic()) {
+      if (instr.IsVectorCall() || instr.IsVectorCallStatic() ||
+          instr.IsVectorCallKW()) {
         auto call = static_cast<VectorCallBase*>(&instr);
         Register* target = call->func();
         if (!target->type().hasValueSpec(TFunc)) {
@@ -948,28 +1118,116 @@ void InlineFunctionCalls::Run(Function& irfunc) {
               irfunc.fullname);
           continue;
         }
-        to_inline.emplace_back(AbstractCall(target, call->numArgs(), call));
+        if (!instr.IsVectorCallKW()) {
+          calls.emplace_back(AbstractCall(target, call->numArgs(), call));
+          continue;
+        }
+        Register* kwnames = call->arg(call->numArgs() - 1);
+        if (!kwnames->type().hasValueSpec(TTupleExact)) {
+          JIT_DLOG(
+              "Cannot inline call with non-constant kwnames %s into %s",
+              *kwnames,
+              irfunc.fullname);
+          continue;
+        }
+        calls.emplace_back(AbstractCall(
+            target,
+            call->numArgs() - 1,
+            call,
+            reinterpret_cast<PyTupleObject*>(kwnames->type().objectSpec())));
       } else if (instr.IsInvokeStaticFunction()) {
         auto call = static_cast<InvokeStaticFunction*>(&instr);
-        to_inline.emplace_back(
-            AbstractCall(call->func(), call->NumArgs(), call));
+        calls.emplace_back(AbstractCall(call->func(), call->NumArgs(), call));
       }
     }
   }
-  if (to_inline.empty()) {
+  return calls;
+}
+
+void InlineFunctionCalls::Run(Function& irfunc) {
+  if (irfunc.code == nullptr) {
+    // In tests, irfunc may not have bytecode.
     return;
   }
-  for (auto& instr : to_inline) {
-    inlineFunctionCall(irfunc, &instr);
-    // We need to reflow types after every inline to propagate new type
-    // information from the callee.
-    reflowTypes(irfunc);
+  if (irfunc.code->co_flags & kCoFlagsAnyGenerator) {
+    // TODO(T109706798): Support inlining into generators
+    JIT_DLOG(
+        "Refusing to inline functions into %s: function is a generator",
+        irfunc.fullname);
+    return;
+  }
+  size_t budget = _PyJIT_HIRInlinerBudget();
+  bool found_calls = false;
+  // Each round considers the calls made by the functions inlined in the
+  // previous one, so hot call chains get flattened up to kMaxInlineDepth.
+  for (int depth = 0; depth < kMaxInlineDepth; depth++) {
+    struct Candidate {
+      AbstractCall call;
+      int64_t hits;
+      size_t cost;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<AbstractCall> calls = collectCalls(irfunc, depth);
+    found_calls |= !calls.empty();
+    for (auto& call : calls) {
+      PyCodeObject* code =
+          reinterpret_cast<PyCodeObject*>(call.func->func_code);
+      const FrameState& frame = *call.instr->frameState();
+      if (recursiveDepth(&frame, code) > kMaxRecursiveInlineDepth) {
+        JIT_DLOG(
+            "Refusing to inline %s into %s: recursion limit reached",
+            funcFullname(call.func),
+            irfunc.fullname);
+        continue;
+      }
+      size_t cost = inlineCost(code);
+      int64_t hits = callSiteHits(frame);
+      if (hits == 0 && cost > kSmallCalleeCost) {
+        JIT_DLOG(
+            "Refusing to inline %s into %s: call site is cold",
+            funcFullname(call.func),
+            irfunc.fullname);
+        continue;
+      }
+      candidates.push_back({call, hits, cost});
+    }
+    if (candidates.empty()) {
+      break;
+    }
+    // Spend the budget on the hottest call sites first. Without profiles,
+    // calls are inlined in program order.
+    std::stable_sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const Candidate& a, const Candidate& b) { return a.hits > b.hits; });
+    for (auto& candidate : candidates) {
+      if (candidate.cost > budget) {
+        JIT_DLOG(
+            "Refusing to inline %s into %s: cost %d exceeds remaining budget "
+            "%d",
+            funcFullname(candidate.call.func),
+            irfunc.fullname,
+            candidate.cost,
+            budget);
+        continue;
+      }
+      if (!inlineFunctionCall(irfunc, &candidate.call)) {
+        continue;
+      }
+      budget -= candidate.cost;
+      // We need to reflow types after every inline to propagate new type
+      // information from the callee.
+      reflowTypes(irfunc);
+    }
+  }
+  if (!found_calls) {
+    return;
   }
   // The inliner will make some blocks unreachable and we need to remove them
   // to make the CFG valid again. While inlining might make some blocks
   // unreachable and therefore make less work (less to inline), we cannot
   // remove unreachable blocks in the above loop. It might delete instructions
-  // pointed to by `to_inline`.
+  // pointed to by the candidates.
   CopyPropagation{}.Run(irfunc);
   CleanCFG{}.Run(irfunc);
 }
@@ -200,6 +200,47 @@ class BuiltinLoadMethodElimination : public Pass {
   }
 };
 
+// Replace instructions that recompute a value that is already available in a
+// register, including loads of memory that hasn't been written since it was
+// last loaded or stored. See gvn.cpp for details.
+class GlobalValueNumbering : public Pass {
+ public:
+  GlobalValueNumbering() : Pass("GlobalValueNumbering") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<GlobalValueNumbering> Factory() {
+    return std::make_unique<GlobalValueNumbering>();
+  }
+};
+
+// Move loop-invariant computations and guards out of loops and into a
+// preheader block. See licm.cpp for details.
+class LoopInvariantCodeMotion : public Pass {
+ public:
+  LoopInvariantCodeMotion() : Pass("LoopInvariantCodeMotion") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<LoopInvariantCodeMotion> Factory() {
+    return std::make_unique<LoopInvariantCodeMotion>();
+  }
+};
+
+// Remove allocations of tuples and boxed primitives that don't escape the
+// function, forwarding their contents to their uses and recreating them only
+// on the deopt paths that need them. See scalar_replacement.cpp for details.
+class ScalarReplacement : public Pass {
+ public:
+  ScalarReplacement() : Pass("ScalarReplacement") {}
+
+  void Run(Function& irfunc) override;
+
+  static std::unique_ptr<ScalarReplacement> Factory() {
+    return std::make_unique<ScalarReplacement>();
+  }
+};
+
 class PassRegistry {
  public:
   PassRegistry();
@@ -214,6 +214,20 @@ Instr* HIRParser::parseInstr(const char* opcode, Register* dst, int bb_index) {
     expect(">");
     auto receiver = ParseRegister();
     NEW_INSTR(LoadTupleItem, dst, receiver, idx);
+  } else if (strcmp(opcode, "LoadField") == 0) {
+    expect("<");
+    std::string field = GetNextToken();
+    auto at = field.find('@');
+    JIT_CHECK(at != std::string::npos, "Bad LoadField field: %s", field);
+    std::size_t offset = std::stoul(field.substr(at + 1));
+    expect(",");
+    Type ty = Type::parse(env_, GetNextToken());
+    expect(",");
+    bool borrowed = strcmp(GetNextToken(), "borrowed") == 0;
+    expect(">");
+    auto receiver = ParseRegister();
+    NEW_INSTR(
+        LoadField, dst, receiver, field.substr(0, at), offset, ty, borrowed);
   } else if (strcmp(opcode, "CallMethod") == 0) {
     expect("<");
     int num_args = GetNextInteger();
@@ -302,7 +316,7 @@ Instr* HIRParser::parseInstr(const char* opcode, Register* dst, int bb_index) {
     auto receiver = ParseRegister();
     auto index = ParseRegister();
     auto value = ParseRegister();
-    NEW_INSTR(StoreSubscr, dst, receiver, index, value);
+    instruction = newInstr<StoreSubscr>(dst, receiver, index, value);
   } else if (strcmp(opcode, "Assign") == 0) {
     auto src = ParseRegister();
     NEW_INSTR(Assign, dst, src);
@@ -467,6 +481,12 @@ Instr* HIRParser::parseInstr(const char* opcode, Register* dst, int bb_index) {
     auto idx = ParseRegister();
     auto array_unused = ParseRegister();
     NEW_INSTR(LoadArrayItem, dst, ob_item, idx, array_unused, 0, TObject);
+  } else if (strcmp(opcode, "StoreArrayItem") == 0) {
+    auto ob_item = ParseRegister();
+    auto idx = ParseRegister();
+    auto value = ParseRegister();
+    auto array_unused = ParseRegister();
+    NEW_INSTR(StoreArrayItem, ob_item, idx, value, array_unused, TObject);
   } else if (strcmp(opcode, "Phi") == 0) {
     expect("<");
     PhiInfo info{dst};
@@ -237,12 +237,8 @@ GlobalCache Preloader::getGlobalCache(BorrowedRef<> name) const {
 }
 
 BorrowedRef<> Preloader::global(int name_idx) const {
-  BorrowedRef<> name = map_get(global_names_, name_idx, nullptr);
-  if (name != nullptr) {
-    GlobalCache cache = getGlobalCache(name);
-    return *(cache.valuePtr());
-  }
-  return nullptr;
+  auto it = global_values_.find(name_idx);
+  return it == global_values_.end() ? nullptr : it->second.get();
 }
 
 std::unique_ptr<Function> Preloader::makeFunction() const {
@@ -285,12 +281,14 @@ void Preloader::preload() {
           int name_idx = bc_instr.oparg();
           BorrowedRef<> name = PyTuple_GET_ITEM(code_->co_names, name_idx);
           // We can't keep hold of a reference to this cache, it could get
-          // invalidated and freed; we just do this here for the side effect to
-          // make sure the cached value has been loaded and any side effects of
-          // loading it have been exercised.
+          // invalidated and freed. Loading it here exercises any side effects
+          // of loading the value, and we keep the value itself alive so the
+          // compile can use it without looking at globals again.
           JIT_CHECK(name != nullptr, "name cannot be null");
-          getGlobalCache(name);
-          global_names_.emplace(name_idx, name);
+          PyObject* value = *(getGlobalCache(name).valuePtr());
+          if (value != nullptr) {
+            global_values_.emplace(name_idx, Ref<>(value));
+          }
         }
         break;
       }
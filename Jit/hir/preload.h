@@ -172,8 +172,8 @@ class Preloader {
   // keyed by locals index
   std::unordered_map<long, Type> check_arg_types_;
   std::map<long, PyTypeOpt> check_arg_pytypes_;
-  // keyed by name index, names borrowed from code object
-  std::unordered_map<int, BorrowedRef<>> global_names_;
+  // keyed by name index; the values globals had when preloaded
+  std::unordered_map<int, Ref<>> global_values_;
   Type return_type_{TObject};
   bool has_primitive_args_{false};
   bool has_primitive_first_arg_{false};
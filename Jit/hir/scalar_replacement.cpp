@@ -0,0 +1,425 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include "Jit/hir/hir.h"
+#include "Jit/hir/optimization.h"
+#include "Jit/hir/ssa.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jit {
+namespace hir {
+
+// This file contains the ScalarReplacement pass, which removes allocations of
+// short-lived objects that don't escape the function, replacing uses of their
+// contents with the values they were created from.
+//
+// Two kinds of allocation are handled:
+// - PrimitiveBox. Unboxing the result gives back the boxed value. If the box
+//   is otherwise only referenced from FrameStates, those references are
+//   replaced with the unboxed value, which the deopt machinery boxes again
+//   when reconstructing the interpreter frame (see MemoryView::read()).
+// - MakeListTuple for a tuple, initialized by InitListTuple. Loads of its
+//   items and size are replaced with the values it was initialized with. If
+//   the tuple is still needed to reconstruct a frame on a deopt path, the
+//   allocation is sunk into the blocks ending in Deopt that need it.
+//
+// Any other use of an allocation (passing it to a call, storing it, merging
+// it in a Phi, etc.) means it escapes, and it is left alone. This pass
+// rewrites FrameStates, so it must run after any pass that copies them, and
+// before RefcountInsertion binds them to guards.
+
+namespace {
+
+enum class UseKind {
+  // A normal operand of the instruction.
+  kOperand,
+  // Only needed to reconstruct the interpreter frame on deopt.
+  kFrameState,
+  // Part of the FrameState of a caller of an inlined function. These
+  // FrameStates are shared between instructions, and can't be rewritten
+  // independently.
+  kParentFrameState,
+};
+
+struct Use {
+  Instr* instr;
+  UseKind kind;
+};
+
+using UseMap = std::unordered_map<Register*, std::vector<Use>>;
+
+FrameState* frameStateOf(Instr& instr) {
+  if (instr.IsSnapshot()) {
+    return static_cast<Snapshot&>(instr).frameState();
+  }
+  if (DeoptBase* db = instr.asDeoptBase()) {
+    return db->frameState();
+  }
+  return nullptr;
+}
+
+UseMap collectUses(Function& irfunc) {
+  UseMap uses;
+  for (auto& block : irfunc.cfg.blocks) {
+    for (auto& instr : block) {
+      auto add_use = [&](Register* reg, UseKind kind) {
+        uses[reg].emplace_back(Use{&instr, kind});
+      };
+      for (std::size_t i = 0, n = instr.NumOperands(); i < n; ++i) {
+        add_use(instr.GetOperand(i), UseKind::kOperand);
+      }
+      if (DeoptBase* db = instr.asDeoptBase()) {
+        if (db->guiltyReg() != nullptr) {
+          add_use(db->guiltyReg(), UseKind::kFrameState);
+        }
+      }
+      UseKind kind = UseKind::kFrameState;
+      for (FrameState* fs = frameStateOf(instr); fs != nullptr;
+           fs = fs->parent) {
+        for (Register* reg : fs->stack) {
+          add_use(reg, kind);
+        }
+        for (Register* reg : fs->locals) {
+          if (reg != nullptr) {
+            add_use(reg, kind);
+          }
+        }
+        for (Register* reg : fs->cells) {
+          if (reg != nullptr) {
+            add_use(reg, kind);
+          }
+        }
+        kind = UseKind::kParentFrameState;
+      }
+    }
+  }
+  return uses;
+}
+
+// Find the Snapshots that will provide the FrameState for a guard. This
+// mirrors the logic in bindGuards() in refcount_insertion.cpp; all other
+// Snapshots are discarded before code generation.
+std::unordered_set<Instr*> findBoundSnapshots(Function& irfunc) {
+  std::unordered_set<Instr*> bound;
+  for (auto& block : irfunc.cfg.blocks) {
+    Instr* snapshot = nullptr;
+    for (auto& instr : block) {
+      if (instr.IsSnapshot()) {
+        snapshot = &instr;
+      } else if (
+          instr.IsGuard() || instr.IsGuardIs() || instr.IsGuardType() ||
+          instr.IsDeopt() || instr.IsDeoptPatchpoint()) {
+        if (snapshot != nullptr) {
+          bound.emplace(snapshot);
+        }
+      } else if (!instr.isReplayable()) {
+        snapshot = nullptr;
+      }
+    }
+  }
+  return bound;
+}
+
+class ScalarReplacer {
+ public:
+  explicit ScalarReplacer(Function& irfunc)
+      : irfunc_{irfunc},
+        uses_{collectUses(irfunc)},
+        bound_snapshots_{findBoundSnapshots(irfunc)} {}
+
+  bool run() {
+    std::vector<Instr*> allocs;
+    for (auto& block : irfunc_.cfg.blocks) {
+      for (auto& instr : block) {
+        if (instr.IsPrimitiveBox() ||
+            (instr.IsMakeListTuple() &&
+             static_cast<MakeListTuple&>(instr).is_tuple())) {
+          allocs.emplace_back(&instr);
+        }
+      }
+    }
+    for (Instr* alloc : allocs) {
+      if (alloc->IsPrimitiveBox()) {
+        sinkBox(static_cast<PrimitiveBox&>(*alloc));
+      } else {
+        sinkTuple(static_cast<MakeListTuple&>(*alloc));
+      }
+    }
+    return !removed_.empty();
+  }
+
+ private:
+  const std::vector<Use>& usesOf(Register* reg) {
+    static const std::vector<Use> kNoUses;
+    auto it = uses_.find(reg);
+    return it == uses_.end() ? kNoUses : it->second;
+  }
+
+  // Replace instr's output with value.
+  void replaceWith(Instr& instr, Register* value) {
+    auto assign = Assign::create(instr.GetOutput(), value);
+    assign->copyBytecodeOffset(instr);
+    instr.ReplaceWith(*assign);
+    removed_.emplace_back(&instr);
+  }
+
+  void remove(Instr& instr) {
+    instr.unlink();
+    removed_.emplace_back(&instr);
+  }
+
+  // Return true if deopting with the input of box in place of its output
+  // recreates an equivalent object. MemoryView::read() only reads integers
+  // that fill a whole register precisely, and enums have their own boxing
+  // logic.
+  static bool canRematerialize(const PrimitiveBox& box) {
+    Type src_type = box.value()->type();
+    Type box_type = box.type();
+    if (box_type <= TCEnum || !(src_type <= box_type)) {
+      return false;
+    }
+    return box_type <= TCInt64 || box_type <= TCUInt64;
+  }
+
+  void sinkBox(PrimitiveBox& box) {
+    Register* value = box.value();
+    if (box.type() <= TCEnum) {
+      return;
+    }
+    bool remat = canRematerialize(box);
+    bool escapes = false;
+    std::unordered_set<Instr*> unboxes;
+    for (const Use& use : usesOf(box.GetOutput())) {
+      if (use.kind != UseKind::kOperand) {
+        escapes |= !remat;
+        continue;
+      }
+      Instr* user = use.instr;
+      if (user->IsPrimitiveUnbox() &&
+          static_cast<PrimitiveUnbox*>(user)->type() == box.type() &&
+          value->type() <= user->GetOutput()->type()) {
+        unboxes.emplace(user);
+      } else {
+        escapes = true;
+      }
+    }
+
+    for (Instr* unbox : unboxes) {
+      replaceWith(*unbox, value);
+    }
+    if (escapes) {
+      return;
+    }
+    for (const Use& use : usesOf(box.GetOutput())) {
+      if (use.kind != UseKind::kOperand) {
+        use.instr->ReplaceUsesOf(box.GetOutput(), value);
+      }
+    }
+    remove(box);
+  }
+
+  // If instr is a LoadArrayItem from a constant index of tuple, return the
+  // index. Otherwise, return -1. ob_item is either the tuple itself, in which
+  // case the load is offset to its items, or the address of its items.
+  int tupleArrayIndex(Instr* instr, Register* tuple, Register* ob_item) {
+    if (!instr->IsLoadArrayItem()) {
+      return -1;
+    }
+    auto load = static_cast<LoadArrayItem*>(instr);
+    Type idx_type = load->idx()->type();
+    ssize_t offset =
+        ob_item == tuple ? offsetof(PyTupleObject, ob_item) : 0;
+    if (load->GetOperand(2) != tuple || load->ob_item() != ob_item ||
+        load->offset() != offset || !idx_type.hasIntSpec()) {
+      return -1;
+    }
+    return idx_type.intSpec();
+  }
+
+  // Return true if reg is a LoadFieldAddress of tuple's ob_item array whose
+  // only uses are loads of tuple's items.
+  bool isItemAddress(Register* reg, Register* tuple, std::size_t nvalues) {
+    Instr* instr = reg->instr();
+    if (!instr->IsLoadFieldAddress() || instr->GetOperand(0) != tuple) {
+      return false;
+    }
+    Type offset_type = instr->GetOperand(1)->type();
+    if (!offset_type.hasIntSpec() ||
+        offset_type.intSpec() != offsetof(PyTupleObject, ob_item)) {
+      return false;
+    }
+    for (const Use& use : usesOf(reg)) {
+      int idx = tupleArrayIndex(use.instr, tuple, reg);
+      if (use.kind != UseKind::kOperand || idx < 0 ||
+          static_cast<std::size_t>(idx) >= nvalues) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void sinkTuple(MakeListTuple& alloc) {
+    Register* tuple = alloc.GetOutput();
+    std::size_t nvalues = alloc.nvalues();
+    InitListTuple* init = nullptr;
+    std::unordered_map<Instr*, int> item_loads;
+    std::unordered_set<Instr*> other_uses;
+    std::unordered_set<Instr*> dead_snapshots;
+    std::unordered_set<BasicBlock*> deopt_blocks;
+
+    for (const Use& use : usesOf(tuple)) {
+      Instr* user = use.instr;
+      if (use.kind == UseKind::kParentFrameState) {
+        return;
+      }
+      if (use.kind == UseKind::kFrameState) {
+        if (user->block()->GetTerminator()->IsDeopt()) {
+          deopt_blocks.emplace(user->block());
+        } else if (user->IsSnapshot() && !bound_snapshots_.count(user)) {
+          dead_snapshots.emplace(user);
+        } else {
+          return;
+        }
+        continue;
+      }
+
+      if (user->IsInitListTuple() && user->GetOperand(0) == tuple) {
+        if ((init != nullptr && init != user) ||
+            user->block() != alloc.block()) {
+          return;
+        }
+        init = static_cast<InitListTuple*>(user);
+      } else if (user->IsLoadTupleItem()) {
+        auto load = static_cast<LoadTupleItem*>(user);
+        if (load->idx() >= nvalues) {
+          return;
+        }
+        item_loads[user] = load->idx();
+      } else if (user->IsLoadArrayItem()) {
+        Register* ob_item = static_cast<LoadArrayItem*>(user)->ob_item();
+        if (ob_item != tuple && !isItemAddress(ob_item, tuple, nvalues)) {
+          return;
+        }
+        int idx = tupleArrayIndex(user, tuple, ob_item);
+        if (idx < 0 || static_cast<std::size_t>(idx) >= nvalues) {
+          return;
+        }
+        item_loads[user] = idx;
+      } else if (
+          (user->IsLoadFieldAddress() &&
+           isItemAddress(user->GetOutput(), tuple, nvalues)) ||
+          user->IsLoadVarObjectSize() || user->IsUseType()) {
+        other_uses.emplace(user);
+      } else {
+        return;
+      }
+    }
+    if (init == nullptr || init->num_args() != nvalues) {
+      return;
+    }
+
+    for (auto& pair : item_loads) {
+      replaceWith(*pair.first, init->GetOperand(pair.second + 1));
+    }
+    for (Instr* user : other_uses) {
+      if (user->IsLoadVarObjectSize()) {
+        auto size = LoadConst::create(
+            irfunc_.env.AllocateRegister(),
+            Type::fromCInt(nvalues, TCInt64));
+        size->copyBytecodeOffset(*user);
+        size->InsertBefore(*user);
+        replaceWith(*user, size->GetOutput());
+      } else {
+        remove(*user);
+      }
+    }
+    for (Instr* snapshot : dead_snapshots) {
+      remove(*snapshot);
+    }
+    for (BasicBlock* block : deopt_blocks) {
+      materializeTuple(alloc, *init, block);
+    }
+    remove(*init);
+    remove(alloc);
+  }
+
+  // Recreate the tuple allocated by alloc at the beginning of block, and use
+  // the new copy in place of the original in block. The new allocation deopts
+  // with the FrameState in effect at that point rather than the one from where
+  // the tuple was first built. That FrameState refers to the tuple itself,
+  // which doesn't exist yet if the allocation fails, so None stands in for it.
+  void materializeTuple(
+      const MakeListTuple& alloc,
+      const InitListTuple& init,
+      BasicBlock* block) {
+    auto it = block->begin();
+    while (it != block->end() && it->IsPhi()) {
+      ++it;
+    }
+    FrameState* escape_fs = nullptr;
+    for (auto fs_it = it; escape_fs == nullptr; ++fs_it) {
+      JIT_CHECK(fs_it != block->end(), "Deopt block without a FrameState");
+      escape_fs = frameStateOf(*fs_it);
+    }
+    FrameState fs{*escape_fs};
+    Register* none = nullptr;
+    auto replace_tuple = [&](Register*& reg) {
+      if (reg != alloc.GetOutput()) {
+        return;
+      }
+      if (none == nullptr) {
+        none = irfunc_.env.AllocateRegister();
+        auto load_none = LoadConst::create(none, TNoneType);
+        load_none->copyBytecodeOffset(alloc);
+        block->insert(load_none, it);
+      }
+      reg = none;
+    };
+    for (Register*& reg : fs.stack) {
+      replace_tuple(reg);
+    }
+    for (Register*& reg : fs.locals) {
+      replace_tuple(reg);
+    }
+    for (Register*& reg : fs.cells) {
+      replace_tuple(reg);
+    }
+
+    Register* tuple = irfunc_.env.AllocateRegister();
+    auto new_alloc =
+        MakeListTuple::create(true, tuple, alloc.nvalues(), fs);
+    auto new_init = InitListTuple::create(init.NumOperands(), true);
+    new_init->SetOperand(0, tuple);
+    for (std::size_t i = 1, n = init.NumOperands(); i < n; ++i) {
+      new_init->SetOperand(i, init.GetOperand(i));
+    }
+    new_alloc->copyBytecodeOffset(alloc);
+    new_init->copyBytecodeOffset(init);
+    tuple->set_type(outputType(*new_alloc));
+
+    for (auto& instr : *block) {
+      instr.ReplaceUsesOf(alloc.GetOutput(), tuple);
+    }
+    block->insert(new_alloc, it);
+    block->insert(new_init, it);
+  }
+
+  Function& irfunc_;
+  UseMap uses_;
+  std::unordered_set<Instr*> bound_snapshots_;
+  std::vector<std::unique_ptr<Instr>> removed_;
+};
+
+} // namespace
+
+void ScalarReplacement::Run(Function& irfunc) {
+  if (ScalarReplacer{irfunc}.run()) {
+    CopyPropagation{}.Run(irfunc);
+    reflowTypes(irfunc);
+  }
+}
+
+} // namespace hir
+} // namespace jit
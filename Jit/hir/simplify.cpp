@@ -5,6 +5,7 @@
 #include "Jit/hir/optimization.h"
 #include "Jit/hir/printer.h"
 #include "Jit/hir/ssa.h"
+#include "Jit/jit_rt.h"
 
 #include <fmt/ostream.h>
 
@@ -381,6 +382,21 @@ Register* simplifyBinaryOp(Env& env, const BinaryOp* instr) {
             instr->readonly_flags(), 2)) {
       return nullptr;
     }
+    if (lhs->isA(TDictExact) && rhs->isA(TUnicodeExact)) {
+      // Exact dicts have no __missing__, so this is the same lookup that
+      // BINARY_SUBSCR_DICT_STR does in the interpreter. The key's hash is
+      // cached on the str object.
+      env.emit<UseType>(lhs, TDictExact);
+      env.emit<UseType>(rhs, TUnicodeExact);
+      Register* result = env.emitRaw<CallStatic>(
+          2,
+          env.func.env.AllocateRegister(),
+          reinterpret_cast<void*>(JITRT_DictSubscrUnicode),
+          TOptObject);
+      result->instr()->SetOperand(0, lhs);
+      result->instr()->SetOperand(1, rhs);
+      return env.emit<CheckExc>(result, *instr->frameState());
+    }
     if (!rhs->isA(TLongExact)) {
       return nullptr;
     }
@@ -441,6 +457,28 @@ Register* simplifyBinaryOp(Env& env, const BinaryOp* instr) {
   return nullptr;
 }
 
+Register* simplifyStoreSubscr(Env& env, const StoreSubscr* instr) {
+  Register* container = instr->GetOperand(0);
+  Register* sub = instr->index();
+  Register* value = instr->GetOperand(2);
+  if (container->isA(TListExact) && sub->isA(TLongExact)) {
+    env.emit<UseType>(container, TListExact);
+    env.emit<UseType>(sub, TLongExact);
+    Register* index = env.emit<PrimitiveUnbox>(sub, TCInt64);
+    Register* adjusted_idx =
+        env.emit<CheckSequenceBounds>(container, index, *instr->frameState());
+    Register* ob_item = env.emit<LoadField>(
+        container, "ob_item", offsetof(PyListObject, ob_item), TCPtr);
+    env.emit<StoreArrayItem>(ob_item, adjusted_idx, value, container, TObject);
+    return env.emit<LoadConst>(Type::fromCInt(0, TCInt32));
+  }
+  if (container->isA(TDictExact)) {
+    env.emit<UseType>(container, TDictExact);
+    return env.emit<SetDictItem>(container, sub, value, *instr->frameState());
+  }
+  return nullptr;
+}
+
 Register* simplifyLongBinaryOp(Env& env, const LongBinaryOp* instr) {
   Type left_type = instr->left()->type();
   Type right_type = instr->right()->type();
@@ -617,6 +655,8 @@ Register* simplifyInstr(Env& env, const Instr* instr) {
 
     case Opcode::kBinaryOp:
       return simplifyBinaryOp(env, static_cast<const BinaryOp*>(instr));
+    case Opcode::kStoreSubscr:
+      return simplifyStoreSubscr(env, static_cast<const StoreSubscr*>(instr));
     case Opcode::kLongBinaryOp:
       return simplifyLongBinaryOp(env, static_cast<const LongBinaryOp*>(instr));
 
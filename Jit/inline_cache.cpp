@@ -100,15 +100,45 @@ void AttributeMutator::set_descr_or_classvar(
   descr_or_cvar_.dictoffset = type->tp_dictoffset;
 }
 
+bool AttributeMutator::toInlineEntry(AttributeInlineEntry& entry) const {
+  switch (kind_) {
+    case Kind::kSplit:
+      entry.keys = split_.keys;
+      entry.dict_offset = split_.dict_offset;
+      entry.value_offset = split_.val_offset * sizeof(PyObject*);
+      break;
+    case Kind::kMemberDescr: {
+      // Only slots holding a PyObject* that raise AttributeError when unset
+      // (which is what __slots__ creates) reduce to a load and a null check.
+      PyMemberDef* memberdef = member_descr_.memberdef;
+      if (memberdef->type != T_OBJECT_EX ||
+          (memberdef->flags & READ_RESTRICTED)) {
+        return false;
+      }
+      entry.keys = nullptr;
+      entry.dict_offset = 0;
+      entry.value_offset = memberdef->offset;
+      break;
+    }
+    default:
+      return false;
+  }
+  entry.type = type_;
+  return true;
+}
+
 void AttributeCache::typeChanged(PyTypeObject* type) {
   for (auto& entry : entries_) {
     if (entry.type() == type) {
       entry.reset();
     }
   }
+  if (inline_entry_.type == type) {
+    inline_entry_ = AttributeInlineEntry{};
+  }
 }
 
-void AttributeCache::fill(
+AttributeMutator* AttributeCache::fill(
     BorrowedRef<PyTypeObject> type,
     BorrowedRef<> name,
     BorrowedRef<> descr) {
@@ -116,12 +146,12 @@ void AttributeCache::fill(
     // The type must have a valid version tag in order for us to be able to
     // invalidate the cache when the type is modified. See the comment at
     // the top of `PyType_Modified` for more details.
-    return;
+    return nullptr;
   }
 
   AttributeMutator* mut = findEmptyEntry();
   if (mut == nullptr) {
-    return;
+    return nullptr;
   }
 
   if (descr != nullptr) {
@@ -138,14 +168,14 @@ void AttributeCache::fill(
       mut->set_descr_or_classvar(type, descr);
     }
     ac_watcher.watch(type, this);
-    return;
+    return mut;
   }
 
   if (type->tp_dictoffset < 0 ||
       !PyType_HasFeature(type, Py_TPFLAGS_HEAPTYPE)) {
     // We only support the common case for objects - fixed-size instances
     // (tp_dictoffset >= 0) of heap types (Py_TPFLAGS_HEAPTYPE).
-    return;
+    return nullptr;
   }
 
   // Instance attribute with no shadowing. Specialize the lookup based on
@@ -160,6 +190,7 @@ void AttributeCache::fill(
     mut->set_combined(type);
   }
   ac_watcher.watch(type, this);
+  return mut;
 }
 
 AttributeMutator* AttributeCache::findEmptyEntry() {
@@ -504,7 +535,7 @@ LoadAttrCache::invokeSlowPath(PyObject* obj, PyObject* name) {
   if (descr != nullptr) {
     f = descr->ob_type->tp_descr_get;
     if (f != nullptr && PyDescr_IsData(descr)) {
-      fill(tp, name, descr);
+      fillInlineEntry(fill(tp, name, descr));
       return f(descr, obj, tp);
     }
   }
@@ -518,18 +549,18 @@ LoadAttrCache::invokeSlowPath(PyObject* obj, PyObject* name) {
   if (dict != nullptr) {
     Ref<> res(PyDict_GetItem(dict, name));
     if (res != nullptr) {
-      fill(tp, name, descr);
+      fillInlineEntry(fill(tp, name, descr));
       return res.release();
     }
   }
 
   if (f != nullptr) {
-    fill(tp, name, descr);
+    fillInlineEntry(fill(tp, name, descr));
     return f(descr, obj, tp);
   }
 
   if (descr != nullptr) {
-    fill(tp, name, descr);
+    fillInlineEntry(fill(tp, name, descr));
     return descr.release();
   }
 
@@ -573,6 +604,16 @@ LoadAttrCache::invoke(LoadAttrCache* cache, PyObject* obj, PyObject* name) {
   return cache->doInvoke(obj, name);
 }
 
+void LoadAttrCache::fillInlineEntry(const AttributeMutator* mut) {
+  if (mut == nullptr || inline_entry_.type != nullptr) {
+    return;
+  }
+  AttributeInlineEntry entry;
+  if (mut->toInlineEntry(entry)) {
+    inline_entry_ = entry;
+  }
+}
+
 PyObject* LoadAttrCache::doInvoke(PyObject* obj, PyObject* name) {
   PyTypeObject* tp = Py_TYPE(obj);
   for (auto& entry : entries_) {
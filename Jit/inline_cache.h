@@ -88,6 +88,22 @@ struct DescrOrClassVarMutator {
   Py_ssize_t dictoffset;
 };
 
+// The hot entry of a LoadAttrCache, laid out to be read directly by
+// JIT-compiled code. A hit only needs a type check and a few dependent loads,
+// so it covers the two kinds of attribute that don't need a call: values in a
+// split instance dict and object slots.
+struct AttributeInlineEntry {
+  // Borrowed; nullptr when the entry is empty.
+  PyTypeObject* type{nullptr};
+  // Shared keys of a split dict, or nullptr for a slot.
+  PyDictKeysObject* keys{nullptr};
+  // Offset of the instance dict in the object (split dicts only).
+  Py_ssize_t dict_offset{0};
+  // Byte offset of the value in the dict's ma_values, or in the object for a
+  // slot.
+  Py_ssize_t value_offset{0};
+};
+
 // An instance of AttributeMutator is specialized to more efficiently perform a
 // get/set of a particular kind of attribute.
 class AttributeMutator {
@@ -115,6 +131,10 @@ class AttributeMutator {
   PyObject* setAttr(PyObject* obj, PyObject* name, PyObject* value);
   PyObject* getAttr(PyObject* obj, PyObject* name);
 
+  // Describe this mutator's lookup as an AttributeInlineEntry. Returns false
+  // if it can't be done without a call.
+  bool toInlineEntry(AttributeInlineEntry& entry) const;
+
  private:
   Kind kind_;
   PyTypeObject* type_; // borrowed
@@ -134,10 +154,14 @@ class AttributeCache {
  protected:
   AttributeMutator* findEmptyEntry();
 
-  void
+  // Returns the entry that was filled, or nullptr if the lookup couldn't be
+  // cached.
+  AttributeMutator*
   fill(BorrowedRef<PyTypeObject> type, BorrowedRef<> name, BorrowedRef<> descr);
 
   std::array<AttributeMutator, 4> entries_;
+  // Only used by LoadAttrCache, but reset here alongside entries_.
+  AttributeInlineEntry inline_entry_;
 };
 
 // A cache for an individual StoreAttr instruction.
@@ -172,10 +196,17 @@ class LoadAttrCache : public AttributeCache {
   // Returns a new reference to the value or NULL on error.
   static PyObject* invoke(LoadAttrCache* cache, PyObject* obj, PyObject* name);
 
+  // The first cached lookup that can be performed inline. JIT-compiled code
+  // checks it before calling invoke().
+  const AttributeInlineEntry& inlineEntry() const {
+    return inline_entry_;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(LoadAttrCache);
 
   PyObject* doInvoke(PyObject* obj, PyObject* name);
+  void fillInlineEntry(const AttributeMutator* mut);
   PyObject* invokeSlowPath(PyObject* obj, PyObject* name);
 };
 
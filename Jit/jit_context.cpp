@@ -1,6 +1,9 @@
 // Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
 #include "Jit/jit_context.h"
 
+#include "internal/pycore_shadow_frame.h"
+
+#include "Jit/code_allocator.h"
 #include "Jit/codegen/gen_asm.h"
 #include "Jit/jit_gdb_support.h"
 #include "Jit/log.h"
@@ -35,6 +38,18 @@ static void deopt_type(_PyJITContext* ctx, BorrowedRef<PyTypeObject> type) {
   tp->tp_str = deopt_info.orig_tp_str;
   tp->tp_getattro = deopt_info.orig_tp_getattro;
   tp->tp_descr_get = deopt_info.orig_tp_descr_get;
+  tp->tp_richcompare = deopt_info.orig_tp_richcompare;
+  tp->tp_hash = deopt_info.orig_tp_hash;
+  tp->tp_iter = deopt_info.orig_tp_iter;
+  tp->tp_iternext = deopt_info.orig_tp_iternext;
+  if (tp->tp_as_sequence != nullptr) {
+    tp->tp_as_sequence->sq_length = deopt_info.orig_sq_length;
+  }
+  if (tp->tp_as_mapping != nullptr) {
+    tp->tp_as_mapping->mp_length = deopt_info.orig_mp_length;
+    tp->tp_as_mapping->mp_subscript = deopt_info.orig_mp_subscript;
+    tp->tp_as_mapping->mp_ass_subscript = deopt_info.orig_mp_ass_subscript;
+  }
 
   ctx->type_deopt.erase(it);
 }
@@ -60,6 +75,122 @@ void _PyJITContext_ClearCache(_PyJITContext* ctx) {
   ctx->compiled_codes.clear();
 }
 
+void _PyJITContext_InvalidateCode(
+    _PyJITContext* ctx,
+    jit::CodeRuntime* code_rt) {
+  jit::ThreadedCompileSerialize guard;
+  for (auto it = ctx->compiled_codes.begin(); it != ctx->compiled_codes.end();
+       ++it) {
+    if (it->second->codeRuntime() != code_rt) {
+      continue;
+    }
+    vectorcallfunc entry = it->second->entry_point();
+    std::vector<BorrowedRef<PyFunctionObject>> funcs;
+    for (BorrowedRef<PyFunctionObject> func : ctx->compiled_funcs) {
+      if (func->vectorcall == entry) {
+        funcs.emplace_back(func);
+      }
+    }
+    for (BorrowedRef<PyFunctionObject> func : funcs) {
+      deopt_func(ctx, func);
+    }
+    JIT_DLOG(
+        "Invalidated %s after failed speculation; %d function(s) reset",
+        PyUnicode_AsUTF8(code_rt->frameState()->code()->co_qualname),
+        funcs.size());
+    // The code may still be running further up the stack.
+    ctx->orphaned_compiled_codes.emplace_back(std::move(it->second));
+    ctx->compiled_codes.erase(it);
+    return;
+  }
+  for (auto it = ctx->osr_codes.begin(); it != ctx->osr_codes.end(); ++it) {
+    if (it->second != nullptr && it->second->codeRuntime() == code_rt) {
+      ctx->orphaned_compiled_codes.emplace_back(std::move(it->second));
+      ctx->osr_codes.erase(it);
+      return;
+    }
+  }
+}
+
+// Return the code objects of all frames on any thread's stack, whether they
+// are executed by the interpreter or the JIT.
+static jit::UnorderedSet<PyCodeObject*> code_on_stacks() {
+  jit::UnorderedSet<PyCodeObject*> result;
+  for (PyInterpreterState* interp = PyInterpreterState_Head();
+       interp != nullptr;
+       interp = PyInterpreterState_Next(interp)) {
+    for (PyThreadState* tstate = PyInterpreterState_ThreadHead(interp);
+         tstate != nullptr;
+         tstate = PyThreadState_Next(tstate)) {
+      for (_PyShadowFrame* sf = tstate->shadow_frame; sf != nullptr;
+           sf = sf->prev) {
+        result.emplace(_PyShadowFrame_GetCode(sf));
+      }
+    }
+  }
+  return result;
+}
+
+int _PyJITContext_ReclaimCode(_PyJITContext* ctx) {
+  int num_reclaimed = 0;
+  // Retiring a CodeRuntime drops its reference to the code object, which can
+  // leave other compiled code (e.g. for functions nested in it) unreferenced,
+  // so keep going until nothing changes.
+  for (;;) {
+    jit::UnorderedSet<PyCodeObject*> running = code_on_stacks();
+    jit::UnorderedSet<vectorcallfunc> bound_entries;
+    for (BorrowedRef<PyFunctionObject> func : ctx->compiled_funcs) {
+      bound_entries.emplace(func->vectorcall);
+    }
+    auto can_free = [&](const jit::CompiledFunction& compiled) {
+      jit::CodeRuntime* code_rt = compiled.codeRuntime();
+      BorrowedRef<PyCodeObject> code = code_rt->frameState()->code();
+      // Static Python code can be called directly from other compiled code
+      // and from vtables, which we don't track.
+      return !(code->co_flags & CO_STATICALLY_COMPILED) &&
+          code_rt->numLiveGenerators() == 0 && running.count(code) == 0 &&
+          bound_entries.count(compiled.entry_point()) == 0;
+    };
+
+    std::vector<std::unique_ptr<jit::CompiledFunction>> dead;
+    auto& orphans = ctx->orphaned_compiled_codes;
+    for (auto it = orphans.begin(); it != orphans.end();) {
+      if (can_free(**it)) {
+        dead.emplace_back(std::move(*it));
+        it = orphans.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // The CodeRuntime owns a reference to its code object, so a count of 1
+    // means that no function, frame, or generator can use the code anymore.
+    for (auto it = ctx->compiled_codes.begin();
+         it != ctx->compiled_codes.end();) {
+      if (Py_REFCNT(it->first.code) == 1 && can_free(*it->second)) {
+        dead.emplace_back(std::move(it->second));
+        it = ctx->compiled_codes.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (dead.empty()) {
+      break;
+    }
+
+    for (auto& compiled : dead) {
+      jit::CodeAllocator::get()->releaseCode(
+          reinterpret_cast<void*>(compiled->entry_point()));
+    }
+    // Releasing references can run arbitrary Python code, so this has to
+    // happen after we're done looking at ctx.
+    for (auto& compiled : dead) {
+      compiled->codeRuntime()->retire();
+    }
+    num_reclaimed += dead.size();
+  }
+  return num_reclaimed;
+}
+
 static inline int check_result(int* ok_count, _PyJIT_Result res) {
   if (res == PYJIT_RESULT_OK) {
     (*ok_count)++;
@@ -203,6 +334,85 @@ _PyJIT_Result specialize_tp_getattr(
   return PYJIT_RESULT_OK;
 }
 
+// Replace *target, if it still holds the generic slot function original from
+// typeobject.c, with a stub made by gen() for the Python function named by id.
+template <typename T, typename Gen>
+static _PyJIT_Result specialize_slot(
+    PyTypeObject* type,
+    T* target,
+    T original,
+    _Py_Identifier* id,
+    Gen gen) {
+  JIT_DCHECK(original != nullptr, "slot not initialized");
+  if (*target != original) {
+    return PYJIT_RESULT_CANNOT_SPECIALIZE;
+  }
+  PyObject* fn = NULL;
+  if (lookup_type_function(type, id, &fn) < 0) {
+    return PYJIT_RESULT_CANNOT_SPECIALIZE;
+  }
+  T specialized = gen(fn);
+  if (specialized == NULL) {
+    return PYJIT_RESULT_UNKNOWN_ERROR;
+  }
+  *target = specialized;
+  JIT_DLOG(
+      "Jitted %s stub for %s at %p that calls %p",
+      id->string,
+      type->tp_name,
+      (void*)specialized,
+      (void*)fn);
+  return PYJIT_RESULT_OK;
+}
+
+static _PyJIT_Result specialize_tp_richcompare(
+    _PyJITContext* ctx,
+    PyTypeObject* type,
+    richcmpfunc slot_tp_richcompare) {
+  JIT_DCHECK(slot_tp_richcompare != nullptr, "slot not initialized");
+  if (type->tp_richcompare != slot_tp_richcompare) {
+    return PYJIT_RESULT_CANNOT_SPECIALIZE;
+  }
+  _Py_IDENTIFIER(__lt__);
+  _Py_IDENTIFIER(__le__);
+  _Py_IDENTIFIER(__eq__);
+  _Py_IDENTIFIER(__ne__);
+  _Py_IDENTIFIER(__gt__);
+  _Py_IDENTIFIER(__ge__);
+  _Py_Identifier* ids[] = {
+      &PyId___lt__,
+      &PyId___le__,
+      &PyId___eq__,
+      &PyId___ne__,
+      &PyId___gt__,
+      &PyId___ge__};
+  // Comparisons that aren't implemented by a Python function (e.g. the
+  // default __ne__ from object) are left to the generic slot.
+  PyObject* funcs[Py_GE + 1];
+  bool any_func = false;
+  for (int op = Py_LT; op <= Py_GE; op++) {
+    if (lookup_type_function(type, ids[op], &funcs[op]) < 0) {
+      funcs[op] = nullptr;
+    } else {
+      any_func = true;
+    }
+  }
+  if (!any_func) {
+    return PYJIT_RESULT_CANNOT_SPECIALIZE;
+  }
+  richcmpfunc specialized =
+      ctx->slot_gen.genRichCompareSlot(type, funcs, slot_tp_richcompare);
+  if (specialized == NULL) {
+    return PYJIT_RESULT_UNKNOWN_ERROR;
+  }
+  type->tp_richcompare = specialized;
+  JIT_DLOG(
+      "Jitted tp_richcompare stub for %s at %p",
+      type->tp_name,
+      (void*)specialized);
+  return PYJIT_RESULT_OK;
+}
+
 _PyJIT_Result _PyJITContext_SpecializeType(
     _PyJITContext* ctx,
     BorrowedRef<PyTypeObject> type,
@@ -244,6 +454,97 @@ _PyJIT_Result _PyJITContext_SpecializeType(
     return PYJIT_RESULT_UNKNOWN_ERROR;
   }
 
+  /* Specialize tp_richcompare */
+  res = specialize_tp_richcompare(ctx, type, slots->tp_richcompare);
+  if (check_result(&ok_count, res) < 0) {
+    return PYJIT_RESULT_UNKNOWN_ERROR;
+  }
+
+  /* Specialize tp_hash */
+  _Py_IDENTIFIER(__hash__);
+  res = specialize_slot(
+      type, &type->tp_hash, slots->tp_hash, &PyId___hash__, [&](PyObject* fn) {
+        return ctx->slot_gen.genHashSlot(type, fn);
+      });
+  if (check_result(&ok_count, res) < 0) {
+    return PYJIT_RESULT_UNKNOWN_ERROR;
+  }
+
+  /* Specialize tp_iter and tp_iternext */
+  _Py_IDENTIFIER(__iter__);
+  res = specialize_slot(
+      type, &type->tp_iter, slots->tp_iter, &PyId___iter__, [&](PyObject* fn) {
+        return ctx->slot_gen.genIterSlot(type, fn);
+      });
+  if (check_result(&ok_count, res) < 0) {
+    return PYJIT_RESULT_UNKNOWN_ERROR;
+  }
+
+  _Py_IDENTIFIER(__next__);
+  res = specialize_slot(
+      type,
+      &type->tp_iternext,
+      slots->tp_iternext,
+      &PyId___next__,
+      [&](PyObject* fn) { return ctx->slot_gen.genIterNextSlot(type, fn); });
+  if (check_result(&ok_count, res) < 0) {
+    return PYJIT_RESULT_UNKNOWN_ERROR;
+  }
+
+  /* Specialize sq_length */
+  _Py_IDENTIFIER(__len__);
+  PySequenceMethods* sq = type->tp_as_sequence;
+  if (sq != nullptr) {
+    res = specialize_slot(
+        type,
+        &sq->sq_length,
+        slots->sq_length,
+        &PyId___len__,
+        [&](PyObject* fn) { return ctx->slot_gen.genLenSlot(type, fn); });
+    if (check_result(&ok_count, res) < 0) {
+      return PYJIT_RESULT_UNKNOWN_ERROR;
+    }
+  }
+
+  /* Specialize mp_length, mp_subscript, and mp_ass_subscript */
+  PyMappingMethods* mp = type->tp_as_mapping;
+  if (mp != nullptr) {
+    res = specialize_slot(
+        type,
+        &mp->mp_length,
+        slots->sq_length,
+        &PyId___len__,
+        [&](PyObject* fn) { return ctx->slot_gen.genLenSlot(type, fn); });
+    if (check_result(&ok_count, res) < 0) {
+      return PYJIT_RESULT_UNKNOWN_ERROR;
+    }
+
+    _Py_IDENTIFIER(__getitem__);
+    res = specialize_slot(
+        type,
+        &mp->mp_subscript,
+        slots->mp_subscript,
+        &PyId___getitem__,
+        [&](PyObject* fn) { return ctx->slot_gen.genGetItemSlot(type, fn); });
+    if (check_result(&ok_count, res) < 0) {
+      return PYJIT_RESULT_UNKNOWN_ERROR;
+    }
+
+    _Py_IDENTIFIER(__setitem__);
+    res = specialize_slot(
+        type,
+        &mp->mp_ass_subscript,
+        slots->mp_ass_subscript,
+        &PyId___setitem__,
+        [&](PyObject* fn) {
+          return ctx->slot_gen.genSetItemSlot(
+              type, fn, slots->mp_ass_subscript);
+        });
+    if (check_result(&ok_count, res) < 0) {
+      return PYJIT_RESULT_UNKNOWN_ERROR;
+    }
+  }
+
   if (ok_count > 0) {
     /* Mark the type as jit compiled */
     bool inserted = ctx->type_deopt.emplace(type, type).second;
@@ -402,6 +703,28 @@ _PyJIT_Result _PyJITContext_CompilePreloader(
   return PYJIT_RESULT_OK;
 }
 
+jit::CompiledFunction* _PyJITContext_CompileOSREntry(
+    _PyJITContext* ctx,
+    BorrowedRef<PyCodeObject> code,
+    BorrowedRef<PyDictObject> globals,
+    const std::string& fullname,
+    const jit::hir::OSREntry& osr_entry) {
+  OSRCompilationKey key{code, globals, osr_entry.offset};
+  auto it = ctx->osr_codes.find(key);
+  if (it != ctx->osr_codes.end()) {
+    return it->second.get();
+  }
+
+  JIT_DLOG("Compiling OSR entry for %s at %d", fullname, osr_entry.offset);
+  std::unique_ptr<jit::CompiledFunction> compiled =
+      ctx->jit_compiler.Compile(
+          jit::hir::Preloader(code, globals, fullname), &osr_entry);
+  if (compiled == nullptr) {
+    ctx->osr_failed_codes.emplace_back(code.get());
+  }
+  return ctx->osr_codes.emplace(key, std::move(compiled)).first->second.get();
+}
+
 _PyJIT_Result _PyJITContext_AttachCompiledCode(
     _PyJITContext* ctx,
     BorrowedRef<PyFunctionObject> func) {
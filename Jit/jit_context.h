@@ -40,6 +40,29 @@ struct std::hash<CompilationKey> {
   }
 };
 
+// Lookup key for _PyJITContext::osr_codes: the code object and globals dict
+// an OSR entry was compiled with, and the offset of its loop header.
+struct OSRCompilationKey {
+  CompilationKey code_key;
+  int offset;
+
+  OSRCompilationKey(PyObject* code, PyObject* globals, int offset)
+      : code_key(code, globals), offset(offset) {}
+
+  bool operator==(const OSRCompilationKey& other) const {
+    return code_key == other.code_key && offset == other.offset;
+  }
+};
+
+template <>
+struct std::hash<OSRCompilationKey> {
+  std::size_t operator()(const OSRCompilationKey& key) const {
+    return jit::combineHash(
+        std::hash<CompilationKey>{}(key.code_key),
+        std::hash<int>{}(key.offset));
+  }
+};
+
 /* Deoptimization information for a compiled type. */
 struct TypeDeoptInfo {
   explicit TypeDeoptInfo(PyTypeObject* type)
@@ -48,7 +71,20 @@ struct TypeDeoptInfo {
         orig_tp_repr{type->tp_repr},
         orig_tp_str{type->tp_str},
         orig_tp_getattro{type->tp_getattro},
-        orig_tp_descr_get{type->tp_descr_get} {}
+        orig_tp_descr_get{type->tp_descr_get},
+        orig_tp_richcompare{type->tp_richcompare},
+        orig_tp_hash{type->tp_hash},
+        orig_tp_iter{type->tp_iter},
+        orig_tp_iternext{type->tp_iternext} {
+    if (type->tp_as_sequence != nullptr) {
+      orig_sq_length = type->tp_as_sequence->sq_length;
+    }
+    if (type->tp_as_mapping != nullptr) {
+      orig_mp_length = type->tp_as_mapping->mp_length;
+      orig_mp_subscript = type->tp_as_mapping->mp_subscript;
+      orig_mp_ass_subscript = type->tp_as_mapping->mp_ass_subscript;
+    }
+  }
 
   // Original values for compiled type objects.
   ternaryfunc orig_tp_call;
@@ -57,6 +93,14 @@ struct TypeDeoptInfo {
   reprfunc orig_tp_str;
   getattrofunc orig_tp_getattro;
   descrgetfunc orig_tp_descr_get;
+  richcmpfunc orig_tp_richcompare;
+  hashfunc orig_tp_hash;
+  getiterfunc orig_tp_iter;
+  iternextfunc orig_tp_iternext;
+  lenfunc orig_sq_length{nullptr};
+  lenfunc orig_mp_length{nullptr};
+  binaryfunc orig_mp_subscript{nullptr};
+  objobjargproc orig_mp_ass_subscript{nullptr};
 };
 
 /*
@@ -89,10 +133,23 @@ struct _PyJITContext {
 
   /*
    * Code which is being kept alive in case it was in use when
-   * _PyJITContext_ClearCache was called. Only intended to be used during
-   * multithreaded_compile_test.
+   * _PyJITContext_ClearCache or _PyJITContext_InvalidateCode was called.
    */
   std::vector<std::unique_ptr<jit::CompiledFunction>> orphaned_compiled_codes;
+
+  /*
+   * OSR entries into the middle of code objects. A null value records a
+   * failed compilation, so that it isn't retried every time the loop gets
+   * hot.
+   */
+  jit::UnorderedMap<OSRCompilationKey, std::unique_ptr<jit::CompiledFunction>>
+      osr_codes;
+
+  /*
+   * Keeps the code objects of failed OSR compilations alive, since nothing
+   * else holds on to the keys of their null entries in osr_codes.
+   */
+  std::vector<Ref<PyCodeObject>> osr_failed_codes;
 };
 
 /*
@@ -102,6 +159,27 @@ struct _PyJITContext {
  */
 void _PyJITContext_ClearCache(_PyJITContext* ctx);
 
+/*
+ * Throw away the compiled code owning code_rt, which has had a speculation
+ * fail too often. Functions using it go back to PyEntry_LazyInit and get
+ * recompiled on their next call.
+ */
+void _PyJITContext_InvalidateCode(
+    _PyJITContext* ctx,
+    jit::CodeRuntime* code_rt);
+
+/*
+ * Free the machine code of compiled functions that can no longer run, and
+ * drop the references held by their CodeRuntimes. This covers orphaned code
+ * that is no longer on any thread's stack or used by a live generator, and
+ * code whose code object is only kept alive by the JIT (e.g. after its module
+ * was reloaded). Code compiled from Static Python is never freed.
+ *
+ * Must be called with the GIL held. Returns the number of compiled functions
+ * that were freed.
+ */
+int _PyJITContext_ReclaimCode(_PyJITContext* ctx);
+
 /*
  * Generate specialized functions for type object slots. Calls the other
  * _PyJITContext_Specialize* functions and handles setting up deoptimization
@@ -149,6 +227,20 @@ _PyJIT_Result _PyJITContext_CompilePreloader(
     _PyJITContext* ctx,
     const jit::hir::Preloader& preloader);
 
+/*
+ * JIT compile an OSR entry into the code object preloaded by preloader, at the
+ * loop header described by osr_entry, or look up one that was already
+ * compiled.
+ *
+ * Returns the compiled entry, or nullptr if it couldn't be compiled.
+ */
+jit::CompiledFunction* _PyJITContext_CompileOSREntry(
+    _PyJITContext* ctx,
+    BorrowedRef<PyCodeObject> code,
+    BorrowedRef<PyDictObject> globals,
+    const std::string& fullname,
+    const jit::hir::OSREntry& osr_entry);
+
 /*
  * Attach already-compiled code to the given function, if it exists.
  *
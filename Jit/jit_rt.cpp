@@ -14,6 +14,7 @@
 
 #include "Jit/codegen/gen_asm.h"
 #include "Jit/frame.h"
+#include "Jit/gen_data_allocator.h"
 #include "Jit/log.h"
 #include "Jit/pyjit.h"
 #include "Jit/ref.h"
@@ -637,6 +638,13 @@ PyThreadState* JITRT_AllocateAndLinkFrame(
   return tstate;
 }
 
+PyThreadState* JITRT_AdoptFrameForOSR() {
+  PyThreadState* tstate = PyThreadState_GET();
+  JIT_DCHECK(tstate->frame != nullptr, "OSR entry without a frame");
+  Py_INCREF(tstate->frame);
+  return tstate;
+}
+
 void JITRT_DecrefFrame(PyFrameObject* frame) {
   if (Py_REFCNT(frame) > 1) {
     // If the frame escaped it needs to be tracked
@@ -878,6 +886,18 @@ PyObject* JITRT_UnaryNot(PyObject* value) {
   return NULL;
 }
 
+PyObject* JITRT_DictSubscrUnicode(PyObject* dict, PyObject* key) {
+  PyObject* res = _PyDict_GetItem_Unicode(dict, key);
+  if (res == nullptr) {
+    if (!PyErr_Occurred()) {
+      _PyErr_SetKeyError(key);
+    }
+    return nullptr;
+  }
+  Py_INCREF(res);
+  return res;
+}
+
 PyObject* JITRT_ReadonlyUnaryOp(
     PyObject* a,
     unaryfunc operation_func,
@@ -1405,7 +1425,12 @@ void JITRT_SetU64_InArray(char* arr, uint64_t val, int64_t idx) {
 }
 
 void JITRT_SetObj_InArray(char* arr, uint64_t val, int64_t idx) {
-  ((PyObject**)arr)[idx] = (PyObject*)val;
+  // Like PyList_SetItem(), this steals the new value and releases the old
+  // one.
+  PyObject** item = &((PyObject**)arr)[idx];
+  PyObject* old = *item;
+  *item = (PyObject*)val;
+  Py_XDECREF(old);
 }
 
 template <typename T>
@@ -1540,48 +1565,13 @@ void JITRT_DoRaise(PyThreadState* tstate, PyObject* exc, PyObject* cause) {
   _Py_DoRaise(tstate, exc, cause);
 }
 
-// JIT generator data free-list globals
-const size_t kGenDataFreeListMaxSize = 1024;
-static size_t gen_data_free_list_size = 0;
-static void* gen_data_free_list_tail;
-
-static void* gen_data_allocate(size_t spill_words) {
-  if (spill_words > jit::kMinGenSpillWords || !gen_data_free_list_size) {
-    auto data =
-        malloc(spill_words * sizeof(uint64_t) + sizeof(jit::GenDataFooter));
-    auto footer = reinterpret_cast<jit::GenDataFooter*>(
-        reinterpret_cast<uint64_t*>(data) + spill_words);
-    footer->spillWords = spill_words;
-    return data;
-  }
-
-  // All free list entries are spill-word size 89, so we don't need to set
-  // footer->spillWords again, it should still be set to 89 from previous use.
-  JIT_DCHECK(spill_words == jit::kMinGenSpillWords, "invalid size");
-
-  gen_data_free_list_size--;
-  auto res = gen_data_free_list_tail;
-  gen_data_free_list_tail = *reinterpret_cast<void**>(gen_data_free_list_tail);
-  return res;
-}
-
 void JITRT_GenJitDataFree(PyGenObject* gen) {
   auto gen_data_footer =
       reinterpret_cast<jit::GenDataFooter*>(gen->gi_jit_data);
   auto gen_data = reinterpret_cast<uint64_t*>(gen_data_footer) -
       gen_data_footer->spillWords;
-
-  if (gen_data_footer->spillWords != jit::kMinGenSpillWords ||
-      gen_data_free_list_size == kGenDataFreeListMaxSize) {
-    free(gen_data);
-    return;
-  }
-
-  if (gen_data_free_list_size) {
-    *reinterpret_cast<void**>(gen_data) = gen_data_free_list_tail;
-  }
-  gen_data_free_list_size++;
-  gen_data_free_list_tail = gen_data;
+  gen_data_footer->code_rt->removeLiveGenerator();
+  jit::GenDataAllocator::release(gen_data, gen_data_footer->spillWords);
 }
 
 enum class MakeGenObjectMode {
@@ -1641,16 +1631,22 @@ static inline PyObject* make_gen_object(
       ? _PyShadowFrame_MakeData(code_rt, PYSF_CODE_RT, PYSF_JIT)
       : _PyShadowFrame_MakeData(gen->gi_frame, PYSF_PYFRAME, PYSF_JIT);
 
-  spill_words = std::max(spill_words, jit::kMinGenSpillWords);
-
-  auto suspend_data = gen_data_allocate(spill_words);
+  spill_words = jit::GenDataAllocator::roundUp(spill_words);
+  auto suspend_data = jit::GenDataAllocator::allocate(spill_words);
+  if (suspend_data == nullptr) {
+    Py_DECREF(gen);
+    PyErr_NoMemory();
+    return nullptr;
+  }
   auto footer = reinterpret_cast<jit::GenDataFooter*>(
       reinterpret_cast<uint64_t*>(suspend_data) + spill_words);
+  footer->spillWords = spill_words;
   footer->resumeEntry = resume_entry;
   footer->yieldPoint = nullptr;
   footer->state = _PyJitGenState_JustStarted;
   footer->gen = gen;
   footer->code_rt = code_rt;
+  code_rt->addLiveGenerator();
 
   gen->gi_jit_data = reinterpret_cast<_PyJIT_GenData*>(footer);
 
@@ -53,6 +53,16 @@ PyThreadState* JITRT_AllocateAndLinkFrame(
     PyCodeObject* code,
     PyObject* globals);
 
+/*
+ * Take a reference to the interpreter frame that is already linked as the
+ * current thread's top frame, for use by an OSR entry that continues executing
+ * it.
+ *
+ * The reference is released by JITRT_UnlinkFrame or deopt, just like a frame
+ * from JITRT_AllocateAndLinkFrame. Returns the current thread state.
+ */
+PyThreadState* JITRT_AdoptFrameForOSR();
+
 /*
  * Helper function to decref a frame.
  *
@@ -244,6 +254,14 @@ void JITRT_Dealloc(PyObject* obj);
  */
 PyObject* JITRT_UnaryNot(PyObject* value);
 
+/*
+ * Mimics the behavior of BINARY_SUBSCR on an exact dict with an exact str key.
+ *
+ * Returns a new reference to the value, or NULL with KeyError set if the key
+ * isn't present.
+ */
+PyObject* JITRT_DictSubscrUnicode(PyObject* dict, PyObject* key);
+
 /*
  * Wraps a readonly unary op with the correct checks.
  */
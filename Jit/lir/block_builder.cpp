@@ -63,13 +63,130 @@ BasicBlockBuilder::BasicBlockBuilder(jit::codegen::Environ* env, Function* func)
 
 void BasicBlockBuilder::AppendLabel(const std::string& s) {
   auto next_bb = GetBasicBlockByLabel(s);
-  if (cur_bb_->successors().size() < 2) {
+  if (cur_bb_->successors().size() < 2 && !cur_bb_branched_) {
     cur_bb_->addSuccessor(next_bb);
   }
   cur_bb_ = next_bb;
+  cur_bb_branched_ = false;
   bbs_.push_back(cur_bb_);
 }
 
+void BasicBlockBuilder::AppendBranch(const std::string& label) {
+  // Like HIR Branches, this doesn't need an instruction until after register
+  // allocation.
+  cur_bb_->addSuccessor(GetBasicBlockByLabel(label));
+  cur_bb_branched_ = true;
+}
+
+void BasicBlockBuilder::AppendJumpIf(
+    hir::Register* cond,
+    const std::string& true_label,
+    const std::string& false_label) {
+  AppendInstr(Instruction::kCondBranch)
+      .input(cond)
+      .successor(true_label)
+      .successor(false_label);
+}
+
+void BasicBlockBuilder::AppendJumpIf(
+    const std::string& cond,
+    const std::string& true_label,
+    const std::string& false_label) {
+  AppendInstr(Instruction::kCondBranch)
+      .input(cond)
+      .successor(true_label)
+      .successor(false_label);
+}
+
+void BasicBlockBuilder::AppendFlagBranch(
+    Instruction::Opcode opcode,
+    const std::string& label) {
+  AppendInstr(opcode).successor(label);
+}
+
+using InstrBuilder = BasicBlockBuilder::InstrBuilder;
+
+InstrBuilder& InstrBuilder::input(hir::Register* reg) {
+  auto type = reg->type();
+  if (type.hasIntSpec()) {
+    instr_->allocateImmediateInput(
+        static_cast<uint64_t>(type.intSpec()),
+        hirTypeToDataType(type.unspecialized()));
+  } else if (type.hasDoubleSpec()) {
+    instr_->allocateImmediateInput(
+        bit_cast<uint64_t>(type.doubleSpec()), Operand::kDouble);
+  } else {
+    bbb_.CreateInstrInput(instr_, reg->name());
+  }
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::input(const std::string& name) {
+  bbb_.CreateInstrInput(instr_, name);
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::imm(uint64_t value, Operand::DataType type) {
+  instr_->allocateImmediateInput(value, type);
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::memInput(const std::string& base, int offset) {
+  bbb_.CreateInstrIndirect(instr_, base, offset);
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::addrInput(const void* addr) {
+  instr_->allocateAddressInput(const_cast<void*>(addr));
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::phyInput(int loc, Operand::DataType type) {
+  instr_->allocatePhyRegisterInput(loc)->setDataType(type);
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::pred(const std::string& label) {
+  instr_->allocateLabelInput(bbb_.GetBasicBlockByLabel(label));
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::pred(const hir::BasicBlock* hir_block) {
+  // LIRGenerator::FixPhiNodes() replaces these with the translated blocks.
+  instr_->allocateLabelInput(reinterpret_cast<BasicBlock*>(
+      const_cast<hir::BasicBlock*>(hir_block)));
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::output(hir::Register* reg) {
+  bbb_.GenericCreateInstrOutput(instr_, reg);
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::output(
+    const std::string& name,
+    Operand::DataType type) {
+  bbb_.CreateInstrOutput(instr_, name, type);
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::memOutput(const std::string& base, int offset) {
+  bbb_.CreateInstrIndirectOutput(instr_, base, offset);
+  instr_->output()->setDataType(instr_->getInput(0)->dataType());
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::addrOutput(const void* addr) {
+  instr_->output()->setMemoryAddress(const_cast<void*>(addr));
+  instr_->output()->setDataType(instr_->getInput(0)->dataType());
+  return *this;
+}
+
+InstrBuilder& InstrBuilder::successor(const std::string& label) {
+  bbb_.cur_bb_->addSuccessor(bbb_.GetBasicBlockByLabel(label));
+  return *this;
+}
+
 std::vector<std::string> BasicBlockBuilder::Tokenize(std::string_view s) {
   std::vector<std::string> tokens;
 
@@ -537,8 +654,13 @@ void BasicBlockBuilder::AppendTokenizedCodeLine(
 
          JIT_CHECK((tokens.size() & 1) == 0, "Expected even number of tokens");
          for (size_t i = 2; i < tokens.size() - 1; i += 2) {
-           instr->allocateLabelInput(reinterpret_cast<BasicBlock*>(
-               std::stoull(tokens[i], nullptr, 0)));
+           // Predecessors are either HIR block addresses, which are fixed up
+           // once all blocks are translated, or labels.
+           BasicBlock* pred = bldr.IsConstant(tokens[i])
+               ? reinterpret_cast<BasicBlock*>(
+                     std::stoull(tokens[i], nullptr, 0))
+               : bldr.GetBasicBlockByLabel(tokens[i]);
+           instr->allocateLabelInput(pred);
            bldr.CreateInstrInputFromStr(instr, tokens[i + 1]);
          }
          bldr.CreateInstrOutputFromStr(instr, tokens[1]);
@@ -703,7 +825,20 @@ void BasicBlockBuilder::CreateInstrIndirectFromStr(
     Instruction* instr,
     const std::string& name_size,
     int offset) {
-  auto name = GetId(name_size);
+  CreateInstrIndirect(instr, GetId(name_size), offset);
+}
+
+void BasicBlockBuilder::CreateInstrIndirectOutputFromStr(
+    Instruction* instr,
+    const std::string& name_size,
+    int offset) {
+  CreateInstrIndirectOutput(instr, GetId(name_size), offset);
+}
+
+void BasicBlockBuilder::CreateInstrIndirect(
+    Instruction* instr,
+    const std::string& name,
+    int offset) {
   if (name == "__native_frame_base") {
     instr->allocateMemoryIndirectInput(PhyLocation::RBP, offset);
     return;
@@ -720,11 +855,10 @@ void BasicBlockBuilder::CreateInstrIndirectFromStr(
   }
 }
 
-void BasicBlockBuilder::CreateInstrIndirectOutputFromStr(
+void BasicBlockBuilder::CreateInstrIndirectOutput(
     Instruction* instr,
-    const std::string& name_size,
+    const std::string& name,
     int offset) {
-  auto name = GetId(name_size);
   if (name == "__native_frame_base") {
     instr->output()->setMemoryIndirect(PhyLocation::RBP, offset);
     return;
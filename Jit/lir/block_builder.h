@@ -29,6 +29,56 @@ namespace lir {
 
 class BasicBlockBuilder {
  public:
+  // Builds a single instruction in the current block from typed operands,
+  // without the format-then-parse round trip of AppendCode(). Operands are
+  // added in the same order the corresponding LIR text would list them.
+  class InstrBuilder {
+   public:
+    InstrBuilder(BasicBlockBuilder& bbb, Instruction* instr)
+        : bbb_(bbb), instr_(instr) {}
+
+    // Registers whose type carries a constant int or double value become
+    // immediates; all others are linked to the instruction defining them.
+    InstrBuilder& input(hir::Register* reg);
+    InstrBuilder& input(const std::string& name);
+    InstrBuilder& imm(
+        uint64_t value,
+        Operand::DataType type = Operand::kObject);
+    InstrBuilder& memInput(hir::Register* base, int offset) {
+      return memInput(base->name(), offset);
+    }
+    InstrBuilder& memInput(const std::string& base, int offset);
+    InstrBuilder& addrInput(const void* addr);
+    InstrBuilder& phyInput(int loc, Operand::DataType type = Operand::kObject);
+    // Phi predecessors; either a label or a HIR block that is fixed up once
+    // all blocks have been translated.
+    InstrBuilder& pred(const std::string& label);
+    InstrBuilder& pred(const hir::BasicBlock* hir_block);
+
+    InstrBuilder& output(hir::Register* reg);
+    InstrBuilder& output(
+        const std::string& name,
+        Operand::DataType type = Operand::kObject);
+    // Memory outputs take the data type of the first input, which must have
+    // been added already.
+    InstrBuilder& memOutput(hir::Register* base, int offset) {
+      return memOutput(base->name(), offset);
+    }
+    InstrBuilder& memOutput(const std::string& base, int offset);
+    InstrBuilder& addrOutput(const void* addr);
+
+    // Add an edge from the current block to the block for the given label.
+    InstrBuilder& successor(const std::string& label);
+
+    Instruction* instr() const {
+      return instr_;
+    }
+
+   private:
+    BasicBlockBuilder& bbb_;
+    Instruction* instr_;
+  };
+
   BasicBlockBuilder(jit::codegen::Environ* env, Function* func);
 
   void setCurrentInstr(const hir::Instr* inst) {
@@ -43,6 +93,10 @@ class BasicBlockBuilder {
   }
   void AppendLabel(const std::string& s);
 
+  // End the current block with an unconditional jump to the given label,
+  // rather than falling through to the next label appended.
+  void AppendBranch(const std::string& label);
+
   template <typename... T>
   void AppendCode(fmt::format_string<T...> s, T&&... args) {
     fmt::memory_buffer buf;
@@ -75,6 +129,23 @@ class BasicBlockBuilder {
     AppendCallInternal(nullptr, func, std::forward<AppendArgs>(args)...);
   }
 
+  InstrBuilder AppendInstr(Instruction::Opcode opcode) {
+    return InstrBuilder(*this, createInstr(opcode));
+  }
+
+  // Typed equivalents of "JumpIf cond, true_label, false_label".
+  void AppendJumpIf(
+      hir::Register* cond,
+      const std::string& true_label,
+      const std::string& false_label);
+  void AppendJumpIf(
+      const std::string& cond,
+      const std::string& true_label,
+      const std::string& false_label);
+  // Branch to label on the flags set by the previous instruction, e.g. with
+  // kBranchNZ or kBranchC.
+  void AppendFlagBranch(Instruction::Opcode opcode, const std::string& label);
+
   Instruction* createInstr(Instruction::Opcode opcode);
 
   Instruction* getDefInstr(const std::string& name);
@@ -94,6 +165,14 @@ class BasicBlockBuilder {
       Instruction* instr,
       const std::string& name_size);
 
+  void CreateInstrIndirect(
+      Instruction* instr,
+      const std::string& name,
+      int offset);
+  void CreateInstrIndirectOutput(
+      Instruction* instr,
+      const std::string& name,
+      int offset);
   void CreateInstrIndirectFromStr(
       Instruction* instr,
       const std::string& name_size,
@@ -108,9 +187,27 @@ class BasicBlockBuilder {
     return bbs_;
   }
 
+  static Operand::DataType hirTypeToDataType(hir::Type tp) {
+    if (tp <= hir::TCDouble) {
+      return Operand::DataType::kDouble;
+    } else if (tp <= (hir::TCInt8 | hir::TCUInt8 | hir::TCBool)) {
+      return Operand::DataType::k8bit;
+    } else if (tp <= (hir::TCInt16 | hir::TCUInt16)) {
+      return Operand::DataType::k16bit;
+    } else if (tp <= (hir::TCInt32 | hir::TCUInt32)) {
+      return Operand::DataType::k32bit;
+    } else if (tp <= (hir::TCInt64 | hir::TCUInt64)) {
+      return Operand::DataType::k64bit;
+    } else {
+      return Operand::DataType::kObject;
+    }
+  }
+
  private:
   const hir::Instr* cur_hir_instr_{nullptr};
   BasicBlock* cur_bb_;
+  // Set by AppendBranch() until the next label is appended.
+  bool cur_bb_branched_{false};
   std::vector<BasicBlock*> bbs_;
   jit::codegen::Environ* env_;
   Function* func_;
@@ -210,22 +307,6 @@ class BasicBlockBuilder {
         instr, std::forward<AppendArgs>(args)...);
   }
 
-  Operand::DataType hirTypeToDataType(hir::Type tp) {
-    if (tp <= hir::TCDouble) {
-      return Operand::DataType::kDouble;
-    } else if (tp <= (hir::TCInt8 | hir::TCUInt8 | hir::TCBool)) {
-      return Operand::DataType::k8bit;
-    } else if (tp <= (hir::TCInt16 | hir::TCUInt16)) {
-      return Operand::DataType::k16bit;
-    } else if (tp <= (hir::TCInt32 | hir::TCUInt32)) {
-      return Operand::DataType::k32bit;
-    } else if (tp <= (hir::TCInt64 | hir::TCUInt64)) {
-      return Operand::DataType::k64bit;
-    } else {
-      return Operand::DataType::kObject;
-    }
-  }
-
   template <typename T>
   void GenericCreateInstrInput(Instruction* instr, const T& val) {
     using CurArgType = std::remove_cv_t<std::remove_reference_t<T>>;
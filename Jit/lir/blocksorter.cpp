@@ -58,9 +58,28 @@ std::vector<BasicBlock*> BasicBlockSorter::getSortedBlocks() {
     }
   }
 
+  if (exit_ != nullptr) {
+    sinkColdBlocks(result);
+  }
+
   return result;
 }
 
+void BasicBlockSorter::sinkColdBlocks(std::vector<BasicBlock*>& blocks) const {
+  if (blocks.size() < 3) {
+    return;
+  }
+  // Keep the entry block first and the exit block last, and otherwise
+  // preserve the relative order of the blocks in each section. With its cold
+  // successor moved out of the way, a conditional branch can fall through to
+  // its hot one.
+  auto begin = blocks.begin() + 1;
+  auto end = blocks.back() == exit_ ? blocks.end() - 1 : blocks.end();
+  std::stable_partition(begin, end, [](const BasicBlock* block) {
+    return block->section() != codegen::CodeSection::kCold;
+  });
+}
+
 void BasicBlockSorter::calculateSCC() {
   scc_stack_.clear();
   scc_in_stack_.clear();
@@ -56,6 +56,10 @@ class BasicBlockSorter {
 
   void calcEntryBlocks();
   void sortRPO();
+
+  // Move the blocks in the cold section after all of the hot ones, so that
+  // the hot path is laid out contiguously.
+  void sinkColdBlocks(std::vector<BasicBlock*>& blocks) const;
 };
 
 } // namespace lir
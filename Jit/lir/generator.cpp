@@ -24,7 +24,6 @@
 #include <fmt/ostream.h>
 
 #include <functional>
-#include <sstream>
 
 // XXX: this file needs to be revisited when we optimize HIR-to-LIR translation
 // in codegen.cpp/h. Currently, this file is almost an identical copy from
@@ -169,6 +168,16 @@ void LIRGenerator::AnalyzeCopies() {
   }
 }
 
+// A profiled branch edge is cold if it was taken no more than once in
+// kColdBranchRatio times, out of at least kMinBranchSamples runs.
+constexpr int64_t kMinBranchSamples = 100;
+constexpr int64_t kColdBranchRatio = 100;
+
+static bool isColdEdge(int64_t edge_hits, int64_t other_hits) {
+  int64_t total = edge_hits + other_hits;
+  return total >= kMinBranchSamples && edge_hits * kColdBranchRatio <= total;
+}
+
 std::unique_ptr<jit::lir::Function> LIRGenerator::TranslateFunction() {
   env_->operand_to_fix.clear();
 
@@ -204,7 +213,9 @@ std::unique_ptr<jit::lir::Function> LIRGenerator::TranslateFunction() {
 
   exit_block_ = GenerateExitBlock();
 
-  // Connect all successors.
+  // Connect all successors, remembering the ones that profiling says are
+  // rarely taken.
+  UnorderedMap<BasicBlock*, BasicBlock*> cold_edges;
   entry_block_->addSuccessor(bb_map[hir_entry].first);
   for (auto hir_bb : translated) {
     auto hir_term = hir_bb->GetTerminator();
@@ -226,6 +237,15 @@ std::unique_ptr<jit::lir::Function> LIRGenerator::TranslateFunction() {
         last_bb->addSuccessor(target_lir_false_bb);
         last_bb->getLastInstr()->allocateLabelInput(target_lir_true_bb);
         last_bb->getLastInstr()->allocateLabelInput(target_lir_false_bb);
+        if (target_lir_true_bb == target_lir_false_bb) {
+          break;
+        }
+        if (isColdEdge(condbranch->trueHits(), condbranch->falseHits())) {
+          cold_edges.emplace(last_bb, target_lir_true_bb);
+        } else if (isColdEdge(
+                       condbranch->falseHits(), condbranch->trueHits())) {
+          cold_edges.emplace(last_bb, target_lir_false_bb);
+        }
         break;
       }
       case Opcode::kReturn: {
@@ -240,55 +260,88 @@ std::unique_ptr<jit::lir::Function> LIRGenerator::TranslateFunction() {
   FixPhiNodes(bb_map);
   FixOperands();
 
+  if (_PyJIT_MultipleCodeSectionsEnabled() && !cold_edges.empty()) {
+    MarkColdBlocks(cold_edges);
+  }
+
   return function;
 }
 
+void LIRGenerator::MarkColdBlocks(
+    const UnorderedMap<BasicBlock*, BasicBlock*>& cold_edges) {
+  // Find everything reachable from the entry block without following a cold
+  // edge or passing through a block that is already cold (e.g. a dealloc
+  // slow path).
+  UnorderedSet<BasicBlock*> hot{entry_block_, exit_block_};
+  std::vector<BasicBlock*> worklist{entry_block_};
+  while (!worklist.empty()) {
+    BasicBlock* block = worklist.back();
+    worklist.pop_back();
+    BasicBlock* cold_succ = map_get(cold_edges, block, nullptr);
+    for (BasicBlock* succ : block->successors()) {
+      if (succ == cold_succ || succ->section() == codegen::CodeSection::kCold) {
+        continue;
+      }
+      if (hot.insert(succ).second) {
+        worklist.push_back(succ);
+      }
+    }
+  }
+
+  for (BasicBlock* block : lir_func_->basicblocks()) {
+    if (!hot.count(block)) {
+      block->setSection(codegen::CodeSection::kCold);
+    }
+  }
+}
+
 void LIRGenerator::AppendGuard(
     BasicBlockBuilder& bbb,
-    std::string_view kind,
+    InstrGuardKind kind,
     const DeoptBase& instr,
-    std::string_view guard_var) {
+    const std::string& guard_var) {
   auto deopt_meta = jit::DeoptMetadata::fromInstr(instr, env_->code_rt);
   auto id = env_->rt->addDeoptMetadata(std::move(deopt_meta));
 
-  fmt::memory_buffer buf;
-  auto buf_ins = std::back_inserter(buf);
-  fmt::format_to(buf_ins, "Guard {}, {}", kind, id);
+  auto guard = bbb.AppendInstr(Instruction::kGuard);
+  guard.imm(kind, Operand::k64bit).imm(id);
 
   JIT_CHECK(
-      guard_var.empty() == (kind == "AlwaysFail"),
+      guard_var.empty() == (kind == kAlwaysFail),
       "MakeGuard expects a register name to guard iff the kind is not "
       "AlwaysFail");
-  if (!guard_var.empty()) {
-    buf.append(std::string_view(", "));
-    buf.append(guard_var);
+  if (guard_var.empty()) {
+    guard.imm(0);
+  } else if (guard_var == "reg:edx") {
+    guard.phyInput(PhyLocation::RDX, Operand::k32bit);
+  } else if (guard_var == "reg:xmm1") {
+    guard.phyInput(PhyLocation::XMM1, Operand::kDouble);
   } else {
-    buf.append(std::string_view(", 0"));
+    guard.input(guard_var);
   }
 
   if (instr.IsGuardIs()) {
-    const auto& guard = static_cast<const GuardIs&>(instr);
-    auto guard_ptr = static_cast<void*>(guard.target());
-    env_->code_rt->addReference(static_cast<PyObject*>(guard_ptr));
-    fmt::format_to(buf_ins, ", {}", guard_ptr);
+    const auto& guard_is = static_cast<const GuardIs&>(instr);
+    auto guard_ptr = guard_is.target();
+    env_->code_rt->addReference(guard_ptr);
+    guard.imm(reinterpret_cast<uint64_t>(guard_ptr));
   } else if (instr.IsGuardType()) {
-    const auto& guard = static_cast<const GuardType&>(instr);
+    const auto& guard_type_instr = static_cast<const GuardType&>(instr);
     // TODO(T101999851): Handle non-Exact types
-    JIT_CHECK(guard.target().isExact(), "Only exact type guards are supported");
-    PyTypeObject* guard_type = guard.target().uniquePyType();
+    JIT_CHECK(
+        guard_type_instr.target().isExact(),
+        "Only exact type guards are supported");
+    PyTypeObject* guard_type = guard_type_instr.target().uniquePyType();
     JIT_CHECK(guard_type != nullptr, "Ensure unique representation exists");
     env_->code_rt->addReference(reinterpret_cast<PyObject*>(guard_type));
-    fmt::format_to(buf_ins, ", {}", reinterpret_cast<void*>(guard_type));
+    guard.imm(reinterpret_cast<uint64_t>(guard_type));
   } else {
-    buf.append(std::string_view(", 0"));
+    guard.imm(0);
   }
 
-  auto& regstates = instr.live_regs();
-  for (const auto& reg_state : regstates) {
-    fmt::format_to(buf_ins, ", {}", reg_state.reg->name());
+  for (const auto& reg_state : instr.live_regs()) {
+    guard.input(reg_state.reg->name());
   }
-
-  bbb.AppendCode(buf);
 }
 
 // Attempt to emit a type-specialized call, returning true if successful.
@@ -357,19 +410,14 @@ bool LIRGenerator::TranslateSpecializedCall(
     return false;
   }
 
-  fmt::memory_buffer buf;
-  auto buf_ins = std::back_inserter(buf);
-  fmt::format_to(
-      buf_ins,
-      "Vectorcall {}, {}, 0, {}",
-      instr.dst()->name(),
-      reinterpret_cast<uint64_t>(func),
-      reinterpret_cast<uint64_t>(callee));
+  auto call = bbb.AppendInstr(Instruction::kVectorCall);
+  call.imm(reinterpret_cast<uint64_t>(func))
+      .imm(0)
+      .imm(reinterpret_cast<uint64_t>(callee));
   for (size_t i = 0, num_args = instr.numArgs(); i < num_args; i++) {
-    fmt::format_to(buf_ins, ", {}", instr.arg(i));
+    call.input(instr.arg(i));
   }
-  buf.append(std::string_view(", 0"));
-  bbb.AppendCode(buf);
+  call.imm(0).output(instr.dst()->name());
   return true;
 }
 
@@ -378,18 +426,18 @@ static void emitVectorCall(
     const VectorCallBase& instr,
     size_t flags,
     bool kwnames) {
-  std::stringstream ss;
-  ss << "Vectorcall " << *instr.dst() << ", "
-     << reinterpret_cast<uint64_t>(_PyObject_Vectorcall) << ", " << flags
-     << ", " << instr.func()->name();
+  auto call = bbb.AppendInstr(Instruction::kVectorCall);
+  call.imm(reinterpret_cast<uint64_t>(_PyObject_Vectorcall))
+      .imm(flags)
+      .input(instr.func()->name());
   auto nargs = instr.numArgs();
   for (size_t i = 0; i < nargs; i++) {
-    ss << ", " << *instr.arg(i);
+    call.input(instr.arg(i)->name());
   }
   if (!kwnames) {
-    ss << ", 0";
+    call.imm(0);
   }
-  bbb.AppendCode(ss.str());
+  call.output(instr.dst()->name());
 }
 
 void LIRGenerator::emitExceptionCheck(
@@ -397,9 +445,9 @@ void LIRGenerator::emitExceptionCheck(
     jit::lir::BasicBlockBuilder& bbb) {
   Register* out = i.GetOutput();
   if (out->isA(TBottom)) {
-    AppendGuard(bbb, "AlwaysFail", i);
+    AppendGuard(bbb, kAlwaysFail, i);
   } else {
-    std::string_view kind = out->isA(TCSigned) ? "NotNegative" : "NotZero";
+    InstrGuardKind kind = out->isA(TCSigned) ? kNotNegative : kNotZero;
     AppendGuard(bbb, kind, i, out->name());
   }
 }
@@ -414,38 +462,50 @@ void LIRGenerator::MakeIncref(
     // don't generate anything for immortal object
     return;
   }
+  bool maybe_immortal = obj->type().couldBe(TImmortalObject);
+#else
+  bool maybe_immortal = false;
 #endif
+  MakeIncref(bbb, obj->name(), xincref, maybe_immortal);
+}
 
+void LIRGenerator::MakeIncref(
+    BasicBlockBuilder& bbb,
+    const std::string& obj,
+    bool xincref,
+    [[maybe_unused]] bool maybe_immortal) {
   auto end_incref = GetSafeLabelName();
   if (xincref) {
     auto cont = GetSafeLabelName();
-    bbb.AppendCode("JumpIf {}, {}, {}", obj, cont, end_incref);
+    bbb.AppendJumpIf(obj, cont, end_incref);
     bbb.AppendLabel(cont);
   }
 
   auto r1 = GetSafeTempName();
-  bbb.AppendCode("Load {}, {}, {:#x}", r1, obj, offsetof(PyObject, ob_refcnt));
+  bbb.AppendInstr(Instruction::kMove)
+      .memInput(obj, offsetof(PyObject, ob_refcnt))
+      .output(r1);
 
 #ifdef Py_DEBUG
   auto r0 = GetSafeTempName();
-  bbb.AppendCode(
-      "Load {}, {:#x}", r0, reinterpret_cast<uint64_t>(&_Py_RefTotal));
-  bbb.AppendCode("Inc {}", r0);
-  bbb.AppendCode(
-      "Store {}, {:#x}", r0, reinterpret_cast<uint64_t>(&_Py_RefTotal));
+  bbb.AppendInstr(Instruction::kMove).addrInput(&_Py_RefTotal).output(r0);
+  bbb.AppendInstr(Instruction::kInc).input(r0);
+  bbb.AppendInstr(Instruction::kMove).input(r0).addrOutput(&_Py_RefTotal);
 #endif
 
 #ifdef Py_IMMORTAL_INSTANCES
-  if (obj->type().couldBe(TImmortalObject)) {
+  if (maybe_immortal) {
     auto mortal = GetSafeLabelName();
-    bbb.AppendCode("BitTest {}, {}", r1, kImmortalBitPos);
-    bbb.AppendCode("BranchC {}", end_incref);
+    bbb.AppendInstr(Instruction::kBitTest).input(r1).imm(kImmortalBitPos);
+    bbb.AppendFlagBranch(Instruction::kBranchC, end_incref);
     bbb.AppendLabel(mortal);
   }
 #endif
 
-  bbb.AppendCode("Inc {}", r1);
-  bbb.AppendCode("Store {}, {}, {:#x}", r1, obj, offsetof(PyObject, ob_refcnt));
+  bbb.AppendInstr(Instruction::kInc).input(r1);
+  bbb.AppendInstr(Instruction::kMove)
+      .input(r1)
+      .memOutput(obj, offsetof(PyObject, ob_refcnt));
   bbb.AppendLabel(end_incref);
 }
 
@@ -465,38 +525,40 @@ void LIRGenerator::MakeDecref(
   auto end_decref = GetSafeLabelName();
   if (xdecref) {
     auto cont = GetSafeLabelName();
-    bbb.AppendCode("JumpIf {}, {}, {}", obj, cont, end_decref);
+    bbb.AppendJumpIf(obj->name(), cont, end_decref);
     bbb.AppendLabel(cont);
   }
 
   auto r1 = GetSafeTempName();
   auto r2 = GetSafeTempName();
 
-  bbb.AppendCode("Load {}, {}, {:#x}", r1, obj, offsetof(PyObject, ob_refcnt));
+  bbb.AppendInstr(Instruction::kMove)
+      .memInput(obj, offsetof(PyObject, ob_refcnt))
+      .output(r1);
 
 #ifdef Py_DEBUG
   auto r0 = GetSafeTempName();
-  bbb.AppendCode(
-      "Load {}, {:#x}", r0, reinterpret_cast<uint64_t>(&_Py_RefTotal));
-  bbb.AppendCode("Dec {}", r0);
-  bbb.AppendCode(
-      "Store {}, {:#x}", r0, reinterpret_cast<uint64_t>(&_Py_RefTotal));
+  bbb.AppendInstr(Instruction::kMove).addrInput(&_Py_RefTotal).output(r0);
+  bbb.AppendInstr(Instruction::kDec).input(r0);
+  bbb.AppendInstr(Instruction::kMove).input(r0).addrOutput(&_Py_RefTotal);
 #endif
 
 #ifdef Py_IMMORTAL_INSTANCES
   if (obj->type().couldBe(TImmortalObject)) {
     auto mortal = GetSafeLabelName();
-    bbb.AppendCode("BitTest {}, {}", r1, kImmortalBitPos);
-    bbb.AppendCode("BranchC {}", end_decref);
+    bbb.AppendInstr(Instruction::kBitTest).input(r1).imm(kImmortalBitPos);
+    bbb.AppendFlagBranch(Instruction::kBranchC, end_decref);
     bbb.AppendLabel(mortal);
   }
 #endif
 
   auto dealloc = GetSafeLabelName();
-  bbb.AppendCode("Sub {}, {}, 1", r2, r1);
-  bbb.AppendCode("Store {}, {}, {:#x}", r2, obj, offsetof(PyObject, ob_refcnt));
+  bbb.AppendInstr(Instruction::kSub).input(r1).imm(1).output(r2);
+  bbb.AppendInstr(Instruction::kMove)
+      .input(r2)
+      .memOutput(obj, offsetof(PyObject, ob_refcnt));
 
-  bbb.AppendCode("BranchNZ {}", end_decref);
+  bbb.AppendFlagBranch(Instruction::kBranchNZ, end_decref);
   bbb.AppendLabel(dealloc);
   if (_PyJIT_MultipleCodeSectionsEnabled()) {
     bbb.SetBlockSection(dealloc, codegen::CodeSection::kCold);
@@ -506,6 +568,145 @@ void LIRGenerator::MakeDecref(
   bbb.AppendLabel(end_decref);
 }
 
+void LIRGenerator::TranslateLoadAttr(
+    BasicBlockBuilder& bbb,
+    const hir::LoadAttr& instr) {
+  PyCodeObject* code = instr.frameState()->code;
+  PyObject* name = PyTuple_GET_ITEM(code->co_names, instr.name_idx());
+  LoadAttrCache* cache = env_->code_rt->AllocateLoadAttrCache();
+  const AttributeInlineEntry& entry = cache->inlineEntry();
+  Register* obj = instr.GetOperand(0);
+
+  // Check the cache's inline entry first, so that loading a split-dict
+  // attribute or a slot from a type we've seen before doesn't need a call.
+  // Anything unexpected (wrong type, no dict, different keys, unset value)
+  // falls back to LoadAttrCache::invoke, which produces the right result or
+  // error.
+  auto hit = GetSafeLabelName();
+  auto slot = GetSafeLabelName();
+  auto split = GetSafeLabelName();
+  auto split_dict = GetSafeLabelName();
+  auto split_keys = GetSafeLabelName();
+  auto slow = GetSafeLabelName();
+  auto found = GetSafeLabelName();
+  auto found_end = GetSafeLabelName();
+  auto done = GetSafeLabelName();
+
+  auto type = GetSafeTempName();
+  auto cached_type = GetSafeTempName();
+  auto type_matches = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kMove)
+      .memInput(obj, offsetof(PyObject, ob_type))
+      .output(type);
+  bbb.AppendInstr(Instruction::kMove)
+      .addrInput(&entry.type)
+      .output(cached_type);
+  bbb.AppendInstr(Instruction::kEqual)
+      .input(type)
+      .input(cached_type)
+      .output(type_matches);
+  bbb.AppendJumpIf(type_matches, hit, slow);
+
+  bbb.AppendLabel(hit);
+  auto value_offset = GetSafeTempName();
+  auto keys = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kMove)
+      .addrInput(&entry.value_offset)
+      .output(value_offset);
+  bbb.AppendInstr(Instruction::kMove)
+      .addrInput(&entry.keys)
+      .output(keys);
+  bbb.AppendJumpIf(keys, split, slot);
+
+  bbb.AppendLabel(slot);
+  auto slot_addr = GetSafeTempName();
+  auto slot_value = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kAdd)
+      .input(obj)
+      .input(value_offset)
+      .output(slot_addr);
+  bbb.AppendInstr(Instruction::kMove).memInput(slot_addr, 0).output(slot_value);
+  bbb.AppendJumpIf(slot_value, found, slow);
+
+  bbb.AppendLabel(split);
+  auto dict_offset = GetSafeTempName();
+  auto dict_addr = GetSafeTempName();
+  auto dict = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kMove)
+      .addrInput(&entry.dict_offset)
+      .output(dict_offset);
+  bbb.AppendInstr(Instruction::kAdd)
+      .input(obj)
+      .input(dict_offset)
+      .output(dict_addr);
+  bbb.AppendInstr(Instruction::kMove).memInput(dict_addr, 0).output(dict);
+  bbb.AppendJumpIf(dict, split_dict, slow);
+
+  bbb.AppendLabel(split_dict);
+  auto dict_keys = GetSafeTempName();
+  auto keys_match = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kMove)
+      .memInput(dict, offsetof(PyDictObject, ma_keys))
+      .output(dict_keys);
+  bbb.AppendInstr(Instruction::kEqual)
+      .input(dict_keys)
+      .input(keys)
+      .output(keys_match);
+  bbb.AppendJumpIf(keys_match, split_keys, slow);
+
+  bbb.AppendLabel(split_keys);
+  auto values = GetSafeTempName();
+  auto value_addr = GetSafeTempName();
+  auto split_value = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kMove)
+      .memInput(dict, offsetof(PyDictObject, ma_values))
+      .output(values);
+  bbb.AppendInstr(Instruction::kAdd)
+      .input(values)
+      .input(value_offset)
+      .output(value_addr);
+  bbb.AppendInstr(Instruction::kMove)
+      .memInput(value_addr, 0)
+      .output(split_value);
+  bbb.AppendJumpIf(split_value, found, slow);
+
+  bbb.AppendLabel(slow);
+  if (_PyJIT_MultipleCodeSectionsEnabled()) {
+    bbb.SetBlockSection(slow, codegen::CodeSection::kCold);
+  }
+  auto name_reg = GetSafeTempName();
+  auto slow_value = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kMove)
+      .imm(reinterpret_cast<uint64_t>(name))
+      .output(name_reg);
+  bbb.AppendInstr(Instruction::kCall)
+      .imm(reinterpret_cast<uint64_t>(LoadAttrCache::invoke))
+      .imm(reinterpret_cast<uint64_t>(cache))
+      .input(obj)
+      .input(name_reg)
+      .output(slow_value);
+  bbb.AppendBranch(done);
+
+  bbb.AppendLabel(found);
+  auto found_value = GetSafeTempName();
+  bbb.AppendInstr(Instruction::kPhi)
+      .pred(slot)
+      .input(slot_value)
+      .pred(split_keys)
+      .input(split_value)
+      .output(found_value);
+  MakeIncref(bbb, found_value, false, true);
+  bbb.AppendLabel(found_end);
+
+  bbb.AppendLabel(done);
+  bbb.AppendInstr(Instruction::kPhi)
+      .pred(found_end)
+      .input(found_value)
+      .pred(slow)
+      .input(slow_value)
+      .output(instr.dst());
+}
+
 // Checks if a type has reasonable == semantics, that is that
 // object identity implies equality when compared by Python.  This
 // is true for most types, but not true for floats where nan is
@@ -520,24 +721,22 @@ bool isTypeWithReasonablePointerEq(Type t) {
 }
 
 namespace {
-void appendYieldLiveRegs(std::stringstream& ss, const DeoptBase* instr) {
+void appendYieldLiveRegs(
+    BasicBlockBuilder::InstrBuilder& yield,
+    const DeoptBase* instr) {
   int num_live_owned_regs = 0;
-  std::stringstream live_owned_regs;
   for (const RegState& rs : instr->live_regs()) {
-    switch (rs.ref_kind) {
-      case RefKind::kBorrowed:
-      case RefKind::kUncounted: {
-        ss << ", " << rs.reg->name();
-        break;
-      }
-      case RefKind::kOwned: {
-        live_owned_regs << ", " << rs.reg->name();
-        num_live_owned_regs++;
-        break;
-      }
+    if (rs.ref_kind != RefKind::kOwned) {
+      yield.input(rs.reg->name());
+    }
+  }
+  for (const RegState& rs : instr->live_regs()) {
+    if (rs.ref_kind == RefKind::kOwned) {
+      yield.input(rs.reg->name());
+      num_live_owned_regs++;
     }
   }
-  ss << live_owned_regs.str() << ", " << num_live_owned_regs;
+  yield.imm(num_live_owned_regs);
 }
 } // namespace
 
@@ -589,7 +788,7 @@ static void emitSubclassCheck(
     JIT_CHECK(false, "unsupported subclass check in CondBranchCheckType");
   }
 #undef GET_FPTR
-  bbb.AppendCode("Call {}, {:#x}, {}", dst, fptr, obj);
+  bbb.AppendInstr(Instruction::kCall).imm(fptr).input(obj).output(dst);
 }
 
 #undef FOREACH_FAST_BUILTIN
@@ -617,17 +816,20 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             "Inconsistent number of args");
         PhyLocation phy_loc = env_->arg_locations[instr->arg_idx()];
         if (phy_loc.is_memory()) {
-          bbb.AppendCode(
-              "Load {}, __asm_extra_args, {}",
-              instr->dst(),
-              -(phy_loc + 1) * kPointerSize);
+          bbb.AppendInstr(Instruction::kMove)
+              .memInput("__asm_extra_args", -(phy_loc + 1) * kPointerSize)
+              .output(instr->dst());
         } else {
-          bbb.AppendCode("LoadArg {} {}", instr->dst(), instr->arg_idx());
+          bbb.AppendInstr(Instruction::kLoadArg)
+              .imm(instr->arg_idx())
+              .output(instr->dst());
         }
         break;
       }
       case Opcode::kLoadCurrentFunc: {
-        bbb.AppendCode("Move {}, __asm_func", i.GetOutput());
+        bbb.AppendInstr(Instruction::kMove)
+            .input("__asm_func")
+            .output(i.GetOutput());
         break;
       }
       case Opcode::kMakeCell: {
@@ -637,20 +839,16 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       }
       case Opcode::kStealCellItem:
       case Opcode::kLoadCellItem: {
-        bbb.AppendCode(
-            "Load {}, {}, {}",
-            i.GetOutput(),
-            i.GetOperand(0),
-            offsetof(PyCellObject, ob_ref));
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(i.GetOperand(0), offsetof(PyCellObject, ob_ref))
+            .output(i.GetOutput());
         break;
       }
       case Opcode::kSetCellItem: {
         auto instr = static_cast<const SetCellItem*>(&i);
-        bbb.AppendCode(
-            "Store {}, {}, {}",
-            instr->GetOperand(1),
-            instr->GetOperand(0),
-            offsetof(PyCellObject, ob_ref));
+        bbb.AppendInstr(Instruction::kMove)
+            .input(instr->GetOperand(1))
+            .memOutput(instr->GetOperand(0), offsetof(PyCellObject, ob_ref));
         break;
       }
       case Opcode::kLoadConst: {
@@ -661,29 +859,32 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           double_t spec_value = ty.doubleSpec();
           auto v = bit_cast<uint64_t>(spec_value);
           // This loads the bits of the double into memory
-          bbb.AppendCode("Move {}:{}, {:#x}", tmp_name, TCUInt64, v);
+          bbb.AppendInstr(Instruction::kMove)
+              .imm(v)
+              .output(tmp_name, Operand::k64bit);
           // This moves the value into a floating point register
-          bbb.AppendCode(
-              "Move {}:{}, {}",
-              instr->dst()->name(),
-              ty.unspecialized(),
-              tmp_name);
+          bbb.AppendInstr(Instruction::kMove)
+              .input(tmp_name)
+              .output(
+                  instr->dst()->name(),
+                  bbb.hirTypeToDataType(ty.unspecialized()));
         } else {
           intptr_t spec_value = ty.hasIntSpec()
               ? ty.intSpec()
               : reinterpret_cast<intptr_t>(ty.asObject());
-          bbb.AppendCode(
-              "Move {}:{}, {:#x}",
-              instr->dst()->name(),
-              ty.unspecialized(),
-              spec_value);
+          bbb.AppendInstr(Instruction::kMove)
+              .imm(spec_value)
+              .output(
+                  instr->dst()->name(),
+                  bbb.hirTypeToDataType(ty.unspecialized()));
         }
         break;
       }
       case Opcode::kLoadVarObjectSize: {
         const size_t kSizeOffset = offsetof(PyVarObject, ob_size);
-        bbb.AppendCode(
-            "Load {}, {}, {}", i.GetOutput(), i.GetOperand(0), kSizeOffset);
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(i.GetOperand(0), kSizeOffset)
+            .output(i.GetOutput());
         break;
       }
       case Opcode::kLoadFunctionIndirect: {
@@ -699,46 +900,50 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kIntConvert: {
         auto instr = static_cast<const IntConvert*>(&i);
         if (instr->type() <= TCUnsigned) {
-          bbb.AppendCode("ConvertUnsigned {}, {}", instr->dst(), instr->src());
+          bbb.AppendInstr(Instruction::kZext)
+              .input(instr->src())
+              .output(instr->dst());
         } else {
           JIT_CHECK(
               instr->type() <= TCSigned,
               "Unexpected IntConvert type %s",
               instr->type());
-          bbb.AppendCode("Convert {}, {}", instr->dst(), instr->src());
+          bbb.AppendInstr(Instruction::kSext)
+              .input(instr->src())
+              .output(instr->dst());
         }
         break;
       }
       case Opcode::kIntBinaryOp: {
         auto instr = static_cast<const IntBinaryOp*>(&i);
-        std::string op;
-        std::string convert;
-        std::string extra_arg = "";
+        Instruction::Opcode op = Instruction::kNop;
+        Instruction::Opcode convert = Instruction::kNop;
+        bool extra_arg = false;
         uint64_t helper = 0;
         switch (instr->op()) {
           case BinaryOpKind::kAdd:
-            op = "Add";
+            op = Instruction::kAdd;
             break;
           case BinaryOpKind::kAnd:
-            op = "And";
+            op = Instruction::kAnd;
             break;
           case BinaryOpKind::kSubtract:
-            op = "Sub";
+            op = Instruction::kSub;
             break;
           case BinaryOpKind::kXor:
-            op = "Xor";
+            op = Instruction::kXor;
             break;
           case BinaryOpKind::kOr:
-            op = "Or";
+            op = Instruction::kOr;
             break;
           case BinaryOpKind::kMultiply:
-            op = "Mul";
+            op = Instruction::kMul;
             break;
           case BinaryOpKind::kLShift:
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "Convert";
+                convert = Instruction::kSext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_ShiftLeft32);
                 break;
@@ -751,7 +956,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "Convert";
+                convert = Instruction::kSext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_ShiftRight32);
                 break;
@@ -764,7 +969,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "ConvertUnsigned";
+                convert = Instruction::kZext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_ShiftRightUnsigned32);
                 break;
@@ -774,18 +979,18 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             }
             break;
           case BinaryOpKind::kFloorDivide:
-            op = "Div";
-            extra_arg = "0, ";
+            op = Instruction::kDiv;
+            extra_arg = true;
             break;
           case BinaryOpKind::kFloorDivideUnsigned:
-            op = "DivUn";
-            extra_arg = "0, ";
+            op = Instruction::kDivUn;
+            extra_arg = true;
             break;
           case BinaryOpKind::kModulo:
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "Convert";
+                convert = Instruction::kSext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_Mod32);
                 break;
@@ -798,7 +1003,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "ConvertUnsigned";
+                convert = Instruction::kZext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_ModUnsigned32);
                 break;
@@ -811,7 +1016,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "Convert";
+                convert = Instruction::kSext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_Power32);
                 break;
@@ -824,7 +1029,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             switch (bytes_from_cint_type(instr->GetOperand(0)->type())) {
               case 1:
               case 2:
-                convert = "ConvertUnsigned";
+                convert = Instruction::kZext;
               case 3:
                 helper = reinterpret_cast<uint64_t>(JITRT_PowerUnsigned32);
                 break;
@@ -840,25 +1045,25 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         if (helper != 0) {
           std::string left = instr->left()->name();
           std::string right = instr->right()->name();
-          if (convert != "") {
+          if (convert != Instruction::kNop) {
             std::string ltmp = GetSafeTempName();
             std::string rtmp = GetSafeTempName();
-            std::string type = convert == "Convert" ? "CInt32" : "CUInt32";
-            bbb.AppendCode("{} {}:{}, {}", convert, ltmp, type, left);
-            bbb.AppendCode("{} {}:{}, {}", convert, rtmp, type, right);
+            bbb.AppendInstr(convert).input(left).output(ltmp, Operand::k32bit);
+            bbb.AppendInstr(convert).input(right).output(rtmp, Operand::k32bit);
             left = ltmp;
             right = rtmp;
           }
-          bbb.AppendCode(
-              "Call {} {:#x}, {}, {}", instr->dst(), helper, left, right);
+          bbb.AppendInstr(Instruction::kCall)
+              .imm(helper)
+              .input(left)
+              .input(right)
+              .output(instr->dst());
         } else {
-          bbb.AppendCode(
-              "{} {}, {} {}, {}",
-              op,
-              instr->dst(),
-              extra_arg,
-              instr->left(),
-              instr->right());
+          auto binop = bbb.AppendInstr(op);
+          if (extra_arg) {
+            binop.imm(0);
+          }
+          binop.input(instr->left()).input(instr->right()).output(instr->dst());
         }
 
         break;
@@ -872,22 +1077,22 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           break;
         }
 
-        std::string op;
+        Instruction::Opcode op = Instruction::kNop;
         switch (instr->op()) {
           case BinaryOpKind::kAdd: {
-            op = "Fadd";
+            op = Instruction::kFadd;
             break;
           }
           case BinaryOpKind::kSubtract: {
-            op = "Fsub";
+            op = Instruction::kFsub;
             break;
           }
           case BinaryOpKind::kMultiply: {
-            op = "Fmul";
+            op = Instruction::kFmul;
             break;
           }
           case BinaryOpKind::kTrueDivide: {
-            op = "Fdiv";
+            op = Instruction::kFdiv;
             break;
           }
           default: {
@@ -896,54 +1101,47 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           }
         }
 
-        // Our formatter for Registers tries to be clever with constant values,
-        // and this backfires in certain situations (it converts registers to
-        // immediates). We have to manually format the name and type here to
-        // work around that.
-        auto codestr = fmt::format(
-            "{} {}, {}:{}, {}:{}",
-            op,
-            instr->dst(),
-            instr->left()->name(),
-            instr->left()->type().unspecialized(),
-            instr->right()->name(),
-            instr->right()->type().unspecialized());
-        bbb.AppendCode(codestr);
+        // Pass the operands by name, since there is no way to use an
+        // immediate double as an operand.
+        bbb.AppendInstr(op)
+            .input(instr->left()->name())
+            .input(instr->right()->name())
+            .output(instr->dst());
         break;
       }
       case Opcode::kPrimitiveCompare: {
         auto instr = static_cast<const PrimitiveCompare*>(&i);
-        std::string op;
+        Instruction::Opcode op = Instruction::kNop;
         switch (instr->op()) {
           case PrimitiveCompareOp::kEqual:
-            op = "Equal";
+            op = Instruction::kEqual;
             break;
           case PrimitiveCompareOp::kNotEqual:
-            op = "NotEqual";
+            op = Instruction::kNotEqual;
             break;
           case PrimitiveCompareOp::kGreaterThanUnsigned:
-            op = "GreaterThanUnsigned";
+            op = Instruction::kGreaterThanUnsigned;
             break;
           case PrimitiveCompareOp::kGreaterThan:
-            op = "GreaterThanSigned";
+            op = Instruction::kGreaterThanSigned;
             break;
           case PrimitiveCompareOp::kLessThanUnsigned:
-            op = "LessThanUnsigned";
+            op = Instruction::kLessThanUnsigned;
             break;
           case PrimitiveCompareOp::kLessThan:
-            op = "LessThanSigned";
+            op = Instruction::kLessThanSigned;
             break;
           case PrimitiveCompareOp::kGreaterThanEqualUnsigned:
-            op = "GreaterThanEqualUnsigned";
+            op = Instruction::kGreaterThanEqualUnsigned;
             break;
           case PrimitiveCompareOp::kGreaterThanEqual:
-            op = "GreaterThanEqualSigned";
+            op = Instruction::kGreaterThanEqualSigned;
             break;
           case PrimitiveCompareOp::kLessThanEqualUnsigned:
-            op = "LessThanEqualUnsigned";
+            op = Instruction::kLessThanEqualUnsigned;
             break;
           case PrimitiveCompareOp::kLessThanEqual:
-            op = "LessThanEqualSigned";
+            op = Instruction::kLessThanEqualSigned;
             break;
           default:
             JIT_CHECK(false, "not implemented %d", (int)instr->op());
@@ -952,21 +1150,18 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
 
         if (instr->left()->type() <= TCDouble ||
             instr->right()->type() <= TCDouble) {
-          // Manually format the code string, otherwise registers with literal
-          // values end up being treated as immediates, and there's no way to
-          // load immediates in an XMM register.
-          auto codestr = fmt::format(
-              "{} {}, {}:{}, {}:{}",
-              op,
-              instr->dst(),
-              instr->left()->name(),
-              instr->left()->type().unspecialized(),
-              instr->right()->name(),
-              instr->right()->type().unspecialized());
-          bbb.AppendCode(codestr);
+          // Pass the operands by name, otherwise registers with literal values
+          // end up being treated as immediates, and there's no way to load
+          // immediates in an XMM register.
+          bbb.AppendInstr(op)
+              .input(instr->left()->name())
+              .input(instr->right()->name())
+              .output(instr->dst());
         } else {
-          bbb.AppendCode(
-              "{} {} {} {}", op, instr->dst(), instr->left(), instr->right());
+          bbb.AppendInstr(op)
+              .input(instr->left())
+              .input(instr->right())
+              .output(instr->dst());
         }
         break;
       }
@@ -982,13 +1177,13 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           JIT_DCHECK(
               src_type <= TCInt64,
               "unboxed enums are represented as int64 in the JIT");
-          bbb.AppendCode(
-              "Call {}, {:#x}, {}:{}, {:#x}:CUInt64",
-              instr->GetOutput(),
-              reinterpret_cast<uint64_t>(JITRT_BoxEnum),
-              src,
-              src_type,
-              reinterpret_cast<uint64_t>(box_type.typeSpec()));
+          bbb.AppendInstr(Instruction::kCall)
+              .imm(reinterpret_cast<uint64_t>(JITRT_BoxEnum))
+              .input(src)
+              .imm(
+                  reinterpret_cast<uint64_t>(box_type.typeSpec()),
+                  Operand::k64bit)
+              .output(instr->GetOutput());
           break;
         }
 
@@ -1008,14 +1203,17 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         } else if (src_type <= TCDouble) {
           func = reinterpret_cast<uint64_t>(JITRT_BoxDouble);
         } else if (src_type <= (TCBool | TCUInt8 | TCUInt16)) {
-          bbb.AppendCode(
-              "ConvertUnsigned {}:CUInt32, {}:{}", tmp, src, src_type);
+          bbb.AppendInstr(Instruction::kZext)
+              .input(src)
+              .output(tmp, Operand::k32bit);
           src = tmp;
           func = reinterpret_cast<uint64_t>(
               (src_type <= TCBool) ? JITRT_BoxBool : JITRT_BoxU32);
           src_type = TCUInt32;
         } else if (src_type <= (TCInt8 | TCInt16)) {
-          bbb.AppendCode("Convert {}:CInt32, {}:{}", tmp, src, src_type);
+          bbb.AppendInstr(Instruction::kSext)
+              .input(src)
+              .output(tmp, Operand::k32bit);
           src = tmp;
           src_type = TCInt32;
           func = reinterpret_cast<uint64_t>(JITRT_BoxI32);
@@ -1024,8 +1222,10 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         JIT_CHECK(
             func != 0, "unknown box type %s", src_type.toString().c_str());
 
-        bbb.AppendCode(
-            "Call {}, {:#x}, {}:{}", instr->GetOutput(), func, src, src_type);
+        bbb.AppendInstr(Instruction::kCall)
+            .imm(func)
+            .input(src)
+            .output(instr->GetOutput());
 
         break;
       }
@@ -1042,45 +1242,44 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         // signed -1 in the unsigned value, we can likewise just treat unsigned
         // as signed for purposes of checking for -1 here.
         if (src_type <= (TCInt64 | TCUInt64)) {
-          bbb.AppendCode(
-              "NotEqual {}, {}:{}, {:#x}",
-              is_not_negative,
-              src_name,
-              TCInt64,
-              static_cast<uint64_t>(-1));
+          bbb.AppendInstr(Instruction::kNotEqual)
+              .input(src_name)
+              .imm(static_cast<uint64_t>(-1))
+              .output(is_not_negative);
         } else {
           // We do have to widen to at least 32 bits due to calling convention
           // always passing a minimum of 32 bits.
           if (src_type <= (TCBool | TCInt8 | TCUInt8 | TCInt16 | TCUInt16)) {
             std::string tmp_name = GetSafeTempName();
-            bbb.AppendCode(
-                "Convert {}:CInt32, {}:{}", tmp_name, src_name, src_type);
+            bbb.AppendInstr(Instruction::kSext)
+                .input(src_name)
+                .output(tmp_name, Operand::k32bit);
             src_name = tmp_name;
           }
-          bbb.AppendCode(
-              "NotEqual {}, {}:{}, {:#x}",
-              is_not_negative,
-              src_name,
-              TCInt32,
-              static_cast<uint32_t>(-1));
-        }
-        bbb.AppendCode("Move {}, {:#x}", instr->dst(), 0);
+          bbb.AppendInstr(Instruction::kNotEqual)
+              .input(src_name)
+              .imm(static_cast<uint32_t>(-1))
+              .output(is_not_negative);
+        }
+        bbb.AppendInstr(Instruction::kMove).imm(0).output(instr->dst());
         auto done = GetSafeLabelName();
         auto check_err = GetSafeLabelName();
-        bbb.AppendCode("JumpIf {}, {}, {}", is_not_negative, done, check_err);
+        bbb.AppendJumpIf(is_not_negative, done, check_err);
         bbb.AppendLabel(check_err);
         auto curexc_type = GetSafeTempName();
-        bbb.AppendCode(
-            "Load {}, __asm_tstate, {}",
-            curexc_type,
-            offsetof(PyThreadState, curexc_type));
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput("__asm_tstate", offsetof(PyThreadState, curexc_type))
+            .output(curexc_type);
         auto is_no_err_set = GetSafeTempName();
-        bbb.AppendCode("Equal {}, {}, {:#x}", is_no_err_set, curexc_type, 0);
+        bbb.AppendInstr(Instruction::kEqual)
+            .input(curexc_type)
+            .imm(0)
+            .output(is_no_err_set);
         auto set_err = GetSafeLabelName();
-        bbb.AppendCode("JumpIf {}, {}, {}", is_no_err_set, done, set_err);
+        bbb.AppendJumpIf(is_no_err_set, done, set_err);
         bbb.AppendLabel(set_err);
         // Set to -1 in the error case
-        bbb.AppendCode("Dec {}", instr->dst());
+        bbb.AppendInstr(Instruction::kDec).input(instr->dst()->name());
         bbb.AppendLabel(done);
         break;
       }
@@ -1090,15 +1289,15 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         Type ty = instr->type();
         if (ty <= TCBool) {
           uint64_t true_addr = reinterpret_cast<uint64_t>(Py_True);
-          bbb.AppendCode(
-              "Equal {} {} {:#x}", instr->dst(), instr->value(), true_addr);
+          bbb.AppendInstr(Instruction::kEqual)
+              .input(instr->value())
+              .imm(true_addr)
+              .output(instr->dst());
         } else if (ty <= TCDouble) {
           // For doubles, we can directly load the offset into the destination.
-          bbb.AppendCode(
-              "Load {}, {}, {}",
-              instr->dst(),
-              instr->value(),
-              offsetof(PyFloatObject, ob_fval));
+          bbb.AppendInstr(Instruction::kMove)
+              .memInput(instr->value(), offsetof(PyFloatObject, ob_fval))
+              .output(instr->dst());
         } else if (ty <= TCUInt64) {
           bbb.AppendCall(instr->dst(), JITRT_UnboxU64, instr->value());
         } else if (ty <= TCUInt32) {
@@ -1126,14 +1325,20 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         auto instr = static_cast<const PrimitiveUnaryOp*>(&i);
         switch (instr->op()) {
           case PrimitiveUnaryOpKind::kNegateInt:
-            bbb.AppendCode("Negate {}, {}", instr->GetOutput(), instr->value());
+            bbb.AppendInstr(Instruction::kNegate)
+                .input(instr->value())
+                .output(instr->GetOutput());
             break;
           case PrimitiveUnaryOpKind::kInvertInt:
-            bbb.AppendCode("Invert {}, {}", instr->GetOutput(), instr->value());
+            bbb.AppendInstr(Instruction::kInvert)
+                .input(instr->value())
+                .output(instr->GetOutput());
             break;
           case PrimitiveUnaryOpKind::kNotInt:
-            bbb.AppendCode(
-                "Equal {}, {}, 0", instr->GetOutput(), instr->value());
+            bbb.AppendInstr(Instruction::kEqual)
+                .input(instr->value())
+                .imm(0)
+                .output(instr->GetOutput());
             break;
           default:
             JIT_CHECK(false, "not implemented unary op %d", (int)instr->op());
@@ -1144,8 +1349,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kReturn: {
         // TODO support constant operand to Return
         Register* reg = i.GetOperand(0);
-        bbb.AppendCode(
-            "Return {}:{}", reg->name(), reg->type().unspecialized());
+        bbb.AppendInstr(Instruction::kReturn).input(reg->name());
         break;
       }
       case Opcode::kSetCurrentAwaiter: {
@@ -1155,41 +1359,44 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       }
       case Opcode::kYieldValue: {
         auto instr = static_cast<const YieldValue*>(&i);
-        std::stringstream ss;
-        ss << "YieldValue " << instr->dst()->name() << ", __asm_tstate,"
-           << instr->reg()->name();
-        appendYieldLiveRegs(ss, instr);
-        bbb.AppendCode(ss.str());
+        auto yield = bbb.AppendInstr(Instruction::kYieldValue);
+        yield.output(instr->dst()->name())
+            .input("__asm_tstate")
+            .input(instr->reg()->name());
+        appendYieldLiveRegs(yield, instr);
         break;
       }
       case Opcode::kInitialYield: {
         auto instr = static_cast<const InitialYield*>(&i);
-        std::stringstream ss;
-        ss << "YieldInitial " << instr->dst()->name() << ", __asm_tstate, ";
-        appendYieldLiveRegs(ss, instr);
-        bbb.AppendCode(ss.str());
+        auto yield = bbb.AppendInstr(Instruction::kYieldInitial);
+        yield.output(instr->dst()->name()).input("__asm_tstate");
+        appendYieldLiveRegs(yield, instr);
         break;
       }
       case Opcode::kYieldAndYieldFrom:
       case Opcode::kYieldFrom:
       case Opcode::kYieldFromHandleStopAsyncIteration: {
-        std::stringstream ss;
+        Instruction::Opcode yield_op;
         if (opcode == Opcode::kYieldAndYieldFrom) {
-          ss << "YieldFromSkipInitialSend ";
+          yield_op = Instruction::kYieldFromSkipInitialSend;
         } else if (opcode == Opcode::kYieldFrom) {
-          ss << "YieldFrom ";
+          yield_op = Instruction::kYieldFrom;
         } else {
-          ss << "YieldFromHandleStopAsyncIteration ";
+          yield_op = Instruction::kYieldFromHandleStopAsyncIteration;
         }
-        ss << i.GetOutput()->name() << ", __asm_tstate, "
-           << i.GetOperand(0)->name() << ", " << i.GetOperand(1)->name();
-        appendYieldLiveRegs(ss, static_cast<const DeoptBase*>(&i));
-        bbb.AppendCode(ss.str());
+        auto yield = bbb.AppendInstr(yield_op);
+        yield.output(i.GetOutput()->name())
+            .input("__asm_tstate")
+            .input(i.GetOperand(0)->name())
+            .input(i.GetOperand(1)->name());
+        appendYieldLiveRegs(yield, static_cast<const DeoptBase*>(&i));
         break;
       }
       case Opcode::kAssign: {
         auto instr = static_cast<const Assign*>(&i);
-        bbb.AppendCode("Assign {}, {}", instr->dst(), instr->reg());
+        bbb.AppendInstr(Instruction::kMove)
+            .input(instr->reg())
+            .output(instr->dst());
         break;
       }
       case Opcode::kCondBranch:
@@ -1203,14 +1410,13 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           tmp = GetSafeTempName();
           auto iter_done_addr =
               reinterpret_cast<uint64_t>(&jit::g_iterDoneSentinel);
-          bbb.AppendCode("Sub {}, {}, {}", tmp, cond, iter_done_addr);
+          bbb.AppendInstr(Instruction::kSub)
+              .input(cond)
+              .imm(iter_done_addr)
+              .output(tmp);
         }
 
-        bbb.AppendCode(
-            "CondBranch {}, {}, {}",
-            tmp,
-            instr->true_bb()->id,
-            instr->false_bb()->id);
+        bbb.AppendInstr(Instruction::kCondBranch).input(tmp);
         break;
       }
       case Opcode::kCondBranchCheckType: {
@@ -1219,24 +1425,17 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         auto eq_res_var = GetSafeTempName();
         if (type.isExact()) {
           auto type_var = GetSafeTempName();
-          bbb.AppendCode(
-              "Load {}, {}, {}",
-              type_var,
-              instr.reg(),
-              offsetof(PyObject, ob_type));
-          bbb.AppendCode(
-              "Equal {}, {}, {:#x}",
-              eq_res_var,
-              type_var,
-              reinterpret_cast<uint64_t>(instr.type().uniquePyType()));
+          bbb.AppendInstr(Instruction::kMove)
+              .memInput(instr.reg(), offsetof(PyObject, ob_type))
+              .output(type_var);
+          bbb.AppendInstr(Instruction::kEqual)
+              .input(type_var)
+              .imm(reinterpret_cast<uint64_t>(instr.type().uniquePyType()))
+              .output(eq_res_var);
         } else {
           emitSubclassCheck(bbb, eq_res_var, instr.GetOperand(0), type);
         }
-        bbb.AppendCode(
-            "CondBranch {}, {}, {}",
-            eq_res_var,
-            instr.true_bb()->id,
-            instr.false_bb()->id);
+        bbb.AppendInstr(Instruction::kCondBranch).input(eq_res_var);
         break;
       }
       case Opcode::kDeleteAttr: {
@@ -1244,29 +1443,17 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         auto instr = static_cast<const DeleteAttr*>(&i);
         PyCodeObject* code = instr->frameState()->code;
         PyObject* name = PyTuple_GET_ITEM(code->co_names, instr->name_idx());
-        bbb.AppendCode(
-            "Call {}:CInt32, {}, {}, {}, 0",
-            tmp,
-            reinterpret_cast<uint64_t>(PyObject_SetAttr),
-            instr->GetOperand(0),
-            reinterpret_cast<uint64_t>(name));
-        AppendGuard(bbb, "NotNegative", *instr, tmp);
+        bbb.AppendInstr(Instruction::kCall)
+            .imm(reinterpret_cast<uint64_t>(PyObject_SetAttr))
+            .input(instr->GetOperand(0))
+            .imm(reinterpret_cast<uint64_t>(name))
+            .imm(0)
+            .output(tmp, Operand::k32bit);
+        AppendGuard(bbb, kNotNegative, *instr, tmp);
         break;
       }
       case Opcode::kLoadAttr: {
-        auto instr = static_cast<const LoadAttr*>(&i);
-        std::string tmp_id = GetSafeTempName();
-        PyCodeObject* code = instr->frameState()->code;
-        PyObject* name = PyTuple_GET_ITEM(code->co_names, instr->name_idx());
-
-        bbb.AppendCode(
-            "Move {}, {:#x}", tmp_id, reinterpret_cast<uint64_t>(name));
-        bbb.AppendCall(
-            instr->dst(),
-            jit::LoadAttrCache::invoke,
-            env_->code_rt->AllocateLoadAttrCache(),
-            instr->GetOperand(0),
-            tmp_id);
+        TranslateLoadAttr(bbb, static_cast<const LoadAttr&>(i));
         break;
       }
       case Opcode::kLoadAttrSpecial: {
@@ -1282,9 +1469,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kLoadTypeAttrCacheItem: {
         auto instr = static_cast<const LoadTypeAttrCacheItem*>(&i);
         auto cache = env_->code_rt->getLoadTypeAttrCache(instr->cache_id());
-        auto addr =
-            reinterpret_cast<uint64_t>(&(cache->items[instr->item_idx()]));
-        bbb.AppendCode("Load {}, {:#x}", instr->GetOutput(), addr);
+        bbb.AppendInstr(Instruction::kMove)
+            .addrInput(&(cache->items[instr->item_idx()]))
+            .output(instr->GetOutput());
         break;
       }
       case Opcode::kFillTypeAttrCache: {
@@ -1292,8 +1479,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         std::string tmp_id = GetSafeTempName();
         PyCodeObject* code = instr->frameState()->code;
         PyObject* name = PyTuple_GET_ITEM(code->co_names, instr->name_idx());
-        bbb.AppendCode(
-            "Move {}, {:#x}", tmp_id, reinterpret_cast<uint64_t>(name));
+        bbb.AppendInstr(Instruction::kMove)
+            .imm(reinterpret_cast<uint64_t>(name))
+            .output(tmp_id);
         bbb.AppendCall(
             instr->GetOutput(),
             jit::LoadTypeAttrCache::invoke,
@@ -1309,23 +1497,25 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         PyCodeObject* code = instr->frameState()->code;
         PyObject* name = PyTuple_GET_ITEM(code->co_names, instr->name_idx());
 
-        bbb.AppendCode(
-            "Move {}, {:#x}", tmp_id, reinterpret_cast<uint64_t>(name));
+        bbb.AppendInstr(Instruction::kMove)
+            .imm(reinterpret_cast<uint64_t>(name))
+            .output(tmp_id);
 
         auto func = reinterpret_cast<uint64_t>(JITRT_GetMethod);
         auto cache_entry = env_->code_rt->AllocateLoadMethodCache();
-        bbb.AppendCode(
-            "Call {}, {:#x}, {}, {}, {:#x}",
-            instr->dst(),
-            func,
-            instr->receiver(),
-            tmp_id,
-            reinterpret_cast<uint64_t>(cache_entry));
+        bbb.AppendInstr(Instruction::kCall)
+            .imm(func)
+            .input(instr->receiver())
+            .input(tmp_id)
+            .imm(reinterpret_cast<uint64_t>(cache_entry))
+            .output(instr->dst());
 
         break;
       }
       case Opcode::kGetLoadMethodInstance: {
-        bbb.AppendCode("Load2ndCallResult {}", i.GetOutput());
+        bbb.AppendInstr(Instruction::kMove)
+            .phyInput(PhyLocation::RDX)
+            .output(i.GetOutput());
         break;
       }
       case Opcode::kLoadMethodSuper: {
@@ -1333,19 +1523,19 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         std::string tmp_id = GetSafeTempName();
         PyCodeObject* code = instr->frameState()->code;
         PyObject* name = PyTuple_GET_ITEM(code->co_names, instr->name_idx());
-        bbb.AppendCode(
-            "Move {}, {:#x}", tmp_id, reinterpret_cast<uint64_t>(name));
+        bbb.AppendInstr(Instruction::kMove)
+            .imm(reinterpret_cast<uint64_t>(name))
+            .output(tmp_id);
 
         auto func = reinterpret_cast<uint64_t>(JITRT_GetMethodFromSuper);
-        bbb.AppendCode(
-            "Call {}, {:#x}, {}, {}, {}, {}, {}",
-            instr->dst(),
-            func,
-            instr->global_super(),
-            instr->type(),
-            instr->receiver(),
-            tmp_id,
-            instr->no_args_in_super_call() ? 1 : 0);
+        bbb.AppendInstr(Instruction::kCall)
+            .imm(func)
+            .input(instr->global_super())
+            .input(instr->type())
+            .input(instr->receiver())
+            .input(tmp_id)
+            .imm(instr->no_args_in_super_call() ? 1 : 0)
+            .output(instr->dst());
         break;
       }
       case Opcode::kLoadAttrSuper: {
@@ -1354,8 +1544,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         PyCodeObject* code = instr->frameState()->code;
         PyObject* name = PyTuple_GET_ITEM(code->co_names, instr->name_idx());
 
-        bbb.AppendCode(
-            "Move {}, {:#x}", tmp_id, reinterpret_cast<uint64_t>(name));
+        bbb.AppendInstr(Instruction::kMove)
+            .imm(reinterpret_cast<uint64_t>(name))
+            .output(tmp_id);
 
         bbb.AppendCall(
             instr->dst(),
@@ -1590,31 +1781,26 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kBatchDecref: {
         auto instr = static_cast<const BatchDecref*>(&i);
 
-        std::stringstream ss;
-        ss << "BatchDecref ";
+        auto batch = bbb.AppendInstr(Instruction::kBatchDecref);
         auto nargs = instr->NumOperands();
         for (size_t i = 0; i < nargs; i++) {
-          ss << (i == 0 ? "" : ", ") << *instr->GetOperand(i);
+          batch.input(instr->GetOperand(i)->name());
         }
-        bbb.AppendCode(ss.str());
         break;
       }
       case Opcode::kDeopt: {
-        AppendGuard(bbb, "AlwaysFail", static_cast<const DeoptBase&>(i));
+        AppendGuard(bbb, kAlwaysFail, static_cast<const DeoptBase&>(i));
         break;
       }
       case Opcode::kDeoptPatchpoint: {
         const auto& instr = static_cast<const DeoptPatchpoint&>(i);
         auto deopt_meta = jit::DeoptMetadata::fromInstr(instr, env_->code_rt);
         auto id = env_->rt->addDeoptMetadata(std::move(deopt_meta));
-        std::stringstream ss;
-        ss << "DeoptPatchpoint " << static_cast<void*>(instr.patcher()) << ", "
-           << id;
-        auto& regstates = instr.live_regs();
-        for (const auto& reg_state : regstates) {
-          ss << ", " << *reg_state.reg;
+        auto patchpoint = bbb.AppendInstr(Instruction::kDeoptPatchpoint);
+        patchpoint.imm(reinterpret_cast<uint64_t>(instr.patcher())).imm(id);
+        for (const auto& reg_state : instr.live_regs()) {
+          patchpoint.input(reg_state.reg->name());
         }
-        bbb.AppendCode(ss.str());
         break;
       }
       case Opcode::kRaiseAwaitableError: {
@@ -1624,7 +1810,7 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             "__asm_tstate",
             instr.GetOperand(0),
             static_cast<int>(instr.with_opcode()));
-        AppendGuard(bbb, "AlwaysFail", instr);
+        AppendGuard(bbb, kAlwaysFail, instr);
         break;
       }
       case Opcode::kCheckExc:
@@ -1635,18 +1821,18 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kGuard:
       case Opcode::kGuardIs: {
         const auto& instr = static_cast<const DeoptBase&>(i);
-        std::string_view kind = "NotZero";
+        InstrGuardKind kind = kNotZero;
         if (instr.IsCheckNeg()) {
-          kind = "NotNegative";
+          kind = kNotNegative;
         } else if (instr.IsGuardIs()) {
-          kind = "Is";
+          kind = kIs;
         }
         AppendGuard(bbb, kind, instr, instr.GetOperand(0)->name());
         break;
       }
       case Opcode::kGuardType: {
         const auto& instr = static_cast<const DeoptBase&>(i);
-        AppendGuard(bbb, "HasType", instr, instr.GetOperand(0)->name());
+        AppendGuard(bbb, kHasType, instr, instr.GetOperand(0)->name());
         break;
       }
       case Opcode::kRefineType: {
@@ -1660,10 +1846,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         PyObject* name =
             PyTuple_GET_ITEM(instr->code()->co_names, instr->name_idx());
         auto cache = env_->rt->findGlobalCache(globals, name);
-        bbb.AppendCode(
-            "Load {}, {:#x}",
-            instr->GetOutput(),
-            reinterpret_cast<uint64_t>(cache.valuePtr()));
+        bbb.AppendInstr(Instruction::kMove)
+            .addrInput(cache.valuePtr())
+            .output(instr->GetOutput());
         break;
       }
       case Opcode::kLoadGlobal: {
@@ -1723,13 +1908,12 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kCallCFunc: {
         auto& instr = static_cast<const CallCFunc&>(i);
 
-        std::stringstream ss;
-        ss << "Call " << *instr.dst() << ", " << instr.funcAddr();
+        auto call = bbb.AppendInstr(Instruction::kCall);
+        call.imm(instr.funcAddr());
         for (size_t i = 0; i < instr.NumOperands(); i++) {
-          ss << ", " << *instr.GetOperand(i);
+          call.input(instr.GetOperand(i)->name());
         }
-
-        bbb.AppendCode(ss.str());
+        call.output(instr.dst()->name());
         break;
       }
       case Opcode::kCallEx: {
@@ -1755,21 +1939,19 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kCallMethod: {
         auto instr = static_cast<const CallMethod*>(&i);
 
-        std::string s = fmt::format("Vectorcall {}", *instr->dst());
         size_t flags = instr->isAwaited() ? _Py_AWAITED_CALL_MARKER : 0;
-        format_to(
-            s,
-            ", {}, {}, {}, {}",
-            reinterpret_cast<uint64_t>(JITRT_CallMethod),
-            flags,
-            *instr->func(),
-            *instr->self());
+        auto call = bbb.AppendInstr(Instruction::kVectorCall);
+        call.imm(reinterpret_cast<uint64_t>(JITRT_CallMethod))
+            .imm(flags)
+            .input(instr->func()->name())
+            .input(instr->self()->name());
 
         for (size_t i = 0, nargs = instr->NumArgs(); i < nargs; i++) {
-          format_to(s, ", {}", *instr->arg(i));
+          call.input(instr->arg(i)->name());
         }
 
-        bbb.AppendCode(s + ", 0"); /* kwnames */
+        call.imm(0); /* kwnames */
+        call.output(instr->dst()->name());
         break;
       }
 
@@ -1777,41 +1959,44 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         auto instr = static_cast<const CallStatic*>(&i);
         auto nargs = instr->NumOperands();
 
-        std::stringstream ss;
-        ss << "Call " << instr->dst()->name() << ", "
-           << reinterpret_cast<uint64_t>(instr->addr());
-
+        // Widen small integer arguments ahead of the call itself.
+        std::vector<std::string> args;
         for (size_t i = 0; i < nargs; i++) {
           Type src_type = instr->GetOperand(i)->type();
           if (src_type <= (TCBool | TCUInt8 | TCUInt16)) {
             std::string tmp = GetSafeTempName();
-            bbb.AppendCode(
-                "ConvertUnsigned {}:CUInt64, {}", tmp, instr->GetOperand(i));
-            ss << ", " << tmp << ":CUInt64";
+            bbb.AppendInstr(Instruction::kZext)
+                .input(instr->GetOperand(i))
+                .output(tmp, Operand::k64bit);
+            args.push_back(tmp);
           } else if (src_type <= (TCInt8 | TCInt16)) {
             std::string tmp = GetSafeTempName();
-            bbb.AppendCode("Convert {}:CInt64, {}", tmp, instr->GetOperand(i));
-            ss << ", " << tmp << ":CInt64";
+            bbb.AppendInstr(Instruction::kSext)
+                .input(instr->GetOperand(i))
+                .output(tmp, Operand::k64bit);
+            args.push_back(tmp);
           } else {
-            ss << ", " << instr->GetOperand(i)->name();
+            args.push_back(instr->GetOperand(i)->name());
           }
         }
 
-        bbb.AppendCode(ss.str());
+        auto call = bbb.AppendInstr(Instruction::kCall);
+        call.imm(reinterpret_cast<uint64_t>(instr->addr()));
+        for (const auto& arg : args) {
+          call.input(arg);
+        }
+        call.output(instr->dst()->name());
         break;
       }
       case Opcode::kCallStaticRetVoid: {
         auto instr = static_cast<const CallStaticRetVoid*>(&i);
         auto nargs = instr->NumOperands();
 
-        std::stringstream ss;
-        ss << "Invoke " << reinterpret_cast<uint64_t>(instr->addr());
-
+        auto call = bbb.AppendInstr(Instruction::kCall);
+        call.imm(reinterpret_cast<uint64_t>(instr->addr()));
         for (size_t i = 0; i < nargs; i++) {
-          ss << ", " << instr->GetOperand(i)->name();
+          call.input(instr->GetOperand(i)->name());
         }
-
-        bbb.AppendCode(ss.str());
         break;
       }
       case Opcode::kInvokeStaticFunction: {
@@ -1821,34 +2006,32 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         auto nargs = instr->NumOperands();
         PyFunctionObject* func = instr->func();
 
-        std::stringstream ss;
         JIT_CHECK(
             !usesRuntimeFunc(func->func_code),
             "Can't statically invoke given function: %s",
             PyUnicode_AsUTF8(func->func_qualname));
-        if (_PyJIT_IsCompiled((PyObject*)func)) {
-          ss << fmt::format(
-              "Call {}, {}",
-              instr->dst(),
-              reinterpret_cast<uint64_t>(
-                  JITRT_GET_STATIC_ENTRY(func->vectorcall)));
-        } else {
+        std::string entry;
+        if (!_PyJIT_IsCompiled((PyObject*)func)) {
           void** indir = env_->rt->findFunctionEntryCache(func);
           env_->function_indirections.emplace(func, indir);
-          std::string tmp_id = GetSafeTempName();
-          bbb.AppendCode(
-              "Load {}, {:#x}", tmp_id, reinterpret_cast<uint64_t>(indir));
-          ss << "Call " << instr->dst()->name() << ", " << tmp_id;
+          entry = GetSafeTempName();
+          bbb.AppendInstr(Instruction::kMove).addrInput(indir).output(entry);
         }
 
+        auto call = bbb.AppendInstr(Instruction::kCall);
+        if (entry.empty()) {
+          call.imm(reinterpret_cast<uint64_t>(
+              JITRT_GET_STATIC_ENTRY(func->vectorcall)));
+        } else {
+          call.input(entry);
+        }
         for (size_t i = 0; i < nargs; i++) {
-          ss << ", " << instr->GetOperand(i)->name();
+          call.input(instr->GetOperand(i)->name());
         }
-
-        bbb.AppendCode(ss.str());
+        call.output(instr->dst());
 
         // functions that return primitives will signal error via edx/xmm1
-        std::string_view err_indicator;
+        std::string err_indicator;
         Type ret_type = instr->ret_type();
         if (ret_type <= TCDouble) {
           err_indicator = "reg:xmm1";
@@ -1858,63 +2041,54 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           err_indicator = instr->GetOutput()->name();
         }
         AppendGuard(
-            bbb, "NotZero", static_cast<const DeoptBase&>(i), err_indicator);
+            bbb, kNotZero, static_cast<const DeoptBase&>(i), err_indicator);
         break;
       }
 
       case Opcode::kInvokeMethod: {
         auto instr = static_cast<const InvokeMethod*>(&i);
 
-        std::stringstream ss;
         size_t flags = instr->isAwaited() ? _Py_AWAITED_CALL_MARKER : 0;
-        if (instr->isClassmethod()) {
-          ss << "Vectorcall " << *instr->dst() << ", "
-             << reinterpret_cast<uint64_t>(JITRT_InvokeClassMethod) << ", "
-             << flags << ", " << instr->slot();
-        } else {
-          ss << "Vectorcall " << *instr->dst() << ", "
-             << reinterpret_cast<uint64_t>(JITRT_InvokeMethod) << ", " << flags
-             << ", " << instr->slot();
-        }
+        auto helper = instr->isClassmethod()
+            ? reinterpret_cast<uint64_t>(JITRT_InvokeClassMethod)
+            : reinterpret_cast<uint64_t>(JITRT_InvokeMethod);
+        auto call = bbb.AppendInstr(Instruction::kVectorCall);
+        call.imm(helper).imm(flags).imm(instr->slot());
 
         auto nargs = instr->NumOperands();
         for (size_t i = 0; i < nargs; i++) {
-          ss << ", " << *instr->GetOperand(i);
+          call.input(instr->GetOperand(i)->name());
         }
 
-        ss << ", 0"; /* kwnames */
-
-        bbb.AppendCode(ss.str());
+        call.imm(0); /* kwnames */
+        call.output(instr->dst()->name());
         break;
       }
 
       case Opcode::kLoadField: {
         auto instr = static_cast<const LoadField*>(&i);
-        bbb.AppendCode(
-            "Load {}, {}, {}",
-            instr->GetOutput(),
-            instr->receiver(),
-            instr->offset());
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(instr->receiver(), instr->offset())
+            .output(instr->GetOutput());
         break;
       }
 
       case Opcode::kLoadFieldAddress: {
         auto instr = static_cast<const LoadFieldAddress*>(&i);
-        bbb.AppendCode(
-            "Lea {}, {}, {}",
-            instr->GetOutput(),
-            instr->object(),
-            instr->offset());
+        Type offset_type = instr->offset()->type();
+        JIT_CHECK(
+            offset_type.hasIntSpec(), "LoadFieldAddress needs a constant offset");
+        bbb.AppendInstr(Instruction::kLea)
+            .memInput(instr->object(), offset_type.intSpec())
+            .output(instr->GetOutput());
         break;
       }
 
       case Opcode::kStoreField: {
         auto instr = static_cast<const StoreField*>(&i);
-        bbb.AppendCode(
-            "Store {}, {}, {:#x}",
-            instr->value(),
-            instr->receiver(),
-            instr->offset());
+        bbb.AppendInstr(Instruction::kMove)
+            .input(instr->value())
+            .memOutput(instr->receiver(), instr->offset());
         break;
       }
 
@@ -1965,19 +2139,18 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
 
         std::string tmp_id = GetSafeTempName();
         if (!is_tuple && instr->NumOperands() > 1) {
-          bbb.AppendCode(
-              "Load {}, {}, {}", tmp_id, base, offsetof(PyListObject, ob_item));
+          bbb.AppendInstr(Instruction::kMove)
+              .memInput(base, offsetof(PyListObject, ob_item))
+              .output(tmp_id);
           base = std::move(tmp_id);
         }
 
         const size_t ob_item_offset =
             is_tuple ? offsetof(PyTupleObject, ob_item) : 0;
         for (size_t i = 1; i < instr->NumOperands(); i++) {
-          bbb.AppendCode(
-              "Store {}, {}, {}",
-              instr->GetOperand(i),
-              base,
-              ob_item_offset + ((i - 1) * kPointerSize));
+          bbb.AppendInstr(Instruction::kMove)
+              .input(instr->GetOperand(i))
+              .memOutput(base, ob_item_offset + ((i - 1) * kPointerSize));
         }
         break;
       }
@@ -1986,8 +2159,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
 
         const size_t item_offset =
             offsetof(PyTupleObject, ob_item) + instr->idx() * kPointerSize;
-        bbb.AppendCode(
-            "Load {} {} {}", instr->GetOutput(), instr->tuple(), item_offset);
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(instr->tuple(), item_offset)
+            .output(instr->GetOutput());
         break;
       }
       case Opcode::kCheckSequenceBounds: {
@@ -1996,10 +2170,14 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         std::string src = instr->GetOperand(1)->name();
         std::string tmp = GetSafeTempName();
         if (type <= (TCInt8 | TCInt16 | TCInt32)) {
-          bbb.AppendCode("Convert {}:CInt64, {}:{}", tmp, src, type);
+          bbb.AppendInstr(Instruction::kSext)
+              .input(src)
+              .output(tmp, Operand::k64bit);
           src = tmp;
         } else if (type <= (TCUInt8 | TCUInt16 | TCUInt32)) {
-          bbb.AppendCode("Convert {}:CUInt64, {}:{}", tmp, src, type);
+          bbb.AppendInstr(Instruction::kSext)
+              .input(src)
+              .output(tmp, Operand::k64bit);
           src = tmp;
         }
         bbb.AppendCall(
@@ -2017,23 +2195,28 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
           // calling to a helper.
           const size_t item_offset =
               instr->idx()->type().intSpec() * scale + instr->offset();
-          bbb.AppendCode(
-              "Load {} {} {}",
-              instr->GetOutput(),
-              instr->ob_item(),
-              item_offset);
+          bbb.AppendInstr(Instruction::kMove)
+              .memInput(instr->ob_item(), item_offset)
+              .output(instr->GetOutput());
           break;
         }
         // TODO(T120848876): Use Load instead of Mul+Add+Load.
         std::string scaled = instr->idx()->name();
         if (scale != 1) {
           scaled = GetSafeTempName();
-          bbb.AppendCode("Mul {} {} {}", scaled, instr->idx(), scale);
+          bbb.AppendInstr(Instruction::kMul)
+              .input(instr->idx())
+              .imm(scale)
+              .output(scaled);
         }
         std::string plus_index = GetSafeTempName();
-        bbb.AppendCode("Add {} {} {}", plus_index, instr->ob_item(), scaled);
-        bbb.AppendCode(
-            "Load {} {} {}", instr->GetOutput(), plus_index, instr->offset());
+        bbb.AppendInstr(Instruction::kAdd)
+            .input(instr->ob_item())
+            .input(scaled)
+            .output(plus_index);
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(plus_index, instr->offset())
+            .output(instr->GetOutput());
         break;
       }
       case Opcode::kStoreArrayItem: {
@@ -2236,19 +2419,13 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kPhi: {
         auto instr = static_cast<const Phi*>(&i);
 
-        std::stringstream ss;
-        ss << "Phi " << fmt::format("{}", instr->GetOutput());
-
+        auto phi = bbb.AppendInstr(Instruction::kPhi);
         for (size_t i = 0; i < instr->NumOperands(); i++) {
-          fmt::print(
-              ss,
-              ", {:#x}, {}",
-              reinterpret_cast<uint64_t>(instr->basic_blocks().at(i)),
+          phi.pred(instr->basic_blocks().at(i))
               // Phis don't support constant inputs yet
-              instr->GetOperand(i)->name());
+              .input(instr->GetOperand(i)->name());
         }
-
-        bbb.AppendCode(ss.str());
+        phi.output(instr->GetOutput());
         break;
       }
       case Opcode::kInitFunction: {
@@ -2275,11 +2452,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       case Opcode::kSetFunctionAttr: {
         auto instr = static_cast<const SetFunctionAttr*>(&i);
 
-        bbb.AppendCode(
-            "Store {}, {}, {:#x}",
-            instr->value(),
-            instr->base(),
-            instr->offset());
+        bbb.AppendInstr(Instruction::kMove)
+            .input(instr->value())
+            .memOutput(instr->base(), instr->offset());
         break;
       }
       case Opcode::kListAppend: {
@@ -2327,12 +2502,12 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         static_assert(
             sizeof(_PyRuntime.ceval.eval_breaker._value) == 4,
             "Eval breaker is not a 4 byte value");
-        auto eval_breaker =
-            reinterpret_cast<uint64_t>(&_PyRuntime.ceval.eval_breaker._value);
         JIT_CHECK(
             i.GetOutput()->type() == TCInt32,
             "eval breaker output should be int");
-        bbb.AppendCode("Load {}, {:#x}", i.GetOutput(), eval_breaker);
+        bbb.AppendInstr(Instruction::kMove)
+            .addrInput(&_PyRuntime.ceval.eval_breaker._value)
+            .output(i.GetOutput());
         break;
       }
       case Opcode::kRunPeriodicTasks: {
@@ -2365,21 +2540,17 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         }
         auto instr = static_cast<const BeginInlinedFunction*>(&i);
         auto caller_shadow_frame = GetSafeTempName();
-        bbb.AppendCode(
-            "Lea {}, __native_frame_base, {}",
-            caller_shadow_frame,
-            shadowFrameOffsetBefore(instr));
+        bbb.AppendInstr(Instruction::kLea)
+            .memInput("__native_frame_base", shadowFrameOffsetBefore(instr))
+            .output(caller_shadow_frame);
         // There is already a shadow frame for the caller function.
         auto callee_shadow_frame = GetSafeTempName();
-        bbb.AppendCode(
-            "Lea {}, __native_frame_base, {}",
-            callee_shadow_frame,
-            shadowFrameOffsetOf(instr));
-        bbb.AppendCode(
-            "Store {}, {}, {}",
-            caller_shadow_frame,
-            callee_shadow_frame,
-            SHADOW_FRAME_FIELD_OFF(prev));
+        bbb.AppendInstr(Instruction::kLea)
+            .memInput("__native_frame_base", shadowFrameOffsetOf(instr))
+            .output(callee_shadow_frame);
+        bbb.AppendInstr(Instruction::kMove)
+            .input(caller_shadow_frame)
+            .memOutput(callee_shadow_frame, SHADOW_FRAME_FIELD_OFF(prev));
         // Set code object data
         PyCodeObject* code = instr->code();
         env_->code_rt->addReference(reinterpret_cast<PyObject*>(code));
@@ -2389,28 +2560,24 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             env_->code_rt->allocateRuntimeFrameState(code, globals);
         uintptr_t data = _PyShadowFrame_MakeData(rtfs, PYSF_RTFS, PYSF_JIT);
         auto data_reg = GetSafeTempName();
-        bbb.AppendCode("Move {}, {:#x}", data_reg, data);
-        bbb.AppendCode(
-            "Store {}, {}, {}",
-            data_reg,
-            callee_shadow_frame,
-            SHADOW_FRAME_FIELD_OFF(data));
+        bbb.AppendInstr(Instruction::kMove).imm(data).output(data_reg);
+        bbb.AppendInstr(Instruction::kMove)
+            .input(data_reg)
+            .memOutput(callee_shadow_frame, SHADOW_FRAME_FIELD_OFF(data));
         // Set orig_data
         // This is only necessary when in normal-frame mode because the frame
         // is already materialized on function entry. It is lazily filled when
         // the frame is materialized in shadow-frame mode.
         if (func_->frameMode == jit::hir::FrameMode::kNormal) {
-          bbb.AppendCode(
-              "Store {}, {}, {}",
-              data_reg,
-              callee_shadow_frame,
-              JIT_SHADOW_FRAME_FIELD_OFF(orig_data));
+          bbb.AppendInstr(Instruction::kMove)
+              .input(data_reg)
+              .memOutput(
+                  callee_shadow_frame, JIT_SHADOW_FRAME_FIELD_OFF(orig_data));
         }
         // Set our shadow frame as top of shadow stack
-        bbb.AppendCode(
-            "Store {}, __asm_tstate, {}",
-            callee_shadow_frame,
-            offsetof(PyThreadState, shadow_frame));
+        bbb.AppendInstr(Instruction::kMove)
+            .input(callee_shadow_frame)
+            .memOutput("__asm_tstate", offsetof(PyThreadState, shadow_frame));
         if (py_debug) {
           bbb.AppendInvoke(assertShadowCallStackConsistent, "__asm_tstate");
         }
@@ -2424,10 +2591,9 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         }
         // callee_shadow_frame <- tstate.shadow_frame
         auto callee_shadow_frame = GetSafeTempName();
-        bbb.AppendCode(
-            "Load {}, __asm_tstate, {}",
-            callee_shadow_frame,
-            offsetof(PyThreadState, shadow_frame));
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput("__asm_tstate", offsetof(PyThreadState, shadow_frame))
+            .output(callee_shadow_frame);
 
         // Check if the callee has been materialized into a PyFrame. Use the
         // flags below.
@@ -2435,30 +2601,25 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
             PYSF_PYFRAME == 1 && _PyShadowFrame_NumPtrKindBits == 2,
             "Unexpected constants");
         auto shadow_frame_data = GetSafeTempName();
-        bbb.AppendCode(
-            "Load {}, {}, {}",
-            shadow_frame_data,
-            callee_shadow_frame,
-            SHADOW_FRAME_FIELD_OFF(data));
-        bbb.AppendCode("BitTest {}, 0", shadow_frame_data);
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(callee_shadow_frame, SHADOW_FRAME_FIELD_OFF(data))
+            .output(shadow_frame_data);
+        bbb.AppendInstr(Instruction::kBitTest).input(shadow_frame_data).imm(0);
 
         // caller_shadow_frame <- callee_shadow_frame.prev
         auto caller_shadow_frame = GetSafeTempName();
-        bbb.AppendCode(
-            "Load {}, {}, {}",
-            caller_shadow_frame,
-            callee_shadow_frame,
-            SHADOW_FRAME_FIELD_OFF(prev));
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(callee_shadow_frame, SHADOW_FRAME_FIELD_OFF(prev))
+            .output(caller_shadow_frame);
         // caller_shadow_frame -> tstate.shadow_frame
-        bbb.AppendCode(
-            "Store {}, __asm_tstate, {}",
-            caller_shadow_frame,
-            offsetof(PyThreadState, shadow_frame));
+        bbb.AppendInstr(Instruction::kMove)
+            .input(caller_shadow_frame)
+            .memOutput("__asm_tstate", offsetof(PyThreadState, shadow_frame));
 
         // Unlink PyFrame if needed. Someone might have materialized all of the
         // PyFrames via PyEval_GetFrame or similar.
         auto done = GetSafeLabelName();
-        bbb.AppendCode("BranchNC {}", done);
+        bbb.AppendFlagBranch(Instruction::kBranchNC, done);
         // TODO(T109445584): Remove this unused label.
         bbb.AppendLabel(GetSafeLabelName());
         bbb.AppendInvoke(JITRT_UnlinkFrame, "__asm_tstate");
@@ -2499,39 +2660,41 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
       }
       case Opcode::kRaise: {
         const auto& instr = static_cast<const Raise&>(i);
-        std::string exc = "0";
-        std::string cause = "0";
+        Register* exc = nullptr;
+        Register* cause = nullptr;
         switch (instr.kind()) {
           case Raise::Kind::kReraise:
             break;
           case Raise::Kind::kRaiseWithExcAndCause:
-            cause = instr.GetOperand(1)->name();
+            cause = instr.GetOperand(1);
             // Fallthrough
           case Raise::Kind::kRaiseWithExc:
-            exc = instr.GetOperand(0)->name();
+            exc = instr.GetOperand(0);
         }
-        bbb.AppendCode(
-            "Call {}, {:#x}, __asm_tstate, {}, {}",
-            GetSafeTempName(),
-            reinterpret_cast<uint64_t>(&_Py_DoRaise),
-            exc,
-            cause);
-        AppendGuard(bbb, "AlwaysFail", instr);
+        auto call = bbb.AppendInstr(Instruction::kCall);
+        call.imm(reinterpret_cast<uint64_t>(&_Py_DoRaise))
+            .input("__asm_tstate");
+        for (Register* arg : {exc, cause}) {
+          if (arg == nullptr) {
+            call.imm(0);
+          } else {
+            call.input(arg->name());
+          }
+        }
+        call.output(GetSafeTempName());
+        AppendGuard(bbb, kAlwaysFail, instr);
         break;
       }
       case Opcode::kRaiseStatic: {
         const auto& instr = static_cast<const RaiseStatic&>(i);
-        std::stringstream args;
+        auto call = bbb.AppendInstr(Instruction::kCall);
+        call.imm(reinterpret_cast<uint64_t>(&PyErr_Format))
+            .imm(reinterpret_cast<uint64_t>(instr.excType()))
+            .imm(reinterpret_cast<uint64_t>(instr.fmt()));
         for (size_t i = 0; i < instr.NumOperands(); i++) {
-          args << ", " << *instr.GetOperand(i);
+          call.input(instr.GetOperand(i)->name());
         }
-        bbb.AppendCode(
-            "Invoke {:#x}, {:#x}, {:#x}{}",
-            reinterpret_cast<uint64_t>(&PyErr_Format),
-            reinterpret_cast<uint64_t>(instr.excType()),
-            reinterpret_cast<uint64_t>(instr.fmt()),
-            args.str());
-        AppendGuard(bbb, "AlwaysFail", instr);
+        AppendGuard(bbb, kAlwaysFail, instr);
         break;
       }
       case Opcode::kFormatValue: {
@@ -2551,60 +2714,50 @@ LIRGenerator::TranslatedBlock LIRGenerator::TranslateOneBasicBlock(
         // using vectorcall here although this is not strictly a vector call.
         // the callable is always null, and all the components to be
         // concatenated will be in the args argument.
-        std::string s = fmt::format(
-            "Vectorcall {}, {}, 0, 0",
-            instr.dst(),
-            reinterpret_cast<uint64_t>(JITRT_BuildString));
+        auto call = bbb.AppendInstr(Instruction::kVectorCall);
+        call.imm(reinterpret_cast<uint64_t>(JITRT_BuildString)).imm(0).imm(0);
         for (size_t i = 0; i < instr.NumOperands(); i++) {
-          s += fmt::format(", {}", instr.GetOperand(i));
+          call.input(instr.GetOperand(i));
         }
 
-        s += ", 0";
-
-        bbb.AppendCode(s);
+        call.imm(0).output(instr.dst());
         break;
       }
       case Opcode::kWaitHandleLoadWaiter: {
         const auto& instr = static_cast<const WaitHandleLoadWaiter&>(i);
-        bbb.AppendCode(
-            "Load {}, {}, {}",
-            instr.GetOutput()->name(),
-            instr.reg(),
-            offsetof(PyWaitHandleObject, wh_waiter));
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(instr.reg(), offsetof(PyWaitHandleObject, wh_waiter))
+            .output(instr.GetOutput()->name());
         break;
       }
       case Opcode::kWaitHandleLoadCoroOrResult: {
         const auto& instr = static_cast<const WaitHandleLoadCoroOrResult&>(i);
-        bbb.AppendCode(
-            "Load {}, {}, {}",
-            instr.GetOutput()->name(),
-            instr.reg(),
-            offsetof(PyWaitHandleObject, wh_coro_or_result));
+        bbb.AppendInstr(Instruction::kMove)
+            .memInput(
+                instr.reg(), offsetof(PyWaitHandleObject, wh_coro_or_result))
+            .output(instr.GetOutput()->name());
         break;
       }
       case Opcode::kWaitHandleRelease: {
         const auto& instr = static_cast<const WaitHandleRelease&>(i);
-        std::string null_var = GetSafeTempName();
-        bbb.AppendCode(
-            "Store 0, {}, {}",
-            instr.reg(),
-            offsetof(PyWaitHandleObject, wh_coro_or_result));
-        bbb.AppendCode(
-            "Store 0, {}, {}",
-            instr.reg(),
-            offsetof(PyWaitHandleObject, wh_waiter));
+        bbb.AppendInstr(Instruction::kMove)
+            .imm(0)
+            .memOutput(
+                instr.reg(), offsetof(PyWaitHandleObject, wh_coro_or_result));
+        bbb.AppendInstr(Instruction::kMove)
+            .imm(0)
+            .memOutput(instr.reg(), offsetof(PyWaitHandleObject, wh_waiter));
         break;
       }
       case Opcode::kDeleteSubscr: {
         auto tmp = GetSafeTempName();
         const auto& instr = static_cast<const DeleteSubscr&>(i);
-        bbb.AppendCode(
-            "Call {}:CInt32, {:#x}, {}, {}",
-            tmp,
-            reinterpret_cast<uint64_t>(PyObject_DelItem),
-            instr.GetOperand(0),
-            instr.GetOperand(1));
-        AppendGuard(bbb, "NotNegative", instr, tmp);
+        bbb.AppendInstr(Instruction::kCall)
+            .imm(reinterpret_cast<uint64_t>(PyObject_DelItem))
+            .input(instr.GetOperand(0))
+            .input(instr.GetOperand(1))
+            .output(tmp, Operand::k32bit);
+        AppendGuard(bbb, kNotNegative, instr, tmp);
         break;
       }
       case Opcode::kUnpackExToTuple: {
@@ -2691,7 +2844,12 @@ void LIRGenerator::FixPhiNodes(
         auto opnd = static_cast<Operand*>(o);
         auto hir_bb =
             reinterpret_cast<jit::hir::BasicBlock*>(opnd->getBasicBlock());
-        opnd->setBasicBlock(bb_map.at(hir_bb).last);
+        // Phis emitted within the translation of a single HIR instruction
+        // already refer to LIR blocks.
+        auto it = bb_map.find(hir_bb);
+        if (it != bb_map.end()) {
+          opnd->setBasicBlock(it->second.last);
+        }
       }
     });
   }
@@ -61,21 +61,30 @@ class LIRGenerator {
   BasicBlock* GenerateEntryBlock();
   BasicBlock* GenerateExitBlock();
 
+  // guard_var may also be "reg:edx" or "reg:xmm1" to guard on the secondary
+  // return register of the preceding call.
   void AppendGuard(
       BasicBlockBuilder& bbb,
-      std::string_view kind,
+      InstrGuardKind kind,
       const hir::DeoptBase& instr,
-      std::string_view guard_var = std::string_view());
+      const std::string& guard_var = std::string());
 
   void MakeIncref(
       BasicBlockBuilder& bbb,
       const jit::hir::Instr& instr,
       bool xincref);
+  void MakeIncref(
+      BasicBlockBuilder& bbb,
+      const std::string& obj,
+      bool xincref,
+      bool maybe_immortal);
   void MakeDecref(
       BasicBlockBuilder& bbb,
       const jit::hir::Instr& instr,
       bool xdecref);
 
+  void TranslateLoadAttr(BasicBlockBuilder& bbb, const hir::LoadAttr& instr);
+
   bool TranslateSpecializedCall(
       BasicBlockBuilder& bbb,
       const jit::hir::VectorCallBase& instr);
@@ -90,6 +99,11 @@ class LIRGenerator {
   void FixPhiNodes(
       UnorderedMap<const hir::BasicBlock*, TranslatedBlock>& bb_map);
   void FixOperands();
+
+  // Put every block that can only be reached through one of cold_edges (keyed
+  // by source block) into the cold section.
+  void MarkColdBlocks(const UnorderedMap<BasicBlock*, BasicBlock*>& cold_edges);
+
   void emitExceptionCheck(
       const jit::hir::DeoptBase& i,
       jit::lir::BasicBlockBuilder& bbb);
@@ -14,6 +14,7 @@
 #include <limits>
 #include <queue>
 #include <stack>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -199,9 +200,12 @@ void LinearScanAllocator::initialize() {
   regalloc_blocks_.clear();
   vreg_last_use_.clear();
   vreg_global_last_use_.clear();
+  vreg_constants_.clear();
+  loop_ranges_.clear();
 
   max_stack_slot_ = initial_max_stack_slot_;
   free_stack_slots_.clear();
+  spilled_vregs_.clear();
 
   allocated_.clear();
 
@@ -219,19 +223,106 @@ void LinearScanAllocator::run() {
 
 // This function can be further optimized to reorder basic blocks so that
 // the linear scan at a later stage generate better results. Now, we only
-// reorder the blocks such that they are in RPO order.
+// reorder the blocks such that they are in RPO order, apart from cold blocks,
+// which go at the end.
 void LinearScanAllocator::sortBasicBlocks() {
   func_->sortBasicBlocks();
 }
 
+// Call f with the definition of each vreg that instr reads, including the base
+// and index registers of memory operands.
+template <typename F>
+static void forEachVregUse(const Instruction* instr, F f) {
+  auto visit_indirect = [&](const OperandBase* operand) {
+    auto indirect = operand->getMemoryIndirect();
+    auto base = indirect->getBaseRegOperand();
+    if (base->isVreg()) {
+      f(base->getDefine());
+    }
+    auto index = indirect->getIndexRegOperand();
+    if (index != nullptr && index->isVreg()) {
+      f(index->getDefine());
+    }
+  };
+
+  if (instr->output()->isInd()) {
+    visit_indirect(instr->output());
+  }
+  for (size_t i = 0; i < instr->getNumInputs(); i++) {
+    const OperandBase* opnd = instr->getInput(i);
+    if (opnd->isInd()) {
+      visit_indirect(opnd);
+    } else if (opnd->isVreg()) {
+      f(opnd->getDefine());
+    }
+  }
+}
+
+UnorderedMap<const BasicBlock*, UnorderedSet<const Operand*>>
+LinearScanAllocator::calculateLiveIn() const {
+  const auto& basic_blocks = func_->basicblocks();
+
+  // The vregs each block reads before writing them, and the ones it writes.
+  UnorderedMap<const BasicBlock*, UnorderedSet<const Operand*>> gen;
+  UnorderedMap<const BasicBlock*, UnorderedSet<const Operand*>> kill;
+  for (auto bb : basic_blocks) {
+    auto& bb_gen = gen[bb];
+    auto& bb_kill = kill[bb];
+    auto& instrs = bb->instructions();
+    for (auto iter = instrs.rbegin(); iter != instrs.rend(); ++iter) {
+      auto instr = iter->get();
+      auto output = instr->output();
+      if (output->isVreg()) {
+        bb_gen.erase(output);
+        bb_kill.insert(output);
+      }
+      // Phi inputs are live at the end of the predecessors rather than here.
+      if (!instr->isPhi()) {
+        forEachVregUse(instr, [&](const Operand* def) { bb_gen.insert(def); });
+      }
+    }
+  }
+
+  // Live sets only grow, so iterate until none of them change size.
+  UnorderedMap<const BasicBlock*, UnorderedSet<const Operand*>> livein;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto iter = basic_blocks.rbegin(); iter != basic_blocks.rend();
+         ++iter) {
+      const BasicBlock* bb = *iter;
+      UnorderedSet<const Operand*> live;
+      for (auto succ : bb->successors()) {
+        auto& succ_livein = livein[succ];
+        live.insert(succ_livein.begin(), succ_livein.end());
+        succ->foreachPhiInstr([&](const Instruction* instr) {
+          live.insert(instr->getOperandByPredecessor(bb)->getDefine());
+        });
+      }
+      for (auto def : kill[bb]) {
+        live.erase(def);
+      }
+      auto& bb_gen = gen[bb];
+      live.insert(bb_gen.begin(), bb_gen.end());
+
+      auto& bb_livein = livein[bb];
+      if (live.size() != bb_livein.size()) {
+        bb_livein = std::move(live);
+        changed = true;
+      }
+    }
+  }
+  return livein;
+}
+
 void LinearScanAllocator::calculateLiveIntervals() {
   const auto& basic_blocks = func_->basicblocks();
 
-  // This table maps loop headers to all their loop ends. A loop end basic
-  // block is the last block of a loop starting at the loop header.
-  // The key is the pointer to the loop header and the value std::vector<int>
-  // is a vector of the block ids of all the associated loop ends.
-  UnorderedMap<const BasicBlock*, std::vector<int>> loop_ends;
+  // With exact live-in sets for every block, the intervals built below are
+  // correct whatever order the blocks are in. In particular, a block placed
+  // after one of its successors (a loop's back edge, or a cold block that
+  // branches back into the hot path) needs no special handling.
+  auto livein = calculateLiveIn();
 
 #ifdef Py_DEBUG
   UnorderedSet<const Operand*> seen_outputs;
@@ -243,7 +334,6 @@ void LinearScanAllocator::calculateLiveIntervals() {
   }
   int total_ids = total_instrs * 2 + basic_blocks.size();
 
-  UnorderedSet<const BasicBlock*> visited_blocks;
   for (auto iter = basic_blocks.rbegin(); iter != basic_blocks.rend(); ++iter) {
     BasicBlock* bb = *iter;
 
@@ -284,11 +374,8 @@ void LinearScanAllocator::calculateLiveIntervals() {
 
     for (auto succ : successors) {
       // each successor's livein is live
-      auto live_iter = regalloc_blocks_.find(succ);
-      if (live_iter != regalloc_blocks_.end()) {
-        auto& livein = live_iter->second.livein;
-        live.insert(livein.begin(), livein.end());
-      }
+      auto& succ_livein = livein[succ];
+      live.insert(succ_livein.begin(), succ_livein.end());
 
       // each successor's phi inputs are live
       succ->foreachPhiInstr([&bb, &live](const Instruction* instr) {
@@ -322,6 +409,12 @@ void LinearScanAllocator::calculateLiveIntervals() {
         getIntervalByVReg(output_opnd).setFrom(instr_id + 1);
         live.erase(output_opnd);
 
+        if (instr_opcode == Instruction::kMove && !output_opnd->isFp() &&
+            instr->getInput(0)->type() == OperandBase::kImm) {
+          vreg_constants_.emplace(
+              output_opnd, instr->getInput(0)->getConstant());
+        }
+
         if (instr->getOutputPhyRegUse()) {
           vreg_phy_uses_[output_opnd].emplace(instr_id + 1);
         }
@@ -428,43 +521,57 @@ void LinearScanAllocator::calculateLiveIntervals() {
     bb->foreachPhiInstr(
         [&live](const Instruction* phi) { live.erase(phi->output()); });
 
-    auto loop_iter = loop_ends.find(bb);
-    if (loop_iter != loop_ends.end()) {
-      for (auto& loop_end_id : loop_iter->second) {
-        for (auto& opnd : live) {
-          LiveRange loop_range(bb_start_id, loop_end_id);
-          getIntervalByVReg(opnd).addRange(loop_range);
-          // if the last use is in a loop, it is not a real last use
-          auto opnd_iter = vreg_last_use_.find(opnd);
-          if (opnd_iter == vreg_last_use_.end()) {
-            continue;
-          }
-          auto& uses = opnd_iter->second;
-          for (auto use_iter = uses.begin(); use_iter != uses.end();) {
-            LIRLocation use_loc = use_iter->second;
-            if (loop_range.isInRange(use_loc)) {
-              use_iter = uses.erase(use_iter);
-              continue;
-            }
-
-            ++use_iter;
-          }
+    JIT_DCHECK(live.size() == livein[bb].size(), "Inconsistent live-in sets");
+    lir_bb_iter->second.livein = std::move(live);
+  }
+
+  calculateLoopRanges();
+}
+
+void LinearScanAllocator::calculateLoopRanges() {
+  const auto& basic_blocks = func_->basicblocks();
+  UnorderedMap<const BasicBlock*, size_t> block_index;
+  for (size_t i = 0; i < basic_blocks.size(); i++) {
+    block_index.emplace(basic_blocks[i], i);
+  }
+
+  auto reaches = [](const BasicBlock* from, const BasicBlock* to) {
+    UnorderedSet<const BasicBlock*> visited{from};
+    std::vector<const BasicBlock*> worklist{from};
+    while (!worklist.empty()) {
+      auto block = worklist.back();
+      worklist.pop_back();
+      if (block == to) {
+        return true;
+      }
+      for (auto succ : block->successors()) {
+        if (visited.insert(succ).second) {
+          worklist.push_back(succ);
         }
       }
     }
+    return false;
+  };
 
-    lir_bb_iter->second.livein = std::move(live);
-
-    // record a loop end
-    for (auto& succ : bb->successors()) {
-      if (visited_blocks.count(bb)) {
+  // An edge to an earlier (or the same) block is a loop's back edge if the
+  // target can reach the source. Other backward edges come from blocks that
+  // were moved out of line, such as cold blocks. Each loop covers everything
+  // from its header to the end of its last back edge's block.
+  UnorderedMap<const BasicBlock*, LIRLocation> loop_ends;
+  for (auto bb : basic_blocks) {
+    for (auto succ : bb->successors()) {
+      if (block_index.at(succ) > block_index.at(bb) || !reaches(succ, bb)) {
         continue;
       }
-
-      loop_ends[succ].push_back(bb_start_id + bb_instrs + 1);
+      LIRLocation end = map_get(regalloc_blocks_, bb).block_start_index +
+          bb->getNumInstrs() * 2 + 1;
+      auto& loop_end = loop_ends[succ];
+      loop_end = std::max(loop_end, end);
     }
-
-    visited_blocks.insert(bb);
+  }
+  for (auto& pair : loop_ends) {
+    loop_ranges_.emplace_back(
+        map_get(regalloc_blocks_, pair.first).block_start_index, pair.second);
   }
 }
 
@@ -573,20 +680,6 @@ void LinearScanAllocator::linearScan() {
   UnorderedSet<LiveInterval*> active;
   UnorderedSet<LiveInterval*> inactive;
 
-  struct LiveIntervalPtrEndLess {
-    bool operator()(const LiveInterval* lhs, const LiveInterval* rhs) const {
-      const auto& lhs_end = lhs->endLocation();
-      const auto& rhs_end = rhs->endLocation();
-
-      if (lhs_end == rhs_end) {
-        return lhs->vreg < rhs->vreg;
-      }
-      return lhs_end < rhs_end;
-    }
-  };
-
-  OrderedSet<LiveInterval*, LiveIntervalPtrEndLess> stack_intervals;
-
   UnhandledQueue unhandled;
   for (auto& interval : allocated_) {
     unhandled.push(interval.get());
@@ -599,19 +692,11 @@ void LinearScanAllocator::linearScan() {
     auto position = current->startLocation();
 
     // free memory stack slot
-    auto end_iter = stack_intervals.begin();
-    while (end_iter != stack_intervals.end()) {
-      auto interval = *end_iter;
-      auto vreg = interval->vreg;
-      auto iter = vreg_global_last_use_.find(vreg);
-
-      if (iter != vreg_global_last_use_.end() && iter->second <= position) {
-        freeStackSlot(vreg);
-      }
-
-      ++end_iter;
+    while (!spilled_vregs_.empty() &&
+           spilled_vregs_.begin()->first <= position) {
+      freeStackSlot(spilled_vregs_.begin()->second);
+      spilled_vregs_.erase(spilled_vregs_.begin());
     }
-    stack_intervals.erase(stack_intervals.begin(), end_iter);
 
     for (auto act_iter = active.begin(); act_iter != active.end();) {
       auto active_interval = *act_iter;
@@ -644,8 +729,6 @@ void LinearScanAllocator::linearScan() {
     if (current->isRegisterAllocated()) {
       changed_regs_.Set(current->allocated_loc);
       active.insert(current);
-    } else {
-      stack_intervals.emplace(current);
     }
   }
 
@@ -778,18 +861,42 @@ void LinearScanAllocator::allocateBlockedReg(
 
   auto reg_iter = std::max_element(start, end);
   PhyLocation reg = std::distance(nextUsePos.begin(), reg_iter);
-  auto& reg_use = *reg_iter;
+  auto reg_use = *reg_iter;
 
   auto first_current_use = getUseAtOrAfter(current->vreg, current_start);
-  if (first_current_use >= reg_use) {
-    auto stack_slot = getStackSlot(current->vreg);
-    current->allocateTo(stack_slot);
-
-    // first_current_use can be MAX_LOCATION when vreg is in a loop and there is
-    // no more uses after current_start
-    if (first_current_use < current->endLocation()) {
-      splitAndSave(current, first_current_use, unhandled);
+  if (first_current_use < reg_use) {
+    // Any register that isn't needed again before current's first use can be
+    // taken from the interval holding it. Rather than always taking the one
+    // with the most distant next use, prefer the one whose reload would
+    // happen in the fewest nested loops, then one holding a constant, which
+    // is cheap to rematerialize.
+    auto spill_cost = [&](PhyLocation r) {
+      LIRLocation use = nextUsePos[r];
+      int depth = use == MAX_LOCATION ? 0 : loopDepthAt(use);
+      auto interval = map_get(reg_active_interval, r, nullptr);
+      bool is_constant =
+          interval != nullptr && vreg_constants_.count(interval->vreg);
+      return std::make_tuple(depth, !is_constant, -use);
+    };
+    auto best_cost = spill_cost(reg);
+    for (auto iter = start; iter != end; ++iter) {
+      PhyLocation r = std::distance(nextUsePos.begin(), iter);
+      auto act_iter = reg_active_interval.find(r);
+      if (*iter <= first_current_use || act_iter == reg_active_interval.end() ||
+          act_iter->second->fixed) {
+        continue;
+      }
+      auto cost = spill_cost(r);
+      if (cost < best_cost) {
+        best_cost = cost;
+        reg = r;
+        reg_use = *iter;
+      }
     }
+  }
+
+  if (first_current_use >= reg_use) {
+    spillUntilNextUse(current, unhandled);
   } else {
     current->allocateTo(reg);
 
@@ -804,7 +911,14 @@ void LinearScanAllocator::allocateBlockedReg(
       active.erase(act_interval);
       unhandled.push(act_interval);
     } else {
-      splitAndSave(act_interval, current_start, unhandled);
+      // Keep the rest of the evicted interval on the stack until it needs a
+      // register again. Queuing it from current_start would let it take a
+      // register from another interval straight away instead.
+      auto rest = act_interval->splitAt(current_start);
+      JIT_DCHECK(
+          rest != nullptr, "The split point must be inside the interval.");
+      spillUntilNextUse(rest.get(), unhandled);
+      allocated_.emplace_back(std::move(rest));
     }
 
     auto inact_iter = reg_inactive_intervals.find(reg);
@@ -848,6 +962,13 @@ LIRLocation LinearScanAllocator::getUseAtOrAfter(
   return *iter;
 }
 
+int LinearScanAllocator::loopDepthAt(LIRLocation loc) const {
+  return std::count_if(
+      loop_ranges_.begin(), loop_ranges_.end(), [&](const LiveRange& range) {
+        return range.isInRange(loc);
+      });
+}
+
 void LinearScanAllocator::markDisallowedRegisters(
     std::vector<LIRLocation>& locs) {
   auto stack_registers = STACK_REGISTERS;
@@ -876,6 +997,21 @@ void LinearScanAllocator::splitAndSave(
   allocated_.emplace_back(std::move(new_interval));
 }
 
+void LinearScanAllocator::spillUntilNextUse(
+    LiveInterval* interval,
+    UnhandledQueue& queue) {
+  interval->allocateTo(getStackSlot(interval->vreg));
+  spilled_vregs_.emplace(
+      map_get(vreg_global_last_use_, interval->vreg), interval->vreg);
+
+  // next_use can be MAX_LOCATION when vreg is in a loop and there is no more
+  // uses after the start of interval
+  auto next_use = getUseAtOrAfter(interval->vreg, interval->startLocation());
+  if (next_use < interval->endLocation()) {
+    splitAndSave(interval, next_use, queue);
+  }
+}
+
 int LinearScanAllocator::getStackSlot(const Operand* operand) {
   int slot = map_get(operand_to_slot_, operand, 0);
   if (slot < 0) {
@@ -1163,7 +1299,7 @@ void LinearScanAllocator::rewriteLIRUpdateMapping(
         *interval);
     if (from != to) {
       TRACE("Copying from %d to %d", from, to);
-      copies->addEdge(from, to, interval->vreg->dataType());
+      addCopy(copies, vreg, from, to, interval->vreg->dataType());
     }
   }
   mapping_iter->second = interval;
@@ -1317,6 +1453,8 @@ LinearScanAllocator::resolveEdgesGenCopies(
     PhyLocation from = 0;
     const OperandBase* from_operand;
     PhyLocation to = 0;
+    // The vreg being moved, if it isn't the input of a phi.
+    const Operand* vreg = nullptr;
 
     if (interval_starts_from_beginning) {
       if (phi != nullptr) {
@@ -1335,7 +1473,7 @@ LinearScanAllocator::resolveEdgesGenCopies(
         // the first instruction could be a define of the same vreg. In that
         // case, we don't need to generate move instructions.
         if (succ_first_instr->output() != interval->vreg) {
-          auto vreg = interval->vreg;
+          vreg = interval->vreg;
           auto from_interval = map_get(end_mapping, vreg, nullptr);
           if (from_interval == nullptr) {
             continue;
@@ -1348,14 +1486,19 @@ LinearScanAllocator::resolveEdgesGenCopies(
         }
       }
     } else {
-      auto vreg = interval->vreg;
+      vreg = interval->vreg;
       auto from_interval = map_get(end_mapping, vreg);
       from = from_interval->allocated_loc;
       from_operand = from_interval->vreg;
       to = interval->allocated_loc;
     }
 
-    if (from != to) {
+    if (from == to) {
+      continue;
+    }
+    if (vreg != nullptr) {
+      addCopy(copies.get(), vreg, from, to, from_operand->dataType());
+    } else {
       copies->addEdge(from, to, from_operand->dataType());
     }
   }
@@ -1363,6 +1506,21 @@ LinearScanAllocator::resolveEdgesGenCopies(
   return copies;
 }
 
+void LinearScanAllocator::addCopy(
+    CopyGraphWithOperand* copies,
+    const Operand* vreg,
+    PhyLocation from,
+    PhyLocation to,
+    OperandBase::DataType type) {
+  auto const_iter = vreg_constants_.find(vreg);
+  if (const_iter != vreg_constants_.end() && !from.is_register() &&
+      to.is_register()) {
+    copies->addRemat(to, const_iter->second, type);
+    return;
+  }
+  copies->addEdge(from, to, type);
+}
+
 void LinearScanAllocator::rewriteLIREmitCopies(
     BasicBlock* block,
     BasicBlock::InstrList::iterator instr_iter,
@@ -1414,6 +1572,15 @@ void LinearScanAllocator::rewriteLIREmitCopies(
       }
     }
   }
+
+  // Each register is written at most once, so loading the constants after the
+  // copies can't clobber a copy's source.
+  for (auto& remat : copies->remats()) {
+    auto instr = block->allocateInstrBefore(instr_iter, Instruction::kMove);
+    instr->allocateImmediateInput(remat.value)->setDataType(remat.type);
+    instr->output()->setPhyRegOrStackSlot(remat.to);
+    instr->output()->setDataType(remat.type);
+  }
 }
 
 // TODO (tiansi): in the (near) future, we need to move the code
@@ -183,11 +183,22 @@ class LinearScanAllocator {
   // the global last use of an operand (vreg)
   UnorderedMap<const lir::Operand*, LIRLocation> vreg_global_last_use_;
 
+  // vregs defined by moving an immediate into them. Instead of being reloaded
+  // from their stack slots after being spilled, these are rematerialized.
+  UnorderedMap<const lir::Operand*, uint64_t> vreg_constants_;
+
+  // The ranges covered by each loop, from the start of the loop header to the
+  // end of the last block that branches back to it.
+  std::vector<LiveRange> loop_ranges_;
+
   int initial_max_stack_slot_;
   // stack slot number always starts from -8, and it's up to the code generator
   // to translate stack slot number into the form of (RBP - offset).
   int max_stack_slot_;
   std::vector<int> free_stack_slots_;
+  // Spilled vregs, ordered by their global last use. Once the scan moves past
+  // that point, the vreg's stack slot can be given to another vreg.
+  OrderedSet<std::pair<LIRLocation, const lir::Operand*>> spilled_vregs_;
 
   jit::codegen::PhyRegisterSet changed_regs_;
 
@@ -200,7 +211,11 @@ class LinearScanAllocator {
 
   void sortBasicBlocks();
   void initialize();
+  // Compute the set of vregs live on entry to each block.
+  UnorderedMap<const lir::BasicBlock*, UnorderedSet<const lir::Operand*>>
+  calculateLiveIn() const;
   void calculateLiveIntervals();
+  void calculateLoopRanges();
 
   void spillRegistersForYield(int instr_id);
   void reserveCallerSaveRegisters(int instr_id);
@@ -240,6 +255,12 @@ class LinearScanAllocator {
       UnorderedSet<LiveInterval*>& inactive,
       UnhandledQueue& unhandled);
   LIRLocation getUseAtOrAfter(const lir::Operand* vreg, LIRLocation loc) const;
+  // The number of loops that loc is in.
+  int loopDepthAt(LIRLocation loc) const;
+
+  // allocate interval to a stack slot up to the next use of its vreg that
+  // needs a register, splitting off the rest into queue.
+  void spillUntilNextUse(LiveInterval* interval, UnhandledQueue& queue);
 
   // split at loc and save the new interval to unhandled and allocated_
   void
@@ -286,8 +307,45 @@ class LinearScanAllocator {
       lir::MemoryIndirect* indirect,
       const UnorderedMap<const lir::Operand*, const LiveInterval*>& mapping);
 
-  using CopyGraphWithOperand =
-      jit::codegen::CopyGraphWithType<const lir::OperandBase::DataType>;
+  // Copies between locations, plus the constants that should be loaded
+  // straight into registers rather than copied from their spill slots.
+  class CopyGraphWithOperand
+      : public jit::codegen::CopyGraphWithType<
+            const lir::OperandBase::DataType> {
+   public:
+    struct Remat {
+      PhyLocation to;
+      uint64_t value;
+      lir::OperandBase::DataType type;
+    };
+
+    void addRemat(
+        PhyLocation to,
+        uint64_t value,
+        lir::OperandBase::DataType type) {
+      remats_.push_back({to, value, type});
+    }
+
+    const std::vector<Remat>& remats() const {
+      return remats_;
+    }
+
+    bool isEmpty() const {
+      return CopyGraph::isEmpty() && remats_.empty();
+    }
+
+   private:
+    std::vector<Remat> remats_;
+  };
+
+  // Record that vreg has to move from one location to another. A constant
+  // moving out of a spill slot into a register is rematerialized instead.
+  void addCopy(
+      CopyGraphWithOperand* copies,
+      const lir::Operand* vreg,
+      PhyLocation from,
+      PhyLocation to,
+      lir::OperandBase::DataType type);
 
   // update virtual register to physical register mapping.
   // if the mapping is changed for a virtual register and copies is not nullptr,
@@ -329,6 +387,8 @@ class LinearScanAllocator {
 
   FRIEND_TEST(LinearScanAllocatorTest, RegAllocationNoSpill);
   FRIEND_TEST(LinearScanAllocatorTest, RegAllocation);
+  FRIEND_TEST(LinearScanAllocatorTest, BackwardEdgeIsNotALoop);
+  FRIEND_TEST(LinearScanAllocatorTest, EvictsValueUsedOutsideInnerLoop);
 };
 
 std::ostream& operator<<(std::ostream& out, const LiveRange& rhs);
@@ -8,8 +8,10 @@
 
 #include "Jit/code_allocator.h"
 #include "Jit/codegen/gen_asm.h"
+#include "Jit/compile_manifest.h"
 #include "Jit/containers.h"
 #include "Jit/frame.h"
+#include "Jit/gen_data_allocator.h"
 #include "Jit/hir/builder.h"
 #include "Jit/hir/preload.h"
 #include "Jit/inline_cache.h"
@@ -29,9 +31,11 @@
 
 #include <dis-asm.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
@@ -61,7 +65,11 @@ struct JitConfig {
   size_t hot_code_section_size{0};
   size_t cold_code_section_size{0};
   int hir_inliner_enabled{0};
+  unsigned int hir_inliner_budget{1000};
   unsigned int auto_jit_threshold{0};
+  int auto_jit_async{0};
+  unsigned int osr_threshold{0};
+  unsigned int recompile_threshold{0};
 };
 static JitConfig jit_config;
 
@@ -89,6 +97,10 @@ unsigned int _PyJIT_GetJitConfigAuto_jit_threshold() {
   return jit_config.auto_jit_threshold;
 }
 
+int _PyJIT_IsJitConfigAuto_jit_async() {
+  return jit_config.auto_jit_async;
+}
+
 namespace {
 // Extra information needed to compile a PyCodeObject.
 struct CodeData {
@@ -110,20 +122,31 @@ static JITList* g_jit_list{nullptr};
 static std::unordered_set<BorrowedRef<>> jit_reg_units;
 // Every unit that is a code object has corresponding entry in jit_code_data.
 static std::unordered_map<BorrowedRef<PyCodeObject>, CodeData> jit_code_data;
+using PreloaderMap = std::unordered_map<BorrowedRef<>, hir::Preloader>;
 // Every unit has an entry in preloaders if we are doing multithreaded compile.
-static std::unordered_map<BorrowedRef<>, hir::Preloader> jit_preloaders;
+static PreloaderMap jit_preloaders;
+// Set on the background compile worker while it compiles a batch without the
+// GIL, so recursive lookups see that batch rather than jit_preloaders.
+static thread_local PreloaderMap* tls_async_preloaders{nullptr};
+
+static PreloaderMap& currentPreloaders() {
+  return tls_async_preloaders != nullptr ? *tls_async_preloaders
+                                         : jit_preloaders;
+}
 
 namespace jit {
 bool isPreloaded(BorrowedRef<PyFunctionObject> func) {
-  return jit_preloaders.find(func) != jit_preloaders.end();
+  PreloaderMap& preloaders = currentPreloaders();
+  return preloaders.find(func) != preloaders.end();
 }
 
 const jit::hir::Preloader& getPreloader(BorrowedRef<PyFunctionObject> func) {
-  auto it = jit_preloaders.find(func);
-  if (it != jit_preloaders.end()) {
+  PreloaderMap& preloaders = currentPreloaders();
+  auto it = preloaders.find(func);
+  if (it != preloaders.end()) {
     return it->second;
   }
-  return map_get_strict(jit_preloaders, func->func_code);
+  return map_get_strict(preloaders, func->func_code);
 }
 } // namespace jit
 
@@ -134,6 +157,10 @@ static std::unordered_map<PyFunctionObject*, std::chrono::duration<double>>
 // shutdown.
 static std::string g_write_profile_file;
 
+// If non-empty, a compile manifest will be written to this filename at
+// shutdown.
+static std::string g_write_compile_manifest_file;
+
 // Frequently-used strings that we intern at JIT startup and hold references to.
 #define INTERNED_STRINGS(X) \
   X(bc_offset)              \
@@ -219,12 +246,14 @@ static jit::FlagProcessor xarg_flag_processor;
 static int use_jit = 0;
 static int jit_help = 0;
 static std::string write_profile_file;
+static std::string compile_manifest_file;
 static int jit_profile_interp = 0;
 static std::string jl_fn;
 
 void initFlagProcessor() {
   use_jit = 0;
   write_profile_file = "";
+  compile_manifest_file = "";
   jit_profile_interp = 0;
   jl_fn = "";
   jit_help = 0;
@@ -244,6 +273,41 @@ void initFlagProcessor() {
         "Enable auto-JIT mode, which compiles functions after the given "
         "threshold");
 
+    xarg_flag_processor.addOption(
+        "jit-auto-async",
+        "PYTHONJITAUTOASYNC",
+        [](int val) {
+          if (use_jit) {
+            jit_config.auto_jit_async = val;
+          }
+        },
+        "In auto-JIT mode, compile functions that reach the threshold on a "
+        "background thread instead of at the call site");
+
+    xarg_flag_processor.addOption(
+        "jit-osr",
+        "PYTHONJITOSR",
+        [](unsigned int threshold) {
+          if (use_jit) {
+            jit_config.osr_threshold = threshold;
+          }
+        },
+        "Enable on-stack replacement, which moves a running interpreted frame "
+        "into JIT-compiled code once its code object has taken the given "
+        "number of loop back edges");
+
+    xarg_flag_processor.addOption(
+        "jit-recompile-threshold",
+        "PYTHONJITRECOMPILETHRESHOLD",
+        [](unsigned int threshold) {
+          if (use_jit) {
+            jit_config.recompile_threshold = threshold;
+          }
+        },
+        "Invalidate and recompile a JIT-compiled function once one of its "
+        "speculative guards has failed this many times, without the failing "
+        "speculation");
+
     xarg_flag_processor.addOption(
         "jit-debug",
         "PYTHONJITDEBUG",
@@ -430,6 +494,16 @@ void initFlagProcessor() {
             "Write profiling data to <filename>")
         .withFlagParamName("filename");
 
+    xarg_flag_processor
+        .addOption(
+            "jit-compile-manifest",
+            "PYTHONJITCOMPILEMANIFEST",
+            compile_manifest_file,
+            "Compile functions listed in <filename> on their first call in "
+            "auto-JIT mode, and record all compiled functions there at exit. "
+            "Only the list of functions is kept, not their compiled code")
+        .withFlagParamName("filename");
+
     xarg_flag_processor.addOption(
         "jit-profile-interp",
         "PYTHONJITPROFILEINTERP",
@@ -518,6 +592,17 @@ void initFlagProcessor() {
         },
         "Enable the JIT's HIR inliner");
 
+    xarg_flag_processor.addOption(
+        "jit-hir-inliner-budget",
+        "PYTHONJITHIRINLINERBUDGET",
+        [](unsigned int budget) {
+          if (use_jit) {
+            jit_config.hir_inliner_budget = budget;
+          }
+        },
+        "Maximum number of bytecode instructions the HIR inliner may inline "
+        "into a single function");
+
     xarg_flag_processor.addOption(
         "jit-dump-hir-passes-json",
         "PYTHONJITDUMPHIRPASSESJSON",
@@ -615,32 +700,11 @@ static void compile_worker_thread() {
   JIT_DLOG("Finished compile worker in thread %d", std::this_thread::get_id());
 }
 
-static void multithread_compile_all() {
-  JIT_CHECK(jit_ctx, "JIT not initialized");
-
-  std::vector<BorrowedRef<>> compilation_units;
-  // first we have to preload everything we are going to compile
-  while (jit_reg_units.size() > 0) {
-    std::vector<BorrowedRef<>> preload_units = {
-        jit_reg_units.begin(), jit_reg_units.end()};
-    jit_reg_units.clear();
-    for (auto unit : preload_units) {
-      compilation_units.push_back(unit);
-      if (PyFunction_Check(unit)) {
-        BorrowedRef<PyFunctionObject> func(unit);
-        jit_preloaders.emplace(unit, func);
-      } else {
-        JIT_CHECK(PyCode_Check(unit), "Expected function or code object");
-        BorrowedRef<PyCodeObject> code(unit);
-        const CodeData& data = map_get(jit_code_data, code);
-        jit_preloaders.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(unit),
-            std::forward_as_tuple(
-                code, data.globals, codeFullname(data.module, code)));
-      }
-    }
-  }
+// Compile the given units, all of which must already have an entry in
+// jit_preloaders, using jit_config.batch_compile_workers threads. Clears
+// jit_preloaders when done.
+static void multithread_compile_preloaded(
+    std::vector<BorrowedRef<>>&& compilation_units) {
   // Disable checks for using GIL protected data across threads.
   // Conceptually what we're doing here is saying we're taking our own
   // responsibility for managing locking of CPython runtime data structures.
@@ -677,6 +741,324 @@ static void multithread_compile_all() {
   jit_preloaders.clear();
 }
 
+// Add a Preloader for the given function or code object to jit_preloaders.
+static void preloadUnit(BorrowedRef<> unit) {
+  if (PyFunction_Check(unit)) {
+    BorrowedRef<PyFunctionObject> func(unit);
+    jit_preloaders.emplace(unit, func);
+  } else {
+    JIT_CHECK(PyCode_Check(unit), "Expected function or code object");
+    BorrowedRef<PyCodeObject> code(unit);
+    const CodeData& data = map_get(jit_code_data, code);
+    jit_preloaders.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(unit),
+        std::forward_as_tuple(
+            code, data.globals, codeFullname(data.module, code)));
+  }
+}
+
+static void multithread_compile_all() {
+  JIT_CHECK(jit_ctx, "JIT not initialized");
+
+  std::vector<BorrowedRef<>> compilation_units;
+  // first we have to preload everything we are going to compile
+  while (jit_reg_units.size() > 0) {
+    std::vector<BorrowedRef<>> preload_units = {
+        jit_reg_units.begin(), jit_reg_units.end()};
+    jit_reg_units.clear();
+    for (auto unit : preload_units) {
+      compilation_units.push_back(unit);
+      preloadUnit(unit);
+    }
+  }
+  multithread_compile_preloaded(std::move(compilation_units));
+}
+
+// As multithread_compile_all(), but only for the given registered units.
+static void multithread_compile_units(std::vector<BorrowedRef<>> units) {
+  JIT_CHECK(jit_ctx, "JIT not initialized");
+  for (auto unit : units) {
+    jit_reg_units.erase(unit);
+    preloadUnit(unit);
+  }
+  multithread_compile_preloaded(std::move(units));
+}
+
+namespace {
+
+// Functions that crossed the auto-JIT threshold while jit-auto-async is
+// enabled. The queue holds strong references and is only ever read or written
+// with the GIL held, which keeps it consistent across fork(). The mutex and
+// condition variable are only used to wake up the worker thread. The worker
+// itself only holds the GIL to preload a batch and to publish its results; see
+// compileAsyncQueue().
+struct AsyncCompileState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool pending{false};
+  bool stop{false};
+  std::thread worker;
+};
+
+AsyncCompileState* g_async_compile{nullptr};
+// Set once the worker has been stopped at exit, after which functions are
+// compiled at the call site again.
+bool g_async_compile_stopped{false};
+std::vector<Ref<PyFunctionObject>> g_async_compile_queue;
+// The batch the worker is compiling. Only touched with the GIL held, so a
+// forked child can put it back on the queue.
+std::vector<Ref<PyFunctionObject>> g_async_compile_inflight;
+size_t g_async_compile_count{0};
+
+// Compile everything currently in g_async_compile_queue. Must be called with
+// the GIL held.
+//
+// Everything the compiler reads from Python objects is preloaded up front, as
+// for a multithreaded batch compile. The GIL is then released for HIR
+// construction, optimization and code generation, so other threads keep
+// running Python code meanwhile. The sections that touch shared runtime state
+// (refcounts, the code allocator, installing the entry point) are marked with
+// ThreadedCompileSerialize, which reacquires the GIL on this thread.
+void compileAsyncQueue() {
+  JIT_CHECK(g_async_compile_inflight.empty(), "Overlapping async batches");
+  g_async_compile_inflight.swap(g_async_compile_queue);
+  if (jit_ctx == nullptr || !_PyJIT_IsEnabled()) {
+    g_async_compile_inflight.clear();
+    return;
+  }
+
+  PreloaderMap preloaders;
+  std::vector<BorrowedRef<>> compilation_units;
+  for (auto& func : g_async_compile_inflight) {
+    BorrowedRef<> unit(reinterpret_cast<PyObject*>(func.get()));
+    if (_PyJIT_IsCompiled(func) || preloaders.count(unit) != 0) {
+      continue;
+    }
+    preloaders.emplace(unit, BorrowedRef<PyFunctionObject>(func));
+    compilation_units.emplace_back(unit);
+  }
+
+  if (!compilation_units.empty()) {
+    JIT_DLOG("Background compile of %d functions", compilation_units.size());
+    tls_async_preloaders = &preloaders;
+    g_threaded_compile_context.setCompilingWithoutGIL(true);
+    Py_BEGIN_ALLOW_THREADS;
+    // A unit comes back as PYJIT_RESULT_RETRY when another thread was
+    // compiling the same code at the time; give it one more chance.
+    std::vector<BorrowedRef<>> retry_units;
+    for (auto unit : compilation_units) {
+      if (_PyJITContext_CompilePreloader(jit_ctx, preloaders.at(unit)) ==
+          PYJIT_RESULT_RETRY) {
+        retry_units.emplace_back(unit);
+      }
+    }
+    for (auto unit : retry_units) {
+      _PyJITContext_CompilePreloader(jit_ctx, preloaders.at(unit));
+    }
+    Py_END_ALLOW_THREADS;
+    g_threaded_compile_context.setCompilingWithoutGIL(false);
+    tls_async_preloaders = nullptr;
+    g_async_compile_count += compilation_units.size();
+  }
+
+  // Release the Preloaders' and the batch's references with the GIL held.
+  preloaders.clear();
+  g_async_compile_inflight.clear();
+}
+
+void async_compile_worker_thread(AsyncCompileState* state) {
+  JIT_DLOG(
+      "Started background compile worker in thread %d",
+      std::this_thread::get_id());
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock{state->mutex};
+      state->cv.wait(lock, [state] { return state->pending || state->stop; });
+      if (state->stop) {
+        break;
+      }
+      state->pending = false;
+    }
+    PyGILState_STATE gil_state = PyGILState_Ensure();
+    compileAsyncQueue();
+    PyGILState_Release(gil_state);
+  }
+  JIT_DLOG(
+      "Finished background compile worker in thread %d",
+      std::this_thread::get_id());
+}
+
+// Stop and join the background worker, dropping anything left in the queue.
+// Must be called with the GIL held; the GIL is released while waiting for the
+// worker to finish its current batch.
+void stopAsyncCompileWorker() {
+  if (g_async_compile == nullptr) {
+    return;
+  }
+  AsyncCompileState* state = g_async_compile;
+  g_async_compile = nullptr;
+  g_async_compile_stopped = true;
+  {
+    std::lock_guard<std::mutex> lock{state->mutex};
+    state->stop = true;
+  }
+  state->cv.notify_one();
+  Py_BEGIN_ALLOW_THREADS;
+  state->worker.join();
+  Py_END_ALLOW_THREADS;
+  delete state;
+  g_async_compile_queue.clear();
+}
+
+} // namespace
+
+static PyObject* stop_async_compile_worker(PyObject*, PyObject*) {
+  stopAsyncCompileWorker();
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef stop_async_compile_worker_def = {
+    "_stop_async_compile_worker",
+    stop_async_compile_worker,
+    METH_NOARGS,
+    nullptr};
+
+// Start the background worker and arrange for it to be stopped from an atexit
+// callback, which runs while other threads can still acquire the GIL.
+static bool startAsyncCompileWorker() {
+  auto stop_func = Ref<>::steal(
+      PyCFunction_New(&stop_async_compile_worker_def, nullptr));
+  if (stop_func == nullptr) {
+    return false;
+  }
+  auto atexit = Ref<>::steal(PyImport_ImportModule("atexit"));
+  if (atexit == nullptr) {
+    return false;
+  }
+  auto result = Ref<>::steal(
+      PyObject_CallMethod(atexit, "register", "O", stop_func.get()));
+  if (result == nullptr) {
+    return false;
+  }
+
+  g_async_compile = new AsyncCompileState();
+  g_async_compile->worker =
+      std::thread(async_compile_worker_thread, g_async_compile);
+  return true;
+}
+
+static void wakeAsyncCompileWorker() {
+  {
+    std::lock_guard<std::mutex> lock{g_async_compile->mutex};
+    g_async_compile->pending = true;
+  }
+  g_async_compile->cv.notify_one();
+}
+
+int _PyJIT_ScheduleCompile(PyFunctionObject* func) {
+  if (!jit_config.auto_jit_async || g_async_compile_stopped ||
+      jit_ctx == nullptr || !_PyJIT_IsEnabled() || !_PyJIT_OnJitList(func)) {
+    return 0;
+  }
+  if (g_async_compile == nullptr && !startAsyncCompileWorker()) {
+    // Fall back to compiling at the call site.
+    PyErr_Clear();
+    return 0;
+  }
+  g_async_compile_queue.emplace_back(func);
+  wakeAsyncCompileWorker();
+  return 1;
+}
+
+// Return the code objects of everything compiled by jit_ctx.
+static std::vector<BorrowedRef<PyCodeObject>> compiledCodes() {
+  std::vector<BorrowedRef<PyCodeObject>> codes;
+  for (auto& entry : jit_ctx->compiled_codes) {
+    codes.emplace_back(entry.first.code);
+  }
+  return codes;
+}
+
+static PyObject* write_compile_manifest(PyObject*, PyObject* filename) {
+  if (!PyUnicode_Check(filename)) {
+    PyErr_SetString(PyExc_TypeError, "filename must be a str");
+    return nullptr;
+  }
+  const char* filename_str = PyUnicode_AsUTF8(filename);
+  if (filename_str == nullptr) {
+    return nullptr;
+  }
+  if (!writeCompileManifest(filename_str, compiledCodes())) {
+    PyErr_Format(
+        PyExc_OSError, "Failed to write compile manifest to %s", filename_str);
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+int _PyJIT_InCompileManifest(PyCodeObject* code) {
+  return inCompileManifest(code);
+}
+
+// Number of times an interpreted frame has been moved into an OSR entry.
+static size_t g_osr_entry_count{0};
+
+// Frames that are currently running in an OSR entry. If one of them deopts,
+// the interpreter resumes it in a nested call, and entering OSR again from
+// there would grow the C stack on every deopt.
+static std::unordered_set<PyFrameObject*> g_osr_frames;
+
+static PyObject* get_osr_stats(PyObject*, PyObject*) {
+  auto stats = Ref<>::steal(PyDict_New());
+  if (stats == nullptr) {
+    return nullptr;
+  }
+  size_t num_compiled = 0;
+  size_t num_failed = 0;
+  if (jit_ctx != nullptr) {
+    for (auto& entry : jit_ctx->osr_codes) {
+      if (entry.second == nullptr) {
+        num_failed++;
+      } else {
+        num_compiled++;
+      }
+    }
+  }
+  auto compiled = Ref<>::steal(PyLong_FromSize_t(num_compiled));
+  if (compiled == nullptr ||
+      PyDict_SetItemString(stats, "compiled", compiled) < 0) {
+    return nullptr;
+  }
+  auto failed = Ref<>::steal(PyLong_FromSize_t(num_failed));
+  if (failed == nullptr || PyDict_SetItemString(stats, "failed", failed) < 0) {
+    return nullptr;
+  }
+  auto entered = Ref<>::steal(PyLong_FromSize_t(g_osr_entry_count));
+  if (entered == nullptr ||
+      PyDict_SetItemString(stats, "entered", entered) < 0) {
+    return nullptr;
+  }
+  return stats.release();
+}
+
+static PyObject* get_async_compile_stats(PyObject*, PyObject*) {
+  auto stats = Ref<>::steal(PyDict_New());
+  if (stats == nullptr) {
+    return nullptr;
+  }
+  auto queued = Ref<>::steal(PyLong_FromSize_t(g_async_compile_queue.size()));
+  if (queued == nullptr || PyDict_SetItemString(stats, "queued", queued) < 0) {
+    return nullptr;
+  }
+  auto compiled = Ref<>::steal(PyLong_FromSize_t(g_async_compile_count));
+  if (compiled == nullptr ||
+      PyDict_SetItemString(stats, "compiled", compiled) < 0) {
+    return nullptr;
+  }
+  return stats.release();
+}
+
 static PyObject* multithreaded_compile_test(PyObject*, PyObject*) {
   if (!jit_config.multithreaded_compile_test) {
     PyErr_SetString(
@@ -700,6 +1082,128 @@ static PyObject* multithreaded_compile_test(PyObject*, PyObject*) {
   Py_RETURN_NONE;
 }
 
+// The code object of a registered compilation unit.
+static BorrowedRef<PyCodeObject> unitCode(BorrowedRef<> unit) {
+  if (PyFunction_Check(unit)) {
+    return reinterpret_cast<PyCodeObject*>(
+        reinterpret_cast<PyFunctionObject*>(unit.get())->func_code);
+  }
+  return BorrowedRef<PyCodeObject>(unit);
+}
+
+static PyObject* precompile_before_fork(
+    PyObject* /* self */,
+    PyObject* const* args,
+    Py_ssize_t nargs) {
+  if (nargs > 2) {
+    PyErr_SetString(
+        PyExc_TypeError, "precompile_before_fork expects at most 2 args");
+    return NULL;
+  }
+  if (jit_ctx == nullptr || !_PyJIT_IsEnabled()) {
+    PyErr_SetString(PyExc_RuntimeError, "JIT is not enabled");
+    return NULL;
+  }
+
+  std::unique_ptr<JITList> jit_list;
+  if (nargs > 0 && args[0] != Py_None) {
+    if (!PyUnicode_Check(args[0])) {
+      PyErr_SetString(PyExc_TypeError, "jit list path must be a str or None");
+      return NULL;
+    }
+    jit_list = JITList::create();
+    if (jit_list == nullptr) {
+      return NULL;
+    }
+    const char* path = PyUnicode_AsUTF8(args[0]);
+    if (path == nullptr) {
+      return NULL;
+    }
+    if (!jit_list->parseFile(path)) {
+      PyErr_Format(PyExc_ValueError, "Failed to parse JIT list '%s'", path);
+      return NULL;
+    }
+  }
+  Py_ssize_t max_units = 0;
+  if (nargs > 1) {
+    max_units = PyLong_AsSsize_t(args[1]);
+    if (max_units == -1 && PyErr_Occurred()) {
+      return NULL;
+    }
+  }
+
+  std::vector<BorrowedRef<>> units;
+  for (auto unit : jit_reg_units) {
+    if (jit_list != nullptr) {
+      int listed = PyFunction_Check(unit)
+          ? jit_list->lookup(BorrowedRef<PyFunctionObject>(unit))
+          : jit_list->lookupCO(BorrowedRef<PyCodeObject>(unit));
+      if (listed < 0) {
+        return NULL;
+      }
+      if (!listed) {
+        continue;
+      }
+    }
+    units.push_back(unit);
+  }
+  // Without a list, prefer the code the master process has run the most.
+  std::stable_sort(
+      units.begin(), units.end(), [](BorrowedRef<> a, BorrowedRef<> b) {
+        return unitCode(a)->co_cache.ncalls > unitCode(b)->co_cache.ncalls;
+      });
+  if (max_units > 0 && units.size() > static_cast<size_t>(max_units)) {
+    units.resize(max_units);
+  }
+
+  size_t num_units = units.size();
+  if (jit_config.batch_compile_workers > 0) {
+    multithread_compile_units(std::move(units));
+  } else {
+    for (auto unit : units) {
+      jit_reg_units.erase(unit);
+      compileUnit(unit);
+    }
+  }
+  CodeAllocator::get()->seal();
+  JIT_DLOG(
+      "Compiled %d units before fork, sealing %d bytes of code",
+      num_units,
+      CodeAllocator::get()->sealedBytes());
+  return PyLong_FromSize_t(num_units);
+}
+
+static PyObject* get_prefork_page_stats(PyObject*, PyObject*) {
+  CodeAllocator* allocator = CodeAllocator::get();
+  size_t sealed_bytes = allocator->sealedBytes();
+  if (sealed_bytes == 0) {
+    Py_RETURN_NONE;
+  }
+  CodeAllocator::SealedPageStats page_stats = allocator->sealedPageStats();
+  auto stats = Ref<>::steal(PyDict_New());
+  if (stats == nullptr) {
+    return nullptr;
+  }
+  auto add_stat = [&](const char* name, size_t value) {
+    auto value_obj = Ref<>::steal(PyLong_FromSize_t(value));
+    return value_obj != nullptr &&
+        PyDict_SetItemString(stats, name, value_obj) == 0;
+  };
+  if (!add_stat("sealed_bytes", sealed_bytes) ||
+      !add_stat("resident_pages", page_stats.resident_pages) ||
+      !add_stat("shared_pages", page_stats.shared_pages)) {
+    return nullptr;
+  }
+  return stats.release();
+}
+
+static PyObject* reclaim_code(PyObject*, PyObject*) {
+  if (jit_ctx == nullptr) {
+    return PyLong_FromLong(0);
+  }
+  return PyLong_FromLong(_PyJITContext_ReclaimCode(jit_ctx));
+}
+
 static PyObject* is_multithreaded_compile_test_enabled(PyObject*, PyObject*) {
   if (jit_config.multithreaded_compile_test) {
     Py_RETURN_TRUE;
@@ -1101,38 +1605,78 @@ static PyObject* jit_suppress(PyObject*, PyObject* func_obj) {
   return func_obj;
 }
 
-static PyObject* get_allocator_stats(PyObject*, PyObject*) {
-  if (!_PyJIT_UseHugePages()) {
-    Py_RETURN_NONE;
+static int add_gen_data_stats(PyObject* stats) {
+  auto blocks = Ref<>::steal(PyDict_New());
+  auto slabs = Ref<>::steal(PyDict_New());
+  if (blocks == NULL || slabs == NULL) {
+    return -1;
+  }
+  for (size_t i = 0; i < GenDataAllocator::kNumSizeClasses; i++) {
+    auto cls_stats = GenDataAllocator::sizeClassStats(i);
+    auto words = Ref<>::steal(PyLong_FromSize_t(cls_stats.spill_words));
+    auto live = Ref<>::steal(PyLong_FromSize_t(cls_stats.live_blocks));
+    auto num_slabs = Ref<>::steal(PyLong_FromSize_t(cls_stats.slabs));
+    if (words == NULL || live == NULL || num_slabs == NULL ||
+        PyDict_SetItem(blocks, words, live) < 0 ||
+        PyDict_SetItem(slabs, words, num_slabs) < 0) {
+      return -1;
+    }
   }
+  auto large_blocks =
+      Ref<>::steal(PyLong_FromSize_t(GenDataAllocator::largeBlocks()));
+  if (large_blocks == NULL ||
+      PyDict_SetItemString(stats, "gen_data_blocks", blocks) < 0 ||
+      PyDict_SetItemString(stats, "gen_data_slabs", slabs) < 0 ||
+      PyDict_SetItemString(stats, "gen_data_large_blocks", large_blocks) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+static PyObject* get_allocator_stats(PyObject*, PyObject*) {
   auto stats = Ref<>::steal(PyDict_New());
-  if (stats == NULL) {
+  if (stats == NULL || add_gen_data_stats(stats) < 0) {
     return NULL;
   }
+  if (!_PyJIT_UseHugePages()) {
+    return stats.release();
+  }
   auto used_bytes =
-      Ref<>::steal(PyLong_FromLong(CodeAllocatorCinder::usedBytes()));
+      Ref<>::steal(PyLong_FromSize_t(CodeAllocatorCinder::usedBytes()));
   if (used_bytes == NULL ||
       PyDict_SetItemString(stats, "used_bytes", used_bytes) < 0) {
     return NULL;
   }
   auto lost_bytes =
-      Ref<>::steal(PyLong_FromLong(CodeAllocatorCinder::lostBytes()));
+      Ref<>::steal(PyLong_FromSize_t(CodeAllocatorCinder::lostBytes()));
   if (lost_bytes == NULL ||
       PyDict_SetItemString(stats, "lost_bytes", lost_bytes) < 0) {
     return NULL;
   }
   auto fragmented_allocs =
-      Ref<>::steal(PyLong_FromLong(CodeAllocatorCinder::fragmentedAllocs()));
+      Ref<>::steal(PyLong_FromSize_t(CodeAllocatorCinder::fragmentedAllocs()));
   if (fragmented_allocs == NULL ||
       PyDict_SetItemString(stats, "fragmented_allocs", fragmented_allocs) < 0) {
     return NULL;
   }
   auto huge_allocs =
-      Ref<>::steal(PyLong_FromLong(CodeAllocatorCinder::hugeAllocs()));
+      Ref<>::steal(PyLong_FromSize_t(CodeAllocatorCinder::hugeAllocs()));
   if (huge_allocs == NULL ||
       PyDict_SetItemString(stats, "huge_allocs", huge_allocs) < 0) {
     return NULL;
   }
+  auto free_bytes =
+      Ref<>::steal(PyLong_FromSize_t(CodeAllocatorCinder::freeBytes()));
+  if (free_bytes == NULL ||
+      PyDict_SetItemString(stats, "free_bytes", free_bytes) < 0) {
+    return NULL;
+  }
+  auto fragmented_bytes =
+      Ref<>::steal(PyLong_FromSize_t(CodeAllocatorCinder::fragmentedBytes()));
+  if (fragmented_bytes == NULL ||
+      PyDict_SetItemString(stats, "fragmented_bytes", fragmented_bytes) < 0) {
+    return NULL;
+  }
   return stats.release();
 }
 
@@ -1159,6 +1703,26 @@ static PyMethodDef jit_methods[] = {
      (PyCFunction)(void*)disable_jit,
      METH_FASTCALL,
      "Disable the jit."},
+    {"precompile_before_fork",
+     (PyCFunction)(void*)precompile_before_fork,
+     METH_FASTCALL,
+     "precompile_before_fork(jit_list_path=None, max_units=0)\n"
+     "Compile pending functions, restricted to those on the given JIT list or "
+     "else the max_units most-called ones, then seal the code allocator so "
+     "that processes forked afterwards share the compiled code. Returns the "
+     "number of units selected for compilation."},
+    {"get_prefork_page_stats",
+     get_prefork_page_stats,
+     METH_NOARGS,
+     "Return how many of the code pages sealed by precompile_before_fork() are "
+     "resident and still shared with other processes, or None if nothing was "
+     "sealed."},
+    {"reclaim_code",
+     reclaim_code,
+     METH_NOARGS,
+     "Free the memory of compiled code that can no longer run, e.g. because "
+     "its function was recompiled or its module was reloaded. Returns the "
+     "number of compiled functions freed."},
     {"disassemble", disassemble, METH_O, "Disassemble JIT compiled functions"},
     {"is_jit_compiled",
      is_jit_compiled,
@@ -1237,10 +1801,26 @@ static PyMethodDef jit_methods[] = {
      METH_NOARGS,
      "Return the number of milliseconds spent in batch compilation when "
      "disabling the JIT."},
+    {"get_async_compile_stats",
+     get_async_compile_stats,
+     METH_NOARGS,
+     "Return the number of functions queued for and attempted by background "
+     "auto-JIT compilation as a dictionary."},
+    {"get_osr_stats",
+     get_osr_stats,
+     METH_NOARGS,
+     "Return the number of OSR entries compiled, the number that failed to "
+     "compile, and the number of times frames entered them as a dictionary."},
+    {"write_compile_manifest",
+     write_compile_manifest,
+     METH_O,
+     "Write a manifest of all JIT-compiled code objects to the given file, for "
+     "use with -X jit-compile-manifest."},
     {"get_allocator_stats",
      get_allocator_stats,
      METH_NOARGS,
-     "Return stats from the code allocator as a dictionary."},
+     "Return stats from the code and generator data allocators as a "
+     "dictionary."},
     {"is_hir_inliner_enabled",
      is_hir_inliner_enabled,
      METH_NOARGS,
@@ -1298,6 +1878,106 @@ int _PyJIT_OnJitList(PyFunctionObject* func) {
   return onJitListImpl(func->func_code, func->func_module, func->func_qualname);
 }
 
+int _PyJIT_OSREnter(
+    PyFrameObject* frame,
+    int target,
+    PyObject** stack_pointer,
+    PyObject** result) {
+  if (jit_ctx == nullptr || !_PyJIT_IsEnabled() ||
+      g_threaded_compile_context.compileRunning()) {
+    return 0;
+  }
+
+  PyThreadState* tstate = PyThreadState_GET();
+  BorrowedRef<PyCodeObject> code = frame->f_code;
+  int required_flags = CO_OPTIMIZED | CO_NEWLOCALS;
+  int prohibited_flags =
+      CO_SUPPRESS_JIT | CO_STATICALLY_COMPILED | kCoFlagsAnyGenerator;
+  // The JIT doesn't know about tracing or a materialized f_locals dict, and
+  // generators keep their state outside of the stack, so leave those in the
+  // interpreter.
+  if ((code->co_flags & required_flags) != required_flags ||
+      (code->co_flags & prohibited_flags) != 0 || frame->f_gen != nullptr ||
+      frame->f_locals != nullptr || frame->f_trace != nullptr ||
+      tstate->use_tracing || !PyDict_CheckExact(frame->f_globals) ||
+      g_osr_frames.count(frame)) {
+    return 0;
+  }
+  BorrowedRef<> module = PyDict_GetItemString(frame->f_globals, "__name__");
+  if (!onJitListImpl(code, module, code->co_qualname)) {
+    return 0;
+  }
+
+  jit::hir::OSREntry osr_entry;
+  osr_entry.offset = target;
+  osr_entry.stack_depth = stack_pointer - frame->f_valuestack;
+  for (int i = 0; i < frame->f_iblock; i++) {
+    const PyTryBlock& block = frame->f_blockstack[i];
+    if (block.b_type != SETUP_FINALLY) {
+      // Exception handlers always run in the interpreter.
+      return 0;
+    }
+    osr_entry.block_stack.push(jit::hir::ExecutionBlock{
+        block.b_type, block.b_handler, block.b_level});
+  }
+  for (PyObject** sp = frame->f_valuestack; sp < stack_pointer; sp++) {
+    if (*sp == nullptr) {
+      return 0;
+    }
+  }
+
+  jit::CompiledFunction* compiled = _PyJITContext_CompileOSREntry(
+      jit_ctx,
+      code,
+      frame->f_globals,
+      codeFullname(module, code),
+      osr_entry);
+  if (compiled == nullptr) {
+    PyErr_Clear();
+    return 0;
+  }
+
+  // Move the locals, cells, and value stack out of the frame and into the
+  // arguments of the OSR entry. The compiled code borrows them for the
+  // duration of the call, and deopt writes whatever it needs back into the
+  // frame.
+  Py_ssize_t nvars = code->co_nlocals + PyTuple_GET_SIZE(code->co_cellvars) +
+      PyTuple_GET_SIZE(code->co_freevars);
+  std::vector<PyObject*> args;
+  args.reserve(nvars + osr_entry.stack_depth);
+  for (Py_ssize_t i = 0; i < nvars; i++) {
+    args.push_back(frame->f_localsplus[i]);
+    frame->f_localsplus[i] = nullptr;
+  }
+  for (PyObject** sp = frame->f_valuestack; sp < stack_pointer; sp++) {
+    args.push_back(*sp);
+    *sp = nullptr;
+  }
+  frame->f_iblock = 0;
+
+  // The compiled code links in its own shadow frame for this frame.
+  _PyShadowFrame* shadow_frame = tstate->shadow_frame;
+  _PyShadowFrame_Pop(tstate, shadow_frame);
+  g_osr_entry_count++;
+  g_osr_frames.insert(frame);
+  *result = compiled->Invoke(nullptr, args.data(), args.size());
+  g_osr_frames.erase(frame);
+  _PyShadowFrame_PushInterp(tstate, shadow_frame, frame);
+
+  for (PyObject* arg : args) {
+    Py_XDECREF(arg);
+  }
+  return 1;
+}
+
+unsigned int _PyJIT_OSRThreshold() {
+  return jit_config.osr_threshold;
+}
+
+int _PyJIT_IsOSREnabled() {
+  return _PyJIT_OSRThreshold() > 0;
+}
+
 int _PyJIT_Initialize() {
   if (jit_config.init_state == JIT_INITIALIZED) {
     return 0;
@@ -1365,10 +2045,28 @@ int _PyJIT_Initialize() {
     return 0;
   }
 
+  if (!compile_manifest_file.empty()) {
+    // A missing manifest is expected on the first run.
+    if (access(compile_manifest_file.c_str(), F_OK) == 0) {
+      readCompileManifest(compile_manifest_file);
+    }
+    g_write_compile_manifest_file = compile_manifest_file;
+  }
+
   CodeAllocator::makeGlobalCodeAllocator();
 
   jit_ctx = new _PyJITContext();
 
+  if (jit_config.recompile_threshold > 0) {
+    Runtime* runtime = Runtime::get();
+    runtime->setRecompileThreshold(jit_config.recompile_threshold);
+    runtime->setInvalidateCallback([](CodeRuntime* code_rt) {
+      if (jit_ctx != nullptr) {
+        _PyJITContext_InvalidateCode(jit_ctx, code_rt);
+      }
+    });
+  }
+
   PyObject* mod = PyModule_Create(&jit_module);
   if (mod == NULL) {
     return -1;
@@ -1409,6 +2107,23 @@ int _PyJIT_IsEnabled() {
 
 void _PyJIT_AfterFork_Child() {
   perf::afterForkChild();
+  if (g_async_compile != nullptr) {
+    // The worker thread doesn't exist in the child, and its mutex may have
+    // been held at the time of the fork. Leak the old state, requeue whatever
+    // it was compiling, and start a fresh worker if anything is queued.
+    g_async_compile = nullptr;
+    for (auto& func : g_async_compile_inflight) {
+      g_async_compile_queue.emplace_back(std::move(func));
+    }
+    g_async_compile_inflight.clear();
+    if (!g_async_compile_queue.empty()) {
+      if (startAsyncCompileWorker()) {
+        wakeAsyncCompileWorker();
+      } else {
+        PyErr_Clear();
+      }
+    }
+  }
 }
 
 int _PyJIT_AreTypeSlotsEnabled() {
@@ -1436,6 +2151,10 @@ int _PyJIT_IsHIRInlinerEnabled() {
   return jit_config.hir_inliner_enabled;
 }
 
+unsigned int _PyJIT_HIRInlinerBudget() {
+  return jit_config.hir_inliner_budget;
+}
+
 int _PyJIT_MultipleCodeSectionsEnabled() {
   return jit_config.multiple_code_sections;
 }
@@ -1490,8 +2209,9 @@ _PyJIT_Result _PyJIT_CompileFunction(PyFunctionObject* func) {
     // we were called recursively (by emitInvokeFunction);
     // find preloader in global map and compile it.
 
-    auto it = jit_preloaders.find(func->func_code);
-    if (it == jit_preloaders.end()) {
+    PreloaderMap& preloaders = currentPreloaders();
+    auto it = preloaders.find(func->func_code);
+    if (it == preloaders.end()) {
       return PYJIT_RESULT_NO_PRELOADER;
     }
     return _PyJITContext_CompilePreloader(jit_ctx, it->second);
@@ -1648,6 +2368,16 @@ int _PyJIT_Finalize() {
   }
   clearProfileData();
 
+  if (!g_write_compile_manifest_file.empty() && jit_ctx != nullptr) {
+    writeCompileManifest(g_write_compile_manifest_file, compiledCodes());
+    g_write_compile_manifest_file.clear();
+  }
+  clearCompileManifest();
+
+  // The background compile worker is stopped by an atexit callback; drop
+  // anything that was queued after that.
+  g_async_compile_queue.clear();
+
   // Always release references from Runtime objects: C++ clients may have
   // invoked the JIT directly without initializing a full _PyJITContext.
   jit::Runtime::get()->clearDeoptStats();
@@ -1802,6 +2532,28 @@ PyObject* _PyJIT_GetGlobals(PyThreadState* tstate) {
   return code_rt->frameState()->globals();
 }
 
+// Return the truthiness of obj if it can be found without running any code,
+// or -1 if it can't.
+static int knownTruthiness(PyObject* obj) {
+  if (obj == Py_True) {
+    return 1;
+  }
+  if (obj == Py_False || obj == Py_None) {
+    return 0;
+  }
+  if (PyLong_CheckExact(obj) || PyTuple_CheckExact(obj) ||
+      PyList_CheckExact(obj)) {
+    return Py_SIZE(obj) != 0;
+  }
+  if (PyDict_CheckExact(obj)) {
+    return PyDict_GET_SIZE(obj) != 0;
+  }
+  if (PyUnicode_CheckExact(obj)) {
+    return PyUnicode_GET_LENGTH(obj) != 0;
+  }
+  return -1;
+}
+
 void _PyJIT_ProfileCurrentInstr(
     PyFrameObject* frame,
     PyObject** stack_top,
@@ -1825,6 +2577,24 @@ void _PyJIT_ProfileCurrentInstr(
     pair.first->second->recordTypes(get_type(stack_offsets)...);
   };
 
+  // Record which way a conditional jump on the top of the stack is about to
+  // go. Conditions that would need a call to __bool__ or __len__ to decide
+  // are skipped.
+  auto profile_branch = [&]() {
+    int truthy = knownTruthiness(stack_top[-1]);
+    if (truthy < 0) {
+      return;
+    }
+    CodeProfile& code_profile =
+        jit::Runtime::get()->typeProfiles()[Ref<PyCodeObject>{frame->f_code}];
+    BranchProfile& branch = code_profile.branch_hits[frame->f_lasti];
+    if (truthy) {
+      branch.true_hits++;
+    } else {
+      branch.false_hits++;
+    }
+  };
+
   switch (opcode) {
     case BEFORE_ASYNC_WITH:
     case DELETE_ATTR:
@@ -1836,13 +2606,9 @@ void _PyJIT_ProfileCurrentInstr(
     case GET_AWAITABLE:
     case GET_ITER:
     case GET_YIELD_FROM_ITER:
-    case JUMP_IF_FALSE_OR_POP:
-    case JUMP_IF_TRUE_OR_POP:
     case LOAD_ATTR:
     case LOAD_FIELD:
     case LOAD_METHOD:
-    case POP_JUMP_IF_FALSE:
-    case POP_JUMP_IF_TRUE:
     case RETURN_VALUE:
     case SETUP_WITH:
     case STORE_DEREF:
@@ -1859,6 +2625,21 @@ void _PyJIT_ProfileCurrentInstr(
       profile_stack(0);
       break;
     }
+    case JUMP_IF_FALSE_OR_POP:
+    case JUMP_IF_TRUE_OR_POP:
+    case POP_JUMP_IF_FALSE:
+    case POP_JUMP_IF_TRUE: {
+      profile_stack(0);
+      profile_branch();
+      break;
+    }
+    case JUMP_IF_NONZERO_OR_POP:
+    case JUMP_IF_ZERO_OR_POP:
+    case POP_JUMP_IF_NONZERO:
+    case POP_JUMP_IF_ZERO: {
+      profile_branch();
+      break;
+    }
     case BINARY_ADD:
     case BINARY_AND:
     case BINARY_FLOOR_DIVIDE:
@@ -1905,6 +2686,10 @@ void _PyJIT_ProfileCurrentInstr(
       profile_stack(oparg);
       break;
     };
+    case CALL_FUNCTION_KW: {
+      profile_stack(oparg + 1);
+      break;
+    }
     case CALL_METHOD: {
       profile_stack(oparg, oparg + 1);
       break;
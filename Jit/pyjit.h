@@ -29,6 +29,7 @@ PyAPI_FUNC(int) _PyJIT_IsJitConfigAllow_jit_list_wildcards(void);
 PyAPI_FUNC(int) _PyJIT_IsJitConfigCompile_all_static_functions(void);
 PyAPI_FUNC(size_t) _PyJIT_GetJitConfigBatch_compile_workers(void);
 PyAPI_FUNC(int) _PyJIT_IsJitConfigMultithreaded_compile_test(void);
+PyAPI_FUNC(int) _PyJIT_IsJitConfigAuto_jit_async(void);
 
 /*
  * Offset of the code object within a jit::CodeRuntime
@@ -97,6 +98,51 @@ PyAPI_FUNC(int) _PyJIT_IsAutoJITEnabled(void);
  */
 PyAPI_FUNC(unsigned int) _PyJIT_AutoJITThreshold(void);
 
+/*
+ * Queue func for compilation by the background auto-JIT worker, if
+ * asynchronous auto-JIT is enabled. The function's entry point is patched once
+ * compilation finishes; until then it keeps running in the interpreter.
+ *
+ * Returns 1 if func was queued and 0 otherwise, in which case the caller
+ * should compile it synchronously.
+ */
+PyAPI_FUNC(int) _PyJIT_ScheduleCompile(PyFunctionObject* func);
+
+/*
+ * Returns 1 if on-stack replacement is enabled and 0 otherwise.
+ */
+PyAPI_FUNC(int) _PyJIT_IsOSREnabled(void);
+
+/*
+ * Returns the number of loop back edges a code object must take before its
+ * interpreted frames are moved into JIT-compiled code, or 0 if on-stack
+ * replacement is disabled.
+ */
+PyAPI_FUNC(unsigned int) _PyJIT_OSRThreshold(void);
+
+/*
+ * Attempt to move frame, which the interpreter is running, into JIT-compiled
+ * code via on-stack replacement. The interpreter is about to jump backwards to
+ * the loop header at bytecode offset target, and stack_pointer is the top of
+ * its value stack.
+ *
+ * Returns 1 if the rest of the frame was executed by the JIT, in which case
+ * its return value (or NULL with an exception set) is stored in *result and
+ * the frame's locals and value stack have been consumed. Returns 0 if the
+ * interpreter should keep running the frame.
+ */
+PyAPI_FUNC(int) _PyJIT_OSREnter(
+    PyFrameObject* frame,
+    int target,
+    PyObject** stack_pointer,
+    PyObject** result);
+
+/*
+ * Returns 1 if code was listed in the compile manifest loaded at startup and 0
+ * otherwise. Auto-JIT uses this to compile previously hot code on first call.
+ */
+PyAPI_FUNC(int) _PyJIT_InCompileManifest(PyCodeObject* code);
+
 /*
    Enable the HIR inliner.
  */
@@ -112,6 +158,12 @@ PyAPI_FUNC(void) _PyJIT_DisableHIRInliner(void);
  */
 PyAPI_FUNC(int) _PyJIT_IsHIRInlinerEnabled(void);
 
+/*
+ * Returns the number of bytecode instructions the HIR inliner may inline into
+ * a single function.
+ */
+PyAPI_FUNC(unsigned int) _PyJIT_HIRInlinerBudget(void);
+
 /*
  * Returns 1 if the JIT will split code emission across multiple sections and 0
  * otherwise.
@@ -19,6 +19,14 @@ typedef struct {
   reprfunc tp_str;
   getattrofunc tp_getattro;
   descrgetfunc tp_descr_get;
+  richcmpfunc tp_richcompare;
+  hashfunc tp_hash;
+  getiterfunc tp_iter;
+  iternextfunc tp_iternext;
+  /* Used for both sq_length and mp_length */
+  lenfunc sq_length;
+  binaryfunc mp_subscript;
+  objobjargproc mp_ass_subscript;
 } _PyJIT_TypeSlots;
 
 #ifdef __cplusplus
@@ -32,6 +32,11 @@ void CodeRuntime::releaseReferences() {
   references_.clear();
 }
 
+void CodeRuntime::retire() {
+  retired_ = true;
+  releaseReferences();
+}
+
 void CodeRuntime::addReference(PyObject* obj) {
   JIT_CHECK(obj != nullptr, "Can't own a reference to nullptr");
   // Serialize as we modify the ref-count to obj which may be widely accessible.
@@ -57,6 +62,9 @@ void Runtime::shutdown() {
 
 void Runtime::mlockProfilerDependencies() {
   for (auto& codert : runtimes_) {
+    if (codert.isRetired()) {
+      continue;
+    }
     PyCodeObject* code = codert.frameState()->code().get();
     ::mlock(code, sizeof(PyCodeObject));
     ::mlock(code->co_qualname, Py_SIZE(code->co_qualname));
@@ -75,6 +83,9 @@ Ref<> Runtime::pageInProfilerDependencies() {
   // the code to do so. There are probably more efficient ways of doing this
   // but perf isn't a major concern.
   for (auto& code_rt : runtimes_) {
+    if (code_rt.isRetired()) {
+      continue;
+    }
     BorrowedRef<> qualname = code_rt.frameState()->code()->co_qualname;
     if (qualname == nullptr) {
       continue;
@@ -165,6 +176,55 @@ void Runtime::recordDeopt(std::size_t idx, PyObject* guilty_value) {
   if (guilty_value != nullptr) {
     stat.types.recordType(Py_TYPE(guilty_value));
   }
+  if (recompile_threshold_ == 0 || stat.count < recompile_threshold_) {
+    return;
+  }
+  const DeoptMetadata& meta = getDeoptMetadata(idx);
+  if (meta.reason != DeoptReason::kGuardFailure) {
+    return;
+  }
+  // Guards take the FrameState of the bytecode they protect, so the innermost
+  // frame identifies the speculation independently of how the function that
+  // contained it was compiled or inlined.
+  const DeoptFrameMetadata& frame = meta.frame_meta.back();
+  BorrowedRef<PyCodeObject> code = frame.code;
+  bool inserted;
+  {
+    ThreadedCompileSerialize guard;
+    inserted =
+        failed_speculations_[code].emplace(frame.next_instr_offset).second;
+  }
+  // Only invalidate the first time we see this guard fail past the threshold;
+  // code compiled before the failure was recorded may still hit it, and
+  // recompiling that again wouldn't help.
+  if (!inserted) {
+    return;
+  }
+  addReference(code);
+  if (invalidate_callback_) {
+    invalidate_callback_(meta.code_rt);
+  }
+}
+
+void Runtime::setRecompileThreshold(std::size_t threshold) {
+  recompile_threshold_ = threshold;
+}
+
+std::size_t Runtime::recompileThreshold() const {
+  return recompile_threshold_;
+}
+
+void Runtime::setInvalidateCallback(Runtime::InvalidateCallback cb) {
+  invalidate_callback_ = cb;
+}
+
+bool Runtime::hasFailedSpeculation(
+    BorrowedRef<PyCodeObject> code,
+    int offset) {
+  // Serialize as this is queried from compile threads.
+  ThreadedCompileSerialize guard;
+  auto it = failed_speculations_.find(code);
+  return it != failed_speculations_.end() && it->second.count(offset);
 }
 
 const DeoptStats& Runtime::deoptStats() const {
@@ -202,6 +262,7 @@ void Runtime::releaseReferences() {
   for (auto& code_rt : runtimes_) {
     code_rt.releaseReferences();
   }
+  failed_speculations_.clear();
   references_.clear();
 }
 
@@ -106,16 +106,6 @@ static_assert(
     offsetof(GenDataFooter, state) == _PY_GEN_JIT_DATA_STATE_OFFSET,
     "Byte offset for state shifted");
 
-// The number of words for pre-allocated blocks in the generator suspend data
-// free-list. I chose this based on it covering 99% of the JIT generator
-// spill-sizes needed when running 'make testcinder_jit' at the time I collected
-// this data. For reference:
-//   99.9% coverage came at 256 spill size
-//   99.99% was at 1552
-//   max was 4999
-// There were about ~15k JIT generators in total during the run.
-const size_t kMinGenSpillWords = 89;
-
 class GenYieldPoint {
  public:
   explicit GenYieldPoint(
@@ -224,6 +214,28 @@ class alignas(16) CodeRuntime {
   // Release any references this CodeRuntime holds to Python objects.
   void releaseReferences();
 
+  // Mark the compiled code for this CodeRuntime as freed and release its
+  // references. The CodeRuntime itself stays allocated, since deopt metadata
+  // and type watchers on its inline caches may still point at it.
+  void retire();
+
+  bool isRetired() const {
+    return retired_;
+  }
+
+  // Track the JIT generators created by this code that are still alive. Their
+  // resume entries and yield points refer into the compiled code.
+  void addLiveGenerator() {
+    num_live_generators_++;
+  }
+  void removeLiveGenerator() {
+    JIT_DCHECK(num_live_generators_ > 0, "Generator count underflow");
+    num_live_generators_--;
+  }
+  std::size_t numLiveGenerators() const {
+    return num_live_generators_;
+  }
+
   JITRT_LoadMethodCache* AllocateLoadMethodCache() {
     return load_method_cache_pool_.AllocateEntry();
   }
@@ -283,6 +295,9 @@ class alignas(16) CodeRuntime {
 
   int frame_size_{-1};
 
+  std::size_t num_live_generators_{0};
+  bool retired_{false};
+
   DebugInfo debug_info_;
 };
 
@@ -298,16 +313,28 @@ using DeoptStats = std::unordered_map<std::size_t, DeoptStat>;
 
 using BytecodeOffset = int;
 
+// How many times a conditional jump saw a true or false condition.
+struct BranchProfile {
+  int64_t true_hits{0};
+  int64_t false_hits{0};
+};
+
 // Profiling information for a PyCodeObject. Includes the total number of
-// bytecodes executed and type profiles for certain opcodes, keyed by bytecode
-// offset.
+// bytecodes executed, type profiles for certain opcodes and the outcomes of
+// conditional jumps, keyed by bytecode offset.
 struct CodeProfile {
   UnorderedMap<BytecodeOffset, std::unique_ptr<TypeProfiler>> typed_hits;
+  UnorderedMap<BytecodeOffset, BranchProfile> branch_hits;
   int64_t total_hits;
 };
 
 using TypeProfiles = std::unordered_map<Ref<PyCodeObject>, CodeProfile>;
 
+// Bytecode offsets, per code object, of speculative guards that failed often
+// enough to get their compiled function invalidated.
+using FailedSpeculations =
+    UnorderedMap<BorrowedRef<PyCodeObject>, UnorderedSet<BytecodeOffset>>;
+
 // Runtime owns all metadata created by the JIT.
 class Runtime {
  public:
@@ -359,9 +386,28 @@ class Runtime {
   DeoptMetadata& getDeoptMetadata(std::size_t id);
 
   // Record that a deopt of the given index happened at runtime, with an
-  // optional guilty value.
+  // optional guilty value. If the deopt point is a guard that has now failed
+  // recompileThreshold() times, its location is remembered as a failed
+  // speculation and the invalidate callback is invoked for the function that
+  // contains it.
   void recordDeopt(std::size_t idx, PyObject* guilty_value);
 
+  // Number of failures after which a guard's speculation is abandoned. 0
+  // disables recompilation.
+  void setRecompileThreshold(std::size_t threshold);
+  std::size_t recompileThreshold() const;
+
+  using InvalidateCallback = std::function<void(CodeRuntime*)>;
+
+  // Set the function used to throw away compiled code whose speculation has
+  // failed, so that it gets recompiled on its next call.
+  void setInvalidateCallback(InvalidateCallback cb);
+
+  // Return true if the guard emitted for the bytecode at the given offset in
+  // code has been abandoned, meaning the compiler should emit a generic path
+  // instead.
+  bool hasFailedSpeculation(BorrowedRef<PyCodeObject> code, int offset);
+
   // Get and/or clear runtime deopt stats.
   const DeoptStats& deoptStats() const;
   void clearDeoptStats();
@@ -419,6 +465,10 @@ class Runtime {
   DeoptStats deopt_stats_;
   GuardFailureCallback guard_failure_callback_;
 
+  std::size_t recompile_threshold_{0};
+  InvalidateCallback invalidate_callback_;
+  FailedSpeculations failed_speculations_;
+
   TypeProfiles type_profiles_;
 
   // References to Python objects held by this Runtime
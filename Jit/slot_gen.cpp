@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <functional>
 #include <iostream>
+#include <string>
 
 using asmjit::Error;
 using asmjit::ErrorHandler;
@@ -282,4 +283,199 @@ descrgetfunc SlotGen::genGetDescrSlot(PyTypeObject* type, PyObject* get_func) {
   });
 }
 
+static std::string slot_name(PyTypeObject* type, const char* method) {
+  return fmt::format("{}::{}", type->tp_name, method);
+}
+
+/*
+ * Call func through its vectorcall entry point, passing the first nargs
+ * incoming argument registers as its positional arguments. The result is left
+ * in rax. Must be called after emit_prologue().
+ */
+static void emit_vectorcall(x86::Builder& as, PyObject* func, int nargs) {
+  JIT_CHECK(nargs >= 1 && nargs <= 3, "Unsupported nargs %d", nargs);
+  const x86::Gp arg_regs[] = {x86::rdi, x86::rsi, x86::rdx};
+
+  if (nargs % 2 != 0) {
+    // keep the stack 16-byte aligned
+    as.push(0);
+  }
+  for (int i = nargs - 1; i >= 0; i--) {
+    as.push(arg_regs[i]);
+  }
+
+  // We indirect through the function object because it's probably
+  // not JITed yet
+  as.mov(x86::rdi, (uint64_t)func);
+  as.mov(x86::rsi, x86::rsp);
+  as.mov(x86::rdx, nargs);
+  as.xor_(x86::rcx, x86::rcx);
+  as.mov(x86::rax, x86::ptr(x86::rdi, offsetof(PyFunctionObject, vectorcall)));
+  as.call(x86::rax);
+}
+
+/*
+ * Emit a function that calls func with its first nargs arguments and then,
+ * if convert isn't null, passes the result through convert.
+ */
+static void gen_fused_slot(
+    x86::Builder& as,
+    PyObject* func,
+    int nargs,
+    void* convert = nullptr) {
+  JIT_DCHECK(PyFunction_Check(func), "Expected a Python function");
+  emit_prologue(as);
+  emit_vectorcall(as, func, nargs);
+  if (convert != nullptr) {
+    as.mov(x86::rdi, x86::rax);
+    as.mov(x86::rax, (uint64_t)convert);
+    as.call(x86::rax);
+  }
+  emit_epilogue(as);
+}
+
+/*
+ * Emit a tail call to generic if the value argument (rdx) is NULL, i.e. if
+ * this is a deletion.
+ */
+static void emit_forward_deletion(x86::Builder& as, void* generic) {
+  Label is_set = as.newLabel();
+  as.test(x86::rdx, x86::rdx);
+  as.jnz(is_set);
+  as.mov(x86::rax, (uint64_t)generic);
+  as.jmp(x86::rax);
+  as.bind(is_set);
+}
+
+// The following convert the result of a dunder method into the return value
+// of its slot. They steal the reference to res and mirror the generic slot_*
+// functions in typeobject.c.
+
+static Py_hash_t hash_result(PyObject* res) {
+  if (res == nullptr) {
+    return -1;
+  }
+  if (!PyLong_Check(res)) {
+    Py_DECREF(res);
+    PyErr_SetString(
+        PyExc_TypeError, "__hash__ method should return an integer");
+    return -1;
+  }
+  Py_hash_t h = PyLong_AsSsize_t(res);
+  if (h == -1 && PyErr_Occurred()) {
+    // res is out of the range of a Py_hash_t, so any well-mixed value will do
+    PyErr_Clear();
+    h = PyLong_Type.tp_hash(res);
+  }
+  // -1 is reserved for errors.
+  if (h == -1) {
+    h = -2;
+  }
+  Py_DECREF(res);
+  return h;
+}
+
+static Py_ssize_t len_result(PyObject* res) {
+  if (res == nullptr) {
+    return -1;
+  }
+  Ref<> index = Ref<>::steal(PyNumber_Index(res));
+  Py_DECREF(res);
+  if (index == nullptr) {
+    return -1;
+  }
+  if (Py_SIZE(index.get()) < 0) {
+    PyErr_SetString(PyExc_ValueError, "__len__() should return >= 0");
+    return -1;
+  }
+  return PyNumber_AsSsize_t(index, PyExc_OverflowError);
+}
+
+static int setter_result(PyObject* res) {
+  if (res == nullptr) {
+    return -1;
+  }
+  Py_DECREF(res);
+  return 0;
+}
+
+richcmpfunc SlotGen::genRichCompareSlot(
+    PyTypeObject* type,
+    PyObject* const* cmp_funcs,
+    richcmpfunc generic) {
+  return (richcmpfunc)GenFunc(
+      slot_name(type, "__richcmp__").c_str(), [&](x86::Builder& as) -> void {
+        // Dispatch on op, which is in edx.
+        Label labels[Py_GE + 1];
+        for (int op = Py_LT; op <= Py_GE; op++) {
+          if (cmp_funcs[op] == nullptr) {
+            continue;
+          }
+          labels[op] = as.newLabel();
+          as.cmp(x86::edx, op);
+          as.je(labels[op]);
+        }
+        as.mov(x86::rax, (uint64_t)generic);
+        as.jmp(x86::rax);
+
+        for (int op = Py_LT; op <= Py_GE; op++) {
+          if (cmp_funcs[op] == nullptr) {
+            continue;
+          }
+          as.bind(labels[op]);
+          gen_fused_slot(as, cmp_funcs[op], 2);
+        }
+      });
+}
+
+hashfunc SlotGen::genHashSlot(PyTypeObject* type, PyObject* hash_func) {
+  return (hashfunc)GenFunc(
+      slot_name(type, "__hash__").c_str(), [&](x86::Builder& as) -> void {
+        gen_fused_slot(as, hash_func, 1, (void*)hash_result);
+      });
+}
+
+lenfunc SlotGen::genLenSlot(PyTypeObject* type, PyObject* len_func) {
+  return (lenfunc)GenFunc(
+      slot_name(type, "__len__").c_str(), [&](x86::Builder& as) -> void {
+        gen_fused_slot(as, len_func, 1, (void*)len_result);
+      });
+}
+
+binaryfunc SlotGen::genGetItemSlot(
+    PyTypeObject* type,
+    PyObject* getitem_func) {
+  return (binaryfunc)GenFunc(
+      slot_name(type, "__getitem__").c_str(), [&](x86::Builder& as) -> void {
+        gen_fused_slot(as, getitem_func, 2);
+      });
+}
+
+getiterfunc SlotGen::genIterSlot(PyTypeObject* type, PyObject* iter_func) {
+  return (getiterfunc)GenFunc(
+      slot_name(type, "__iter__").c_str(), [&](x86::Builder& as) -> void {
+        gen_fused_slot(as, iter_func, 1);
+      });
+}
+
+iternextfunc SlotGen::genIterNextSlot(
+    PyTypeObject* type,
+    PyObject* next_func) {
+  return (iternextfunc)GenFunc(
+      slot_name(type, "__next__").c_str(), [&](x86::Builder& as) -> void {
+        gen_fused_slot(as, next_func, 1);
+      });
+}
+
+objobjargproc SlotGen::genSetItemSlot(
+    PyTypeObject* type,
+    PyObject* setitem_func,
+    objobjargproc generic) {
+  return (objobjargproc)GenFunc(
+      slot_name(type, "__setitem__").c_str(), [&](x86::Builder& as) -> void {
+        emit_forward_deletion(as, (void*)generic);
+        gen_fused_slot(as, setitem_func, 3, (void*)setter_result);
+      });
+}
+
 } // namespace jit
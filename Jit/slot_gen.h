@@ -33,6 +33,43 @@ class SlotGen {
   getattrofunc genGetAttrSlot(PyTypeObject* type, PyObject* call_func);
   descrgetfunc genGetDescrSlot(PyTypeObject* type, PyObject* get_func);
 
+  /*
+   * Generate a specialized tp_richcompare that calls cmp_funcs[op] directly.
+   * cmp_funcs is indexed by comparison op (Py_LT .. Py_GE); ops without a
+   * function are forwarded to generic.
+   *
+   * Returns NULL on error.
+   */
+  richcmpfunc genRichCompareSlot(
+      PyTypeObject* type,
+      PyObject* const* cmp_funcs,
+      richcmpfunc generic);
+
+  /*
+   * Generate specialized slots that call the given Python function directly
+   * and convert its result the same way the generic slot_* functions in
+   * typeobject.c do.
+   *
+   * Returns NULL on error.
+   */
+  hashfunc genHashSlot(PyTypeObject* type, PyObject* hash_func);
+  lenfunc genLenSlot(PyTypeObject* type, PyObject* len_func);
+  binaryfunc genGetItemSlot(PyTypeObject* type, PyObject* getitem_func);
+  getiterfunc genIterSlot(PyTypeObject* type, PyObject* iter_func);
+  iternextfunc genIterNextSlot(PyTypeObject* type, PyObject* next_func);
+
+  /*
+   * Generate a specialized mp_ass_subscript that calls setitem_func directly.
+   * Deletions (a NULL value) are forwarded to generic, which looks up
+   * __delitem__.
+   *
+   * Returns NULL on error.
+   */
+  objobjargproc genSetItemSlot(
+      PyTypeObject* type,
+      PyObject* setitem_func,
+      objobjargproc generic);
+
  private:
   DISALLOW_COPY_AND_ASSIGN(SlotGen);
 };
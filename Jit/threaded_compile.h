@@ -45,8 +45,22 @@ class ThreadedCompileContext {
     unlock();
   }
 
+  // True while units are being compiled from Preloaders, either by a batch of
+  // worker threads or by the calling thread without the GIL.
   bool compileRunning() const {
-    return compile_running_;
+    return compile_running_ || compiling_without_gil_;
+  }
+
+  // Mark the calling thread as compiling preloaded units without holding the
+  // GIL. While set, ThreadedCompileSerialize acquires the GIL on this thread
+  // instead of the compile mutex, so other Python threads are excluded from
+  // the same sections the batch workers serialize among themselves.
+  void setCompilingWithoutGIL(bool value) {
+    compiling_without_gil_ = value;
+  }
+
+  bool compilingWithoutGIL() const {
+    return compiling_without_gil_;
   }
 
  private:
@@ -65,6 +79,7 @@ class ThreadedCompileContext {
   }
 
   bool compile_running_{false};
+  static inline thread_local bool compiling_without_gil_{false};
   // This needs to be recursive because we allow recursive compilation via
   // jit::hir::tryRecursiveCompile
   std::recursive_mutex mutex_;
@@ -78,12 +93,23 @@ extern ThreadedCompileContext g_threaded_compile_context;
 class ThreadedCompileSerialize {
  public:
   ThreadedCompileSerialize() {
+    if (g_threaded_compile_context.compilingWithoutGIL()) {
+      gil_state_ = PyGILState_Ensure();
+      holds_gil_ = true;
+    }
     g_threaded_compile_context.lock();
   }
 
   ~ThreadedCompileSerialize() {
     g_threaded_compile_context.unlock();
+    if (holds_gil_) {
+      PyGILState_Release(gil_state_);
+    }
   }
+
+ private:
+  PyGILState_STATE gil_state_;
+  bool holds_gil_{false};
 };
 
 // Acquire the global threaded-compile lock for the execution of an expression.
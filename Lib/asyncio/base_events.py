@@ -48,6 +48,11 @@ from . import transports
 from . import trsock
 from .log import logger
 
+try:
+    from _asyncio import _run_ready
+except ImportError:
+    _run_ready = None
+
 
 __all__ = 'BaseEventLoop',
 
@@ -1825,6 +1830,10 @@ class BaseEventLoop(events.AbstractEventLoop):
 
         # Handle 'later' callbacks that are ready.
         end_time = self.time() + self._clock_resolution
+        if _run_ready is not None and not self._debug:
+            # Same as below, minus the debug-mode timing.
+            _run_ready(self._ready, self._scheduled, end_time)
+            return
         while self._scheduled:
             handle = self._scheduled[0]
             if handle._when >= end_time:
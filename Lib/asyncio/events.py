@@ -96,6 +96,20 @@ class Handle:
         self = None  # Needed to break cycles when an exception occurs.
 
 
+# Alias pure-Python implementation for testing purposes.
+_PyHandle = Handle
+
+try:
+    # A handle is created and run for every callback, so this is on the
+    # event loop's hottest path.
+    from _asyncio import Handle
+except ImportError:
+    pass
+else:
+    # Alias C implementation for testing purposes.
+    _CHandle = Handle
+
+
 class TimerHandle(Handle):
     """Object returned by timed callback registration methods."""
 
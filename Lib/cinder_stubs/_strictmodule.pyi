@@ -60,6 +60,7 @@ class StrictModuleLoader(IStrictModuleLoader):
         _verbose_logs: bool = False,
         /,
     ) -> None: ...
+    def set_analysis_cache(self, _cache_dir: str, /) -> bool: ...
 
 StrictModuleLoaderFactory = Callable[
     [List[str], str, List[str], List[str], bool, List[str], bool], IStrictModuleLoader
@@ -88,6 +88,13 @@ class Compiler(StaticCompiler):
             list(self.allow_list_regex),
             self.verbose,  # _verbose_logging
         )
+        # a directory to persist analysis results in across processes
+        analysis_cache = os.getenv("PYTHONSTRICTCACHE") or sys._xoptions.get(
+            "strict-cache"
+        )
+        set_analysis_cache = getattr(self.loader, "set_analysis_cache", None)
+        if isinstance(analysis_cache, str) and set_analysis_cache is not None:
+            set_analysis_cache(analysis_cache)
         self.raise_on_error = raise_on_error
         self.log_time_func = log_time_func
         self.enable_patching = enable_patching
@@ -352,6 +352,35 @@ shadow_op('BINARY_SUBSCR_LIST', 227)
 shadow_op('BINARY_SUBSCR_TUPLE', 228)
 shadow_op('BINARY_SUBSCR_DICT', 229)
 
+shadow_op('BINARY_ADD_INT', 30)
+shadow_op('BINARY_ADD_FLOAT', 31)
+shadow_op('BINARY_ADD_UNICODE', 32)
+shadow_op('BINARY_SUBTRACT_INT', 33)
+shadow_op('BINARY_SUBTRACT_FLOAT', 34)
+shadow_op('BINARY_MULTIPLY_INT', 35)
+shadow_op('BINARY_MULTIPLY_FLOAT', 36)
+shadow_op('INPLACE_ADD_INT', 37)
+shadow_op('INPLACE_ADD_FLOAT', 38)
+shadow_op('INPLACE_ADD_UNICODE', 39)
+shadow_op('COMPARE_OP_INT', 119)
+shadow_op('COMPARE_OP_FLOAT', 120)
+shadow_op('COMPARE_OP_STR_EQ', 121)
+
+shadow_op('CALL_FUNCTION_PY_EXACT_ARGS', 40)
+shadow_op('CALL_FUNCTION_BUILTIN_FAST', 41)
+shadow_op('CALL_FUNCTION_BUILTIN_O', 42)
+shadow_op('CALL_FUNCTION_TYPE_ALLOC', 43)
+shadow_op('CALL_METHOD_PY', 44)
+shadow_op('CALL_METHOD_DESCR_FAST', 45)
+shadow_op('CALL_METHOD_DESCR_O', 46)
+
+shadow_op('FOR_ITER_LIST', 99)
+shadow_op('FOR_ITER_TUPLE', 123)
+shadow_op('FOR_ITER_RANGE', 127)
+shadow_op('FOR_ITER_DICT_ITEMS', 128)
+shadow_op('UNPACK_SEQUENCE_TUPLE2', 129)
+shadow_op('UNPACK_SEQUENCE_LIST', 134)
+
 shadow_op('LOAD_METHOD_UNCACHABLE', 230)
 shadow_op('LOAD_METHOD_MODULE', 231)
 shadow_op('LOAD_METHOD_TYPE', 232)
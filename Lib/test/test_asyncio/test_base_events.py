@@ -389,6 +389,33 @@ class BaseEventLoopTests(test_utils.TestCase):
         self.assertTrue(processed)
         self.assertEqual([handle], list(self.loop._ready))
 
+    def test__run_once_skips_cancelled_handles(self):
+        calls = []
+        self.loop._process_events = mock.Mock()
+        self.loop.call_soon(calls.append, 1)
+        self.loop.call_soon(calls.append, 2).cancel()
+        self.loop.call_later(-1, calls.append, 3)
+        self.loop.call_later(-1, calls.append, 4).cancel()
+        self.loop.call_soon(calls.append, 5)
+        self.loop._run_once()
+
+        self.assertEqual(calls, [1, 5, 3])
+        self.assertFalse(self.loop._ready)
+        self.assertFalse(self.loop._scheduled)
+
+    def test__run_once_handle_subclass(self):
+        calls = []
+
+        class MyHandle(asyncio.Handle):
+            def _run(self):
+                calls.append('overridden')
+
+        self.loop._process_events = mock.Mock()
+        self.loop._ready.append(MyHandle(calls.append, ('base',), self.loop))
+        self.loop._run_once()
+
+        self.assertEqual(calls, ['overridden'])
+
     def test__run_once_cancelled_event_cleanup(self):
         self.loop._process_events = mock.Mock()
 
@@ -17,6 +17,7 @@ from compiler.static import StaticCodeGenerator
 from contextlib import contextmanager
 from functools import cmp_to_key
 from pathlib import Path
+from test.support.script_helper import assert_python_ok
 from textwrap import dedent
 
 try:
@@ -2912,6 +2913,53 @@ class DeleteSubscrTests(unittest.TestCase):
             self._delit(c, "foo")
 
 
+class SubscrTests(unittest.TestCase):
+    @unittest.failUnlessJITCompiled
+    def _getitem(self, container, key):
+        return container[key]
+
+    @unittest.failUnlessJITCompiled
+    def _setitem(self, container, key, value):
+        container[key] = value
+
+    def test_list_int(self):
+        l = [1, 2, 3]
+        self._setitem(l, 1, "b")
+        self._setitem(l, -1, "c")
+        self.assertEqual(l, [1, "b", "c"])
+        self.assertEqual(self._getitem(l, -2), "b")
+        with self.assertRaises(IndexError):
+            self._setitem(l, 3, 4)
+        with self.assertRaises(IndexError):
+            self._getitem(l, -4)
+
+    def test_list_store_releases_old_item(self):
+        class C:
+            pass
+
+        c = C()
+        ref = weakref.ref(c)
+        l = [c]
+        del c
+        self._setitem(l, 0, None)
+        self.assertIsNone(ref())
+
+    def test_dict_str(self):
+        d = {"foo": 1}
+        self._setitem(d, "bar", 2)
+        self.assertEqual(self._getitem(d, "foo"), 1)
+        self.assertEqual(self._getitem(d, "bar"), 2)
+        with self.assertRaisesRegex(KeyError, "baz"):
+            self._getitem(d, "baz")
+
+    def test_dict_subclass_missing(self):
+        class D(dict):
+            def __missing__(self, key):
+                return key * 2
+
+        self.assertEqual(self._getitem(D(), "ab"), "abab")
+
+
 class DeleteFastTests(unittest.TestCase):
     @unittest.failUnlessJITCompiled
     def _del(self):
@@ -3184,6 +3232,52 @@ class CinderJitModuleTests(StaticTestBase):
 
             self.assertEqual(cinderjit.get_num_inlined_functions(g), 1)
 
+    @unittest.skipIf(
+        not cinderjit or not cinderjit.is_hir_inliner_enabled(),
+        "meaningless without HIR inliner enabled",
+    )
+    def test_inline_function_with_defaults(self):
+        codestr = f"""
+            import cinderjit
+
+            @cinderjit.jit_suppress
+            def f(a, b=2):
+                return a + b
+
+            def g():
+                return f(1)
+        """
+        with self.in_module(codestr) as mod:
+            f = mod.f
+            g = mod.g
+            self.assertEqual(g(), 3)
+            self.assertTrue(cinderjit.is_jit_compiled(g))
+            self.assertEqual(cinderjit.get_num_inlined_functions(g), 1)
+
+            f.__defaults__ = (10,)
+            self.assertEqual(g(), 11)
+
+    @unittest.skipIf(
+        not cinderjit or not cinderjit.is_hir_inliner_enabled(),
+        "meaningless without HIR inliner enabled",
+    )
+    def test_inline_function_with_keyword_args(self):
+        codestr = f"""
+            import cinderjit
+
+            @cinderjit.jit_suppress
+            def f(a, b, *, c):
+                return (a, b, c)
+
+            def g():
+                return f(1, c=3, b=2)
+        """
+        with self.in_module(codestr) as mod:
+            g = mod.g
+            self.assertEqual(g(), (1, 2, 3))
+            self.assertTrue(cinderjit.is_jit_compiled(g))
+            self.assertEqual(cinderjit.get_num_inlined_functions(g), 1)
+
 
 @jit_suppress
 def _inner(*args, **kwargs):
@@ -3528,6 +3622,218 @@ class DeleteAttrTests(unittest.TestCase):
             del c.foo
 
 
+class AutoJITAsyncTests(unittest.TestCase):
+    @unittest.skipIf(cinderjit is None, "not jitting")
+    def test_compiles_on_background_thread(self):
+        code = dedent(
+            """
+            import cinderjit
+            import time
+
+            def f(x):
+                return x + 1
+
+            for i in range(10):
+                f(i)
+
+            # Compilation happens on another thread; give it time to run.
+            deadline = time.monotonic() + 30
+            while not cinderjit.is_jit_compiled(f):
+                assert time.monotonic() < deadline, "f was never compiled"
+                time.sleep(0.01)
+            assert f(1) == 2
+            assert cinderjit.get_async_compile_stats()["compiled"] >= 1
+            """
+        )
+        assert_python_ok(
+            "-X", "jit", "-X", "jit-auto=2", "-X", "jit-auto-async", "-c", code
+        )
+
+
+class OSRTests(unittest.TestCase):
+    def run_with_osr(self, code):
+        # A high auto-JIT threshold keeps functions in the interpreter, so the
+        # only way into compiled code is through a hot loop.
+        assert_python_ok(
+            "-X", "jit", "-X", "jit-auto=1000000", "-X", "jit-osr=100", "-c", code
+        )
+
+    @unittest.skipIf(cinderjit is None, "not jitting")
+    def test_hot_loop_enters_compiled_code(self):
+        self.run_with_osr(
+            dedent(
+                """
+                import cinderjit
+
+                def f(n):
+                    total = 0
+                    i = 0
+                    while i < n:
+                        total += i
+                        i += 1
+                    return total
+
+                # Loops run during startup may have been OSR'd already.
+                before = cinderjit.get_osr_stats()
+                assert f(1000) == sum(range(1000))
+                after = cinderjit.get_osr_stats()
+                assert not cinderjit.is_jit_compiled(f)
+                assert after["compiled"] == before["compiled"] + 1, after
+                assert after["entered"] == before["entered"] + 1, after
+                """
+            )
+        )
+
+    @unittest.skipIf(cinderjit is None, "not jitting")
+    def test_loop_state_survives_deopt(self):
+        self.run_with_osr(
+            dedent(
+                """
+                def f(items):
+                    scale = 2
+                    def times(v):
+                        return v * scale
+                    total = 0
+                    caught = 0
+                    for item in items:
+                        try:
+                            total += times(item)
+                        except TypeError:
+                            caught += 1
+                    return total, caught
+
+                items = list(range(1000)) + [None, 1.5]
+                assert f(items) == (2 * sum(range(1000)) + 3.0, 1)
+                """
+            )
+        )
+
+
+class RecompileTests(unittest.TestCase):
+    @unittest.skipIf(cinderjit is None, "not jitting")
+    def test_failed_guard_triggers_recompile(self):
+        assert_python_ok(
+            "-X",
+            "jit",
+            "-X",
+            "jit-recompile-threshold=10",
+            "-c",
+            dedent(
+                """
+                import cinderjit
+
+                def helper():
+                    return 1
+
+                def f():
+                    return helper()
+
+                cinderjit.force_compile(f)
+                assert f() == 1
+
+                def replacement():
+                    return 2
+
+                # Rebinding the global makes the LOAD_GLOBAL guard in f fail on
+                # every call until f gets recompiled without it.
+                helper = replacement
+                for _ in range(100):
+                    assert f() == 2
+                assert cinderjit.is_jit_compiled(f)
+                """
+            ),
+        )
+
+
+class ReclaimCodeTests(unittest.TestCase):
+    @unittest.skipIf(cinderjit is None, "not jitting")
+    def test_unreferenced_code_is_reclaimed(self):
+        assert_python_ok(
+            "-X",
+            "jit",
+            "-c",
+            dedent(
+                """
+                import cinderjit
+
+                SRC = (
+                    "def f(x):\\n    return x + 1\\n"
+                    "def g():\\n    return 0\\n"
+                )
+                ns = {}
+
+                def load():
+                    exec(compile(SRC, "<reloaded>", "exec"), ns)
+                    cinderjit.force_compile(ns["f"])
+                    cinderjit.force_compile(ns["g"])
+                    assert ns["f"](1) == 2
+
+                # Re-running the source in the same namespace, like
+                # importlib.reload() does, leaves the old code objects
+                # referenced only by the JIT.
+                load()
+                load()
+                assert cinderjit.reclaim_code() >= 2
+
+                stats = cinderjit.get_allocator_stats()
+                if "free_bytes" in stats:
+                    free_bytes = stats["free_bytes"]
+                    assert free_bytes > 0
+                    load()
+                    stats = cinderjit.get_allocator_stats()
+                    assert stats["free_bytes"] < free_bytes
+                    assert cinderjit.reclaim_code() == 2
+
+                # Code that's still in use is left alone.
+                assert cinderjit.reclaim_code() == 0
+                assert ns["f"](2) == 3
+                """
+            ),
+        )
+
+
+class PreforkCompileTests(unittest.TestCase):
+    @unittest.skipIf(cinderjit is None, "not jitting")
+    def test_precompile_before_fork_shares_code(self):
+        assert_python_ok(
+            "-X",
+            "jit",
+            "-c",
+            dedent(
+                """
+                import cinderjit
+                import os
+                import tempfile
+
+                def f():
+                    return 1
+
+                def g():
+                    return 2
+
+                with tempfile.NamedTemporaryFile("w", suffix=".txt") as jit_list:
+                    jit_list.write("__main__:f\\n")
+                    jit_list.flush()
+                    assert cinderjit.precompile_before_fork(jit_list.name) == 1
+                assert cinderjit.is_jit_compiled(f)
+                assert not cinderjit.is_jit_compiled(g)
+
+                pid = os.fork()
+                if pid == 0:
+                    stats = cinderjit.get_prefork_page_stats()
+                    ok = (
+                        stats is not None
+                        and stats["sealed_bytes"] > 0
+                        and stats["shared_pages"] <= stats["resident_pages"]
+                    )
+                    os._exit(0 if ok else 1)
+                _, status = os.waitpid(pid, 0)
+                assert os.WEXITSTATUS(status) == 0
+                """
+            ),
+        )
+
+
 _cmp_key = cmp_to_key(lambda x, y: 0)
 
 
@@ -760,10 +760,17 @@ class GCTests(unittest.TestCase):
         for st in stats:
             self.assertIsInstance(st, dict)
             self.assertEqual(set(st),
-                             {"collected", "collections", "uncollectable"})
+                             {"collected", "collections", "uncollectable",
+                              "increments", "pause_histogram"})
             self.assertGreaterEqual(st["collected"], 0)
             self.assertGreaterEqual(st["collections"], 0)
             self.assertGreaterEqual(st["uncollectable"], 0)
+            self.assertGreaterEqual(st["increments"], 0)
+            histogram = st["pause_histogram"]
+            self.assertEqual(list(histogram),
+                             [1e-4, 1e-3, 1e-2, 1e-1, 1.0, float("inf")])
+            self.assertEqual(sum(histogram.values()),
+                             st["collections"] + st["increments"])
         # Check that collection counts are incremented correctly
         if gc.isenabled():
             self.addCleanup(gc.enable)
@@ -925,6 +932,124 @@ class GCTests(unittest.TestCase):
         gc.freeze()
         self.assertIn(referrer, gc.get_all_referrers(obj))
         gc.unfreeze()
+
+    def test_incremental(self):
+        self.assertEqual(gc.get_incremental(), 0)
+        self.assertRaises(ValueError, gc.set_incremental, -1)
+        self.assertRaises(TypeError, gc.set_incremental, "1")
+
+        if not gc.isenabled():
+            self.addCleanup(gc.disable)
+            gc.enable()
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.set_incremental, 0)
+        # Start from an empty oldest generation so that promoting a few
+        # objects into it is enough to start an incremental pass.
+        self.addCleanup(gc.unfreeze)
+        gc.freeze()
+        gc.collect()
+        gc.set_incremental(0.001)
+        self.assertEqual(gc.get_incremental(), 0.001)
+        gc.set_threshold(100, 1, 1)
+
+        class A:
+            pass
+        a = A()
+        a.a = a
+        wr = weakref.ref(a)
+        gc.collect(1)
+        self.assertTrue(
+                any(a is element for element in gc.get_objects(generation=2))
+        )
+        del a
+
+        old = gc.get_stats()[2]
+        for i in range(100000):
+            if wr() is None:
+                break
+            l = []
+            l.append(l)
+        self.assertIsNone(wr())
+        new = gc.get_stats()[2]
+        self.assertGreater(new["increments"], old["increments"])
+        self.assertEqual(new["collections"], old["collections"])
+
+    def test_incremental_falls_back_to_full_collection(self):
+        if not gc.isenabled():
+            self.addCleanup(gc.disable)
+            gc.enable()
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.set_incremental, 0)
+        self.addCleanup(gc.unfreeze)
+        gc.freeze()
+
+        # A cycle far larger than any increment, so that no increment can
+        # find it.
+        class A:
+            pass
+        ring = [A() for i in range(20000)]
+        for i, a in enumerate(ring):
+            a.next = ring[i - 1]
+        wr = weakref.ref(a)
+        gc.collect()
+        del ring, a
+
+        gc.set_incremental(0.000001)
+        gc.set_threshold(100, 1, 1)
+        old = gc.get_stats()[2]
+        # Keep objects alive so that incremental passes keep starting.
+        keep = []
+        for i in range(1000000):
+            if wr() is None:
+                break
+            keep.append([])
+        self.assertIsNone(wr())
+        new = gc.get_stats()[2]
+        self.assertGreater(new["increments"], old["increments"])
+        self.assertGreater(new["collections"], old["collections"])
+
+    def test_telemetry(self):
+        self.assertEqual(gc.get_telemetry(), [])
+        self.assertRaises(ValueError, gc.enable_telemetry, 0)
+        self.assertRaises(ValueError, gc.enable_telemetry, 4, 0)
+
+        if gc.isenabled():
+            self.addCleanup(gc.enable)
+            gc.disable()
+        self.addCleanup(gc.disable_telemetry)
+        gc.enable_telemetry(capacity=4)
+        for i in range(5):
+            gc.collect(i % 3)
+        l = []
+        l.append(l)
+        del l
+        gc.collect()
+
+        records = gc.get_telemetry()
+        self.assertEqual([r["generation"] for r in records], [2, 0, 1, 2])
+        starts = [r["start"] for r in records]
+        self.assertEqual(starts, sorted(starts))
+        phases = {"deduce_unreachable", "legacy_finalizers",
+                  "handle_weakrefs", "finalize_garbage", "delete_garbage"}
+        for r in records:
+            self.assertFalse(r["incremental"])
+            self.assertEqual(set(r["phases"]), phases)
+            self.assertGreaterEqual(r["duration"], sum(r["phases"].values()))
+            self.assertGreaterEqual(r["visited"], r["unreachable"])
+            self.assertEqual(r["uncollectable"], 0)
+        self.assertGreaterEqual(records[-1]["unreachable"], 1)
+        self.assertGreaterEqual(records[-1]["collected"], 1)
+
+        # Only every third collection is recorded when sampling.
+        gc.enable_telemetry(capacity=4, sample_every=3)
+        self.assertEqual(gc.get_telemetry(), [])
+        for i in range(7):
+            gc.collect(0)
+        self.assertEqual(len(gc.get_telemetry()), 3)
+
+        gc.disable_telemetry()
+        gc.collect()
+        self.assertEqual(gc.get_telemetry(), [])
     # end facebook
 
 
@@ -6,7 +6,7 @@ import gc
 import sys
 import unittest
 import weakref
-from collections import UserDict
+from collections import OrderedDict, UserDict
 from test.support.script_helper import assert_python_ok, run_python_until_end
 from unittest import skipIf
 from unittest.case import CINDERJIT_ENABLED
@@ -825,6 +825,46 @@ def f(x):
             knobs = cinder.getknobs()
             self.assertEqual(knobs['shadowcode'], True)
 
+    @skipIf(cinder is None or CINDERJIT_ENABLED, "no shadowcode")
+    def test_shadowcode_stats(self):
+        def f(x):
+            return x.real
+
+        before = cinder.get_shadowcode_stats()
+        size_before = sys.getsizeof(f.__code__)
+        for _ in range(REPETITION):
+            self.assertEqual(f(1), 1)
+        after = cinder.get_shadowcode_stats()
+        self.assertGreater(after["count"], before["count"])
+        self.assertGreater(after["bytes"], before["bytes"])
+        self.assertGreater(sys.getsizeof(f.__code__), size_before)
+
+    @skipIf(cinder is None or CINDERJIT_ENABLED, "no shadowcode")
+    def test_shadowcode_budget(self):
+        def cold(x):
+            return x.real
+
+        def hot(x):
+            return x.imag
+
+        for _ in range(REPETITION):
+            cold(1)
+
+        self.assertRaises(ValueError, cinder.set_shadowcode_budget, -1)
+        budget = cinder.get_shadowcode_stats()["bytes"]
+        try:
+            cinder.set_shadowcode_budget(budget)
+            self.assertEqual(cinder.get_shadowcode_stats()["budget"], budget)
+            for _ in range(REPETITION * 20):
+                self.assertEqual(hot(1), 0)
+            self.assertGreater(cinder.get_shadowcode_stats()["evictions"], 0)
+        finally:
+            cinder.set_shadowcode_budget(0)
+
+        # Evicted code gets new shadow code once it warms up again.
+        for _ in range(REPETITION):
+            self.assertEqual(cold(1), 1)
+
     def test_store_attr_dict(self):
         class C:
             def __init__(self, x):
@@ -2305,6 +2345,242 @@ def f(x):
         for __ in range(REPETITION):
             self.assertEqual(f(t, 1), 6)
 
+    def test_binary_add_types(self):
+        def f(a, b):
+            return a + b
+        for __ in range(REPETITION):
+            self.assertEqual(f(1, 2), 3)
+        for __ in range(REPETITION):
+            self.assertEqual(f(1.5, 2.0), 3.5)
+        for __ in range(REPETITION):
+            self.assertEqual(f("a", "b"), "ab")
+        for __ in range(REPETITION):
+            self.assertEqual(f([1], [2]), [1, 2])
+        self.assertEqual(f(1, 2.5), 3.5)
+        self.assertEqual(f(True, 1), 2)
+
+    def test_binary_arith_big_ints(self):
+        def f(a, b):
+            return (a + b, a - b, a * b)
+        big = 2 ** 70
+        for __ in range(REPETITION):
+            self.assertEqual(f(3, 4), (7, -1, 12))
+        for __ in range(REPETITION):
+            self.assertEqual(f(big, 2), (big + 2, big - 2, big * 2))
+        for __ in range(REPETITION):
+            self.assertEqual(f(2.0, 0.5), (2.5, 1.5, 1.0))
+        self.assertEqual(f(2.0, 1), (3.0, 1.0, 2.0))
+
+    def test_inplace_add_types(self):
+        def f(a, b):
+            a += b
+            return a
+        for __ in range(REPETITION):
+            self.assertEqual(f(1, 2), 3)
+        for __ in range(REPETITION):
+            self.assertEqual(f(0.25, 0.5), 0.75)
+        for __ in range(REPETITION):
+            self.assertEqual(f("x", "y"), "xy")
+        l = [1]
+        self.assertIs(f(l, [2]), l)
+        self.assertEqual(l, [1, 2])
+
+    def test_compare_op_types(self):
+        def f(a, b):
+            return (a < b, a <= b, a == b, a != b, a > b, a >= b)
+        for __ in range(REPETITION):
+            self.assertEqual(f(1, 2), (True, True, False, True, False, False))
+            self.assertEqual(f(-5, -5), (False, True, True, False, False, True))
+            self.assertEqual(f(2 ** 70, 1), (False, False, False, True, True, True))
+        nan = float("nan")
+        for __ in range(REPETITION):
+            self.assertEqual(f(1.0, 0.5), (False, False, False, True, True, True))
+            self.assertEqual(f(nan, nan), (False, False, False, True, False, False))
+        for __ in range(REPETITION):
+            self.assertEqual(f("a", "b"), (True, True, False, True, False, False))
+        self.assertEqual(f(1, 1.0), (False, True, True, False, False, True))
+
+    def test_compare_op_str_eq(self):
+        def eq(a, b):
+            return a == b
+        def ne(a, b):
+            return a != b
+        s = "abc"
+        for __ in range(REPETITION):
+            self.assertTrue(eq(s, s))
+            self.assertTrue(eq(s, "".join(["ab", "c"])))
+            self.assertFalse(eq(s, "abd"))
+            self.assertFalse(ne(s, "".join(["ab", "c"])))
+            self.assertTrue(ne(s, "ab"))
+        for __ in range(REPETITION):
+            self.assertTrue(eq(1, 1))
+            self.assertFalse(ne(1, 1))
+
+    def test_call_py_function_exact_args(self):
+        def g(a, b):
+            return a + b
+        def h(a, b):
+            return a * b
+        def f(callee):
+            return callee(3, 4)
+        for __ in range(REPETITION):
+            self.assertEqual(f(g), 7)
+        for __ in range(REPETITION):
+            self.assertEqual(f(h), 12)
+        g.__code__ = h.__code__
+        for __ in range(REPETITION):
+            self.assertEqual(f(g), 12)
+
+    def test_call_py_function_defaults_changed(self):
+        def g(a, b):
+            return (a, b)
+        def f():
+            return g(1, 2)
+        for __ in range(REPETITION):
+            self.assertEqual(f(), (1, 2))
+        g.__defaults__ = (5,)
+        for __ in range(REPETITION):
+            self.assertEqual(f(), (1, 2))
+
+    def test_call_py_function_wrong_arg_count(self):
+        def g(a):
+            return a
+        def f(callee):
+            return callee(1, 2)
+        def two(a, b):
+            return b
+        for __ in range(REPETITION):
+            self.assertEqual(f(two), 2)
+        with self.assertRaises(TypeError):
+            f(g)
+
+    def test_call_builtin(self):
+        def f(callee, x):
+            return callee(x)
+        for __ in range(REPETITION):
+            self.assertEqual(f(len, [1, 2]), 2)
+        for __ in range(REPETITION):
+            self.assertEqual(f(abs, -3), 3)
+        with self.assertRaises(TypeError):
+            f(len, 1)
+        def g(x, y):
+            return isinstance(x, y)
+        for __ in range(REPETITION):
+            self.assertTrue(g(1, int))
+            self.assertFalse(g("a", int))
+
+    def test_call_type(self):
+        class C:
+            def __init__(self, x):
+                self.x = x
+        class D:
+            pass
+        def f(cls, x):
+            return cls(x)
+        for __ in range(REPETITION):
+            self.assertEqual(f(C, 1).x, 1)
+        with self.assertRaises(TypeError):
+            f(D, 1)
+        for __ in range(REPETITION):
+            self.assertEqual(f(str, 1), "1")
+
+    def test_call_method_py(self):
+        class C:
+            def m(self, a):
+                return (self, a)
+        class D:
+            def m(self, a, b=2):
+                return (self, a, b)
+        def f(o):
+            return o.m(1)
+        c = C()
+        d = D()
+        for __ in range(REPETITION):
+            self.assertEqual(f(c), (c, 1))
+        for __ in range(REPETITION):
+            self.assertEqual(f(d), (d, 1, 2))
+
+    def test_call_method_descr(self):
+        class L(list):
+            pass
+        def append(l, x):
+            l.append(x)
+        def index(l, x):
+            return l.index(x)
+        l = []
+        for i in range(REPETITION):
+            append(l, i)
+        self.assertEqual(l, list(range(REPETITION)))
+        sub = L()
+        append(sub, 1)
+        self.assertEqual(sub, [1])
+        for __ in range(REPETITION):
+            self.assertEqual(index(l, 3), 3)
+        with self.assertRaises(ValueError):
+            index(l, -1)
+        self.assertEqual(index("abc", "c"), 2)
+
+    def test_for_iter_types(self):
+        def f(it):
+            res = []
+            for x in it:
+                res.append(x)
+            return res
+        for __ in range(REPETITION):
+            self.assertEqual(f([1, 2, 3]), [1, 2, 3])
+        for __ in range(REPETITION):
+            self.assertEqual(f((4, 5)), [4, 5])
+        for __ in range(REPETITION):
+            self.assertEqual(f(range(-3, 600, 200)), [-3, 197, 397, 597])
+        for __ in range(REPETITION):
+            self.assertEqual(f("ab"), ["a", "b"])
+        self.assertEqual(f([]), [])
+
+    def test_for_iter_list_mutated(self):
+        def f(l):
+            n = 0
+            for x in l:
+                if x == 0:
+                    l.append(1)
+                n += 1
+            return n
+        for __ in range(REPETITION):
+            self.assertEqual(f([0, 2]), 3)
+
+    def test_for_iter_dict_items(self):
+        def f(d):
+            res = []
+            for k, v in d.items():
+                res.append((k, v))
+            return res
+        d = {"a": 1, "b": 2}
+        for __ in range(REPETITION):
+            self.assertEqual(f(d), [("a", 1), ("b", 2)])
+        for __ in range(REPETITION):
+            self.assertEqual(f(OrderedDict(d)), [("a", 1), ("b", 2)])
+
+        def g(d):
+            for k, v in d.items():
+                d[k + k] = v
+        for __ in range(REPETITION):
+            with self.assertRaises(RuntimeError):
+                g({"a": 1})
+
+    def test_unpack_sequence_types(self):
+        def f(seq):
+            a, b = seq
+            return b, a
+        for __ in range(REPETITION):
+            self.assertEqual(f((1, 2)), (2, 1))
+        for __ in range(REPETITION):
+            self.assertEqual(f([3, 4]), (4, 3))
+        for __ in range(REPETITION):
+            self.assertEqual(f("xy"), ("y", "x"))
+        with self.assertRaises(ValueError):
+            f((1, 2, 3))
+        with self.assertRaises(ValueError):
+            f([1])
+
     def test_tuple_subscr_indexerror(self):
         t = (1, 2, 3, 4, 5)
         def f(i):
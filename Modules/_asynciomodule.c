@@ -48,6 +48,9 @@ _Py_IDENTIFIER(_set_task_context);
 /* State of the _asyncio module */
 static PyObject *asyncio_mod;
 static PyObject *traceback_extract_stack;
+static PyObject *asyncio_format_helpers_extract_stack;
+static PyObject *asyncio_format_callback_source;
+static PyObject *heapq_heappop;
 static PyObject *asyncio_get_event_loop_policy;
 static PyObject *asyncio_future_repr_info_func;
 static PyObject *asyncio_iscoroutine_func;
@@ -412,6 +415,18 @@ typedef struct {
   PyObject *af_done_callback;
 } _AwaitingFutureObj;
 
+typedef struct {
+    PyObject_HEAD
+    PyObject *h_callback;
+    PyObject *h_args;
+    PyObject *h_loop;
+    PyObject *h_context;
+    PyObject *h_source_tb;
+    PyObject *h_repr;
+    PyObject *h_weakreflist;
+    char h_cancelled;
+} HandleObj;
+
 static PyTypeObject FutureType;
 static PyTypeObject TaskType;
 static PyTypeObject ContextAwareTaskType;
@@ -421,6 +436,7 @@ static PyTypeObject _AsyncLazyValue_Type;
 static PyTypeObject _AsyncLazyValueCompute_Type;
 static PyTypeObject AwaitableValue_Type;
 static PyTypeObject _AwaitingFuture_Type;
+static PyTypeObject HandleType;
 
 #if defined(HAVE_GETPID) && !defined(MS_WINDOWS)
 static pid_t current_pid;
@@ -443,6 +459,7 @@ static pid_t current_pid;
 
 #define Future_Check(obj) PyObject_TypeCheck(obj, &FutureType)
 #define Task_Check(obj) PyObject_TypeCheck(obj, &TaskType)
+#define Handle_Check(obj) PyObject_TypeCheck(obj, &HandleType)
 
 #include "clinic/_asynciomodule.c.h"
 
@@ -1891,6 +1908,21 @@ get_event_loop(void)
         return loop;
     }
 
+    if (asyncio_get_event_loop_policy == NULL) {
+        /* asyncio.events imports this module before it's done executing, so
+           the policy getter can only be looked up once it's needed. */
+        PyObject *events = PyImport_ImportModule("asyncio.events");
+        if (events == NULL) {
+            return NULL;
+        }
+        asyncio_get_event_loop_policy =
+            PyObject_GetAttrString(events, "get_event_loop_policy");
+        Py_DECREF(events);
+        if (asyncio_get_event_loop_policy == NULL) {
+            return NULL;
+        }
+    }
+
     policy = _PyObject_CallNoArg(asyncio_get_event_loop_policy);
     if (policy == NULL) {
         return NULL;
@@ -8339,6 +8371,575 @@ static PyTypeObject _AwaitingFuture_Type = {
 
 
 
+/*********************** Handle **************************/
+
+/*[clinic input]
+class _asyncio.Handle "HandleObj *" "&HandleType"
+[clinic start generated code]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=50e97de3b2344c61]*/
+
+static int
+handle_loop_get_debug(PyObject *loop)
+{
+    PyEventLoopDispatchTable *t = get_dispatch_table(Py_TYPE(loop));
+    if (t == NULL) {
+        return -1;
+    }
+    PyObject *res = t->invoke_get_debug(t, loop);
+    if (res == NULL) {
+        return -1;
+    }
+    int is_true = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    return is_true;
+}
+
+/*[clinic input]
+_asyncio.Handle.__init__
+
+    callback: object
+    args as callback_args: object
+    loop: object
+    context: object = None
+
+Object returned by callback registration methods.
+[clinic start generated code]*/
+
+static int
+_asyncio_Handle___init___impl(HandleObj *self, PyObject *callback,
+                              PyObject *callback_args, PyObject *loop,
+                              PyObject *context)
+/*[clinic end generated code: output=a6fd445f3dd461ba input=2f5e00dd6750c23d]*/
+{
+    if (context == Py_None) {
+        context = PyContext_CopyCurrent();
+        if (context == NULL) {
+            return -1;
+        }
+    }
+    else {
+        Py_INCREF(context);
+    }
+    Py_XSETREF(self->h_context, context);
+    Py_INCREF(loop);
+    Py_XSETREF(self->h_loop, loop);
+    Py_INCREF(callback);
+    Py_XSETREF(self->h_callback, callback);
+    Py_INCREF(callback_args);
+    Py_XSETREF(self->h_args, callback_args);
+    self->h_cancelled = 0;
+    Py_CLEAR(self->h_repr);
+    Py_CLEAR(self->h_source_tb);
+
+    int debug = handle_loop_get_debug(loop);
+    if (debug < 0) {
+        return -1;
+    }
+    if (debug) {
+        /* There's no Python frame for this call, so the current frame is the
+           one that created the handle. */
+        PyObject *frame = (PyObject *)PyEval_GetFrame();
+        self->h_source_tb = PyObject_CallFunctionObjArgs(
+            asyncio_format_helpers_extract_stack,
+            frame != NULL ? frame : Py_None,
+            NULL);
+        if (self->h_source_tb == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static PyObject *
+handle_format_callback_source(HandleObj *self)
+{
+    return PyObject_CallFunctionObjArgs(
+        asyncio_format_callback_source,
+        self->h_callback != NULL ? self->h_callback : Py_None,
+        self->h_args != NULL ? self->h_args : Py_None,
+        NULL);
+}
+
+/*[clinic input]
+_asyncio.Handle._repr_info
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Handle__repr_info_impl(HandleObj *self)
+/*[clinic end generated code: output=7838b12075048d03 input=dba1c0a083077d57]*/
+{
+    PyObject *info = PyList_New(0);
+    if (info == NULL) {
+        return NULL;
+    }
+    PyObject *item = PyUnicode_FromString(_PyType_Name(Py_TYPE(self)));
+    if (item == NULL || PyList_Append(info, item) < 0) {
+        goto fail;
+    }
+    Py_CLEAR(item);
+
+    if (self->h_cancelled) {
+        item = PyUnicode_FromString("cancelled");
+        if (item == NULL || PyList_Append(info, item) < 0) {
+            goto fail;
+        }
+        Py_CLEAR(item);
+    }
+    if (self->h_callback != NULL && self->h_callback != Py_None) {
+        item = handle_format_callback_source(self);
+        if (item == NULL || PyList_Append(info, item) < 0) {
+            goto fail;
+        }
+        Py_CLEAR(item);
+    }
+    if (self->h_source_tb != NULL) {
+        int has_tb = PyObject_IsTrue(self->h_source_tb);
+        if (has_tb < 0) {
+            goto fail;
+        }
+        if (has_tb) {
+            PyObject *frame = PySequence_GetItem(self->h_source_tb, -1);
+            if (frame == NULL) {
+                goto fail;
+            }
+            PyObject *filename = PySequence_GetItem(frame, 0);
+            PyObject *lineno = PySequence_GetItem(frame, 1);
+            Py_DECREF(frame);
+            if (filename != NULL && lineno != NULL) {
+                item = PyUnicode_FromFormat(
+                    "created at %S:%S", filename, lineno);
+            }
+            Py_XDECREF(filename);
+            Py_XDECREF(lineno);
+            if (item == NULL || PyList_Append(info, item) < 0) {
+                goto fail;
+            }
+            Py_CLEAR(item);
+        }
+    }
+    return info;
+
+fail:
+    Py_XDECREF(item);
+    Py_DECREF(info);
+    return NULL;
+}
+
+static PyObject *
+HandleObj_repr(HandleObj *self)
+{
+    _Py_IDENTIFIER(_repr_info);
+    _Py_static_string(PyId_space, " ");
+
+    if (self->h_repr != NULL && self->h_repr != Py_None) {
+        Py_INCREF(self->h_repr);
+        return self->h_repr;
+    }
+
+    /* Go through the method so that subclasses like TimerHandle can add to
+       the description. */
+    PyObject *info = _PyObject_CallMethodIdObjArgs(
+        (PyObject *)self, &PyId__repr_info, NULL);
+    if (info == NULL) {
+        return NULL;
+    }
+    PyObject *space = _PyUnicode_FromId(&PyId_space);
+    if (space == NULL) {
+        Py_DECREF(info);
+        return NULL;
+    }
+    PyObject *joined = PyUnicode_Join(space, info);
+    Py_DECREF(info);
+    if (joined == NULL) {
+        return NULL;
+    }
+    PyObject *res = PyUnicode_FromFormat("<%U>", joined);
+    Py_DECREF(joined);
+    return res;
+}
+
+/*[clinic input]
+_asyncio.Handle.cancel
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Handle_cancel_impl(HandleObj *self)
+/*[clinic end generated code: output=ddb39234782aab82 input=eaa3eb93236f622f]*/
+{
+    if (self->h_cancelled) {
+        Py_RETURN_NONE;
+    }
+    self->h_cancelled = 1;
+    if (self->h_loop != NULL) {
+        int debug = handle_loop_get_debug(self->h_loop);
+        if (debug < 0) {
+            return NULL;
+        }
+        if (debug) {
+            /* Keep a representation in debug mode to keep callback and
+               parameters. For example, to log the warning
+               "Executing <Handle...> took 2.5 second" */
+            PyObject *repr = PyObject_Repr((PyObject *)self);
+            if (repr == NULL) {
+                return NULL;
+            }
+            Py_XSETREF(self->h_repr, repr);
+        }
+    }
+    Py_INCREF(Py_None);
+    Py_XSETREF(self->h_callback, Py_None);
+    Py_INCREF(Py_None);
+    Py_XSETREF(self->h_args, Py_None);
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.Handle.cancelled
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Handle_cancelled_impl(HandleObj *self)
+/*[clinic end generated code: output=0f4ad57f569e9f24 input=14a55098bea1b40a]*/
+{
+    return PyBool_FromLong(self->h_cancelled);
+}
+
+static PyObject *
+handle_call_callback(HandleObj *self)
+{
+    _Py_IDENTIFIER(run);
+
+    PyObject *callback = self->h_callback != NULL ? self->h_callback : Py_None;
+    PyObject *context = self->h_context != NULL ? self->h_context : Py_None;
+    PyObject *args;
+    if (self->h_args != NULL && PyTuple_CheckExact(self->h_args)) {
+        args = self->h_args;
+        Py_INCREF(args);
+    }
+    else {
+        args = PySequence_Tuple(
+            self->h_args != NULL ? self->h_args : Py_None);
+        if (args == NULL) {
+            return NULL;
+        }
+    }
+    /* The callback may cancel this handle, which drops its references. */
+    Py_INCREF(callback);
+    Py_INCREF(context);
+
+    PyObject *res = NULL;
+    if (PyContext_CheckExact(context)) {
+        /* Same as context.run(callback, *args), without building a new
+           argument vector. */
+        if (PyContext_Enter(context) == 0) {
+            res = _PyObject_Vectorcall(
+                callback,
+                &PyTuple_GET_ITEM(args, 0),
+                PyTuple_GET_SIZE(args),
+                NULL);
+            if (PyContext_Exit(context) < 0) {
+                Py_CLEAR(res);
+            }
+        }
+    }
+    else {
+        PyObject *run = _PyObject_GetAttrId(context, &PyId_run);
+        if (run != NULL) {
+            Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+            PyObject *run_args = PyTuple_New(nargs + 1);
+            if (run_args != NULL) {
+                Py_INCREF(callback);
+                PyTuple_SET_ITEM(run_args, 0, callback);
+                for (Py_ssize_t i = 0; i < nargs; i++) {
+                    PyObject *arg = PyTuple_GET_ITEM(args, i);
+                    Py_INCREF(arg);
+                    PyTuple_SET_ITEM(run_args, i + 1, arg);
+                }
+                res = PyObject_Call(run, run_args, NULL);
+                Py_DECREF(run_args);
+            }
+            Py_DECREF(run);
+        }
+    }
+    Py_DECREF(context);
+    Py_DECREF(callback);
+    Py_DECREF(args);
+    return res;
+}
+
+static int
+handle_report_exception(HandleObj *self)
+{
+    _Py_IDENTIFIER(call_exception_handler);
+    _Py_IDENTIFIER(message);
+    _Py_IDENTIFIER(exception);
+    _Py_IDENTIFIER(handle);
+    _Py_IDENTIFIER(source_traceback);
+
+    PyObject *exc_type, *exc, *exc_tb;
+    PyErr_Fetch(&exc_type, &exc, &exc_tb);
+    PyErr_NormalizeException(&exc_type, &exc, &exc_tb);
+    if (exc_tb != NULL) {
+        PyException_SetTraceback(exc, exc_tb);
+    }
+
+    int ret = -1;
+    PyObject *message = NULL;
+    PyObject *context = NULL;
+    PyObject *cb = handle_format_callback_source(self);
+    if (cb == NULL) {
+        goto done;
+    }
+    message = PyUnicode_FromFormat("Exception in callback %S", cb);
+    if (message == NULL) {
+        goto done;
+    }
+    context = PyDict_New();
+    if (context == NULL ||
+        _PyDict_SetItemId(context, &PyId_message, message) < 0 ||
+        _PyDict_SetItemId(context, &PyId_exception, exc) < 0 ||
+        _PyDict_SetItemId(context, &PyId_handle, (PyObject *)self) < 0) {
+        goto done;
+    }
+    if (self->h_source_tb != NULL) {
+        int has_tb = PyObject_IsTrue(self->h_source_tb);
+        if (has_tb < 0 ||
+            (has_tb && _PyDict_SetItemId(context,
+                                         &PyId_source_traceback,
+                                         self->h_source_tb) < 0)) {
+            goto done;
+        }
+    }
+
+    PyObject *res = _PyObject_CallMethodIdObjArgs(
+        self->h_loop, &PyId_call_exception_handler, context, NULL);
+    if (res != NULL) {
+        Py_DECREF(res);
+        ret = 0;
+    }
+
+done:
+    Py_XDECREF(cb);
+    Py_XDECREF(message);
+    Py_XDECREF(context);
+    Py_XDECREF(exc_type);
+    Py_XDECREF(exc);
+    Py_XDECREF(exc_tb);
+    return ret;
+}
+
+static int
+handle_run(HandleObj *self)
+{
+    PyObject *res = handle_call_callback(self);
+    if (res != NULL) {
+        Py_DECREF(res);
+        return 0;
+    }
+    if (PyErr_ExceptionMatches(PyExc_SystemExit) ||
+        PyErr_ExceptionMatches(PyExc_KeyboardInterrupt)) {
+        return -1;
+    }
+    return handle_report_exception(self);
+}
+
+/*[clinic input]
+_asyncio.Handle._run
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Handle__run_impl(HandleObj *self)
+/*[clinic end generated code: output=1b186b710881500a input=94fc71ae0ddc7106]*/
+{
+    if (handle_run(self) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static int
+HandleObj_traverse(HandleObj *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->h_callback);
+    Py_VISIT(self->h_args);
+    Py_VISIT(self->h_loop);
+    Py_VISIT(self->h_context);
+    Py_VISIT(self->h_source_tb);
+    Py_VISIT(self->h_repr);
+    return 0;
+}
+
+static int
+HandleObj_clear(HandleObj *self)
+{
+    Py_CLEAR(self->h_callback);
+    Py_CLEAR(self->h_args);
+    Py_CLEAR(self->h_loop);
+    Py_CLEAR(self->h_context);
+    Py_CLEAR(self->h_source_tb);
+    Py_CLEAR(self->h_repr);
+    return 0;
+}
+
+static void
+HandleObj_dealloc(HandleObj *self)
+{
+    PyObject_GC_UnTrack(self);
+    if (self->h_weakreflist != NULL) {
+        PyObject_ClearWeakRefs((PyObject *)self);
+    }
+    (void)HandleObj_clear(self);
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyMemberDef HandleType_members[] = {
+    {"_callback", T_OBJECT, offsetof(HandleObj, h_callback), 0},
+    {"_args", T_OBJECT, offsetof(HandleObj, h_args), 0},
+    {"_loop", T_OBJECT, offsetof(HandleObj, h_loop), 0},
+    {"_context", T_OBJECT, offsetof(HandleObj, h_context), 0},
+    {"_source_traceback", T_OBJECT, offsetof(HandleObj, h_source_tb), 0},
+    {"_repr", T_OBJECT, offsetof(HandleObj, h_repr), 0},
+    {"_cancelled", T_BOOL, offsetof(HandleObj, h_cancelled), 0},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef HandleType_methods[] = {
+    _ASYNCIO_HANDLE__REPR_INFO_METHODDEF
+    _ASYNCIO_HANDLE_CANCEL_METHODDEF
+    _ASYNCIO_HANDLE_CANCELLED_METHODDEF
+    _ASYNCIO_HANDLE__RUN_METHODDEF
+    {NULL, NULL} /* Sentinel */
+};
+
+static PyTypeObject HandleType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "_asyncio.Handle",
+    .tp_basicsize = sizeof(HandleObj),
+    .tp_dealloc = (destructor)HandleObj_dealloc,
+    .tp_repr = (reprfunc)HandleObj_repr,
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE,
+    .tp_doc = _asyncio_Handle___init____doc__,
+    .tp_traverse = (traverseproc)HandleObj_traverse,
+    .tp_clear = (inquiry)HandleObj_clear,
+    .tp_weaklistoffset = offsetof(HandleObj, h_weakreflist),
+    .tp_methods = HandleType_methods,
+    .tp_members = HandleType_members,
+    .tp_init = (initproc)_asyncio_Handle___init__,
+    .tp_new = PyType_GenericNew,
+};
+
+/* Handle._run as found in the type dict, used to spot subclasses that
+   override it. */
+static PyObject *handle_run_method;
+
+static int
+run_ready_handle(PyObject *handle)
+{
+    _Py_IDENTIFIER(_run);
+    _Py_IDENTIFIER(_cancelled);
+
+    if (Handle_Check(handle) &&
+        _PyType_LookupId(Py_TYPE(handle), &PyId__run) == handle_run_method) {
+        if (((HandleObj *)handle)->h_cancelled) {
+            return 0;
+        }
+        return handle_run((HandleObj *)handle);
+    }
+
+    PyObject *cancelled = _PyObject_GetAttrId(handle, &PyId__cancelled);
+    if (cancelled == NULL) {
+        return -1;
+    }
+    int is_cancelled = PyObject_IsTrue(cancelled);
+    Py_DECREF(cancelled);
+    if (is_cancelled) {
+        return is_cancelled < 0 ? -1 : 0;
+    }
+    PyObject *res = _PyObject_CallMethodId(handle, &PyId__run, NULL);
+    if (res == NULL) {
+        return -1;
+    }
+    Py_DECREF(res);
+    return 0;
+}
+
+/*[clinic input]
+_asyncio._run_ready
+
+    ready: object
+    scheduled: object(subclass_of='&PyList_Type')
+    end_time: object
+    /
+
+Run the callbacks for one iteration of an event loop.
+
+Timer handles in the scheduled heap that are due before end_time are moved
+to the ready deque, and then every handle in the deque is run, skipping the
+cancelled ones. Callbacks added by those handles run on the next call.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__run_ready_impl(PyObject *module, PyObject *ready,
+                         PyObject *scheduled, PyObject *end_time)
+/*[clinic end generated code: output=859d1a195431b7a6 input=0d7c6a7651e2f0a5]*/
+{
+    _Py_IDENTIFIER(_when);
+    _Py_IDENTIFIER(_scheduled);
+    _Py_IDENTIFIER(append);
+    _Py_IDENTIFIER(popleft);
+
+    while (PyList_GET_SIZE(scheduled) > 0) {
+        PyObject *when =
+            _PyObject_GetAttrId(PyList_GET_ITEM(scheduled, 0), &PyId__when);
+        if (when == NULL) {
+            return NULL;
+        }
+        int later = PyObject_RichCompareBool(when, end_time, Py_GE);
+        Py_DECREF(when);
+        if (later < 0) {
+            return NULL;
+        }
+        if (later) {
+            break;
+        }
+        PyObject *handle = PyObject_CallFunctionObjArgs(
+            heapq_heappop, scheduled, NULL);
+        if (handle == NULL) {
+            return NULL;
+        }
+        if (_PyObject_SetAttrId(handle, &PyId__scheduled, Py_False) < 0) {
+            Py_DECREF(handle);
+            return NULL;
+        }
+        PyObject *res =
+            _PyObject_CallMethodIdObjArgs(ready, &PyId_append, handle, NULL);
+        Py_DECREF(handle);
+        if (res == NULL) {
+            return NULL;
+        }
+        Py_DECREF(res);
+    }
+
+    Py_ssize_t ntodo = PyObject_Size(ready);
+    if (ntodo < 0) {
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < ntodo; i++) {
+        PyObject *handle = _PyObject_CallMethodId(ready, &PyId_popleft, NULL);
+        if (handle == NULL) {
+            return NULL;
+        }
+        int err = run_ready_handle(handle);
+        Py_DECREF(handle);
+        if (err < 0) {
+            return NULL;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
+
+
 /*********************** Module **************************/
 
 
@@ -8367,6 +8968,9 @@ module_free(void *m)
 {
     Py_CLEAR(asyncio_mod);
     Py_CLEAR(traceback_extract_stack);
+    Py_CLEAR(asyncio_format_helpers_extract_stack);
+    Py_CLEAR(asyncio_format_callback_source);
+    Py_CLEAR(heapq_heappop);
     Py_CLEAR(asyncio_future_repr_info_func);
     Py_CLEAR(asyncio_get_event_loop_policy);
     Py_CLEAR(asyncio_iscoroutine_func);
@@ -8475,8 +9079,9 @@ module_init(void)
         goto fail; \
     }
 
-    WITH_MOD("asyncio.events")
-    GET_MOD_ATTR(asyncio_get_event_loop_policy, "get_event_loop_policy")
+    WITH_MOD("asyncio.format_helpers")
+    GET_MOD_ATTR(asyncio_format_helpers_extract_stack, "extract_stack")
+    GET_MOD_ATTR(asyncio_format_callback_source, "_format_callback_source")
 
     WITH_MOD("asyncio.base_futures")
     GET_MOD_ATTR(asyncio_future_repr_info_func, "_future_repr_info")
@@ -8500,6 +9105,9 @@ module_init(void)
     WITH_MOD("traceback")
     GET_MOD_ATTR(traceback_extract_stack, "extract_stack")
 
+    WITH_MOD("heapq")
+    GET_MOD_ATTR(heapq_heappop, "heappop")
+
     PyObject *weak_set;
     WITH_MOD("weakref")
     GET_MOD_ATTR(weak_set, "WeakSet");
@@ -8552,6 +9160,7 @@ static PyMethodDef asyncio_methods[] = {
     { "ig_gather_iterable_no_raise", (PyCFunction)_asyncio_ig_gather_iterable_no_raise, METH_FASTCALL, NULL },
     { "create_awaitable_value", (PyCFunction)_asyncio_create_awaitable_value, METH_O, NULL },
     _ASYNCIO__START_IMMEDIATE_METHODDEF
+    _ASYNCIO__RUN_READY_METHODDEF
     { "_clear_caches", (PyCFunction)_asyncio_clear_caches, METH_NOARGS, NULL },
     { "_clear_method_table", (PyCFunction)clear_method_table, METH_O, NULL},
     {NULL, NULL}
@@ -8672,6 +9281,14 @@ PyInit__asyncio(void)
     if (PyType_Ready(&_ContextAwareTaskCallback_Type) < 0) {
         return NULL;
     }
+    if (PyType_Ready(&HandleType) < 0) {
+        return NULL;
+    }
+    _Py_IDENTIFIER(_run);
+    handle_run_method = _PyType_LookupId(&HandleType, &PyId__run);
+    if (handle_run_method == NULL) {
+        return NULL;
+    }
     methodref_callback = PyCFunction_New(&_MethodTableRefCallback, NULL);
     if (methodref_callback == NULL) {
         return NULL;
@@ -8757,6 +9374,13 @@ PyInit__asyncio(void)
         return NULL;
     }
 
+    Py_INCREF(&HandleType);
+    if (PyModule_AddObject(m, "Handle", (PyObject *)&HandleType) < 0) {
+        Py_DECREF(&HandleType);
+        Py_DECREF(m);
+        return NULL;
+    }
+
     Py_INCREF(&ContextAwareTaskType);
     if (PyModule_AddObject(
             m, "ContextAwareTask", (PyObject *)&ContextAwareTaskType) < 0) {
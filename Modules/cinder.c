@@ -7,6 +7,8 @@
 #include "Jit/pyjit.h"
 
 PyAPI_FUNC(void) _PyShadow_ClearCache(PyObject *co);
+PyAPI_FUNC(void) _PyShadow_SetMemoryBudget(Py_ssize_t budget);
+PyAPI_FUNC(PyObject *) _PyShadow_GetMemoryStats(void);
 
 extern int _PyShadow_PolymorphicCacheEnabled;
 extern int _Py_SkipFinalCleanup;
@@ -303,6 +305,41 @@ clear_shadow_cache(PyObject *self, PyObject *obj)
     Py_RETURN_NONE;
 }
 
+static PyObject *
+set_shadowcode_budget(PyObject *self, PyObject *arg)
+{
+    Py_ssize_t budget = PyLong_AsSsize_t(arg);
+    if (budget == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (budget < 0) {
+        PyErr_SetString(PyExc_ValueError, "budget must be non-negative");
+        return NULL;
+    }
+    _PyShadow_SetMemoryBudget(budget);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_shadowcode_budget_doc,
+"set_shadowcode_budget(nbytes)\n\
+\n\
+Limit the memory used by shadow code in this process to nbytes, or remove\n\
+the limit if nbytes is 0. Shadow code for functions that have gone cold is\n\
+freed to stay within the limit, and recreated if they warm up again.");
+
+static PyObject *
+get_shadowcode_stats(PyObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return _PyShadow_GetMemoryStats();
+}
+
+PyDoc_STRVAR(get_shadowcode_stats_doc,
+"get_shadowcode_stats()\n\
+\n\
+Return a dict with the bytes used by shadow code in this process, the number\n\
+of code objects that have it, the current budget, and the number of times\n\
+shadow code has been evicted to stay within the budget.");
+
 
 PyDoc_STRVAR(strict_module_patch_doc,
 "strict_module_patch(mod, name, value)\n\
@@ -639,6 +676,14 @@ static struct PyMethodDef cinder_module_methods[] = {
      "Clears caches associated with the JIT.  This may have a negative effect "
      "on performance of existing JIT compiled code."},
     {"clear_shadow_cache", clear_shadow_cache, METH_O, ""},
+    {"set_shadowcode_budget",
+     set_shadowcode_budget,
+     METH_O,
+     set_shadowcode_budget_doc},
+    {"get_shadowcode_stats",
+     get_shadowcode_stats,
+     METH_NOARGS,
+     get_shadowcode_stats_doc},
     {"strict_module_patch",
      strict_module_patch,
      METH_VARARGS,
@@ -122,6 +122,36 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(gc_set_incremental__doc__,
+"set_incremental($module, budget, /)\n"
+"--\n"
+"\n"
+"Collect the oldest generation in increments that take about budget seconds.\n"
+"\n"
+"A budget of 0 collects the oldest generation all at once.  Explicit calls\n"
+"to collect() always collect all at once.");
+
+#define GC_SET_INCREMENTAL_METHODDEF    \
+    {"set_incremental", (PyCFunction)gc_set_incremental, METH_O, gc_set_incremental__doc__},
+
+PyDoc_STRVAR(gc_get_incremental__doc__,
+"get_incremental($module, /)\n"
+"--\n"
+"\n"
+"Return the time budget of an increment in seconds, or 0 if disabled.");
+
+#define GC_GET_INCREMENTAL_METHODDEF    \
+    {"get_incremental", (PyCFunction)gc_get_incremental, METH_NOARGS, gc_get_incremental__doc__},
+
+static PyObject *
+gc_get_incremental_impl(PyObject *module);
+
+static PyObject *
+gc_get_incremental(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return gc_get_incremental_impl(module);
+}
+
 PyDoc_STRVAR(gc_set_debug__doc__,
 "set_debug($module, flags, /)\n"
 "--\n"
@@ -293,6 +323,123 @@ gc_get_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
     return gc_get_stats_impl(module);
 }
 
+PyDoc_STRVAR(gc_enable_telemetry__doc__,
+"enable_telemetry($module, /, capacity=256, sample_every=1)\n"
+"--\n"
+"\n"
+"Start recording details of each collection for get_telemetry().\n"
+"\n"
+"Only the last capacity records are kept, and only one in every\n"
+"sample_every collections is recorded.  Any records already kept are\n"
+"discarded.");
+
+#define GC_ENABLE_TELEMETRY_METHODDEF    \
+    {"enable_telemetry", (PyCFunction)(void(*)(void))gc_enable_telemetry, METH_FASTCALL|METH_KEYWORDS, gc_enable_telemetry__doc__},
+
+static PyObject *
+gc_enable_telemetry_impl(PyObject *module, Py_ssize_t capacity,
+                         Py_ssize_t sample_every);
+
+static PyObject *
+gc_enable_telemetry(PyObject *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *return_value = NULL;
+    static const char * const _keywords[] = {"capacity", "sample_every", NULL};
+    static _PyArg_Parser _parser = {NULL, _keywords, "enable_telemetry", 0};
+    PyObject *argsbuf[2];
+    Py_ssize_t noptargs = nargs + (kwnames ? PyTuple_GET_SIZE(kwnames) : 0) - 0;
+    Py_ssize_t capacity = 256;
+    Py_ssize_t sample_every = 1;
+
+    args = _PyArg_UnpackKeywords(args, nargs, NULL, kwnames, &_parser, 0, 2, 0, argsbuf);
+    if (!args) {
+        goto exit;
+    }
+    if (!noptargs) {
+        goto skip_optional_pos;
+    }
+    if (args[0]) {
+        if (PyFloat_Check(args[0])) {
+            PyErr_SetString(PyExc_TypeError,
+                            "integer argument expected, got float" );
+            goto exit;
+        }
+        {
+            Py_ssize_t ival = -1;
+            PyObject *iobj = PyNumber_Index(args[0]);
+            if (iobj != NULL) {
+                ival = PyLong_AsSsize_t(iobj);
+                Py_DECREF(iobj);
+            }
+            if (ival == -1 && PyErr_Occurred()) {
+                goto exit;
+            }
+            capacity = ival;
+        }
+        if (!--noptargs) {
+            goto skip_optional_pos;
+        }
+    }
+    if (PyFloat_Check(args[1])) {
+        PyErr_SetString(PyExc_TypeError,
+                        "integer argument expected, got float" );
+        goto exit;
+    }
+    {
+        Py_ssize_t ival = -1;
+        PyObject *iobj = PyNumber_Index(args[1]);
+        if (iobj != NULL) {
+            ival = PyLong_AsSsize_t(iobj);
+            Py_DECREF(iobj);
+        }
+        if (ival == -1 && PyErr_Occurred()) {
+            goto exit;
+        }
+        sample_every = ival;
+    }
+skip_optional_pos:
+    return_value = gc_enable_telemetry_impl(module, capacity, sample_every);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_disable_telemetry__doc__,
+"disable_telemetry($module, /)\n"
+"--\n"
+"\n"
+"Stop recording collections and discard the records kept so far.");
+
+#define GC_DISABLE_TELEMETRY_METHODDEF    \
+    {"disable_telemetry", (PyCFunction)gc_disable_telemetry, METH_NOARGS, gc_disable_telemetry__doc__},
+
+static PyObject *
+gc_disable_telemetry_impl(PyObject *module);
+
+static PyObject *
+gc_disable_telemetry(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return gc_disable_telemetry_impl(module);
+}
+
+PyDoc_STRVAR(gc_get_telemetry__doc__,
+"get_telemetry($module, /)\n"
+"--\n"
+"\n"
+"Return a list of dictionaries describing recent collections, oldest first.");
+
+#define GC_GET_TELEMETRY_METHODDEF    \
+    {"get_telemetry", (PyCFunction)gc_get_telemetry, METH_NOARGS, gc_get_telemetry__doc__},
+
+static PyObject *
+gc_get_telemetry_impl(PyObject *module);
+
+static PyObject *
+gc_get_telemetry(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return gc_get_telemetry_impl(module);
+}
+
 PyDoc_STRVAR(gc_is_tracked__doc__,
 "is_tracked($module, obj, /)\n"
 "--\n"
@@ -373,4 +520,4 @@ gc_get_freeze_count(PyObject *module, PyObject *Py_UNUSED(ignored))
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=e40d384b1f0d513c input=a9049054013a1b77]*/
+/*[clinic end generated code: output=c78f73967deb3a5d input=a9049054013a1b77]*/
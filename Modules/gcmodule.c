@@ -125,6 +125,17 @@ static PyObject *gc_str = NULL;
 
 #define GEN_HEAD(state, n) (&(state)->generations[n].head)
 
+/* Bounds on the number of objects examined by one increment of the oldest
+   generation, and the number examined by the first one. */
+#define GC_MIN_INCREMENT        100
+#define GC_MAX_INCREMENT        10000000
+#define GC_INITIAL_INCREMENT    10000
+
+/* Incremental collection still falls back to a full collection of the
+   oldest generation after this many passes, or once the generation has
+   doubled in size since the last full one. */
+#define GC_PASSES_PER_FULL      8
+
 void
 _PyGC_Initialize(struct _gc_runtime_state *state)
 {
@@ -146,6 +157,7 @@ _PyGC_Initialize(struct _gc_runtime_state *state)
            (uintptr_t)&state->permanent_generation.head}, 0, 0
     };
     state->permanent_generation = permanent_generation;
+    state->increment_size = GC_INITIAL_INCREMENT;
 }
 
 /*
@@ -287,6 +299,37 @@ gc_list_merge(PyGC_Head *from, PyGC_Head *to)
     gc_list_init(from);
 }
 
+/* Move up to `n` objects from the front of list `from` to the empty list
+ * `to`, keeping their order.  Return the number of objects moved.
+ */
+static Py_ssize_t
+gc_list_take(PyGC_Head *from, PyGC_Head *to, Py_ssize_t n)
+{
+    assert(gc_list_is_empty(to));
+    PyGC_Head *last = from;
+    Py_ssize_t taken = 0;
+    while (taken < n && GC_NEXT(last) != from) {
+        last = GC_NEXT(last);
+        taken++;
+    }
+    if (taken == 0) {
+        return 0;
+    }
+    PyGC_Head *first = GC_NEXT(from);
+    PyGC_Head *rest = GC_NEXT(last);
+
+    // from <-> rest
+    _PyGCHead_SET_NEXT(from, rest);
+    _PyGCHead_SET_PREV(rest, from);
+
+    // to <-> first ... last <-> to
+    _PyGCHead_SET_NEXT(to, first);
+    _PyGCHead_SET_PREV(first, to);
+    _PyGCHead_SET_NEXT(last, to);
+    _PyGCHead_SET_PREV(to, last);
+    return taken;
+}
+
 static Py_ssize_t
 gc_list_size(PyGC_Head *list)
 {
@@ -1004,83 +1047,123 @@ show_stats_each_generations(struct _gc_runtime_state *state)
         buf, gc_list_size(&state->permanent_generation.head));
 }
 
-/* This is the main function.  Read this to understand how the
- * collection process works. */
-static Py_ssize_t
-collect(struct _gc_runtime_state *state, int generation,
-        Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable, int nofail)
+/* Record how long a collection took in the pause histogram of `stats`. */
+static void
+record_pause(struct gc_generation_stats *stats, _PyTime_t elapsed)
 {
-    int i;
-    Py_ssize_t m = 0; /* # objects collected */
-    Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
-    PyGC_Head *young; /* the generation we are examining */
-    PyGC_Head *old; /* next older generation */
-    PyGC_Head unreachable; /* non-problematic unreachable trash */
-    PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
-    PyGC_Head *gc;
-    _PyTime_t t1 = 0;   /* initialize to prevent a compiler warning */
-
-    if (state->debug & DEBUG_STATS) {
-        PySys_WriteStderr("gc: collecting generation %d...\n", generation);
-        show_stats_each_generations(state);
-        t1 = _PyTime_GetMonotonicClock();
+    _PyTime_t bound = _PyTime_FromNanoseconds(100 * 1000);
+    int i = 0;
+    while (i < GC_PAUSE_BUCKETS - 1 && elapsed >= bound) {
+        bound *= 10;
+        i++;
     }
+    stats->pauses[i]++;
+}
 
-    if (PyDTrace_GC_START_ENABLED())
-        PyDTrace_GC_START(generation);
+/*** telemetry ***/
 
-    /* update collection and allocation counters */
-    if (generation+1 < NUM_GENERATIONS)
-        state->generations[generation+1].count += 1;
-    for (i = 0; i <= generation; i++)
-        state->generations[i].count = 0;
+static const char *gc_phase_names[GC_NUM_PHASES] = {
+    "deduce_unreachable",
+    "legacy_finalizers",
+    "handle_weakrefs",
+    "finalize_garbage",
+    "delete_garbage",
+};
 
-    /* merge younger generations with one we are currently collecting */
-    for (i = 0; i < generation; i++) {
-        gc_list_merge(GEN_HEAD(state, i), GEN_HEAD(state, generation));
+/* If the collection starting at `start` should be recorded, initialize `rec`
+ * for it and return it.  Otherwise return NULL.
+ */
+static struct gc_collection_record *
+telemetry_begin(struct _gc_runtime_state *state,
+                struct gc_collection_record *rec, int generation,
+                int incremental, _PyTime_t start)
+{
+    if (state->telemetry == NULL) {
+        return NULL;
+    }
+    if (state->telemetry_countdown > 0) {
+        state->telemetry_countdown--;
+        return NULL;
     }
+    state->telemetry_countdown = state->telemetry_sample_every - 1;
 
-    /* handy references */
-    young = GEN_HEAD(state, generation);
-    if (generation < NUM_GENERATIONS-1)
-        old = GEN_HEAD(state, generation+1);
-    else
-        old = young;
+    memset(rec, 0, sizeof(*rec));
+    rec->generation = generation;
+    rec->incremental = (char)incremental;
+    rec->allocations = state->generations[0].count;
+    rec->start = start;
+    return rec;
+}
 
-    validate_list(young, 0);
-    validate_list(old, 0);
+/* Add `rec` to the ring buffer. */
+static void
+telemetry_commit(struct _gc_runtime_state *state,
+                 struct gc_collection_record *rec)
+{
+    /* A finalizer may have disabled telemetry during the collection. */
+    if (state->telemetry == NULL) {
+        return;
+    }
+    Py_ssize_t i = state->telemetry_written % state->telemetry_capacity;
+    state->telemetry[i] = *rec;
+    state->telemetry_written++;
+}
+
+/* If recording, charge the time since *t to `phase` and restart *t. */
+static inline void
+time_phase(struct gc_collection_record *rec, enum gc_phase phase,
+           _PyTime_t *t)
+{
+    if (rec != NULL) {
+        _PyTime_t now = _PyTime_GetMonotonicClock();
+        rec->phases[phase] += now - *t;
+        *t = now;
+    }
+}
+
+/* Deduce which objects among `base` are unreachable from outside the list
+ * and move them to `unreachable`.  The objects left in `base` are reachable
+ * from outside it, either directly or through other objects in `base`.
+ */
+static void
+deduce_unreachable(PyGC_Head *base, PyGC_Head *unreachable)
+{
+    validate_list(base, 0);
     /* Using ob_refcnt and gc_refs, calculate which objects in the
      * container set are reachable from outside the set (i.e., have a
      * refcount greater than 0 when all the references within the
      * set are taken into account).
      */
-    update_refs(young);  // gc_prev is used for gc_refs
-    subtract_refs(young);
+    update_refs(base);  // gc_prev is used for gc_refs
+    subtract_refs(base);
 
-    /* Leave everything reachable from outside young in young, and move
-     * everything else (in young) to unreachable.
+    /* Leave everything reachable from outside base in base, and move
+     * everything else (in base) to unreachable.
      * NOTE:  This used to move the reachable objects into a reachable
      * set instead.  But most things usually turn out to be reachable,
      * so it's more efficient to move the unreachable things.
      */
-    gc_list_init(&unreachable);
-    move_unreachable(young, &unreachable);  // gc_prev is pointer again
-    validate_list(young, 0);
+    gc_list_init(unreachable);
+    move_unreachable(base, unreachable);  // gc_prev is pointer again
+    validate_list(base, 0);
+}
 
-    untrack_tuples(young);
-    /* Move reachable objects to next generation. */
-    if (young != old) {
-        if (generation == NUM_GENERATIONS - 2) {
-            state->long_lived_pending += gc_list_size(young);
-        }
-        gc_list_merge(young, old);
-    }
-    else {
-        /* We only untrack dicts in full collections, to avoid quadratic
-           dict build-up. See issue #14775. */
-        untrack_dicts(young);
-        state->long_lived_pending = 0;
-        state->long_lived_total = gc_list_size(young);
+/* Free the objects in `unreachable`, moving any that survive to `old`.
+ * Add the number of objects collected to *m and the number that couldn't
+ * be collected to *n.
+ */
+static void
+handle_unreachable(struct _gc_runtime_state *state, PyGC_Head *unreachable,
+                   PyGC_Head *old, Py_ssize_t *m, Py_ssize_t *n,
+                   struct gc_collection_record *rec)
+{
+    PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
+    PyGC_Head *gc;
+    _PyTime_t t = 0;
+
+    if (rec != NULL) {
+        rec->unreachable = gc_list_size(unreachable);
+        t = _PyTime_GetMonotonicClock();
     }
 
     /* All objects in unreachable are trash, but objects reachable from
@@ -1089,58 +1172,55 @@ collect(struct _gc_runtime_state *state, int generation,
     gc_list_init(&finalizers);
     // NEXT_MASK_UNREACHABLE is cleared here.
     // After move_legacy_finalizers(), unreachable is normal list.
-    move_legacy_finalizers(&unreachable, &finalizers);
+    move_legacy_finalizers(unreachable, &finalizers);
     /* finalizers contains the unreachable objects with a legacy finalizer;
      * unreachable objects reachable *from* those are also uncollectable,
      * and we move those into the finalizers list too.
      */
     move_legacy_finalizer_reachable(&finalizers);
+    time_phase(rec, GC_PHASE_LEGACY_FINALIZERS, &t);
 
     validate_list(&finalizers, 0);
-    validate_list(&unreachable, PREV_MASK_COLLECTING);
+    validate_list(unreachable, PREV_MASK_COLLECTING);
 
     /* Print debugging information. */
     if (state->debug & DEBUG_COLLECTABLE) {
-        for (gc = GC_NEXT(&unreachable); gc != &unreachable; gc = GC_NEXT(gc)) {
+        for (gc = GC_NEXT(unreachable); gc != unreachable; gc = GC_NEXT(gc)) {
             debug_cycle("collectable", FROM_GC(gc));
         }
     }
 
     /* Clear weakrefs and invoke callbacks as necessary. */
-    m += handle_weakrefs(&unreachable, old);
+    *m += handle_weakrefs(unreachable, old);
+    time_phase(rec, GC_PHASE_HANDLE_WEAKREFS, &t);
 
     validate_list(old, 0);
-    validate_list(&unreachable, PREV_MASK_COLLECTING);
+    validate_list(unreachable, PREV_MASK_COLLECTING);
 
     /* Call tp_finalize on objects which have one. */
-    finalize_garbage(&unreachable);
+    finalize_garbage(unreachable);
+    time_phase(rec, GC_PHASE_FINALIZE_GARBAGE, &t);
 
-    if (check_garbage(&unreachable)) { // clear PREV_MASK_COLLECTING here
-        gc_list_merge(&unreachable, old);
+    if (check_garbage(unreachable)) { // clear PREV_MASK_COLLECTING here
+        gc_list_merge(unreachable, old);
     }
     else {
         /* Call tp_clear on objects in the unreachable set.  This will cause
          * the reference cycles to be broken.  It may also cause some objects
          * in finalizers to be freed.
          */
-        m += gc_list_size(&unreachable);
-        delete_garbage(state, &unreachable, old);
+        *m += gc_list_size(unreachable);
+        delete_garbage(state, unreachable, old);
     }
+    time_phase(rec, GC_PHASE_DELETE_GARBAGE, &t);
 
     /* Collect statistics on uncollectable objects found and print
      * debugging information. */
     for (gc = GC_NEXT(&finalizers); gc != &finalizers; gc = GC_NEXT(gc)) {
-        n++;
+        (*n)++;
         if (state->debug & DEBUG_UNCOLLECTABLE)
             debug_cycle("uncollectable", FROM_GC(gc));
     }
-    if (state->debug & DEBUG_STATS) {
-        double d = _PyTime_AsSecondsDouble(_PyTime_GetMonotonicClock() - t1);
-        PySys_WriteStderr(
-            "gc: done, %" PY_FORMAT_SIZE_T "d unreachable, "
-            "%" PY_FORMAT_SIZE_T "d uncollectable, %.4fs elapsed\n",
-            n+m, n, d);
-    }
 
     /* Append instances in the uncollectable set to a Python
      * reachable list of garbage.  The programmer has to deal with
@@ -1148,13 +1228,11 @@ collect(struct _gc_runtime_state *state, int generation,
      */
     handle_legacy_finalizers(state, &finalizers, old);
     validate_list(old, 0);
+}
 
-    /* Clear free list only during the collection of the highest
-     * generation */
-    if (generation == NUM_GENERATIONS-1) {
-        clear_freelists();
-    }
-
+static void
+handle_collection_error(int nofail)
+{
     if (PyErr_Occurred()) {
         if (nofail) {
             PyErr_Clear();
@@ -1166,6 +1244,99 @@ collect(struct _gc_runtime_state *state, int generation,
             Py_FatalError("unexpected exception during garbage collection");
         }
     }
+}
+
+/* This is the main function.  Read this to understand how the
+ * collection process works. */
+static Py_ssize_t
+collect(struct _gc_runtime_state *state, int generation,
+        Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable, int nofail)
+{
+    int i;
+    Py_ssize_t m = 0; /* # objects collected */
+    Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
+    PyGC_Head *young; /* the generation we are examining */
+    PyGC_Head *old; /* next older generation */
+    PyGC_Head unreachable; /* non-problematic unreachable trash */
+    _PyTime_t t1 = _PyTime_GetMonotonicClock();
+    struct gc_collection_record record;
+    struct gc_collection_record *rec =
+        telemetry_begin(state, &record, generation, 0, t1);
+
+    if (state->debug & DEBUG_STATS) {
+        PySys_WriteStderr("gc: collecting generation %d...\n", generation);
+        show_stats_each_generations(state);
+    }
+
+    if (PyDTrace_GC_START_ENABLED())
+        PyDTrace_GC_START(generation);
+
+    /* update collection and allocation counters */
+    if (generation+1 < NUM_GENERATIONS)
+        state->generations[generation+1].count += 1;
+    for (i = 0; i <= generation; i++)
+        state->generations[i].count = 0;
+
+    /* merge younger generations with one we are currently collecting */
+    for (i = 0; i < generation; i++) {
+        gc_list_merge(GEN_HEAD(state, i), GEN_HEAD(state, generation));
+    }
+
+    /* handy references */
+    young = GEN_HEAD(state, generation);
+    if (generation < NUM_GENERATIONS-1)
+        old = GEN_HEAD(state, generation+1);
+    else
+        old = young;
+
+    validate_list(old, 0);
+    _PyTime_t t = 0;
+    if (rec != NULL) {
+        rec->visited = gc_list_size(young);
+        t = _PyTime_GetMonotonicClock();
+    }
+    deduce_unreachable(young, &unreachable);
+    time_phase(rec, GC_PHASE_DEDUCE_UNREACHABLE, &t);
+
+    untrack_tuples(young);
+    /* Move reachable objects to next generation. */
+    if (young != old) {
+        if (generation == NUM_GENERATIONS - 2) {
+            state->long_lived_pending += gc_list_size(young);
+        }
+        gc_list_merge(young, old);
+    }
+    else {
+        /* We only untrack dicts in full collections, to avoid quadratic
+           dict build-up. See issue #14775. */
+        untrack_dicts(young);
+        state->long_lived_pending = 0;
+        state->long_lived_total = gc_list_size(young);
+        /* This supersedes any incremental pass in progress. */
+        state->increment_remaining = 0;
+        state->increment_survivors = 0;
+        state->passes_since_full = 0;
+        state->long_lived_at_full = state->long_lived_total;
+    }
+
+    handle_unreachable(state, &unreachable, old, &m, &n, rec);
+
+    _PyTime_t elapsed = _PyTime_GetMonotonicClock() - t1;
+    if (state->debug & DEBUG_STATS) {
+        double d = _PyTime_AsSecondsDouble(elapsed);
+        PySys_WriteStderr(
+            "gc: done, %" PY_FORMAT_SIZE_T "d unreachable, "
+            "%" PY_FORMAT_SIZE_T "d uncollectable, %.4fs elapsed\n",
+            n+m, n, d);
+    }
+
+    /* Clear free list only during the collection of the highest
+     * generation */
+    if (generation == NUM_GENERATIONS-1) {
+        clear_freelists();
+    }
+
+    handle_collection_error(nofail);
 
     /* Update stats */
     if (n_collected) {
@@ -1179,6 +1350,14 @@ collect(struct _gc_runtime_state *state, int generation,
     stats->collections++;
     stats->collected += m;
     stats->uncollectable += n;
+    record_pause(stats, elapsed);
+
+    if (rec != NULL) {
+        rec->duration = elapsed;
+        rec->collected = m;
+        rec->uncollectable = n;
+        telemetry_commit(state, rec);
+    }
 
     if (PyDTrace_GC_DONE_ENABLED()) {
         PyDTrace_GC_DONE(n+m);
@@ -1188,6 +1367,178 @@ collect(struct _gc_runtime_state *state, int generation,
     return n+m;
 }
 
+/* Incremental collection of the oldest generation
+ * ===============================================
+ *
+ * When an increment budget is set, the oldest generation isn't collected all
+ * at once when its threshold is reached.  Instead a pass over it starts, and
+ * after each collection of the younger generations one increment of the pass
+ * runs: it takes the first increment_size objects of the oldest generation
+ * and collects them as if they were a generation of their own.  References
+ * from objects outside the increment keep objects in it alive, just as
+ * references from older generations do in a young collection, so this never
+ * frees anything reachable.  Survivors go to the back of the list, and the
+ * pass is done once about as many objects as the generation held when the
+ * pass started have been examined.
+ *
+ * The price is that a cycle is only found if it lies entirely within one
+ * increment.  Every other pass starts half an increment later, so small
+ * cycles split by an increment boundary are found by the next pass, but a
+ * cycle larger than an increment is only found by a full collection.  So
+ * every GC_PASSES_PER_FULL passes, or when the generation has doubled since
+ * the last full collection, the oldest generation is collected all at once
+ * instead of starting another pass.
+ *
+ * increment_size adapts so that increments take about increment_budget.
+ */
+
+/* Return true if the oldest generation should get a full collection rather
+ * than another incremental pass.  Growth below GC_INITIAL_INCREMENT objects
+ * doesn't count, so a small generation isn't collected in full every time.
+ */
+static int
+full_collection_due(struct _gc_runtime_state *state)
+{
+    if (state->passes_since_full >= GC_PASSES_PER_FULL) {
+        return 1;
+    }
+    Py_ssize_t growth = state->long_lived_total + state->long_lived_pending
+        - state->long_lived_at_full;
+    return growth > state->long_lived_at_full &&
+        growth > GC_INITIAL_INCREMENT;
+}
+
+/* Start a pass over the oldest generation unless one is in progress. */
+static void
+start_incremental_pass(struct _gc_runtime_state *state)
+{
+    PyGC_Head *old = GEN_HEAD(state, NUM_GENERATIONS-1);
+    state->generations[NUM_GENERATIONS-1].count = 0;
+    if (state->increment_remaining > 0) {
+        return;
+    }
+    state->increment_remaining =
+        state->long_lived_total + state->long_lived_pending;
+    state->long_lived_pending = 0;
+    state->increment_survivors = 0;
+    state->passes_since_full++;
+    if (state->increment_passes++ & 1) {
+        /* Shift the increment boundaries by half an increment. */
+        PyGC_Head skipped;
+        gc_list_init(&skipped);
+        gc_list_take(old, &skipped, state->increment_size / 2);
+        gc_list_merge(&skipped, old);
+    }
+}
+
+/* Aim for the next increment to take increment_budget, given that the last
+ * one examined `size` objects in `elapsed`.
+ */
+static void
+adjust_increment_size(struct _gc_runtime_state *state, Py_ssize_t size,
+                      _PyTime_t elapsed)
+{
+    if (size < state->increment_size || elapsed <= 0) {
+        /* Too small a sample to learn anything from. */
+        return;
+    }
+    double target = (double)size * state->increment_budget / elapsed;
+    /* Smooth out noise from the timer and from uneven object graphs. */
+    double next = (state->increment_size + target) / 2;
+    if (next < GC_MIN_INCREMENT) {
+        next = GC_MIN_INCREMENT;
+    }
+    else if (next > GC_MAX_INCREMENT) {
+        next = GC_MAX_INCREMENT;
+    }
+    state->increment_size = (Py_ssize_t)next;
+}
+
+/* Run the next increment of the current pass over the oldest generation. */
+static Py_ssize_t
+collect_increment(struct _gc_runtime_state *state,
+                  Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable)
+{
+    const int generation = NUM_GENERATIONS-1;
+    Py_ssize_t m = 0; /* # objects collected */
+    Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
+    PyGC_Head *old = GEN_HEAD(state, generation);
+    PyGC_Head increment; /* the objects we are examining */
+    PyGC_Head unreachable; /* non-problematic unreachable trash */
+    _PyTime_t t1 = _PyTime_GetMonotonicClock();
+    struct gc_collection_record record;
+    struct gc_collection_record *rec =
+        telemetry_begin(state, &record, generation, 1, t1);
+
+    assert(state->increment_remaining > 0);
+    Py_ssize_t size = state->increment_size;
+    gc_list_init(&increment);
+    Py_ssize_t taken = gc_list_take(old, &increment, size);
+
+    if (state->debug & DEBUG_STATS) {
+        PySys_WriteStderr(
+            "gc: collecting %" PY_FORMAT_SIZE_T "d objects of generation "
+            "%d...\n", taken, generation);
+    }
+
+    _PyTime_t t = t1;
+    if (rec != NULL) {
+        rec->visited = taken;
+    }
+    deduce_unreachable(&increment, &unreachable);
+    time_phase(rec, GC_PHASE_DEDUCE_UNREACHABLE, &t);
+
+    untrack_tuples(&increment);
+    untrack_dicts(&increment);
+    state->increment_survivors += gc_list_size(&increment);
+    gc_list_merge(&increment, old);
+
+    handle_unreachable(state, &unreachable, old, &m, &n, rec);
+
+    state->increment_remaining -= taken;
+    if (state->increment_remaining <= 0 || taken < size) {
+        /* The pass is done. */
+        state->increment_remaining = 0;
+        state->long_lived_total = state->increment_survivors;
+        state->increment_survivors = 0;
+    }
+
+    _PyTime_t elapsed = _PyTime_GetMonotonicClock() - t1;
+    if (state->debug & DEBUG_STATS) {
+        double d = _PyTime_AsSecondsDouble(elapsed);
+        PySys_WriteStderr(
+            "gc: done, %" PY_FORMAT_SIZE_T "d unreachable, "
+            "%" PY_FORMAT_SIZE_T "d uncollectable, %.4fs elapsed\n",
+            n+m, n, d);
+    }
+    adjust_increment_size(state, taken, elapsed);
+
+    handle_collection_error(0);
+
+    if (n_collected) {
+        *n_collected = m;
+    }
+    if (n_uncollectable) {
+        *n_uncollectable = n;
+    }
+
+    struct gc_generation_stats *stats = &state->generation_stats[generation];
+    stats->increments++;
+    stats->collected += m;
+    stats->uncollectable += n;
+    record_pause(stats, elapsed);
+
+    if (rec != NULL) {
+        rec->duration = elapsed;
+        rec->collected = m;
+        rec->uncollectable = n;
+        telemetry_commit(state, rec);
+    }
+
+    assert(!PyErr_Occurred());
+    return n+m;
+}
+
 /* Invoke progress callbacks to notify clients that garbage collection
  * is starting or stopping
  */
@@ -1247,6 +1598,21 @@ collect_with_callback(struct _gc_runtime_state *state, int generation)
     return result;
 }
 
+/* Run an increment of the oldest generation and invoke progress callbacks.
+ */
+static Py_ssize_t
+collect_increment_with_callback(struct _gc_runtime_state *state)
+{
+    assert(!PyErr_Occurred());
+    Py_ssize_t result, collected, uncollectable;
+    invoke_gc_callback(state, "start", NUM_GENERATIONS-1, 0, 0);
+    result = collect_increment(state, &collected, &uncollectable);
+    invoke_gc_callback(state, "stop", NUM_GENERATIONS-1,
+                       collected, uncollectable);
+    assert(!PyErr_Occurred());
+    return result;
+}
+
 static Py_ssize_t
 collect_generations(struct _gc_runtime_state *state)
 {
@@ -1260,13 +1626,24 @@ collect_generations(struct _gc_runtime_state *state)
                of tracked objects. See comments at the beginning
                of this file, and issue #4074.
             */
-            if (i == NUM_GENERATIONS - 1
-                && state->long_lived_pending < state->long_lived_total / 4)
-                continue;
+            if (i == NUM_GENERATIONS - 1) {
+                if (state->long_lived_pending < state->long_lived_total / 4)
+                    continue;
+                if (state->increment_budget > 0 &&
+                    !full_collection_due(state)) {
+                    /* Collect it a slice at a time instead; see
+                       collect_increment(). */
+                    start_incremental_pass(state);
+                    continue;
+                }
+            }
             n = collect_with_callback(state, i);
             break;
         }
     }
+    if (state->increment_remaining > 0) {
+        n += collect_increment_with_callback(state);
+    }
     return n;
 }
 
@@ -1351,6 +1728,54 @@ gc_collect_impl(PyObject *module, int generation)
     return n;
 }
 
+/*[clinic input]
+gc.set_incremental
+
+    budget: object
+    /
+
+Collect the oldest generation in increments that take about budget seconds.
+
+A budget of 0 collects the oldest generation all at once.  Explicit calls
+to collect() always collect all at once.
+[clinic start generated code]*/
+
+static PyObject *
+gc_set_incremental(PyObject *module, PyObject *budget)
+/*[clinic end generated code: output=6a3c4a1498708ace input=4340eb1dad9a586b]*/
+{
+    _PyTime_t t;
+    if (_PyTime_FromSecondsObject(&t, budget, _PyTime_ROUND_CEILING) < 0) {
+        return NULL;
+    }
+    if (t < 0) {
+        PyErr_SetString(PyExc_ValueError, "budget must be non-negative");
+        return NULL;
+    }
+
+    struct _gc_runtime_state *state = &_PyRuntime.gc;
+    state->increment_budget = t;
+    if (t == 0) {
+        state->increment_remaining = 0;
+        state->increment_survivors = 0;
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.get_incremental
+
+Return the time budget of an increment in seconds, or 0 if disabled.
+[clinic start generated code]*/
+
+static PyObject *
+gc_get_incremental_impl(PyObject *module)
+/*[clinic end generated code: output=7dd3078b18c0e4ba input=8f49d8c9275b8ff0]*/
+{
+    struct _gc_runtime_state *state = &_PyRuntime.gc;
+    return PyFloat_FromDouble(_PyTime_AsSecondsDouble(state->increment_budget));
+}
+
 /*[clinic input]
 gc.set_debug
 
@@ -1594,6 +2019,40 @@ error:
     return NULL;
 }
 
+/* Return a dict mapping the upper bound of each pause histogram bucket, in
+   seconds, to the number of pauses in it. */
+static PyObject *
+pause_histogram(struct gc_generation_stats *st)
+{
+    PyObject *result = PyDict_New();
+    if (result == NULL)
+        return NULL;
+
+    double bound = 1e-4;
+    for (int i = 0; i < GC_PAUSE_BUCKETS; i++) {
+        PyObject *key = PyFloat_FromDouble(
+            i == GC_PAUSE_BUCKETS - 1 ? Py_HUGE_VAL : bound);
+        if (key == NULL)
+            goto error;
+        PyObject *count = PyLong_FromSsize_t(st->pauses[i]);
+        if (count == NULL) {
+            Py_DECREF(key);
+            goto error;
+        }
+        int err = PyDict_SetItem(result, key, count);
+        Py_DECREF(key);
+        Py_DECREF(count);
+        if (err < 0)
+            goto error;
+        bound *= 10;
+    }
+    return result;
+
+error:
+    Py_DECREF(result);
+    return NULL;
+}
+
 /*[clinic input]
 gc.get_stats
 
@@ -1619,12 +2078,17 @@ gc_get_stats_impl(PyObject *module)
         return NULL;
 
     for (i = 0; i < NUM_GENERATIONS; i++) {
-        PyObject *dict;
+        PyObject *dict, *histogram;
         st = &stats[i];
-        dict = Py_BuildValue("{snsnsn}",
+        histogram = pause_histogram(st);
+        if (histogram == NULL)
+            goto error;
+        dict = Py_BuildValue("{snsnsnsnsN}",
                              "collections", st->collections,
                              "collected", st->collected,
-                             "uncollectable", st->uncollectable
+                             "uncollectable", st->uncollectable,
+                             "increments", st->increments,
+                             "pause_histogram", histogram
                             );
         if (dict == NULL)
             goto error;
@@ -1642,6 +2106,150 @@ error:
 }
 
 
+/*[clinic input]
+gc.enable_telemetry
+
+    capacity: Py_ssize_t = 256
+    sample_every: Py_ssize_t = 1
+
+Start recording details of each collection for get_telemetry().
+
+Only the last capacity records are kept, and only one in every
+sample_every collections is recorded.  Any records already kept are
+discarded.
+[clinic start generated code]*/
+
+static PyObject *
+gc_enable_telemetry_impl(PyObject *module, Py_ssize_t capacity,
+                         Py_ssize_t sample_every)
+/*[clinic end generated code: output=ee8810246c7f3c90 input=4a08446ea18df90a]*/
+{
+    if (capacity <= 0) {
+        PyErr_SetString(PyExc_ValueError, "capacity must be positive");
+        return NULL;
+    }
+    if (sample_every <= 0) {
+        PyErr_SetString(PyExc_ValueError, "sample_every must be positive");
+        return NULL;
+    }
+    struct gc_collection_record *records =
+        PyMem_RawCalloc(capacity, sizeof(struct gc_collection_record));
+    if (records == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    struct _gc_runtime_state *state = &_PyRuntime.gc;
+    PyMem_RawFree(state->telemetry);
+    state->telemetry = records;
+    state->telemetry_capacity = capacity;
+    state->telemetry_written = 0;
+    state->telemetry_sample_every = sample_every;
+    state->telemetry_countdown = 0;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.disable_telemetry
+
+Stop recording collections and discard the records kept so far.
+[clinic start generated code]*/
+
+static PyObject *
+gc_disable_telemetry_impl(PyObject *module)
+/*[clinic end generated code: output=c97b564be71c7200 input=3e9e00de4bdeeda1]*/
+{
+    struct _gc_runtime_state *state = &_PyRuntime.gc;
+    PyMem_RawFree(state->telemetry);
+    state->telemetry = NULL;
+    state->telemetry_capacity = 0;
+    state->telemetry_written = 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+telemetry_record_as_dict(struct gc_collection_record *rec)
+{
+    PyObject *phases = PyDict_New();
+    if (phases == NULL)
+        return NULL;
+    for (int i = 0; i < GC_NUM_PHASES; i++) {
+        PyObject *duration = PyFloat_FromDouble(
+            _PyTime_AsSecondsDouble(rec->phases[i]));
+        if (duration == NULL) {
+            Py_DECREF(phases);
+            return NULL;
+        }
+        int err = PyDict_SetItemString(phases, gc_phase_names[i], duration);
+        Py_DECREF(duration);
+        if (err < 0) {
+            Py_DECREF(phases);
+            return NULL;
+        }
+    }
+
+    return Py_BuildValue("{sisNsisdsdsNsnsnsnsn}",
+                         "generation", rec->generation,
+                         "incremental", PyBool_FromLong(rec->incremental),
+                         "allocations", rec->allocations,
+                         "start", _PyTime_AsSecondsDouble(rec->start),
+                         "duration", _PyTime_AsSecondsDouble(rec->duration),
+                         "phases", phases,
+                         "visited", rec->visited,
+                         "unreachable", rec->unreachable,
+                         "collected", rec->collected,
+                         "uncollectable", rec->uncollectable);
+}
+
+/*[clinic input]
+gc.get_telemetry
+
+Return a list of dictionaries describing recent collections, oldest first.
+[clinic start generated code]*/
+
+static PyObject *
+gc_get_telemetry_impl(PyObject *module)
+/*[clinic end generated code: output=e27a8e501d5061d4 input=f53c3e0b8077f97e]*/
+{
+    struct _gc_runtime_state *state = &_PyRuntime.gc;
+    if (state->telemetry == NULL) {
+        return PyList_New(0);
+    }
+
+    /* Building the result can trigger collections that overwrite the ring
+       buffer, so work from a snapshot of it. */
+    Py_ssize_t capacity = state->telemetry_capacity;
+    Py_ssize_t written = state->telemetry_written;
+    Py_ssize_t count = Py_MIN(written, capacity);
+    struct gc_collection_record *records =
+        PyMem_RawMalloc(Py_MAX(count, 1) * sizeof(*records));
+    if (records == NULL) {
+        return PyErr_NoMemory();
+    }
+    for (Py_ssize_t i = 0; i < count; i++) {
+        records[i] = state->telemetry[(written - count + i) % capacity];
+    }
+
+    PyObject *result = PyList_New(count);
+    if (result == NULL) {
+        goto error;
+    }
+    for (Py_ssize_t i = 0; i < count; i++) {
+        PyObject *dict = telemetry_record_as_dict(&records[i]);
+        if (dict == NULL) {
+            goto error;
+        }
+        PyList_SET_ITEM(result, i, dict);
+    }
+    PyMem_RawFree(records);
+    return result;
+
+error:
+    PyMem_RawFree(records);
+    Py_XDECREF(result);
+    return NULL;
+}
+
+
 /*[clinic input]
 gc.is_tracked
 
@@ -1902,10 +2510,15 @@ PyDoc_STRVAR(gc__doc__,
 "collect() -- Do a full collection right now.\n"
 "get_count() -- Return the current collection counts.\n"
 "get_stats() -- Return list of dictionaries containing per-generation stats.\n"
+"enable_telemetry() -- Start recording details of each collection.\n"
+"disable_telemetry() -- Stop recording details of each collection.\n"
+"get_telemetry() -- Return the details recorded for recent collections.\n"
 "set_debug() -- Set debugging flags.\n"
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_incremental() -- Collect the oldest generation in time-bounded steps.\n"
+"get_incremental() -- Return the time budget of those steps.\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "get_referrers() -- Return the list of objects that refer to an object.\n"
@@ -1927,8 +2540,13 @@ static PyMethodDef GcMethods[] = {
     {"set_threshold",  gc_set_threshold, METH_VARARGS, gc_set_thresh__doc__},
     GC_GET_THRESHOLD_METHODDEF
     GC_COLLECT_METHODDEF
+    GC_SET_INCREMENTAL_METHODDEF
+    GC_GET_INCREMENTAL_METHODDEF
     GC_GET_OBJECTS_METHODDEF
     GC_GET_STATS_METHODDEF
+    GC_ENABLE_TELEMETRY_METHODDEF
+    GC_DISABLE_TELEMETRY_METHODDEF
+    GC_GET_TELEMETRY_METHODDEF
     GC_IS_TRACKED_METHODDEF
     {"get_referrers",  gc_get_referrers, METH_VARARGS,
         gc_get_referrers__doc__},
@@ -2098,6 +2716,8 @@ _PyGC_Fini(_PyRuntimeState *runtime)
     struct _gc_runtime_state *state = &runtime->gc;
     Py_CLEAR(state->garbage);
     Py_CLEAR(state->callbacks);
+    PyMem_RawFree(state->telemetry);
+    state->telemetry = NULL;
 }
 
 /* for debugging */
@@ -259,6 +259,8 @@ PyCode_NewWithPosOnlyArgs(int argcount, int posonlyargcount, int kwonlyargcount,
     co->co_cache.shadow = NULL;
     co->co_cache.ncalls = 0;
     co->co_cache.curcalls = 0;
+    co->co_cache.nbackedges = 0;
+    co->co_cache.shadow_backoff = 0;
     co->co_qualname = NULL;
     /* facebook end */
     return co;
@@ -553,15 +555,7 @@ code_sizeof(PyCodeObject *co, PyObject *Py_UNUSED(args))
                (co_extra->ce_size-1) * sizeof(co_extra->ce_extras[0]);
     }
     if (co->co_cache.shadow != NULL) {
-        _PyShadowCode *shadow = co->co_cache.shadow;
-        res += sizeof(_PyShadowCode);
-        res += sizeof(PyObject *) * shadow->l1_cache.size;
-        res += sizeof(PyObject *) * shadow->cast_cache.size;
-        res += sizeof(PyObject **) * shadow->globals_size;
-        res += sizeof(_PyShadow_InstanceAttrEntry **) *
-               shadow->polymorphic_caches_size;
-        res += sizeof(_FieldCache) * shadow->field_cache_size;
-        res += sizeof(_Py_CODEUNIT) * shadow->len;
+        res += co->co_cache.shadow->nbytes;
     }
     return PyLong_FromSsize_t(res);
 }
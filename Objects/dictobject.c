@@ -4430,25 +4430,28 @@ PyTypeObject PyDictIterValue_Type = {
     0,
 };
 
-static PyObject *
-dictiter_iternextitem(dictiterobject *di)
+/* Advance an items iterator. Returns 1 and sets *pkey and *pvalue to new
+ * references if there's another item, or 0 if the iterator is exhausted or an
+ * error was raised. */
+static int
+dictiter_nextitem(dictiterobject *di, PyObject **pkey, PyObject **pvalue)
 {
     PyObject **value_ptr;
     PyDictKeysObject *dk;
     PyDictKeyEntry *entry_ptr;
-    PyObject *key, *value, *result;
+    PyObject *key, *value;
     Py_ssize_t i;
     PyDictObject *d = di->di_dict;
 
     if (d == NULL)
-        return NULL;
+        return 0;
     assert(_PyDict_CheckIncludingChecked((PyObject *)d));
 
     if (di->di_used != d->ma_used) {
         PyErr_SetString(PyExc_RuntimeError,
                         "dictionary changed size during iteration");
         di->di_used = -1; /* Make this state sticky */
-        return NULL;
+        return 0;
     }
 
     dk = d->ma_keys;
@@ -4498,7 +4501,7 @@ dictiter_iternextitem(dictiterobject *di)
                 didn't change and bailing otherwise. */
             Py_DECREF(key);
             Py_DECREF(value);
-            return NULL;
+            return 0;
         }
         if (*value_ptr != new_value) {
             Py_INCREF(new_value);
@@ -4512,6 +4515,23 @@ dictiter_iternextitem(dictiterobject *di)
     }
     di->di_pos = i+1;
     di->len--;
+    *pkey = key;
+    *pvalue = value;
+    return 1;
+
+fail:
+    di->di_dict = NULL;
+    Py_DECREF(d);
+    return 0;
+}
+
+static PyObject *
+dictiter_iternextitem(dictiterobject *di)
+{
+    PyObject *key, *value, *result;
+
+    if (!dictiter_nextitem(di, &key, &value))
+        return NULL;
     result = di->di_result;
     if (Py_REFCNT(result) == 1) {
         PyObject *oldkey = PyTuple_GET_ITEM(result, 0);
@@ -4524,17 +4544,22 @@ dictiter_iternextitem(dictiterobject *di)
     }
     else {
         result = PyTuple_New(2);
-        if (result == NULL)
+        if (result == NULL) {
+            Py_DECREF(key);
+            Py_DECREF(value);
             return NULL;
+        }
         PyTuple_SET_ITEM(result, 0, key);  /* steals reference */
         PyTuple_SET_ITEM(result, 1, value);  /* steals reference */
     }
     return result;
+}
 
-fail:
-    di->di_dict = NULL;
-    Py_DECREF(d);
-    return NULL;
+int
+_PyDictIter_NextItem(PyObject *iter, PyObject **key, PyObject **value)
+{
+    assert(Py_TYPE(iter) == &PyDictIterItem_Type);
+    return dictiter_nextitem((dictiterobject *)iter, key, value);
 }
 
 PyTypeObject PyDictIterItem_Type = {
@@ -1,6 +1,7 @@
 /* Range object implementation */
 
 #include "Python.h"
+#include "pycore_iterobject.h"
 #include "structmember.h"
 
 /* Support objects whose length is > PY_SSIZE_T_MAX.
@@ -711,13 +712,7 @@ PyTypeObject PyRange_Type = {
    in the normal case, but possible for any numeric value.
 */
 
-typedef struct {
-        PyObject_HEAD
-        long    index;
-        long    start;
-        long    step;
-        long    len;
-} rangeiterobject;
+typedef _PyRangeIterObject rangeiterobject;
 
 static PyObject *
 rangeiter_next(rangeiterobject *r)
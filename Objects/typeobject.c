@@ -105,6 +105,27 @@ slot_tp_getattr_hook(PyObject *self, PyObject *name);
 static PyObject *
 slot_tp_descr_get(PyObject *self, PyObject *obj, PyObject *type);
 
+static PyObject *
+slot_tp_richcompare(PyObject *self, PyObject *other, int op);
+
+static Py_hash_t
+slot_tp_hash(PyObject *self);
+
+static PyObject *
+slot_tp_iter(PyObject *self);
+
+static PyObject *
+slot_tp_iternext(PyObject *self);
+
+static Py_ssize_t
+slot_sq_length(PyObject *self);
+
+static PyObject *
+slot_mp_subscript(PyObject *self, PyObject *arg1);
+
+static int
+slot_mp_ass_subscript(PyObject *self, PyObject *key, PyObject *value);
+
 static PyObject *object_new_object_init_vectorcall(PyTypeObject *type,
                                                    PyObject **stack,
                                                    size_t nargsf,
@@ -126,6 +147,13 @@ static _PyJIT_TypeSlots _jit_default_slots = {
   .tp_call = slot_tp_call,
   .tp_getattro = slot_tp_getattr_hook,
   .tp_descr_get = slot_tp_descr_get,
+  .tp_richcompare = slot_tp_richcompare,
+  .tp_hash = slot_tp_hash,
+  .tp_iter = slot_tp_iter,
+  .tp_iternext = slot_tp_iternext,
+  .sq_length = slot_sq_length,
+  .mp_subscript = slot_mp_subscript,
+  .mp_ass_subscript = slot_mp_ass_subscript,
 };
 
 static void
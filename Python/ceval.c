@@ -13,6 +13,7 @@
 #include "Python.h"
 #include "pycore_ceval.h"
 #include "pycore_code.h"
+#include "pycore_iterobject.h"
 #include "pycore_object.h"
 #include "pycore_pyerrors.h"
 #include "pycore_pylifecycle.h"
@@ -169,6 +170,17 @@ static void dtrace_function_entry(PyFrameObject *);
 static void dtrace_function_return(PyFrameObject *);
 
 PyObject * cmp_outcome(PyThreadState *, int, int, PyObject *, PyObject *);
+static inline PyObject * compare_exact_ints(PyObject *, PyObject *, int);
+static inline PyObject * compare_exact_floats(PyObject *, PyObject *, int);
+static inline PyObject * compare_exact_strs(PyObject *, PyObject *, int);
+static int shadow_call_opcode(int, PyObject *, Py_ssize_t);
+/* The ml_flags bits that pick a builtin's calling convention */
+#define METH_CALL_FLAGS                                                     \
+    (METH_VARARGS | METH_FASTCALL | METH_NOARGS | METH_O | METH_KEYWORDS | \
+     METH_TYPED)
+static PyObject * _PyFunction_Vectorcall_NArgs(PyFunctionObject *,
+                                               PyObject **, size_t,
+                                               PyObject *);
 
 static int import_all_from(PyThreadState *, PyFrameObject *, PyObject *);
 void format_exc_check_arg(PyThreadState *, PyObject *, const char *, PyObject *);
@@ -1345,10 +1357,14 @@ _PyEval_EvalFrameDefault(PyFrameObject *f, int throwflag)
     /* Initialize the inline cache after the code object is "hot enough" */
     if (co->co_cache.shadow == NULL && _PyEval_ShadowByteCodeEnabled) {
         if (++(co->co_cache.ncalls) > PYSHADOW_INIT_THRESHOLD) {
-            if (_PyShadow_InitCache(co) == -1) {
-                goto error;
+            if (co->co_cache.shadow_backoff > 0) {
+                co->co_cache.shadow_backoff--;
+            } else {
+                if (_PyShadow_InitCache(co) == -1) {
+                    goto error;
+                }
+                INLINE_CACHE_CREATED(co->co_cache);
             }
-            INLINE_CACHE_CREATED(co->co_cache);
         }
     }
     /* facebook end t39538061 */
@@ -1370,6 +1386,7 @@ _PyEval_EvalFrameDefault(PyFrameObject *f, int throwflag)
     if (!tstate->profile_interp && co->co_cache.shadow != NULL &&
         PyDict_CheckExact(f->f_globals)) {
         shadow.shadow = co->co_cache.shadow;
+        shadow.shadow->ncalls++;
         global_cache = shadow.shadow->globals;
         first_instr = &shadow.shadow->code[0];
     } else {
@@ -1762,6 +1779,10 @@ main_loop:
         case TARGET(BINARY_MULTIPLY): {
             PyObject *right = POP();
             PyObject *left = TOP();
+            if (shadow.shadow != NULL) {
+                _PyShadow_BinaryOpWithTypes(
+                    &shadow, next_instr, BINARY_MULTIPLY, left, right, oparg);
+            }
             PyObject *res = PyNumber_Multiply(left, right);
             Py_DECREF(left);
             Py_DECREF(right);
@@ -1837,6 +1858,10 @@ main_loop:
                http://bugs.python.org/issue10044 for the discussion. In short,
                no patch shown any impact on a realistic benchmark, only a minor
                speedup on microbenchmarks. */
+            if (shadow.shadow != NULL) {
+                _PyShadow_BinaryOpWithTypes(
+                    &shadow, next_instr, BINARY_ADD, left, right, oparg);
+            }
             if (PyUnicode_CheckExact(left) &&
                      PyUnicode_CheckExact(right)) {
                 sum = unicode_concatenate(tstate, left, right, f, next_instr);
@@ -1856,6 +1881,10 @@ main_loop:
         case TARGET(BINARY_SUBTRACT): {
             PyObject *right = POP();
             PyObject *left = TOP();
+            if (shadow.shadow != NULL) {
+                _PyShadow_BinaryOpWithTypes(
+                    &shadow, next_instr, BINARY_SUBTRACT, left, right, oparg);
+            }
             PyObject *diff = PyNumber_Subtract(left, right);
             Py_DECREF(right);
             Py_DECREF(left);
@@ -2051,6 +2080,10 @@ main_loop:
             PyObject *right = POP();
             PyObject *left = TOP();
             PyObject *sum;
+            if (shadow.shadow != NULL) {
+                _PyShadow_BinaryOpWithTypes(
+                    &shadow, next_instr, INPLACE_ADD, left, right, oparg);
+            }
             if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right)) {
                 sum = unicode_concatenate(tstate, left, right, f, next_instr);
                 /* unicode_concatenate consumed the ref to left */
@@ -2603,6 +2636,10 @@ main_loop:
         case TARGET(UNPACK_SEQUENCE): {
             PREDICTED(UNPACK_SEQUENCE);
             PyObject *seq = POP(), *item, **items;
+            if (shadow.shadow != NULL) {
+                _PyShadow_IterWithTypes(
+                    &shadow, next_instr, UNPACK_SEQUENCE, seq, oparg);
+            }
             if (PyTuple_CheckExact(seq) &&
                 PyTuple_GET_SIZE(seq) == oparg) {
                 items = ((PyTupleObject *)seq)->ob_item;
@@ -2631,6 +2668,41 @@ main_loop:
             DISPATCH();
         }
 
+        case TARGET(UNPACK_SEQUENCE_TUPLE2): {
+            PyObject *seq = TOP();
+            if (PyTuple_CheckExact(seq) && PyTuple_GET_SIZE(seq) == 2) {
+                PyObject *first = PyTuple_GET_ITEM(seq, 0);
+                PyObject *second = PyTuple_GET_ITEM(seq, 1);
+                Py_INCREF(first);
+                Py_INCREF(second);
+                SET_TOP(second);
+                PUSH(first);
+                Py_DECREF(seq);
+                DISPATCH();
+            }
+            _PyShadow_PatchByteCode(
+                &shadow, next_instr, UNPACK_SEQUENCE, oparg);
+            goto PRED_UNPACK_SEQUENCE;
+        }
+
+        case TARGET(UNPACK_SEQUENCE_LIST): {
+            PyObject *seq = TOP();
+            if (PyList_CheckExact(seq) && PyList_GET_SIZE(seq) == oparg) {
+                PyObject **items = ((PyListObject *)seq)->ob_item;
+                STACK_SHRINK(1);
+                while (oparg--) {
+                    PyObject *item = items[oparg];
+                    Py_INCREF(item);
+                    PUSH(item);
+                }
+                Py_DECREF(seq);
+                DISPATCH();
+            }
+            _PyShadow_PatchByteCode(
+                &shadow, next_instr, UNPACK_SEQUENCE, oparg);
+            goto PRED_UNPACK_SEQUENCE;
+        }
+
         case TARGET(UNPACK_EX): {
             int totalargs = 1 + (oparg & 0xFF) + (oparg >> 8);
             PyObject *seq = POP();
@@ -3658,6 +3730,10 @@ main_loop:
         case TARGET(COMPARE_OP): {
             PyObject *right = POP();
             PyObject *left = TOP();
+            if (shadow.shadow != NULL) {
+                _PyShadow_BinaryOpWithTypes(
+                    &shadow, next_instr, COMPARE_OP, left, right, oparg);
+            }
             PyObject *res = cmp_outcome(tstate, oparg, 0, left, right);
             Py_DECREF(left);
             Py_DECREF(right);
@@ -3864,6 +3940,17 @@ main_loop:
 
         case TARGET(JUMP_ABSOLUTE): {
             PREDICTED(JUMP_ABSOLUTE);
+            /* Once a loop in this code is hot, continue running the frame in
+               JIT-compiled code, starting at the loop header. */
+            if (oparg < (int)INSTR_OFFSET() && _PyJIT_IsOSREnabled() &&
+                ++(co->co_cache.nbackedges) > _PyJIT_OSRThreshold()) {
+                if (_PyJIT_OSREnter(f, oparg, stack_pointer, &retval)) {
+                    /* The JIT consumed the value stack. */
+                    stack_pointer = f->f_valuestack;
+                    goto exit_returning;
+                }
+                co->co_cache.nbackedges = 0;
+            }
             JUMPTO(oparg);
 #if FAST_LOOPS
             /* Enabling this path speeds-up all while and for-loops by bypassing
@@ -3925,6 +4012,10 @@ main_loop:
             PREDICTED(FOR_ITER);
             /* before: [iter]; after: [iter, iter()] *or* [] */
             PyObject *iter = TOP();
+            if (shadow.shadow != NULL) {
+                _PyShadow_IterWithTypes(
+                    &shadow, next_instr, FOR_ITER, iter, oparg);
+            }
             PyObject *next = (*iter->ob_type->tp_iternext)(iter);
             if (next != NULL) {
                 PUSH(next);
@@ -3949,6 +4040,112 @@ main_loop:
             DISPATCH();
         }
 
+        case TARGET(FOR_ITER_LIST): {
+            PyObject *iter = TOP();
+            if (Py_TYPE(iter) != &PyListIter_Type) {
+                _PyShadow_PatchByteCode(&shadow, next_instr, FOR_ITER, oparg);
+                goto PRED_FOR_ITER;
+            }
+            _PyListIterObject *it = (_PyListIterObject *)iter;
+            PyListObject *seq = it->it_seq;
+            if (seq != NULL) {
+                if (it->it_index < PyList_GET_SIZE(seq)) {
+                    PyObject *next = PyList_GET_ITEM(seq, it->it_index++);
+                    Py_INCREF(next);
+                    PUSH(next);
+                    PREDICT(STORE_FAST);
+                    PREDICT(UNPACK_SEQUENCE);
+                    DISPATCH();
+                }
+                it->it_seq = NULL;
+                Py_DECREF(seq);
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(iter);
+            JUMPBY(oparg);
+            PREDICT(POP_BLOCK);
+            DISPATCH();
+        }
+
+        case TARGET(FOR_ITER_TUPLE): {
+            PyObject *iter = TOP();
+            if (Py_TYPE(iter) != &PyTupleIter_Type) {
+                _PyShadow_PatchByteCode(&shadow, next_instr, FOR_ITER, oparg);
+                goto PRED_FOR_ITER;
+            }
+            _PyTupleIterObject *it = (_PyTupleIterObject *)iter;
+            PyTupleObject *seq = it->it_seq;
+            if (seq != NULL) {
+                if (it->it_index < PyTuple_GET_SIZE(seq)) {
+                    PyObject *next = PyTuple_GET_ITEM(seq, it->it_index++);
+                    Py_INCREF(next);
+                    PUSH(next);
+                    PREDICT(STORE_FAST);
+                    PREDICT(UNPACK_SEQUENCE);
+                    DISPATCH();
+                }
+                it->it_seq = NULL;
+                Py_DECREF(seq);
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(iter);
+            JUMPBY(oparg);
+            PREDICT(POP_BLOCK);
+            DISPATCH();
+        }
+
+        case TARGET(FOR_ITER_RANGE): {
+            PyObject *iter = TOP();
+            if (Py_TYPE(iter) != &PyRangeIter_Type) {
+                _PyShadow_PatchByteCode(&shadow, next_instr, FOR_ITER, oparg);
+                goto PRED_FOR_ITER;
+            }
+            _PyRangeIterObject *r = (_PyRangeIterObject *)iter;
+            if (r->index < r->len) {
+                /* cast to unsigned to avoid possible signed overflow
+                   in intermediate calculations. */
+                PyObject *next = PyLong_FromLong(
+                    (long)(r->start + (unsigned long)(r->index++) * r->step));
+                if (next == NULL) {
+                    goto error;
+                }
+                PUSH(next);
+                PREDICT(STORE_FAST);
+                DISPATCH();
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(iter);
+            JUMPBY(oparg);
+            PREDICT(POP_BLOCK);
+            DISPATCH();
+        }
+
+        case TARGET(FOR_ITER_DICT_ITEMS): {
+            /* Only used when followed by UNPACK_SEQUENCE 2, which this does
+               the work of: the key and value are pushed without building
+               the item tuple, and the UNPACK_SEQUENCE is skipped. */
+            PyObject *iter = TOP();
+            if (Py_TYPE(iter) != &PyDictIterItem_Type || tstate->use_tracing) {
+                _PyShadow_PatchByteCode(&shadow, next_instr, FOR_ITER, oparg);
+                goto PRED_FOR_ITER;
+            }
+            PyObject *key, *value;
+            if (_PyDictIter_NextItem(iter, &key, &value)) {
+                PUSH(value);
+                PUSH(key);
+                next_instr++;
+                DISPATCH();
+            }
+            if (_PyErr_Occurred(tstate)) {
+                goto error;
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(iter);
+            JUMPBY(oparg);
+            PREDICT(POP_BLOCK);
+            DISPATCH();
+        }
+
         case TARGET(SETUP_FINALLY): {
             /* NOTE: If you add any new block-setup opcodes that
                are not try/except/finally handlers, you may need
@@ -4238,10 +4435,18 @@ main_loop:
             /* Designed to work in tamdem with LOAD_METHOD. */
             PyObject **sp, *res, *meth;
 
+        call_method_generic:
             sp = stack_pointer;
             int awaited = IS_AWAITED();
 
             meth = PEEK(oparg + 2);
+            if (shadow.shadow != NULL && meth != NULL) {
+                int shadow_op = shadow_call_opcode(CALL_METHOD, meth, oparg + 1);
+                if (shadow_op != -1) {
+                    _PyShadow_PatchByteCode(
+                        &shadow, next_instr, shadow_op, oparg);
+                }
+            }
             if (meth == NULL) {
                 /* `meth` is NULL when LOAD_METHOD thinks that it's not
                    a method call.
@@ -4301,8 +4506,17 @@ main_loop:
         case TARGET(CALL_FUNCTION): {
             PREDICTED(CALL_FUNCTION);
             PyObject **sp, *res;
+        call_function_generic:
             sp = stack_pointer;
             int awaited = IS_AWAITED();
+            if (shadow.shadow != NULL) {
+                int shadow_op =
+                    shadow_call_opcode(CALL_FUNCTION, PEEK(oparg + 1), oparg);
+                if (shadow_op != -1) {
+                    _PyShadow_PatchByteCode(
+                        &shadow, next_instr, shadow_op, oparg);
+                }
+            }
             res = call_function(tstate,
                                 &sp,
                                 oparg,
@@ -4321,6 +4535,189 @@ main_loop:
             DISPATCH();
         }
 
+#define _POST_SHADOW_CALL_PUSH_DISPATCH(nitems, awaited, res)   \
+            for (int i = 0; i < nitems; i++) {                    \
+                Py_DECREF(POP());                                 \
+            }                                                     \
+            if (res == NULL) {                                    \
+                PUSH(NULL);                                       \
+                goto error;                                       \
+            }                                                     \
+            if (awaited && _PyWaitHandle_CheckExact(res)) {       \
+                DISPATCH_EAGER_CORO_RESULT(res, PUSH);            \
+            }                                                     \
+            assert(!_PyWaitHandle_CheckExact(res));               \
+            PUSH(res);                                            \
+            DISPATCH();                                           \
+
+        case TARGET(CALL_FUNCTION_PY_EXACT_ARGS): {
+            PyObject *callable = PEEK(oparg + 1);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            size_t flags = awaited ? _Py_AWAITED_CALL_MARKER : 0;
+            if (PyFunction_Check(callable) &&
+                ((PyFunctionObject *)callable)->vectorcall ==
+                    (vectorcallfunc)_PyFunction_Vectorcall_NArgs &&
+                ((PyCodeObject *)PyFunction_GET_CODE(callable))->co_argcount ==
+                    oparg) {
+                PyFunctionObject *func = (PyFunctionObject *)callable;
+                res = _PyFunctionCode_FastCall(
+                    (PyCodeObject *)func->func_code,
+                    stack_pointer - oparg,
+                    oparg | flags | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                    func->func_globals,
+                    func->func_name,
+                    func->func_qualname);
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 1, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_FUNCTION, oparg);
+            goto call_function_generic;
+        }
+
+        case TARGET(CALL_FUNCTION_BUILTIN_FAST): {
+            PyObject *callable = PEEK(oparg + 1);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            if (PyCFunction_Check(callable) && !tstate->use_tracing &&
+                (PyCFunction_GET_FLAGS(callable) & METH_CALL_FLAGS) ==
+                    METH_FASTCALL) {
+                _PyCFunctionFast meth =
+                    (_PyCFunctionFast)(void(*)(void))PyCFunction_GET_FUNCTION(
+                        callable);
+                if (Py_EnterRecursiveCall(" while calling a Python object")) {
+                    res = NULL;
+                } else {
+                    res = meth(PyCFunction_GET_SELF(callable),
+                               stack_pointer - oparg,
+                               oparg);
+                    Py_LeaveRecursiveCall();
+                    res = _Py_CheckFunctionResultTstate(
+                        tstate, callable, res, NULL);
+                }
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 1, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_FUNCTION, oparg);
+            goto call_function_generic;
+        }
+
+        case TARGET(CALL_FUNCTION_BUILTIN_O): {
+            PyObject *callable = PEEK(oparg + 1);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            if (PyCFunction_Check(callable) && !tstate->use_tracing &&
+                (PyCFunction_GET_FLAGS(callable) & METH_CALL_FLAGS) == METH_O &&
+                oparg == 1) {
+                PyCFunction meth = PyCFunction_GET_FUNCTION(callable);
+                if (Py_EnterRecursiveCall(" while calling a Python object")) {
+                    res = NULL;
+                } else {
+                    res = meth(PyCFunction_GET_SELF(callable), TOP());
+                    Py_LeaveRecursiveCall();
+                    res = _Py_CheckFunctionResultTstate(
+                        tstate, callable, res, NULL);
+                }
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 1, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_FUNCTION, oparg);
+            goto call_function_generic;
+        }
+
+        case TARGET(CALL_FUNCTION_TYPE_ALLOC): {
+            PyObject *callable = PEEK(oparg + 1);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            size_t flags = awaited ? _Py_AWAITED_CALL_MARKER : 0;
+            if (Py_TYPE(callable) == &PyType_Type &&
+                ((PyTypeObject *)callable)->tp_vectorcall != NULL) {
+                res = ((PyTypeObject *)callable)->tp_vectorcall(
+                    callable,
+                    stack_pointer - oparg,
+                    oparg | flags | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                    NULL);
+                res = _Py_CheckFunctionResultTstate(
+                    tstate, callable, res, NULL);
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 1, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_FUNCTION, oparg);
+            goto call_function_generic;
+        }
+
+        case TARGET(CALL_METHOD_PY): {
+            /* Stack layout: ... | method | self | arg1 | ... | argN */
+            PyObject *meth = PEEK(oparg + 2);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            size_t flags = (awaited ? _Py_AWAITED_CALL_MARKER : 0) |
+                           _Py_VECTORCALL_INVOKED_METHOD;
+            if (meth != NULL && PyFunction_Check(meth) &&
+                ((PyFunctionObject *)meth)->vectorcall ==
+                    (vectorcallfunc)_PyFunction_Vectorcall_NArgs &&
+                ((PyCodeObject *)PyFunction_GET_CODE(meth))->co_argcount ==
+                    oparg + 1) {
+                PyFunctionObject *func = (PyFunctionObject *)meth;
+                res = _PyFunctionCode_FastCall(
+                    (PyCodeObject *)func->func_code,
+                    stack_pointer - oparg - 1,
+                    (oparg + 1) | flags | PY_VECTORCALL_ARGUMENTS_OFFSET,
+                    func->func_globals,
+                    func->func_name,
+                    func->func_qualname);
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 2, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_METHOD, oparg);
+            goto call_method_generic;
+        }
+
+        case TARGET(CALL_METHOD_DESCR_FAST): {
+            PyObject *meth = PEEK(oparg + 2);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            if (meth != NULL && Py_TYPE(meth) == &PyMethodDescr_Type &&
+                !tstate->use_tracing &&
+                (((PyMethodDescrObject *)meth)->d_method->ml_flags &
+                 METH_CALL_FLAGS) == METH_FASTCALL &&
+                PyObject_TypeCheck(PEEK(oparg + 1),
+                                   PyDescr_TYPE(meth))) {
+                _PyCFunctionFast cfunc = (_PyCFunctionFast)(void(*)(void))
+                    ((PyMethodDescrObject *)meth)->d_method->ml_meth;
+                if (Py_EnterRecursiveCall(" while calling a Python object")) {
+                    res = NULL;
+                } else {
+                    res = cfunc(PEEK(oparg + 1), stack_pointer - oparg, oparg);
+                    Py_LeaveRecursiveCall();
+                    res = _Py_CheckFunctionResultTstate(
+                        tstate, meth, res, NULL);
+                }
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 2, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_METHOD, oparg);
+            goto call_method_generic;
+        }
+
+        case TARGET(CALL_METHOD_DESCR_O): {
+            PyObject *meth = PEEK(oparg + 2);
+            PyObject *res;
+            int awaited = IS_AWAITED();
+            if (meth != NULL && Py_TYPE(meth) == &PyMethodDescr_Type &&
+                !tstate->use_tracing && oparg == 1 &&
+                (((PyMethodDescrObject *)meth)->d_method->ml_flags &
+                 METH_CALL_FLAGS) == METH_O &&
+                PyObject_TypeCheck(SECOND(), PyDescr_TYPE(meth))) {
+                PyCFunction cfunc = ((PyMethodDescrObject *)meth)->d_method->ml_meth;
+                if (Py_EnterRecursiveCall(" while calling a Python object")) {
+                    res = NULL;
+                } else {
+                    res = cfunc(SECOND(), TOP());
+                    Py_LeaveRecursiveCall();
+                    res = _Py_CheckFunctionResultTstate(
+                        tstate, meth, res, NULL);
+                }
+                _POST_SHADOW_CALL_PUSH_DISPATCH(oparg + 2, awaited, res);
+            }
+            _PyShadow_PatchByteCode(&shadow, next_instr, CALL_METHOD, oparg);
+            goto call_method_generic;
+        }
+
 #define _POST_INVOKE_CLEANUP_PUSH_DISPATCH(nargs, awaited, res)   \
             while (nargs--) {                                     \
                 Py_DECREF(POP());                                 \
@@ -6185,6 +6582,239 @@ main_loop:
             FAST_DISPATCH();
         }
 
+        case TARGET(BINARY_ADD_INT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+                res = PyLong_Type.tp_as_number->nb_add(left, right);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_ADD, oparg);
+                res = PyNumber_Add(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(BINARY_ADD_FLOAT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+                res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) +
+                                         PyFloat_AS_DOUBLE(right));
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_ADD, oparg);
+                res = PyNumber_Add(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(BINARY_ADD_UNICODE): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right)) {
+                res = unicode_concatenate(tstate, left, right, f, next_instr);
+                /* unicode_concatenate consumed the ref to left */
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_ADD, oparg);
+                res = PyNumber_Add(left, right);
+                Py_DECREF(left);
+            }
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(BINARY_SUBTRACT_INT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+                res = PyLong_Type.tp_as_number->nb_subtract(left, right);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_SUBTRACT, oparg);
+                res = PyNumber_Subtract(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(BINARY_SUBTRACT_FLOAT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+                res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) -
+                                         PyFloat_AS_DOUBLE(right));
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_SUBTRACT, oparg);
+                res = PyNumber_Subtract(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(BINARY_MULTIPLY_INT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+                res = PyLong_Type.tp_as_number->nb_multiply(left, right);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_MULTIPLY, oparg);
+                res = PyNumber_Multiply(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(BINARY_MULTIPLY_FLOAT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+                res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) *
+                                         PyFloat_AS_DOUBLE(right));
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, BINARY_MULTIPLY, oparg);
+                res = PyNumber_Multiply(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(INPLACE_ADD_INT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+                res = PyLong_Type.tp_as_number->nb_add(left, right);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, INPLACE_ADD, oparg);
+                res = PyNumber_InPlaceAdd(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(INPLACE_ADD_FLOAT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+                res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) +
+                                         PyFloat_AS_DOUBLE(right));
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, INPLACE_ADD, oparg);
+                res = PyNumber_InPlaceAdd(left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(INPLACE_ADD_UNICODE): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right)) {
+                res = unicode_concatenate(tstate, left, right, f, next_instr);
+                /* unicode_concatenate consumed the ref to left */
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, INPLACE_ADD, oparg);
+                res = PyNumber_InPlaceAdd(left, right);
+                Py_DECREF(left);
+            }
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            FAST_DISPATCH();
+        }
+
+        case TARGET(COMPARE_OP_INT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+                res = compare_exact_ints(left, right, oparg);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, COMPARE_OP, oparg);
+                res = cmp_outcome(tstate, oparg, 0, left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            FAST_DISPATCH();
+        }
+
+        case TARGET(COMPARE_OP_FLOAT): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+                res = compare_exact_floats(left, right, oparg);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, COMPARE_OP, oparg);
+                res = cmp_outcome(tstate, oparg, 0, left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            FAST_DISPATCH();
+        }
+
+        case TARGET(COMPARE_OP_STR_EQ): {
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right)) {
+                res = compare_exact_strs(left, right, oparg);
+            } else {
+                _PyShadow_PatchByteCode(&shadow, next_instr, COMPARE_OP, oparg);
+                res = cmp_outcome(tstate, oparg, 0, left, right);
+            }
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            FAST_DISPATCH();
+        }
+
         case TARGET(FAST_LEN): {
             PyObject *collection = POP(), *length = NULL;
             int inexact = oparg & FAST_LEN_INEXACT;
@@ -8527,8 +9157,18 @@ PyEntry_AutoJIT(PyFunctionObject *func,
                 Py_ssize_t nargsf,
                 PyObject *kwnames) {
     PyCodeObject* code = (PyCodeObject*)func->func_code;
+    if (code->co_cache.ncalls == 0 && _PyJIT_InCompileManifest(code)) {
+        /* This code was hot in a previous run; don't wait for the
+           threshold again. */
+        code->co_cache.ncalls = _PyJIT_AutoJITThreshold();
+    }
     if (++(code->co_cache.ncalls) > _PyJIT_AutoJITThreshold()) {
-        if (_PyJIT_CompileFunction(func) != PYJIT_RESULT_OK) {
+        if (_PyJIT_ScheduleCompile(func)) {
+            /* Keep running in the interpreter until the background worker
+               patches in the compiled entry point. */
+            func->vectorcall = (vectorcallfunc)PyEntry_LazyInit;
+            PyEntry_initnow(func);
+        } else if (_PyJIT_CompileFunction(func) != PYJIT_RESULT_OK) {
             func->vectorcall = (vectorcallfunc)PyEntry_LazyInit;
             PyEntry_initnow(func);
         }
@@ -9046,6 +9686,83 @@ unicode_concatenate(PyThreadState *tstate, PyObject *v, PyObject *w,
     return res;
 }
 
+/* Picks the shadow opcode that calls callable directly at a CALL_FUNCTION or
+ * CALL_METHOD site, or returns -1 if there isn't one. For CALL_METHOD,
+ * callable is the unbound method and nargs includes self.
+ *
+ * Python functions are only specialized while their vectorcall entry is the
+ * interpreter's exact-args one. Assigning __code__ or __defaults__ resets the
+ * entry, as does compiling the function, so the specialized opcodes can
+ * guard on it instead of on the code object. */
+static int
+shadow_call_opcode(int opcode, PyObject *callable, Py_ssize_t nargs)
+{
+    if (PyFunction_Check(callable)) {
+        PyFunctionObject *func = (PyFunctionObject *)callable;
+        if (func->vectorcall != (vectorcallfunc)_PyFunction_Vectorcall_NArgs ||
+            ((PyCodeObject *)func->func_code)->co_argcount != nargs) {
+            return -1;
+        }
+        return opcode == CALL_FUNCTION ? CALL_FUNCTION_PY_EXACT_ARGS
+                                       : CALL_METHOD_PY;
+    }
+    if (opcode == CALL_FUNCTION) {
+        if (PyCFunction_Check(callable)) {
+            switch (PyCFunction_GET_FLAGS(callable) & METH_CALL_FLAGS) {
+            case METH_FASTCALL:
+                return CALL_FUNCTION_BUILTIN_FAST;
+            case METH_O:
+                return nargs == 1 ? CALL_FUNCTION_BUILTIN_O : -1;
+            }
+        } else if (Py_TYPE(callable) == &PyType_Type &&
+                   ((PyTypeObject *)callable)->tp_vectorcall != NULL) {
+            return CALL_FUNCTION_TYPE_ALLOC;
+        }
+    } else if (Py_TYPE(callable) == &PyMethodDescr_Type) {
+        PyMethodDef *ml = ((PyMethodDescrObject *)callable)->d_method;
+        switch (ml->ml_flags & METH_CALL_FLAGS) {
+        case METH_FASTCALL:
+            return CALL_METHOD_DESCR_FAST;
+        case METH_O:
+            return nargs == 2 ? CALL_METHOD_DESCR_O : -1;
+        }
+    }
+    return -1;
+}
+
+/* Comparisons used by the COMPARE_OP_* shadow opcodes. op must be one of
+ * Py_LT .. Py_GE (only Py_EQ or Py_NE for strs). */
+static inline PyObject *
+compare_exact_ints(PyObject *v, PyObject *w, int op)
+{
+    Py_ssize_t v_size = Py_SIZE(v), w_size = Py_SIZE(w);
+    if (v_size >= -1 && v_size <= 1 && w_size >= -1 && w_size <= 1) {
+        /* Both values fit in a single digit */
+        sdigit a = (sdigit)((PyLongObject *)v)->ob_digit[0] * v_size;
+        sdigit b = (sdigit)((PyLongObject *)w)->ob_digit[0] * w_size;
+        Py_RETURN_RICHCOMPARE(a, b, op);
+    }
+    return PyLong_Type.tp_richcompare(v, w, op);
+}
+
+static inline PyObject *
+compare_exact_floats(PyObject *v, PyObject *w, int op)
+{
+    double a = PyFloat_AS_DOUBLE(v), b = PyFloat_AS_DOUBLE(w);
+    Py_RETURN_RICHCOMPARE(a, b, op);
+}
+
+static inline PyObject *
+compare_exact_strs(PyObject *v, PyObject *w, int op)
+{
+    assert(op == Py_EQ || op == Py_NE);
+    int eq = v == w || _PyUnicode_EQ(v, w);
+    if (eq == (op == Py_EQ)) {
+        Py_RETURN_TRUE;
+    }
+    Py_RETURN_FALSE;
+}
+
 static inline void try_profile_next_instr(PyFrameObject* f,
                                           PyObject** stack_pointer,
                                           const _Py_CODEUNIT* next_instr) {
@@ -29,23 +29,23 @@ static void *opcode_targets[256] = {
     &&TARGET_BINARY_TRUE_DIVIDE,
     &&TARGET_INPLACE_FLOOR_DIVIDE,
     &&TARGET_INPLACE_TRUE_DIVIDE,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
+    &&TARGET_BINARY_ADD_INT,
+    &&TARGET_BINARY_ADD_FLOAT,
+    &&TARGET_BINARY_ADD_UNICODE,
+    &&TARGET_BINARY_SUBTRACT_INT,
+    &&TARGET_BINARY_SUBTRACT_FLOAT,
+    &&TARGET_BINARY_MULTIPLY_INT,
+    &&TARGET_BINARY_MULTIPLY_FLOAT,
+    &&TARGET_INPLACE_ADD_INT,
+    &&TARGET_INPLACE_ADD_FLOAT,
+    &&TARGET_INPLACE_ADD_UNICODE,
+    &&TARGET_CALL_FUNCTION_PY_EXACT_ARGS,
+    &&TARGET_CALL_FUNCTION_BUILTIN_FAST,
+    &&TARGET_CALL_FUNCTION_BUILTIN_O,
+    &&TARGET_CALL_FUNCTION_TYPE_ALLOC,
+    &&TARGET_CALL_METHOD_PY,
+    &&TARGET_CALL_METHOD_DESCR_FAST,
+    &&TARGET_CALL_METHOD_DESCR_O,
     &&_unknown_opcode,
     &&_unknown_opcode,
     &&_unknown_opcode,
@@ -98,7 +98,7 @@ static void *opcode_targets[256] = {
     &&TARGET_DELETE_ATTR,
     &&TARGET_STORE_GLOBAL,
     &&TARGET_DELETE_GLOBAL,
-    &&_unknown_opcode,
+    &&TARGET_FOR_ITER_LIST,
     &&TARGET_LOAD_CONST,
     &&TARGET_LOAD_NAME,
     &&TARGET_BUILD_TUPLE,
@@ -118,22 +118,22 @@ static void *opcode_targets[256] = {
     &&TARGET_LOAD_GLOBAL,
     &&TARGET_CAST_CACHED_EXACT,
     &&TARGET_CAST_CACHED_OPTIONAL_EXACT,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
+    &&TARGET_COMPARE_OP_INT,
+    &&TARGET_COMPARE_OP_FLOAT,
+    &&TARGET_COMPARE_OP_STR_EQ,
     &&TARGET_SETUP_FINALLY,
-    &&_unknown_opcode,
+    &&TARGET_FOR_ITER_TUPLE,
     &&TARGET_LOAD_FAST,
     &&TARGET_STORE_FAST,
     &&TARGET_DELETE_FAST,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
+    &&TARGET_FOR_ITER_RANGE,
+    &&TARGET_FOR_ITER_DICT_ITEMS,
+    &&TARGET_UNPACK_SEQUENCE_TUPLE2,
     &&TARGET_RAISE_VARARGS,
     &&TARGET_CALL_FUNCTION,
     &&TARGET_MAKE_FUNCTION,
     &&TARGET_BUILD_SLICE,
-    &&_unknown_opcode,
+    &&TARGET_UNPACK_SEQUENCE_LIST,
     &&TARGET_LOAD_CLOSURE,
     &&TARGET_LOAD_DEREF,
     &&TARGET_STORE_DEREF,
@@ -29,6 +29,58 @@ Py_ssize_t inline_cache_count = 0;
 /* Total number of bytes allocated to inline caches */
 Py_ssize_t inline_cache_total_size = 0;
 
+/* Memory used by all live shadow code, and the budget it's held to (0 for
+ * unlimited). */
+static Py_ssize_t shadow_code_bytes = 0;
+static Py_ssize_t shadow_code_count = 0;
+static Py_ssize_t shadow_code_evictions = 0;
+static Py_ssize_t shadow_code_budget = 0;
+
+/* Calls a code object waits before getting shadow code again after its shadow
+ * code was evicted or didn't fit in the budget. This is counted separately
+ * from co_cache.ncalls, which also drives the autojit threshold. */
+#define SHADOW_RETRY_BACKOFF 50
+
+/* Live shadow code, least recently considered for eviction at the tail */
+static _PyShadowCode *shadow_lru_head = NULL;
+static _PyShadowCode *shadow_lru_tail = NULL;
+
+static void
+shadow_account(_PyShadowCode *shadow, Py_ssize_t nbytes)
+{
+    shadow->nbytes += nbytes;
+    shadow_code_bytes += nbytes;
+}
+
+static void
+shadow_lru_unlink(_PyShadowCode *shadow)
+{
+    if (shadow->lru_prev != NULL) {
+        shadow->lru_prev->lru_next = shadow->lru_next;
+    } else {
+        shadow_lru_head = shadow->lru_next;
+    }
+    if (shadow->lru_next != NULL) {
+        shadow->lru_next->lru_prev = shadow->lru_prev;
+    } else {
+        shadow_lru_tail = shadow->lru_prev;
+    }
+    shadow->lru_prev = shadow->lru_next = NULL;
+}
+
+static void
+shadow_lru_push(_PyShadowCode *shadow)
+{
+    shadow->lru_prev = NULL;
+    shadow->lru_next = shadow_lru_head;
+    if (shadow_lru_head != NULL) {
+        shadow_lru_head->lru_prev = shadow;
+    } else {
+        shadow_lru_tail = shadow;
+    }
+    shadow_lru_head = shadow;
+}
+
 PyTypeObject _PyCodeCache_RefType = {
     PyVarObject_HEAD_INIT(NULL, 0).tp_name = "shadow_ref",
     .tp_doc = "shadow_ref",
@@ -502,7 +554,10 @@ _PyShadow_CacheHitInvalidate(_PyShadow_EvalState *shadow,
 }
 
 static int
-generic_cache_grow(void **items, Py_ssize_t *size, size_t item_size);
+generic_cache_grow(_PyShadowCode *shadow,
+                   void **items,
+                   Py_ssize_t *size,
+                   size_t item_size);
 int _PyShadow_IsCacheOpcode(unsigned char opcode);
 
 PyObject *
@@ -526,6 +581,9 @@ _PyShadow_LoadAttrSwitchPolymorphic(_PyShadow_EvalState *state,
         state->shadow->polymorphic_caches = polymorphic_caches;
         state->shadow->polymorphic_caches_size =
             INITIAL_POLYMORPHIC_CACHE_ARRAY_SIZE;
+        shadow_account(state->shadow,
+                       INITIAL_POLYMORPHIC_CACHE_ARRAY_SIZE *
+                           sizeof(_PyShadow_InstanceAttrEntry **));
     }
 
     /* Find a free cache entry */
@@ -539,7 +597,8 @@ _PyShadow_LoadAttrSwitchPolymorphic(_PyShadow_EvalState *state,
     }
     if (cache_index == -1) {
         cache_index = state->shadow->polymorphic_caches_size;
-        if (!generic_cache_grow((void **)&state->shadow->polymorphic_caches,
+        if (!generic_cache_grow(state->shadow,
+                                (void **)&state->shadow->polymorphic_caches,
                                 &state->shadow->polymorphic_caches_size,
                                 sizeof(_PyShadow_InstanceAttrEntry **))) {
             _PyShadow_LoadAttrMiss(state, next_instr, name);
@@ -555,6 +614,9 @@ _PyShadow_LoadAttrSwitchPolymorphic(_PyShadow_EvalState *state,
         return NULL;
     }
     polymorphic_caches[cache_index] = entries;
+    shadow_account(state->shadow,
+                   POLYMORPHIC_CACHE_SIZE *
+                       sizeof(_PyShadow_InstanceAttrEntry *));
 
     /* Switch the opcode and just run the normal polymorphic code path */
     _PyShadow_PatchByteCode(
@@ -850,7 +912,10 @@ cache_init(_ShadowCache *cache)
 }
 
 static int
-generic_cache_grow(void **items, Py_ssize_t *size, size_t item_size)
+generic_cache_grow(_PyShadowCode *shadow,
+                   void **items,
+                   Py_ssize_t *size,
+                   size_t item_size)
 {
     const Py_ssize_t initial_size = 4;
     Py_ssize_t new_size = *items == NULL ? initial_size : *size * 2;
@@ -863,16 +928,17 @@ generic_cache_grow(void **items, Py_ssize_t *size, size_t item_size)
         return 0;
     }
     memset(&new[*size * item_size], 0, item_size * (new_size - *size));
+    shadow_account(shadow, item_size * (new_size - *size));
     *items = new;
     *size = new_size;
     return 1;
 }
 
 static int
-shadow_cache_grow(_ShadowCache *cache)
+shadow_cache_grow(_PyShadowCode *shadow, _ShadowCache *cache)
 {
     return generic_cache_grow(
-        (void **)&cache->items, &cache->size, sizeof(PyObject *));
+        shadow, (void **)&cache->items, &cache->size, sizeof(PyObject *));
 }
 
 static Py_ssize_t
@@ -902,7 +968,7 @@ _PyShadow_CacheAdd(_ShadowCache *cache,
     }
 
     size_t index = cache->size;
-    if (shadow_cache_grow(cache)) {
+    if (shadow_cache_grow(state->shadow, cache)) {
         cache->items[index] = from;
         return index;
     }
@@ -953,6 +1019,8 @@ _PyShadow_CacheFieldType(_PyShadow_EvalState *state, int offset, int type)
     }
     caches[cache_size].offset = offset;
     caches[cache_size].type = type;
+    shadow_account(state->shadow,
+                   sizeof(_FieldCache) * (new_cache_size - cache_size));
     state->shadow->field_caches = caches;
     state->shadow->field_cache_size = new_cache_size;
     return cache_size;
@@ -2150,6 +2218,123 @@ _PyShadow_BinarySubscrWithCache(_PyShadow_EvalState *shadow,
     return res;
 }
 
+/* Patch an arithmetic or comparison opcode into a version specialized for
+ * the types of its operands, if there is one. The specialized opcodes check
+ * the types again and patch themselves back to opcode on a miss. */
+void
+_PyShadow_BinaryOpWithTypes(_PyShadow_EvalState *shadow,
+                            const _Py_CODEUNIT *next_instr,
+                            int opcode,
+                            PyObject *left,
+                            PyObject *right,
+                            int oparg)
+{
+    int shadow_op = -1;
+    if (Py_TYPE(left) != Py_TYPE(right)) {
+        return;
+    }
+    if (PyLong_CheckExact(left)) {
+        switch (opcode) {
+        case BINARY_ADD:
+            shadow_op = BINARY_ADD_INT;
+            break;
+        case BINARY_SUBTRACT:
+            shadow_op = BINARY_SUBTRACT_INT;
+            break;
+        case BINARY_MULTIPLY:
+            shadow_op = BINARY_MULTIPLY_INT;
+            break;
+        case INPLACE_ADD:
+            shadow_op = INPLACE_ADD_INT;
+            break;
+        case COMPARE_OP:
+            if (oparg <= Py_GE) {
+                shadow_op = COMPARE_OP_INT;
+            }
+            break;
+        }
+    } else if (PyFloat_CheckExact(left)) {
+        switch (opcode) {
+        case BINARY_ADD:
+            shadow_op = BINARY_ADD_FLOAT;
+            break;
+        case BINARY_SUBTRACT:
+            shadow_op = BINARY_SUBTRACT_FLOAT;
+            break;
+        case BINARY_MULTIPLY:
+            shadow_op = BINARY_MULTIPLY_FLOAT;
+            break;
+        case INPLACE_ADD:
+            shadow_op = INPLACE_ADD_FLOAT;
+            break;
+        case COMPARE_OP:
+            if (oparg <= Py_GE) {
+                shadow_op = COMPARE_OP_FLOAT;
+            }
+            break;
+        }
+    } else if (PyUnicode_CheckExact(left)) {
+        switch (opcode) {
+        case BINARY_ADD:
+            shadow_op = BINARY_ADD_UNICODE;
+            break;
+        case INPLACE_ADD:
+            shadow_op = INPLACE_ADD_UNICODE;
+            break;
+        case COMPARE_OP:
+            if (oparg == Py_EQ || oparg == Py_NE) {
+                shadow_op = COMPARE_OP_STR_EQ;
+            }
+            break;
+        }
+    }
+    if (shadow_op >= 0) {
+        _PyShadow_PatchByteCode(shadow, next_instr, shadow_op, oparg);
+    }
+}
+
+/* Patch FOR_ITER or UNPACK_SEQUENCE into a version that steps the builtin
+ * iterator or unpacks the builtin sequence obj directly. For FOR_ITER obj is
+ * the iterator, and dict items are only handled when the next instruction
+ * unpacks them into two values, which FOR_ITER_DICT_ITEMS then does itself. */
+void
+_PyShadow_IterWithTypes(_PyShadow_EvalState *shadow,
+                        const _Py_CODEUNIT *next_instr,
+                        int opcode,
+                        PyObject *obj,
+                        int oparg)
+{
+    int shadow_op = -1;
+    PyTypeObject *type = Py_TYPE(obj);
+    if (opcode == FOR_ITER) {
+        if (type == &PyListIter_Type) {
+            shadow_op = FOR_ITER_LIST;
+        } else if (type == &PyTupleIter_Type) {
+            shadow_op = FOR_ITER_TUPLE;
+        } else if (type == &PyRangeIter_Type) {
+            shadow_op = FOR_ITER_RANGE;
+        } else if (type == &PyDictIterItem_Type) {
+            int next_op = _Py_OPCODE(*next_instr);
+            if ((next_op == UNPACK_SEQUENCE ||
+                 next_op == UNPACK_SEQUENCE_TUPLE2 ||
+                 next_op == UNPACK_SEQUENCE_LIST) &&
+                _Py_OPARG(*next_instr) == 2) {
+                shadow_op = FOR_ITER_DICT_ITEMS;
+            }
+        }
+    } else if (opcode == UNPACK_SEQUENCE) {
+        if (type == &PyTuple_Type && oparg == 2 &&
+            PyTuple_GET_SIZE(obj) == 2) {
+            shadow_op = UNPACK_SEQUENCE_TUPLE2;
+        } else if (type == &PyList_Type && PyList_GET_SIZE(obj) == oparg) {
+            shadow_op = UNPACK_SEQUENCE_LIST;
+        }
+    }
+    if (shadow_op >= 0) {
+        _PyShadow_PatchByteCode(shadow, next_instr, shadow_op, oparg);
+    }
+}
+
 #ifdef INLINE_CACHE_PROFILE
 
 /* Indexed by opcode */
@@ -2410,6 +2595,57 @@ _PyShadow_GetInlineCacheStats(PyObject *self)
 
 #endif
 
+/* Free shadow code for cold functions until there's room for nbytes more
+ * within the budget. Returns 0 if there still isn't enough room.
+ *
+ * Each call is one sweep over the shadow code, oldest first. Shadow code that
+ * hasn't run since the last sweep is freed, and its code object has to warm
+ * up again before it gets new shadow code. Anything else has its call count
+ * halved and moves to the front of the list, so it'll be freed by a later
+ * sweep unless it keeps getting called. */
+static int
+shadow_make_room(Py_ssize_t nbytes)
+{
+    Py_ssize_t remaining = shadow_code_count;
+    while (remaining-- > 0 && shadow_code_bytes + nbytes > shadow_code_budget) {
+        _PyShadowCode *shadow = shadow_lru_tail;
+        PyCodeObject *co = shadow->co;
+        if (shadow->ncalls == 0 && co->co_cache.curcalls == 0) {
+            _PyShadow_ClearCache((PyObject *)co);
+            co->co_cache.shadow_backoff = SHADOW_RETRY_BACKOFF;
+            shadow_code_evictions++;
+        } else {
+            shadow->ncalls >>= 1;
+            shadow_lru_unlink(shadow);
+            shadow_lru_push(shadow);
+        }
+    }
+    return shadow_code_bytes + nbytes <= shadow_code_budget;
+}
+
+void
+_PyShadow_SetMemoryBudget(Py_ssize_t budget)
+{
+    shadow_code_budget = budget;
+    if (budget) {
+        shadow_make_room(0);
+    }
+}
+
+PyObject *
+_PyShadow_GetMemoryStats(void)
+{
+    return Py_BuildValue("{snsnsnsn}",
+                         "bytes",
+                         shadow_code_bytes,
+                         "count",
+                         shadow_code_count,
+                         "budget",
+                         shadow_code_budget,
+                         "evictions",
+                         shadow_code_evictions);
+}
+
 int
 _PyShadow_InitCache(PyCodeObject *co)
 {
@@ -2490,6 +2726,14 @@ _PyShadow_InitCache(PyCodeObject *co)
         Py_DECREF(func_set);
     }
 
+    Py_ssize_t nbytes = sizeof(_PyShadowCode) + Py_SIZE(co->co_code) +
+                        (glob_count + func_count) * sizeof(PyObject **);
+    if (shadow_code_budget && !shadow_make_room(nbytes)) {
+        /* Everything is still warm; wait a while before retrying. */
+        co->co_cache.shadow_backoff = SHADOW_RETRY_BACKOFF;
+        return 0;
+    }
+
     _PyShadowCode *shadow;
     shadow = PyMem_Malloc(sizeof(_PyShadowCode) + Py_SIZE(co->co_code));
     if (shadow == NULL) {
@@ -2532,6 +2776,13 @@ _PyShadow_InitCache(PyCodeObject *co)
     cache_init(&shadow->l1_cache);
     cache_init(&shadow->cast_cache);
 
+    shadow->nbytes = 0;
+    shadow_account(shadow, nbytes);
+    shadow->ncalls = 0;
+    shadow->co = co;
+    shadow_lru_push(shadow);
+    shadow_code_count++;
+
     co->co_cache.shadow = shadow;
     return 0;
 }
@@ -2539,6 +2790,10 @@ _PyShadow_InitCache(PyCodeObject *co)
 void
 _PyShadowCode_Free(_PyShadowCode *shadow)
 {
+    shadow_lru_unlink(shadow);
+    shadow_code_bytes -= shadow->nbytes;
+    shadow_code_count--;
+
     if (shadow->globals_size) {
         PyMem_Free(shadow->globals);
     }
@@ -8,6 +8,7 @@
 #include "Jit/perf_jitdump.h"
 #include "Jit/profile_data.h"
 #include "Jit/pyjit.h"
+#include "Jit/runtime.h"
 
 #include "RuntimeTests/fixtures.h"
 #include "RuntimeTests/testutil.h"
@@ -403,6 +404,89 @@ TEST_F(CmdLineTest, JITEnabledFlags_MultithreadCompile) {
       0);
 }
 
+TEST_F(CmdLineTest, JITEnabledFlags_AutoJITAsync) {
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-auto-async",
+          "PYTHONJITAUTOASYNC",
+          []() {},
+          []() { ASSERT_EQ(_PyJIT_IsJitConfigAuto_jit_async(), 0); },
+          false),
+      0);
+
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-auto-async",
+          "PYTHONJITAUTOASYNC",
+          []() {},
+          []() { ASSERT_EQ(_PyJIT_IsJitConfigAuto_jit_async(), 1); },
+          true),
+      0);
+}
+
+TEST_F(CmdLineTest, JITEnabledFlags_OSR) {
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-osr=1000",
+          "PYTHONJITOSR=1000",
+          []() {},
+          []() { ASSERT_EQ(_PyJIT_IsOSREnabled(), 0); },
+          false),
+      0);
+
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-osr=1000",
+          "PYTHONJITOSR=1000",
+          []() {},
+          []() {
+            ASSERT_EQ(_PyJIT_IsOSREnabled(), 1);
+            ASSERT_EQ(_PyJIT_OSRThreshold(), 1000u);
+          },
+          true),
+      0);
+}
+
+TEST_F(CmdLineTest, JITEnabledFlags_RecompileThreshold) {
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-recompile-threshold=50",
+          "PYTHONJITRECOMPILETHRESHOLD=50",
+          []() {},
+          []() { ASSERT_EQ(jit::Runtime::get()->recompileThreshold(), 0u); },
+          false),
+      0);
+
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-recompile-threshold=50",
+          "PYTHONJITRECOMPILETHRESHOLD=50",
+          []() {},
+          []() { ASSERT_EQ(jit::Runtime::get()->recompileThreshold(), 50u); },
+          true),
+      0);
+}
+
+TEST_F(CmdLineTest, JITEnabledFlags_HIRInlinerBudget) {
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-hir-inliner-budget=50",
+          "PYTHONJITHIRINLINERBUDGET=50",
+          []() {},
+          []() { ASSERT_NE(_PyJIT_HIRInlinerBudget(), 50u); },
+          false),
+      0);
+
+  ASSERT_EQ(
+      try_flag_and_envvar_effect(
+          L"jit-hir-inliner-budget=50",
+          "PYTHONJITHIRINLINERBUDGET=50",
+          []() {},
+          []() { ASSERT_EQ(_PyJIT_HIRInlinerBudget(), 50u); },
+          true),
+      0);
+}
+
 TEST_F(CmdLineTest, JITEnabledFlags_MatchLineNumbers) {
   ASSERT_EQ(
       try_flag_and_envvar_effect(
@@ -0,0 +1,78 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include <gtest/gtest.h>
+
+#include "Python.h"
+
+#include "Jit/compile_manifest.h"
+
+#include "RuntimeTests/fixtures.h"
+
+#include <sstream>
+
+using namespace jit;
+
+class CompileManifestTest : public RuntimeTest {
+ public:
+  void TearDown() override {
+    clearCompileManifest();
+    RuntimeTest::TearDown();
+  }
+};
+
+TEST_F(CompileManifestTest, RoundTrip) {
+  const char* py_src = R"(
+def foo():
+  return 1
+
+def bar():
+  return 2
+)";
+  ASSERT_TRUE(runCode(py_src));
+  Ref<PyFunctionObject> foo(getGlobal("foo"));
+  Ref<PyFunctionObject> bar(getGlobal("bar"));
+  ASSERT_NE(foo, nullptr);
+  ASSERT_NE(bar, nullptr);
+  BorrowedRef<PyCodeObject> foo_code = foo->func_code;
+  BorrowedRef<PyCodeObject> bar_code = bar->func_code;
+
+  std::stringstream stream;
+  ASSERT_TRUE(writeCompileManifest(stream, {foo_code}));
+  EXPECT_FALSE(inCompileManifest(foo_code));
+
+  ASSERT_TRUE(readCompileManifest(stream));
+  EXPECT_EQ(compileManifestSize(), 1);
+  EXPECT_TRUE(inCompileManifest(foo_code));
+  EXPECT_FALSE(inCompileManifest(bar_code));
+
+  // Loaded keys are preserved when writing a new manifest.
+  std::stringstream stream2;
+  ASSERT_TRUE(writeCompileManifest(stream2, {bar_code}));
+  clearCompileManifest();
+  ASSERT_TRUE(readCompileManifest(stream2));
+  EXPECT_EQ(compileManifestSize(), 2);
+  EXPECT_TRUE(inCompileManifest(foo_code));
+  EXPECT_TRUE(inCompileManifest(bar_code));
+}
+
+TEST_F(CompileManifestTest, ChangedBytecodeDoesNotMatch) {
+  ASSERT_TRUE(runCode("def foo():\n  return 1\n"));
+  Ref<PyFunctionObject> old_foo(getGlobal("foo"));
+  ASSERT_NE(old_foo, nullptr);
+
+  std::stringstream stream;
+  ASSERT_TRUE(writeCompileManifest(
+      stream, {BorrowedRef<PyCodeObject>(old_foo->func_code)}));
+  ASSERT_TRUE(readCompileManifest(stream));
+
+  ASSERT_TRUE(runCode("def foo():\n  return 2 + x\n"));
+  Ref<PyFunctionObject> new_foo(getGlobal("foo"));
+  ASSERT_NE(new_foo, nullptr);
+  EXPECT_FALSE(
+      inCompileManifest(BorrowedRef<PyCodeObject>(new_foo->func_code)));
+}
+
+TEST_F(CompileManifestTest, RejectsBadHeader) {
+  std::stringstream stream("not a manifest\nfoo:1:foo:1234\n");
+  EXPECT_FALSE(readCompileManifest(stream));
+  EXPECT_EQ(compileManifestSize(), 0);
+}
@@ -118,6 +118,88 @@ def test(x):
   ASSERT_EQ(PyLong_AsLong(res), 1);
 }
 
+TEST_F(ASMGeneratorTest, LoadAttrInlineSplitDict) {
+  const char* pycode = R"(
+class C:
+    def __init__(self, x):
+        self.x = x
+
+a = C(1)
+b = C(2)
+c = C(3)
+c.__dict__.clear()
+d = C(4)
+d.y = 5
+del d.x
+d.x = 4
+
+def test(o):
+    return o.x
+)";
+
+  Ref<PyObject> pyfunc(compileAndGet(pycode, "test"));
+  ASSERT_NE(pyfunc.get(), nullptr) << "Failed compiling func";
+
+  auto compiled = GenerateCode(pyfunc);
+  ASSERT_NE(compiled, nullptr);
+
+  // The first call fills the cache; the second is served by the inline entry.
+  PyObject* a_args[] = {getGlobal("a")};
+  auto res = Ref<>::steal(compiled->Invoke(pyfunc, a_args, 1));
+  EXPECT_TRUE(isIntEquals(res, 1));
+  PyObject* b_args[] = {getGlobal("b")};
+  res = Ref<>::steal(compiled->Invoke(pyfunc, b_args, 1));
+  EXPECT_TRUE(isIntEquals(res, 2));
+
+  // A dict whose keys no longer match takes the slow path.
+  PyObject* d_args[] = {getGlobal("d")};
+  res = Ref<>::steal(compiled->Invoke(pyfunc, d_args, 1));
+  EXPECT_TRUE(isIntEquals(res, 4));
+
+  // So does a missing value, which must still raise.
+  PyObject* c_args[] = {getGlobal("c")};
+  res = Ref<>::steal(compiled->Invoke(pyfunc, c_args, 1));
+  ASSERT_EQ(res, nullptr);
+  EXPECT_TRUE(PyErr_ExceptionMatches(PyExc_AttributeError));
+  PyErr_Clear();
+}
+
+TEST_F(ASMGeneratorTest, LoadAttrInlineSlot) {
+  const char* pycode = R"(
+class C:
+    __slots__ = ("x",)
+
+a = C()
+a.x = 1
+b = C()
+b.x = 2
+c = C()
+
+def test(o):
+    return o.x
+)";
+
+  Ref<PyObject> pyfunc(compileAndGet(pycode, "test"));
+  ASSERT_NE(pyfunc.get(), nullptr) << "Failed compiling func";
+
+  auto compiled = GenerateCode(pyfunc);
+  ASSERT_NE(compiled, nullptr);
+
+  PyObject* a_args[] = {getGlobal("a")};
+  auto res = Ref<>::steal(compiled->Invoke(pyfunc, a_args, 1));
+  EXPECT_TRUE(isIntEquals(res, 1));
+  PyObject* b_args[] = {getGlobal("b")};
+  res = Ref<>::steal(compiled->Invoke(pyfunc, b_args, 1));
+  EXPECT_TRUE(isIntEquals(res, 2));
+
+  // An unset slot takes the slow path, which raises.
+  PyObject* c_args[] = {getGlobal("c")};
+  res = Ref<>::steal(compiled->Invoke(pyfunc, c_args, 1));
+  ASSERT_EQ(res, nullptr);
+  EXPECT_TRUE(PyErr_ExceptionMatches(PyExc_AttributeError));
+  PyErr_Clear();
+}
+
 TEST_F(ASMGeneratorTest, KWArgCall) {
   const char* pycode = R"(
 def test(a, b):
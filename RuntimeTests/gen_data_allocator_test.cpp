@@ -0,0 +1,78 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include <gtest/gtest.h>
+
+#include "Jit/gen_data_allocator.h"
+#include "Jit/runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <vector>
+
+using jit::GenDataAllocator;
+
+TEST(GenDataAllocatorTest, RoundUp) {
+  EXPECT_EQ(GenDataAllocator::roundUp(0), 8u);
+  EXPECT_EQ(GenDataAllocator::roundUp(8), 8u);
+  EXPECT_EQ(GenDataAllocator::roundUp(9), 16u);
+  EXPECT_EQ(GenDataAllocator::roundUp(89), 128u);
+  EXPECT_EQ(GenDataAllocator::roundUp(256), 256u);
+  EXPECT_EQ(GenDataAllocator::roundUp(257), 257u);
+}
+
+TEST(GenDataAllocatorTest, ReusesFreedBlocks) {
+  size_t words = GenDataAllocator::roundUp(20);
+  // Keep the slab alive so releasing a doesn't give it back to the system.
+  void* keep = GenDataAllocator::allocate(words);
+  void* a = GenDataAllocator::allocate(words);
+  ASSERT_NE(keep, nullptr);
+  ASSERT_NE(a, nullptr);
+  GenDataAllocator::release(a, words);
+  void* b = GenDataAllocator::allocate(words);
+  EXPECT_EQ(a, b);
+  GenDataAllocator::release(b, words);
+  GenDataAllocator::release(keep, words);
+}
+
+TEST(GenDataAllocatorTest, SlabsComeAndGo) {
+  const size_t kClass = 5;
+  size_t words = GenDataAllocator::kSizeClassWords[kClass];
+  auto before = GenDataAllocator::sizeClassStats(kClass);
+
+  // Enough blocks to need several slabs.
+  size_t block_bytes = words * sizeof(uint64_t) + sizeof(jit::GenDataFooter);
+  size_t count = 4 * GenDataAllocator::kSlabSize / block_bytes;
+  std::vector<void*> blocks;
+  std::set<void*> unique;
+  for (size_t i = 0; i < count; i++) {
+    void* block = GenDataAllocator::allocate(words);
+    ASSERT_NE(block, nullptr);
+    std::memset(block, 0xab, block_bytes);
+    blocks.push_back(block);
+    unique.insert(block);
+  }
+  EXPECT_EQ(unique.size(), count);
+
+  auto during = GenDataAllocator::sizeClassStats(kClass);
+  EXPECT_EQ(during.spill_words, words);
+  EXPECT_EQ(during.live_blocks, before.live_blocks + count);
+  EXPECT_GE(during.slabs, before.slabs + 3);
+
+  for (void* block : blocks) {
+    GenDataAllocator::release(block, words);
+  }
+  auto after = GenDataAllocator::sizeClassStats(kClass);
+  EXPECT_EQ(after.live_blocks, before.live_blocks);
+  EXPECT_LE(after.slabs, std::max<size_t>(before.slabs, 1));
+}
+
+TEST(GenDataAllocatorTest, LargeBlocks) {
+  size_t words = GenDataAllocator::kSizeClassWords.back() + 100;
+  size_t before = GenDataAllocator::largeBlocks();
+  void* block = GenDataAllocator::allocate(words);
+  ASSERT_NE(block, nullptr);
+  EXPECT_EQ(GenDataAllocator::largeBlocks(), before + 1);
+  GenDataAllocator::release(block, words);
+  EXPECT_EQ(GenDataAllocator::largeBlocks(), before);
+}
@@ -419,6 +419,32 @@ BB %10 - preds: %0 %7 - section: hot
       parsed_func->basicblocks()[2]->section(), codegen::CodeSection::kHot);
 }
 
+TEST_F(LIRGeneratorTest, SortSinksColdBlocks) {
+  auto lir_str = fmt::format(R"(Function:
+BB %0 - succs: %1 %2
+                   CondBranch RAX:Object, BB%1, BB%2
+BB %1 - preds: %0 - succs: %3
+      RAX:Object = Move RDI:Object
+BB %2 - preds: %0 - succs: %3 - section: .coldtext
+      RAX:Object = Move R13:Object
+BB %3 - preds: %1 %2 - succs: %4
+      RAX:Object = Move RSI:Object
+BB %4 - preds: %3
+)");
+
+  Parser parser;
+  auto parsed_func = parser.parse(lir_str);
+  parsed_func->sortBasicBlocks();
+
+  // The cold block goes after all of the hot ones except the exit block, so
+  // the branch in BB %0 can fall through to its hot successor.
+  std::vector<int> ids;
+  for (auto block : parsed_func->basicblocks()) {
+    ids.push_back(block->id());
+  }
+  EXPECT_EQ(ids, (std::vector<int>{0, 1, 3, 2, 4}));
+}
+
 TEST(LIRTest, MemoryIndirectTests) {
   ASSERT_TRUE(MemoryIndirectTestCase("[RCX:Object]", PhyLocation::RCX));
   ASSERT_TRUE(MemoryIndirectTestCase(
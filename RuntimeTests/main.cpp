@@ -104,6 +104,7 @@ int main(int argc, char* argv[]) {
       "RuntimeTests/hir_tests/hir_builder_static_test.txt",
       HIRTest::kCompileStatic);
   register_test("RuntimeTests/hir_tests/guard_type_removal_test.txt");
+  register_test("RuntimeTests/hir_tests/gvn_test.txt");
   register_test("RuntimeTests/hir_tests/inliner_test.txt");
   register_test(
       "RuntimeTests/hir_tests/inliner_static_test.txt",
@@ -112,11 +113,13 @@ int main(int argc, char* argv[]) {
   register_test(
       "RuntimeTests/hir_tests/inliner_elimination_static_test.txt",
       HIRTest::kCompileStatic);
+  register_test("RuntimeTests/hir_tests/licm_test.txt");
   register_test("RuntimeTests/hir_tests/phi_elimination_test.txt");
   register_test("RuntimeTests/hir_tests/refcount_insertion_test.txt");
   register_test(
       "RuntimeTests/hir_tests/refcount_insertion_static_test.txt",
       HIRTest::kCompileStatic);
+  register_test("RuntimeTests/hir_tests/scalar_replacement_test.txt");
   register_test(
       "RuntimeTests/hir_tests/super_access_test.txt", HIRTest::kCompileStatic);
   register_test("RuntimeTests/hir_tests/simplify_test.txt");
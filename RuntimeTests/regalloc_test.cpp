@@ -340,4 +340,293 @@ TEST_F(LinearScanAllocatorTest, CallWithSideEffectTest) {
   ASSERT_TRUE(a->opcode() == Instruction::kCall);
   ASSERT_TRUE(a->output()->type() == lir::Operand::kNone);
 }
+
+TEST_F(LinearScanAllocatorTest, BackwardEdgeIsNotALoop) {
+  // BB%5 is laid out after the join block it branches back to, as happens
+  // for cold blocks. %1 must not be kept alive across BB%11 ([16, 24)), and
+  // nothing here should be treated as a loop.
+  const char* lir_source = R"(
+Function:
+BB %0 - succs: %3 %5
+      %1 = Move 0(0x0)
+      %2 = Move 8(0x8)
+           CondBranch %1, BB%3, BB%5
+
+BB %3 - succs: %7
+      %4 = Add %2, 8(0x8)
+           Branch BB%7
+
+BB %7 - succs: %11
+      %8 = Phi (BB%3, %4), (BB%5, %6)
+      %9 = Add %1, %8
+           Branch BB%11
+
+BB %11 - succs: %14
+     %12 = Add %9, %9
+           Return %12
+
+BB %5 - succs: %7
+      %6 = Add %2, %2
+           Branch BB%7
+
+BB %14
+
+)";
+
+  Parser parser;
+  auto lir_func = parser.parse(lir_source);
+  auto opnd_id_map = buildOperandToIndexMap(parser.getOutputInstrMap());
+
+  LinearScanAllocator lsallocator(lir_func.get());
+  lsallocator.initialize();
+  lsallocator.calculateLiveIntervals();
+  ASSERT_TRUE(lsallocator.loop_ranges_.empty());
+
+  auto id_interval = buildIndexMap(lsallocator.vreg_interval_, opnd_id_map);
+  ASSERT_FALSE(id_interval.empty());
+
+  std::vector<int> vregs;
+  for (auto& ii : id_interval) {
+    vregs.push_back(ii.first);
+  }
+  std::sort(vregs.begin(), vregs.end());
+
+  std::stringstream ss_ranges;
+  for (auto& vreg : vregs) {
+    ss_ranges << vreg << ": " << id_interval.at(vreg) << "\n";
+  }
+
+  std::string live_expected = R"(1: [2, 16), [24, 29)
+2: [4, 9), [24, 26)
+4: [9, 12)
+6: [26, 29)
+8: [12, 16)
+9: [16, 21)
+12: [21, 23)
+)";
+  ASSERT_EQ(ss_ranges.str(), live_expected);
+
+  ASSERT_EQ(lsallocator.vreg_constants_.size(), 2u);
+}
+
+TEST_F(LinearScanAllocatorTest, RematerializesSpilledConstant) {
+  // All 14 allocatable registers are taken when %16 is defined, so the
+  // constant in %1 is spilled. It should be loaded back with a move of the
+  // immediate rather than read from its stack slot.
+  const char* lir_source = R"(
+Function:
+BB %0 - succs: %40
+     %1 = Move 12345(0x3039)
+     %2 = Move 0(0x0)
+     %3 = Add %2, 1(0x1)
+     %4 = Add %3, 1(0x1)
+     %5 = Add %4, 1(0x1)
+     %6 = Add %5, 1(0x1)
+     %7 = Add %6, 1(0x1)
+     %8 = Add %7, 1(0x1)
+     %9 = Add %8, 1(0x1)
+    %10 = Add %9, 1(0x1)
+    %11 = Add %10, 1(0x1)
+    %12 = Add %11, 1(0x1)
+    %13 = Add %12, 1(0x1)
+    %14 = Add %13, 1(0x1)
+    %15 = Add %14, 1(0x1)
+    %16 = Add %15, 1(0x1)
+    %17 = Add %16, 1(0x1)
+    %18 = Add %3, %17
+    %19 = Add %4, %18
+    %20 = Add %5, %19
+    %21 = Add %6, %20
+    %22 = Add %7, %21
+    %23 = Add %8, %22
+    %24 = Add %9, %23
+    %25 = Add %10, %24
+    %26 = Add %11, %25
+    %27 = Add %12, %26
+    %28 = Add %13, %27
+    %29 = Add %14, %28
+    %30 = Add %15, %29
+    %31 = Add %1, %30
+          Return %31
+
+BB %40
+)";
+
+  Parser parser;
+  auto lir_func = parser.parse(lir_source);
+  runAllocator(lir_func.get());
+
+  std::vector<const Instruction*> const_moves;
+  for (auto bb : lir_func->basicblocks()) {
+    for (auto& instr : bb->instructions()) {
+      if (instr->isMove() && instr->getInput(0)->isImm() &&
+          instr->getInput(0)->getConstant() == 12345) {
+        const_moves.push_back(instr.get());
+      }
+    }
+  }
+  ASSERT_EQ(const_moves.size(), 2u);
+  ASSERT_TRUE(const_moves[1]->output()->isReg());
+}
+
+TEST_F(LinearScanAllocatorTest, EvictsValueUsedOutsideInnerLoop) {
+  // When %21 is defined, %2 through %15 hold all 14 allocatable registers.
+  // %2 through %14 are next used in the inner loop (BB%30), and %15 in the
+  // outer loop. %14 has the most distant next use, but it would be reloaded
+  // in the inner loop, so %15 should be evicted instead.
+  const char* lir_source = R"(
+Function:
+BB %0 - succs: %20
+     %1 = Move 0(0x0)
+     %2 = Add %1, 1(0x1)
+     %3 = Add %2, 1(0x1)
+     %4 = Add %3, 1(0x1)
+     %5 = Add %4, 1(0x1)
+     %6 = Add %5, 1(0x1)
+     %7 = Add %6, 1(0x1)
+     %8 = Add %7, 1(0x1)
+     %9 = Add %8, 1(0x1)
+    %10 = Add %9, 1(0x1)
+    %11 = Add %10, 1(0x1)
+    %12 = Add %11, 1(0x1)
+    %13 = Add %12, 1(0x1)
+    %14 = Add %13, 1(0x1)
+    %15 = Add %14, 1(0x1)
+          Branch BB%20
+
+BB %20 - succs: %30
+    %21 = Add %2, 1(0x1)
+    %22 = Add %21, 1(0x1)
+    %23 = Add %15, 1(0x1)
+          Branch BB%30
+
+BB %30 - succs: %30 %50
+    %31 = Add %2, 1(0x1)
+    %32 = Add %3, %31
+    %33 = Add %4, %32
+    %34 = Add %5, %33
+    %35 = Add %6, %34
+    %36 = Add %7, %35
+    %37 = Add %8, %36
+    %38 = Add %9, %37
+    %39 = Add %10, %38
+    %40 = Add %11, %39
+    %41 = Add %12, %40
+    %42 = Add %13, %41
+    %43 = Add %14, %42
+          CondBranch %43, BB%30, BB%50
+
+BB %50 - succs: %20 %60
+          CondBranch %23, BB%20, BB%60
+
+BB %60 - succs: %70
+          Return %23
+
+BB %70
+)";
+
+  Parser parser;
+  auto lir_func = parser.parse(lir_source);
+  auto opnd_id_map = buildOperandToIndexMap(parser.getOutputInstrMap());
+
+  LinearScanAllocator lsallocator(lir_func.get());
+  lsallocator.initialize();
+  lsallocator.sortBasicBlocks();
+  lsallocator.calculateLiveIntervals();
+  ASSERT_EQ(lsallocator.loop_ranges_.size(), 2u);
+  lsallocator.linearScan();
+
+  auto always_in_register = [&](int id) {
+    return std::all_of(
+        lsallocator.allocated_.begin(),
+        lsallocator.allocated_.end(),
+        [&](const auto& interval) {
+          return opnd_id_map.at(interval->vreg) != id ||
+              interval->isRegisterAllocated();
+        });
+  };
+  EXPECT_FALSE(always_in_register(15));
+  for (int id = 2; id <= 14; id++) {
+    EXPECT_TRUE(always_in_register(id)) << "%" << id << " was spilled";
+  }
+}
+
+TEST_F(LinearScanAllocatorTest, ReusesSpillSlots) {
+  // Each of the two chains of 15 values needs one of them spilled. The first
+  // spilled value is dead by the time the second chain is built, so they
+  // share a stack slot.
+  const char* lir_source = R"(
+Function:
+BB %0 - succs: %80
+     %1 = Move 0(0x0)
+     %2 = Add %1, 1(0x1)
+     %3 = Add %2, 1(0x1)
+     %4 = Add %3, 1(0x1)
+     %5 = Add %4, 1(0x1)
+     %6 = Add %5, 1(0x1)
+     %7 = Add %6, 1(0x1)
+     %8 = Add %7, 1(0x1)
+     %9 = Add %8, 1(0x1)
+    %10 = Add %9, 1(0x1)
+    %11 = Add %10, 1(0x1)
+    %12 = Add %11, 1(0x1)
+    %13 = Add %12, 1(0x1)
+    %14 = Add %13, 1(0x1)
+    %15 = Add %14, 1(0x1)
+    %16 = Add %15, 1(0x1)
+    %17 = Add %2, 1(0x1)
+    %18 = Add %3, %17
+    %19 = Add %4, %18
+    %20 = Add %5, %19
+    %21 = Add %6, %20
+    %22 = Add %7, %21
+    %23 = Add %8, %22
+    %24 = Add %9, %23
+    %25 = Add %10, %24
+    %26 = Add %11, %25
+    %27 = Add %12, %26
+    %28 = Add %13, %27
+    %29 = Add %14, %28
+    %30 = Add %15, %29
+    %31 = Add %16, %30
+    %32 = Add %31, 1(0x1)
+    %33 = Add %32, 1(0x1)
+    %34 = Add %33, 1(0x1)
+    %35 = Add %34, 1(0x1)
+    %36 = Add %35, 1(0x1)
+    %37 = Add %36, 1(0x1)
+    %38 = Add %37, 1(0x1)
+    %39 = Add %38, 1(0x1)
+    %40 = Add %39, 1(0x1)
+    %41 = Add %40, 1(0x1)
+    %42 = Add %41, 1(0x1)
+    %43 = Add %42, 1(0x1)
+    %44 = Add %43, 1(0x1)
+    %45 = Add %44, 1(0x1)
+    %46 = Add %45, 1(0x1)
+    %47 = Add %32, 1(0x1)
+    %48 = Add %33, %47
+    %49 = Add %34, %48
+    %50 = Add %35, %49
+    %51 = Add %36, %50
+    %52 = Add %37, %51
+    %53 = Add %38, %52
+    %54 = Add %39, %53
+    %55 = Add %40, %54
+    %56 = Add %41, %55
+    %57 = Add %42, %56
+    %58 = Add %43, %57
+    %59 = Add %44, %58
+    %60 = Add %45, %59
+    %61 = Add %46, %60
+          Return %61
+
+BB %80
+)";
+
+  Parser parser;
+  auto lir_func = parser.parse(lir_source);
+  auto allocator = runAllocator(lir_func.get());
+  ASSERT_EQ(allocator->getSpillSize(), 8);
+}
 } // namespace jit::lir
@@ -31,6 +31,14 @@ class SlotGenTest : public RuntimeTest {
     return Ref<>::steal(_PyObject_Call_Prepend(func, type, args, kwargs));
   }
 
+  PyObject* lookupFunc(PyTypeObject* type, const char* name) {
+    auto name_obj = Ref<>::steal(PyUnicode_FromString(name));
+    if (name_obj.get() == nullptr) {
+      return nullptr;
+    }
+    return _PyType_Lookup(type, name_obj);
+  }
+
   void TearDown() override {
     RuntimeTest::TearDown();
   }
@@ -213,3 +221,147 @@ class Foo:
   ASSERT_EQ(Py_TYPE(result3.get()), &PyLong_Type);
   ASSERT_EQ(PyLong_AsLong(result3), 200);
 }
+
+static PyObject* richcompare_fallback(PyObject*, PyObject*, int) {
+  Py_RETURN_NOTIMPLEMENTED;
+}
+
+TEST_F(SlotGenTest, RichCompareDispatchesOnOp) {
+  const char* src = R"(
+class Foo:
+  def __eq__(self, other):
+    return "eq"
+  def __lt__(self, other):
+    return "lt"
+)";
+  Ref<PyTypeObject> foo(compileAndGet(src, "Foo"));
+  ASSERT_NE(foo.get(), nullptr) << "Failed creating foo";
+
+  PyObject* funcs[Py_GE + 1] = {};
+  funcs[Py_EQ] = lookupFunc(foo, "__eq__");
+  funcs[Py_LT] = lookupFunc(foo, "__lt__");
+  ASSERT_NE(funcs[Py_EQ], nullptr);
+  ASSERT_NE(funcs[Py_LT], nullptr);
+
+  richcmpfunc richcmp =
+      slot_gen_->genRichCompareSlot(foo, funcs, richcompare_fallback);
+  ASSERT_NE(richcmp, nullptr);
+
+  auto args = Ref<>::steal(PyTuple_New(0));
+  Ref<PyObject> instance(
+      makeRawInstance(reinterpret_cast<PyObject*>(foo.get()), args, nullptr));
+
+  auto eq = Ref<>::steal(richcmp(instance, instance, Py_EQ));
+  ASSERT_NE(eq, nullptr);
+  EXPECT_EQ(PyUnicode_CompareWithASCIIString(eq, "eq"), 0);
+
+  auto lt = Ref<>::steal(richcmp(instance, instance, Py_LT));
+  ASSERT_NE(lt, nullptr);
+  EXPECT_EQ(PyUnicode_CompareWithASCIIString(lt, "lt"), 0);
+
+  auto gt = Ref<>::steal(richcmp(instance, instance, Py_GT));
+  EXPECT_EQ(gt.get(), Py_NotImplemented);
+}
+
+TEST_F(SlotGenTest, HashConvertsResult) {
+  const char* src = R"(
+class Foo:
+  def __hash__(self):
+    return self.h
+)";
+  Ref<PyTypeObject> foo(compileAndGet(src, "Foo"));
+  ASSERT_NE(foo.get(), nullptr) << "Failed creating foo";
+
+  PyObject* hash_func = lookupFunc(foo, "__hash__");
+  ASSERT_NE(hash_func, nullptr);
+
+  hashfunc hash = slot_gen_->genHashSlot(foo, hash_func);
+  ASSERT_NE(hash, nullptr);
+
+  auto args = Ref<>::steal(PyTuple_New(0));
+  Ref<PyObject> instance(
+      makeRawInstance(reinterpret_cast<PyObject*>(foo.get()), args, nullptr));
+
+  auto set_h = [&](PyObject* value) {
+    auto owned = Ref<>::steal(value);
+    ASSERT_EQ(PyObject_SetAttrString(instance, "h", owned), 0);
+  };
+
+  set_h(PyLong_FromLong(1234));
+  EXPECT_EQ(hash(instance), 1234);
+
+  // -1 is reserved for errors
+  set_h(PyLong_FromLong(-1));
+  EXPECT_EQ(hash(instance), -2);
+
+  auto big = Ref<>::steal(PyNumber_Lshift(
+      Ref<>::steal(PyLong_FromLong(1)), Ref<>::steal(PyLong_FromLong(100))));
+  ASSERT_NE(big, nullptr);
+  Py_INCREF(big.get());
+  set_h(big.get());
+  EXPECT_EQ(hash(instance), PyLong_Type.tp_hash(big));
+
+  set_h(PyUnicode_FromString("not an int"));
+  EXPECT_EQ(hash(instance), -1);
+  ASSERT_TRUE(PyErr_ExceptionMatches(PyExc_TypeError));
+  PyErr_Clear();
+}
+
+static int deleted_items = 0;
+
+static int ass_subscript_fallback(PyObject*, PyObject*, PyObject* value) {
+  EXPECT_EQ(value, nullptr);
+  deleted_items++;
+  return 0;
+}
+
+TEST_F(SlotGenTest, MappingSlots) {
+  const char* src = R"(
+class Foo:
+  def __len__(self):
+    return self.n
+  def __getitem__(self, key):
+    return key * 2
+  def __setitem__(self, key, value):
+    self.n = key + value
+)";
+  Ref<PyTypeObject> foo(compileAndGet(src, "Foo"));
+  ASSERT_NE(foo.get(), nullptr) << "Failed creating foo";
+
+  PyObject* len_func = lookupFunc(foo, "__len__");
+  PyObject* getitem_func = lookupFunc(foo, "__getitem__");
+  PyObject* setitem_func = lookupFunc(foo, "__setitem__");
+  ASSERT_NE(len_func, nullptr);
+  ASSERT_NE(getitem_func, nullptr);
+  ASSERT_NE(setitem_func, nullptr);
+
+  lenfunc len = slot_gen_->genLenSlot(foo, len_func);
+  binaryfunc getitem = slot_gen_->genGetItemSlot(foo, getitem_func);
+  objobjargproc setitem =
+      slot_gen_->genSetItemSlot(foo, setitem_func, ass_subscript_fallback);
+  ASSERT_NE(len, nullptr);
+  ASSERT_NE(getitem, nullptr);
+  ASSERT_NE(setitem, nullptr);
+
+  auto args = Ref<>::steal(PyTuple_New(0));
+  Ref<PyObject> instance(
+      makeRawInstance(reinterpret_cast<PyObject*>(foo.get()), args, nullptr));
+
+  auto three = Ref<>::steal(PyLong_FromLong(3));
+  auto four = Ref<>::steal(PyLong_FromLong(4));
+  ASSERT_EQ(setitem(instance, three, four), 0);
+  EXPECT_EQ(len(instance), 7);
+
+  auto item = Ref<>::steal(getitem(instance, three));
+  ASSERT_NE(item, nullptr);
+  EXPECT_EQ(PyLong_AsLong(item), 6);
+
+  ASSERT_EQ(setitem(instance, three, nullptr), 0);
+  EXPECT_EQ(deleted_items, 1);
+
+  auto minus_one = Ref<>::steal(PyLong_FromLong(-1));
+  ASSERT_EQ(PyObject_SetAttrString(instance, "n", minus_one), 0);
+  EXPECT_EQ(len(instance), -1);
+  ASSERT_TRUE(PyErr_ExceptionMatches(PyExc_ValueError));
+  PyErr_Clear();
+}
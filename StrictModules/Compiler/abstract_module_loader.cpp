@@ -9,16 +9,22 @@
 #include "StrictModules/parser_util.h"
 #include "StrictModules/symbol_table.h"
 
+#include <algorithm>
 #include <cstring>
 #include <filesystem>
 #include <regex>
 #include <optional>
+#include <system_error>
 
 namespace strictmod::compiler {
 
 using strictmod::objects::ModuleType;
 using strictmod::objects::StrictModuleObject;
 
+// Part of every cache key, bump when the analysis changes in a way that
+// makes earlier results stale
+static const char* kAnalysisCacheVersion = "1";
+
 static const char* kFileSuffixNames[] = {".py", ".pys", ".pyi"};
 
 const char* getFileSuffixKindName(FileSuffixKind kind) {
@@ -197,6 +203,10 @@ std::shared_ptr<StrictModuleObject> ModuleLoader::loadModuleValue(
 std::shared_ptr<StrictModuleObject> ModuleLoader::loadModuleValue(
     const std::string& modName) {
   AnalyzedModule* mod = loadModule(modName);
+  if (mod && mod->isRestored()) {
+    mod = reanalyzeRestored(mod);
+  }
+  recordDependency(modName);
   if (mod) {
     return mod->getModuleValue();
   }
@@ -211,7 +221,12 @@ std::shared_ptr<StrictModuleObject> ModuleLoader::tryGetModuleValue(
     const std::string& modName) {
   auto exist = modules_.find(modName);
   if (exist != modules_.end() && exist->second) {
-    return exist->second->getModuleValue();
+    AnalyzedModule* mod = exist->second.get();
+    if (mod->isRestored()) {
+      mod = reanalyzeRestored(mod);
+    }
+    recordDependency(modName);
+    return mod ? mod->getModuleValue() : nullptr;
   } else {
     auto it = lazy_modules_.find(modName);
     if (it != lazy_modules_.end()) {
@@ -249,6 +264,10 @@ AnalyzedModule* ModuleLoader::loadSingleModule(const std::string& modName) {
     return analyze(std::move(stubModInfo));
   }
   if (modInfo) {
+    std::string source;
+    if (analysisCache_ && readFileContents(modInfo->getFilename(), source)) {
+      return analyze(std::move(modInfo), std::move(source));
+    }
     return analyze(std::move(modInfo));
   }
 
@@ -315,6 +334,7 @@ bool ModuleLoader::setAllowListRegex(std::vector<std::string> allowList) {
   for (const std::string& regex : allowList) {
     try {
       allowListRegexes_.emplace_back(regex);
+      allowListRegexStrs_.emplace_back(regex);
     }
     catch (const std::regex_error&) {
       return -1;
@@ -351,6 +371,9 @@ AnalyzedModule* ModuleLoader::loadModuleFromSource(
         std::move(result.symbols),
         stubKind,
         std::move(searchLocations));
+    if (analysisCache_) {
+      return analyze(std::move(modinfo), std::string(source));
+    }
     return analyze(std::move(modinfo));
   }
   return nullptr;
@@ -486,8 +509,31 @@ std::unique_ptr<ModuleInfo> ModuleLoader::findModuleFromSource(
   return nullptr;
 }
 
-AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
+namespace {
+// keeps analysisStack_ balanced when the analysis throws
+class AnalysisStackGuard {
+ public:
+  AnalysisStackGuard(std::vector<AnalyzedModule*>& stack, AnalyzedModule* mod)
+      : stack_(stack) {
+    stack_.push_back(mod);
+  }
+  ~AnalysisStackGuard() {
+    stack_.pop_back();
+  }
+
+ private:
+  std::vector<AnalyzedModule*>& stack_;
+};
+} // namespace
+
+AnalyzedModule* ModuleLoader::analyze(
+    std::unique_ptr<ModuleInfo> modInfo,
+    std::optional<std::string> source) {
   const mod_ty ast = modInfo->getAst();
+  if (analysisStack_.empty()) {
+    // files may have changed since the last top level analysis
+    fingerprints_.clear();
+  }
 
   // Following python semantics, publish the module before ast visits
   auto errorSink = errorSinkFactory_();
@@ -529,8 +575,21 @@ AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
     return existingMod;
   }
 
+  std::optional<uint64_t> cacheKey;
+  if (analysisCache_ && source) {
+    cacheKey = getCacheKey(moduleInfo, *source);
+  }
+
   if (analyzedModule->isStrict() || isForcedStrict(name, filename)) {
     assert(ast != nullptr);
+    // Only modules checked directly can be restored; a module imported
+    // during analysis must produce a value for its importer
+    if (cacheKey && analysisStack_.empty() &&
+        restoreFromCache(analyzedModule, *cacheKey)) {
+      log("Restored module %s from the analysis cache", name.c_str());
+      analyzedModule->setRestoredSource(std::move(*source));
+      return analyzedModule;
+    }
     // Run ast visits
     auto globalScope = std::make_shared<objects::DictType>();
     // create module object. Analysis result will be the __dict__ of this object
@@ -571,8 +630,15 @@ AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
         mod,
         moduleInfo.getFutureAnnotations());
 
-    analyzer.analyze();
+    size_t firstError = errorSinkBorrowed->getErrorCount();
+    {
+      AnalysisStackGuard guard(analysisStack_, analyzedModule);
+      analyzer.analyze();
+    }
     analyzedModule->setAstToResults(analyzer.passAstToResultsMap());
+    if (cacheKey) {
+      storeToCache(analyzedModule, *cacheKey, firstError);
+    }
   }
 
   if (hasAllowListedParent(name)) {
@@ -581,6 +647,233 @@ AnalyzedModule* ModuleLoader::analyze(std::unique_ptr<ModuleInfo> modInfo) {
   return analyzedModule;
 }
 
+AnalyzedModule* ModuleLoader::reanalyzeRestored(AnalyzedModule* mod) {
+  const ModuleInfo& info = mod->getModuleInfo();
+  const std::string name = info.getModName();
+  const std::string& filename = info.getFilename();
+  log("Analyzing module %s restored from the analysis cache", name.c_str());
+  const std::string& source = mod->getRestoredSource();
+  auto readResult = readFromSource(source.c_str(), filename.c_str(), arena_);
+  if (!readResult) {
+    return nullptr;
+  }
+  AstAndSymbols& result = readResult.value();
+  auto modInfo = std::make_unique<ModuleInfo>(
+      name,
+      filename,
+      result.ast,
+      info.getFutureAnnotations(),
+      std::move(result.symbols),
+      info.getStubKind(),
+      info.getSubmoduleSearchLocations());
+  // the restored module stays alive in deletedModules_ for anyone
+  // still holding on to it
+  deleteModule(name);
+  return analyze(std::move(modInfo));
+}
+
+void ModuleLoader::recordDependency(const std::string& modName) {
+  if (analysisStack_.empty()) {
+    return;
+  }
+  AnalyzedModule* dependent = analysisStack_.back();
+  // importing a submodule also runs its parents
+  size_t end = modName.find('.');
+  while (true) {
+    std::string name = modName.substr(0, end);
+    dependent->addDependency(name);
+    auto it = modules_.find(name);
+    if (it != modules_.end() && it->second && it->second.get() != dependent) {
+      dependent->addDependencies(it->second->getDependencies());
+    }
+    if (end == std::string::npos) {
+      break;
+    }
+    end = modName.find('.', end + 1);
+  }
+}
+
+/**
+ * Summarize every file `modName` could be loaded from, in the same
+ * places findModule looks. Missing modules get a fingerprint too, so
+ * adding one invalidates the modules that failed to import it.
+ */
+uint64_t ModuleLoader::fingerprintModule(const std::string& modName) {
+  auto it = fingerprints_.find(modName);
+  if (it != fingerprints_.end()) {
+    return it->second;
+  }
+  std::string modPathStr(modName);
+  std::replace(
+      modPathStr.begin(),
+      modPathStr.end(),
+      '.',
+      static_cast<char>(std::filesystem::path::preferred_separator));
+
+  std::string summary = modName;
+  summary += isAllowListed(modName) ? ":allowed" : ":";
+  auto probe = [&](const std::vector<std::string>& searchLocations,
+                   FileSuffixKind suffixKind) {
+    const char* suffix = getFileSuffixKindName(suffixKind);
+    for (const std::string& importPath : searchLocations) {
+      std::filesystem::path modPath =
+          std::filesystem::path(importPath) / modPathStr;
+      std::filesystem::path filePath = modPath;
+      filePath += suffix;
+      std::filesystem::path initPath = modPath / "__init__";
+      initPath += suffix;
+      for (const auto& path : {filePath, initPath}) {
+        std::string filename = path.string();
+        std::string contents;
+        if (readFileContents(filename, contents)) {
+          summary += fmt::format(
+              "\n{}:{}:{:x}",
+              filename,
+              isForcedStrict(modName, filename),
+              AnalysisCache::hash(contents));
+        }
+      }
+      std::error_code ec;
+      if (std::filesystem::is_directory(modPath, ec)) {
+        summary += fmt::format("\n{}:dir", modPath.string());
+      }
+    }
+  };
+  probe(stubImportPath_, FileSuffixKind::kStrictStubFile);
+  probe(importPath_, FileSuffixKind::kPythonFile);
+  probe(importPath_, FileSuffixKind::kTypingStubFile);
+
+  uint64_t fingerprint = AnalysisCache::hash(summary);
+  fingerprints_[modName] = fingerprint;
+  return fingerprint;
+}
+
+uint64_t ModuleLoader::getCacheKey(
+    const ModuleInfo& modInfo,
+    const std::string& source) {
+  const std::string& name = modInfo.getModName();
+  const std::string& filename = modInfo.getFilename();
+  std::string config = fmt::format(
+      "{}\n{}\n{}\n{}\n{}\n{}\n{}",
+      kAnalysisCacheVersion,
+      Py_GetVersion(),
+      name,
+      filename,
+      modInfo.getStubKind().getValue(),
+      isForcedStrict(name, filename),
+      modInfo.getFutureAnnotations());
+  auto addList = [&config](const char* label, const auto& values) {
+    config += "\n";
+    config += label;
+    for (const std::string& value : values) {
+      config += "\n ";
+      config += value;
+    }
+  };
+  addList("search", modInfo.getSubmoduleSearchLocations());
+  addList("import", importPath_);
+  addList("stub", stubImportPath_);
+  addList("regex", allowListRegexStrs_);
+  config += "\nallow";
+  for (const auto& allowed : allowList_) {
+    config += fmt::format(
+        "\n {}:{}", allowed.first, static_cast<int>(allowed.second));
+  }
+  return AnalysisCache::hash(source, AnalysisCache::hash(config));
+}
+
+bool ModuleLoader::restoreFromCache(AnalyzedModule* mod, uint64_t key) {
+  const std::string& name = mod->getModuleInfo().getModName();
+  std::optional<CachedAnalysis> entry = analysisCache_->load(name);
+  if (!entry || entry->key != key) {
+    return false;
+  }
+  for (const auto& dep : entry->dependencies) {
+    if (fingerprintModule(dep.first) != dep.second) {
+      log("Cached analysis of %s is stale: %s changed",
+          name.c_str(),
+          dep.first.c_str());
+      return false;
+    }
+  }
+
+  // The preprocessor only reads rewriter attributes from the analysis
+  // results, so attach them to placeholder objects
+  std::vector<void*> targets =
+      collectRewriteTargets(mod->getModuleInfo().getAst());
+  auto astToResults = std::make_unique<objects::astToResultT>();
+  for (const CachedRewriterAttrs& cached : entry->rewriterAttrs) {
+    if (cached.target >= targets.size()) {
+      return false;
+    }
+    auto placeholder = std::make_shared<objects::StrictInstance>(
+        objects::ObjectType(), std::weak_ptr<StrictModuleObject>());
+    placeholder->ensureRewriterAttrs() = cached.attrs;
+    (*astToResults)[targets[cached.target]] = std::move(placeholder);
+  }
+  mod->setAstToResults(std::move(astToResults));
+  for (const auto& dep : entry->dependencies) {
+    mod->addDependency(dep.first);
+  }
+  BaseErrorSink& errorSink = mod->getErrorSink();
+  for (const CachedError& err : entry->errors) {
+    errorSink.error<StrictModuleCachedException>(
+        err.lineno,
+        err.col,
+        err.filename,
+        err.scopeName,
+        err.testString,
+        err.displayString);
+  }
+  return true;
+}
+
+void ModuleLoader::storeToCache(
+    AnalyzedModule* mod,
+    uint64_t key,
+    size_t firstError) {
+  const ModuleInfo& modInfo = mod->getModuleInfo();
+  CachedAnalysis entry;
+  entry.key = key;
+  for (const std::string& dep : mod->getDependencies()) {
+    entry.dependencies.emplace_back(dep, fingerprintModule(dep));
+  }
+  // flag errors are found again when the module is parsed
+  const auto& errors = mod->getErrorSink().getErrors();
+  for (size_t i = firstError; i < errors.size(); ++i) {
+    const auto& err = errors[i];
+    std::string testStr = err->testString();
+    std::string lineInfo =
+        fmt::format("{} {} ", err->getLineno(), err->getCol());
+    if (testStr.rfind(lineInfo, 0) == 0) {
+      testStr.erase(0, lineInfo.size());
+    }
+    entry.errors.push_back(CachedError{
+        err->getLineno(),
+        err->getCol(),
+        err->getFilename(),
+        err->getScopeName(),
+        std::move(testStr),
+        err->displayString(false)});
+  }
+  auto astToResults = mod->getAstToResults();
+  if (astToResults) {
+    std::vector<void*> targets = collectRewriteTargets(modInfo.getAst());
+    for (size_t i = 0; i < targets.size(); ++i) {
+      auto it = astToResults->find(targets[i]);
+      if (it != astToResults->end() && it->second &&
+          it->second->hasRewritterAttrs()) {
+        entry.rewriterAttrs.push_back(
+            CachedRewriterAttrs{i, it->second->getRewriterAttrs()});
+      }
+    }
+  }
+  if (!analysisCache_->store(modInfo.getModName(), entry)) {
+    log("Failed to write the analysis cache entry for %s",
+        modInfo.getModName().c_str());
+  }
+}
+
 bool ModuleLoader::isAllowListed(const std::string& modName) {
   for (const auto& allowed : allowList_) {
     if (allowed.first == modName) {
@@ -613,7 +906,8 @@ bool ModuleLoader::isAllowListed(const std::string& modName) {
 int ModuleLoader::getAnalyzedModuleCount() const {
   int count = 0;
   for (auto& m : modules_) {
-    if (m.second != nullptr && m.second->getModuleValue() != nullptr) {
+    if (m.second != nullptr &&
+        (m.second->getModuleValue() != nullptr || m.second->isRestored())) {
       count++;
     }
   }
@@ -642,6 +936,15 @@ bool ModuleLoader::loadStrictModuleModule() {
   return false;
 }
 
+bool ModuleLoader::setAnalysisCacheDir(std::string directory) {
+  if (directory.empty()) {
+    analysisCache_.reset();
+  } else {
+    analysisCache_ = std::make_unique<AnalysisCache>(std::move(directory));
+  }
+  return true;
+}
+
 bool ModuleLoader::enableVerboseLogging() {
   verbose_ = true;
   return true;
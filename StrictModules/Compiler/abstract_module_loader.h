@@ -1,6 +1,7 @@
 // Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
 #pragma once
 
+#include "StrictModules/Compiler/analysis_cache.h"
 #include "StrictModules/Compiler/analyzed_module.h"
 #include "StrictModules/Compiler/module_info.h"
 #include "StrictModules/analyzer.h"
@@ -8,6 +9,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <string>
 #include <unordered_map>
@@ -155,6 +157,11 @@ class ModuleLoader {
   bool setAllowListPrefix(std::vector<std::string> allowList);
   bool setAllowListExact(std::vector<std::string> allowList);
   bool setAllowListRegex(std::vector<std::string> allowList);
+  /** Persist analysis results under `directory` and reuse them for
+   *  modules whose source, dependencies and loader configuration are
+   *  unchanged. An empty string disables the cache.
+   */
+  bool setAnalysisCacheDir(std::string directory);
 
   int getAnalyzedModuleCount() const;
 
@@ -198,9 +205,27 @@ class ModuleLoader {
   ErrorSinkFactory errorSinkFactory_;
   std::unordered_set<std::unique_ptr<AnalyzedModule>> deletedModules_;
   std::vector<std::regex> allowListRegexes_;
+  // source of allowListRegexes_, which is part of the cache key
+  std::vector<std::string> allowListRegexStrs_;
   bool verbose_ = false;
-
-  AnalyzedModule* analyze(std::unique_ptr<ModuleInfo> modInfo);
+  std::unique_ptr<AnalysisCache> analysisCache_;
+  // modules currently being analyzed, innermost last
+  std::vector<AnalyzedModule*> analysisStack_;
+  // fingerprints of module files, valid for one top level analysis
+  std::unordered_map<std::string, uint64_t> fingerprints_;
+
+  /** `source` is the text `modInfo` was parsed from. It is only passed
+   *  when the analysis cache is enabled and the module may be cached
+   */
+  AnalyzedModule* analyze(
+      std::unique_ptr<ModuleInfo> modInfo,
+      std::optional<std::string> source = std::nullopt);
+  AnalyzedModule* reanalyzeRestored(AnalyzedModule* mod);
+  void recordDependency(const std::string& modName);
+  uint64_t fingerprintModule(const std::string& modName);
+  uint64_t getCacheKey(const ModuleInfo& modInfo, const std::string& source);
+  bool restoreFromCache(AnalyzedModule* mod, uint64_t key);
+  void storeToCache(AnalyzedModule* mod, uint64_t key, size_t firstError);
   bool isAllowListed(const std::string& modName);
   bool isForcedStrict(const std::string& modName, const std::string& fileName);
   bool hasAllowListedParent(const std::string& modName);
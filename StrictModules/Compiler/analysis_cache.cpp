@@ -0,0 +1,315 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#include "StrictModules/Compiler/analysis_cache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace strictmod::compiler {
+
+namespace {
+// bump whenever the entry layout changes
+const char kEntryMagic[] = "STRICTC1";
+const char kEntrySuffix[] = ".strictcache";
+
+void writeU64(std::string& out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void writeStr(std::string& out, const std::string& value) {
+  writeU64(out, value.size());
+  out.append(value);
+}
+
+class EntryReader {
+ public:
+  explicit EntryReader(const std::string& data) : data_(data), pos_(0) {}
+
+  bool readU64(uint64_t& value) {
+    if (data_.size() - pos_ < 8) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value |= static_cast<uint64_t>(static_cast<unsigned char>(data_[pos_++]))
+          << (8 * i);
+    }
+    return true;
+  }
+
+  bool readInt(int& value) {
+    uint64_t v;
+    if (!readU64(v)) {
+      return false;
+    }
+    value = static_cast<int>(static_cast<int64_t>(v));
+    return true;
+  }
+
+  bool readBool(bool& value) {
+    uint64_t v;
+    if (!readU64(v)) {
+      return false;
+    }
+    value = v != 0;
+    return true;
+  }
+
+  bool readStr(std::string& value) {
+    uint64_t size;
+    if (!readU64(size) || data_.size() - pos_ < size) {
+      return false;
+    }
+    value = data_.substr(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  // guard against absurd counts in corrupt entries before reserving
+  bool readCount(uint64_t& count) {
+    return readU64(count) && count <= data_.size() - pos_;
+  }
+
+  bool atEnd() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+};
+
+void writeAttrs(std::string& out, const RewriterAttrs& attrs) {
+  writeU64(out, attrs.isSlotDisabled());
+  writeU64(out, attrs.isLooseSlots());
+  const auto& extraSlots = attrs.getExtraSlots();
+  writeU64(out, extraSlots.size());
+  for (const std::string& slot : extraSlots) {
+    writeStr(out, slot);
+  }
+  writeU64(out, attrs.isMutable());
+  writeU64(out, attrs.hasCachedProperty());
+  writeU64(out, static_cast<uint64_t>(attrs.getCachedPropKind()));
+}
+
+bool readAttrs(EntryReader& reader, RewriterAttrs& attrs) {
+  bool slotsDisabled, looseSlots, isMutable, hasCachedProp;
+  uint64_t numSlots, propKind;
+  if (!reader.readBool(slotsDisabled) || !reader.readBool(looseSlots) ||
+      !reader.readCount(numSlots)) {
+    return false;
+  }
+  std::vector<std::string> extraSlots(numSlots);
+  for (std::string& slot : extraSlots) {
+    if (!reader.readStr(slot)) {
+      return false;
+    }
+  }
+  if (!reader.readBool(isMutable) || !reader.readBool(hasCachedProp) ||
+      !reader.readU64(propKind) ||
+      propKind > static_cast<uint64_t>(CachedPropertyKind::kCached)) {
+    return false;
+  }
+  attrs.setSlotsEnabled(!slotsDisabled);
+  attrs.setLooseSlots(looseSlots);
+  attrs.setExtraSlots(std::move(extraSlots));
+  attrs.setMutable(isMutable);
+  attrs.setHasCachedProp(hasCachedProp);
+  attrs.setCachedPropKind(static_cast<CachedPropertyKind>(propKind));
+  return true;
+}
+
+// Mirrors the traversal done by the Preprocessor: class and function
+// bodies are visited, other compound statements are not.
+void collectTargets(const asdl_seq* body, std::vector<void*>& targets) {
+  for (int i = 0; i < asdl_seq_LEN(body); i++) {
+    stmt_ty stmt = reinterpret_cast<stmt_ty>(asdl_seq_GET(body, i));
+    asdl_seq* decorators = nullptr;
+    asdl_seq* innerBody = nullptr;
+    switch (stmt->kind) {
+      case ClassDef_kind:
+        targets.push_back(stmt);
+        collectTargets(stmt->v.ClassDef.body, targets);
+        continue;
+      case FunctionDef_kind:
+        decorators = stmt->v.FunctionDef.decorator_list;
+        innerBody = stmt->v.FunctionDef.body;
+        break;
+      case AsyncFunctionDef_kind:
+        decorators = stmt->v.AsyncFunctionDef.decorator_list;
+        innerBody = stmt->v.AsyncFunctionDef.body;
+        break;
+      default:
+        continue;
+    }
+    targets.push_back(stmt);
+    for (int j = 0; j < asdl_seq_LEN(decorators); j++) {
+      targets.push_back(asdl_seq_GET(decorators, j));
+    }
+    collectTargets(innerBody, targets);
+  }
+}
+} // namespace
+
+bool readFileContents(const std::string& path, std::string& out) {
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path, ec)) {
+    return false;
+  }
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  out = buffer.str();
+  return !in.bad();
+}
+
+uint64_t AnalysisCache::hash(const std::string& data, uint64_t seed) {
+  // 64 bit FNV-1a, with the seed and length mixed in
+  const uint64_t kPrime = 0x100000001b3;
+  uint64_t h = 0xcbf29ce484222325;
+  auto mix = [&](uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      h ^= (value >> (8 * i)) & 0xff;
+      h *= kPrime;
+    }
+  };
+  mix(seed);
+  for (char c : data) {
+    h ^= static_cast<unsigned char>(c);
+    h *= kPrime;
+  }
+  mix(data.size());
+  return h;
+}
+
+std::string AnalysisCache::entryPath(const std::string& modName) const {
+  char name[17];
+  snprintf(
+      name,
+      sizeof(name),
+      "%016llx",
+      static_cast<unsigned long long>(hash(modName)));
+  std::filesystem::path path = std::filesystem::path(directory_) / name;
+  path += kEntrySuffix;
+  return path.string();
+}
+
+std::optional<CachedAnalysis> AnalysisCache::load(
+    const std::string& modName) const {
+  std::string data;
+  if (!readFileContents(entryPath(modName), data)) {
+    return std::nullopt;
+  }
+  EntryReader reader(data);
+  std::string magic, storedName;
+  CachedAnalysis entry;
+  uint64_t count;
+  if (!reader.readStr(magic) || magic != kEntryMagic ||
+      !reader.readStr(storedName) || storedName != modName ||
+      !reader.readU64(entry.key) || !reader.readCount(count)) {
+    return std::nullopt;
+  }
+  entry.dependencies.resize(count);
+  for (auto& dep : entry.dependencies) {
+    if (!reader.readStr(dep.first) || !reader.readU64(dep.second)) {
+      return std::nullopt;
+    }
+  }
+  if (!reader.readCount(count)) {
+    return std::nullopt;
+  }
+  entry.errors.resize(count);
+  for (CachedError& err : entry.errors) {
+    if (!reader.readInt(err.lineno) || !reader.readInt(err.col) ||
+        !reader.readStr(err.filename) || !reader.readStr(err.scopeName) ||
+        !reader.readStr(err.testString) || !reader.readStr(err.displayString)) {
+      return std::nullopt;
+    }
+  }
+  if (!reader.readCount(count)) {
+    return std::nullopt;
+  }
+  entry.rewriterAttrs.resize(count);
+  for (CachedRewriterAttrs& attrs : entry.rewriterAttrs) {
+    if (!reader.readU64(attrs.target) || !readAttrs(reader, attrs.attrs)) {
+      return std::nullopt;
+    }
+  }
+  if (!reader.atEnd()) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+bool AnalysisCache::store(
+    const std::string& modName,
+    const CachedAnalysis& entry) const {
+  std::string data;
+  writeStr(data, kEntryMagic);
+  writeStr(data, modName);
+  writeU64(data, entry.key);
+  writeU64(data, entry.dependencies.size());
+  for (const auto& dep : entry.dependencies) {
+    writeStr(data, dep.first);
+    writeU64(data, dep.second);
+  }
+  writeU64(data, entry.errors.size());
+  for (const CachedError& err : entry.errors) {
+    writeU64(data, static_cast<uint64_t>(static_cast<int64_t>(err.lineno)));
+    writeU64(data, static_cast<uint64_t>(static_cast<int64_t>(err.col)));
+    writeStr(data, err.filename);
+    writeStr(data, err.scopeName);
+    writeStr(data, err.testString);
+    writeStr(data, err.displayString);
+  }
+  writeU64(data, entry.rewriterAttrs.size());
+  for (const CachedRewriterAttrs& attrs : entry.rewriterAttrs) {
+    writeU64(data, attrs.target);
+    writeAttrs(data, attrs.attrs);
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+  if (ec) {
+    return false;
+  }
+  std::string path = entryPath(modName);
+  std::string tmpPath = path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out.write(data.data(), data.size());
+    if (!out.good()) {
+      out.close();
+      std::filesystem::remove(tmpPath, ec);
+      return false;
+    }
+  }
+  std::filesystem::rename(tmpPath, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+  return true;
+}
+
+std::vector<void*> collectRewriteTargets(mod_ty mod) {
+  std::vector<void*> targets;
+  if (mod != nullptr && mod->kind == Module_kind) {
+    collectTargets(mod->v.Module.body, targets);
+  }
+  return targets;
+}
+
+} // namespace strictmod::compiler
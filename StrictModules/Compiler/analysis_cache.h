@@ -0,0 +1,82 @@
+// Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
+#pragma once
+
+#include "StrictModules/py_headers.h"
+#include "StrictModules/rewriter_attributes.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace strictmod::compiler {
+
+/** An error reported while analyzing a module, in rendered form */
+struct CachedError {
+  int lineno;
+  int col;
+  std::string filename;
+  std::string scopeName;
+  // testString() without the leading line info
+  std::string testString;
+  // displayString(false)
+  std::string displayString;
+};
+
+/** Rewriter attributes of one of the nodes returned by
+ *  collectRewriteTargets, identified by its index
+ */
+struct CachedRewriterAttrs {
+  uint64_t target;
+  RewriterAttrs attrs;
+};
+
+/** The parts of a module's analysis that the compiler consumes */
+struct CachedAnalysis {
+  // hash of the module's source and of the loader configuration
+  uint64_t key;
+  // every module whose value the analysis looked at, with a fingerprint
+  // of the files that module would be loaded from
+  std::vector<std::pair<std::string, uint64_t>> dependencies;
+  std::vector<CachedError> errors;
+  std::vector<CachedRewriterAttrs> rewriterAttrs;
+};
+
+/**
+ * On-disk store of analysis results, one file per module in `directory`.
+ * Entries are written to a temporary file and renamed into place, so
+ * concurrent processes sharing a directory never see a partial entry.
+ * Unreadable or malformed entries are treated as missing.
+ */
+class AnalysisCache {
+ public:
+  explicit AnalysisCache(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  std::optional<CachedAnalysis> load(const std::string& modName) const;
+  bool store(const std::string& modName, const CachedAnalysis& entry) const;
+
+  const std::string& getDirectory() const {
+    return directory_;
+  }
+
+  static uint64_t hash(const std::string& data, uint64_t seed = 0);
+
+ private:
+  std::string directory_;
+
+  std::string entryPath(const std::string& modName) const;
+};
+
+/** Read the whole file at `path` into `out`.
+ *  Return false if it isn't a readable regular file
+ */
+bool readFileContents(const std::string& path, std::string& out);
+
+/** The nodes of `mod` that the AST preprocessor looks up in the
+ *  analysis results, in a deterministic order
+ */
+std::vector<void*> collectRewriteTargets(mod_ty mod);
+
+} // namespace strictmod::compiler
@@ -7,6 +7,9 @@
 #include "StrictModules/symbol_table.h"
 
 #include <memory>
+#include <optional>
+#include <set>
+#include <string>
 namespace strictmod::compiler {
 using strictmod::objects::StrictModuleObject;
 
@@ -74,6 +77,34 @@ class AnalyzedModule {
   }
   int getModKindAsInt() const;
 
+  /* names of the modules whose values the analysis of this module used,
+   * directly or transitively
+   */
+  const std::set<std::string>& getDependencies() const {
+    return dependencies_;
+  }
+  void addDependency(const std::string& name) {
+    dependencies_.insert(name);
+  }
+  void addDependencies(const std::set<std::string>& names) {
+    dependencies_.insert(names.begin(), names.end());
+  }
+
+  /* A restored module took its errors and rewriter attributes from the
+   * analysis cache instead of being analyzed, so it has no module value.
+   * The source is kept so the module can be analyzed if a dependent
+   * needs its value.
+   */
+  bool isRestored() const {
+    return restoredSource_.has_value();
+  }
+  const std::string& getRestoredSource() const {
+    return *restoredSource_;
+  }
+  void setRestoredSource(std::string source) {
+    restoredSource_ = std::move(source);
+  }
+
  private:
   std::shared_ptr<StrictModuleObject> module_;
   ModuleKind moduleKind_;
@@ -81,5 +112,7 @@ class AnalyzedModule {
   std::unique_ptr<astToResultT> astToResults_;
   std::unique_ptr<ModuleInfo> modInfo_;
   PreprocessingRecord preprocessRecord_;
+  std::set<std::string> dependencies_;
+  std::optional<std::string> restoredSource_;
 };
 } // namespace strictmod::compiler
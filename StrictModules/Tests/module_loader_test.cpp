@@ -1,5 +1,11 @@
 // Copyright (c) Facebook, Inc. and its affiliates. (http://www.facebook.com)
 #include "StrictModules/Tests/test.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <unistd.h>
+
 TEST_F(ModuleLoaderTest, GetLoader) {
   auto mod = getLoader(nullptr, nullptr);
   ASSERT_NE(mod.get(), nullptr);
@@ -202,3 +208,117 @@ TEST_F(ModuleLoaderTest, ASTPreprocessCachedProperty) {
   std::size_t found = preprocessedStr.find(astStrPreprocessedExpected);
   ASSERT_NE(found, std::string::npos);
 }
+
+class AnalysisCacheTest : public ModuleLoaderTest {
+ public:
+  void SetUp() override {
+    ModuleLoaderTest::SetUp();
+    dir_ = std::filesystem::temp_directory_path() /
+        ("strict_cache_test_" + std::to_string(getpid()));
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+    writeFile(
+        "dep.py",
+        "import __strict__\n"
+        "x = 1\n");
+    writeFile(
+        "m.py",
+        "import __strict__\n"
+        "from __strict__ import strict_slots, _mark_cached_property\n"
+        "import dep\n"
+        "def dec(f):\n"
+        "    _mark_cached_property(f, False, dec)\n"
+        "    return f\n"
+        "@strict_slots\n"
+        "class C:\n"
+        "    @dec\n"
+        "    def p(self):\n"
+        "        return dep.x\n"
+        "y = ''.__lenx__()\n");
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(dir_);
+    ModuleLoaderTest::TearDown();
+  }
+
+  void writeFile(const char* name, const char* contents) {
+    std::ofstream out(dir_ / name, std::ios::trunc);
+    out << contents;
+  }
+
+  std::unique_ptr<strictmod::compiler::ModuleLoader> getCachingLoader() {
+    auto loader = getLoader(
+        dir_.c_str(),
+        (dir_ / "stubs").c_str(),
+        [](const std::string&, const std::string&) { return false; },
+        [] { return std::make_shared<strictmod::CollectingErrorSink>(); });
+    loader->setAnalysisCacheDir((dir_ / "cache").string());
+    return loader;
+  }
+
+  std::vector<std::string> getErrors(
+      strictmod::compiler::AnalyzedModule* mod) {
+    std::vector<std::string> result;
+    for (const auto& err : mod->getErrorSink().getErrors()) {
+      result.push_back(err->testString());
+      result.push_back(err->displayString(true));
+    }
+    return result;
+  }
+
+  std::string getPreprocessedAst(
+      strictmod::compiler::ModuleLoader* loader,
+      strictmod::compiler::AnalyzedModule* mod) {
+    auto ast = mod->getPyAst(true, loader->getArena());
+    EXPECT_NE(ast, nullptr);
+    Ref<> astMod = Ref<>::steal(PyImport_ImportModule("ast"));
+    EXPECT_NE(astMod, nullptr);
+    Ref<> dump =
+        Ref<>::steal(PyObject_CallMethod(astMod, "dump", "O", ast.get()));
+    EXPECT_NE(dump, nullptr);
+    return PyUnicode_AsUTF8(dump);
+  }
+
+ protected:
+  std::filesystem::path dir_;
+};
+
+TEST_F(AnalysisCacheTest, RestoresUnchangedModule) {
+  auto loader = getCachingLoader();
+  auto mod = loader->loadModule("m");
+  ASSERT_NE(mod, nullptr);
+  ASSERT_NE(mod->getModuleValue(), nullptr);
+  auto errors = getErrors(mod);
+  ASSERT_EQ(errors.size(), 2u);
+  std::string ast = getPreprocessedAst(loader.get(), mod);
+  ASSERT_NE(ast.find("<cached_property>"), std::string::npos);
+
+  auto cachedLoader = getCachingLoader();
+  auto cachedMod = cachedLoader->loadModule("m");
+  ASSERT_NE(cachedMod, nullptr);
+  EXPECT_TRUE(cachedMod->isRestored());
+  EXPECT_EQ(cachedMod->getModuleValue(), nullptr);
+  EXPECT_EQ(getErrors(cachedMod), errors);
+  EXPECT_EQ(getPreprocessedAst(cachedLoader.get(), cachedMod), ast);
+
+  // a dependent needing the value gets the module analyzed
+  auto value = cachedLoader->loadModuleValue("m");
+  ASSERT_NE(value, nullptr);
+  EXPECT_NE(value->getAttr("C"), nullptr);
+}
+
+TEST_F(AnalysisCacheTest, DependencyChangeInvalidates) {
+  auto loader = getCachingLoader();
+  ASSERT_NE(loader->loadModule("m"), nullptr);
+
+  writeFile(
+      "dep.py",
+      "import __strict__\n"
+      "x = 2\n");
+  auto cachedLoader = getCachingLoader();
+  auto cachedMod = cachedLoader->loadModule("m");
+  ASSERT_NE(cachedMod, nullptr);
+  EXPECT_FALSE(cachedMod->isRestored());
+  EXPECT_NE(cachedMod->getModuleValue(), nullptr);
+}
@@ -91,6 +91,41 @@ void StrictModuleTooManyIterationsException::raise() {
   throw *this;
 }
 
+// StrictModuleCachedException
+StrictModuleCachedException::StrictModuleCachedException(
+    int lineno,
+    int col,
+    std::string filename,
+    std::string scopeName,
+    std::string testStr,
+    std::string displayStr)
+    : StrictModuleException(
+          lineno,
+          col,
+          std::move(filename),
+          std::move(scopeName),
+          displayStr),
+      testStr_(std::move(testStr)),
+      displayStr_(std::move(displayStr)) {}
+
+std::string StrictModuleCachedException::testStringHelper() const {
+  return testStr_;
+}
+
+std::string StrictModuleCachedException::displayStringHelper() const {
+  return displayStr_;
+}
+
+void StrictModuleCachedException::raise() {
+  throw *this;
+}
+
+std::unique_ptr<StrictModuleException> StrictModuleCachedException::clone()
+    const {
+  return std::make_unique<StrictModuleCachedException>(
+      lineno_, col_, filename_, scopeName_, testStr_, displayStr_);
+}
+
 // StrictModuleUnhandledException
 StrictModuleUnhandledException::StrictModuleUnhandledException(
     int lineno,
@@ -172,6 +172,32 @@ class StrictModuleUnhandledException : public StrictModuleException {
   virtual std::string displayStringHelper() const override;
 };
 
+/** An error replayed from the analysis cache. Only the rendered forms of
+ *  the original error are kept, so it reports the same strings.
+ */
+class StrictModuleCachedException : public StrictModuleException {
+ public:
+  StrictModuleCachedException(
+      int lineno,
+      int col,
+      std::string filename,
+      std::string scopeName,
+      std::string testStr,
+      std::string displayStr);
+
+  [[noreturn]] virtual void raise() override;
+  virtual std::unique_ptr<StrictModuleException> clone() const override;
+
+ private:
+  // testString() of the original error without the line info
+  std::string testStr_;
+  // displayString(false) of the original error
+  std::string displayStr_;
+
+  virtual std::string testStringHelper() const override;
+  virtual std::string displayStringHelper() const override;
+};
+
 /**
  * Use this template to specify which fields in a structued
  * exception will be formatted into the final
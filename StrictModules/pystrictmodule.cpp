@@ -662,6 +662,20 @@ static PyObject* StrictModuleLoader_delete_module(
   Py_RETURN_FALSE;
 }
 
+static PyObject* StrictModuleLoader_set_analysis_cache(
+    StrictModuleLoaderObject* self,
+    PyObject* args) {
+  const char* cache_dir;
+  if (!PyArg_ParseTuple(args, "s", &cache_dir)) {
+    return NULL;
+  }
+  int ok = StrictModuleChecker_SetAnalysisCacheDir(self->checker, cache_dir);
+  if (ok == 0) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+}
+
 static PyMethodDef StrictModuleLoader_methods[] = {
     {"check",
      (PyCFunction)StrictModuleLoader_check,
@@ -690,6 +704,10 @@ static PyMethodDef StrictModuleLoader_methods[] = {
      (PyCFunction)StrictModuleLoader_delete_module,
      METH_VARARGS,
      PyDoc_STR("delete_module(name: str) -> bool")},
+    {"set_analysis_cache",
+     (PyCFunction)StrictModuleLoader_set_analysis_cache,
+     METH_VARARGS,
+     PyDoc_STR("set_analysis_cache(cache_dir: str) -> bool")},
     {NULL, NULL, 0, NULL} /* sentinel */
 };
 #pragma GCC diagnostic push
@@ -96,6 +96,14 @@ int StrictModuleChecker_EnableVerboseLogging(StrictModuleChecker* checker) {
   return success ? 0 : -1;
 }
 
+int StrictModuleChecker_SetAnalysisCacheDir(
+    StrictModuleChecker* checker,
+    const char* cache_dir) {
+  auto loader = reinterpret_cast<strictmod::compiler::ModuleLoader*>(checker);
+  bool success = loader->setAnalysisCacheDir(cache_dir);
+  return success ? 0 : -1;
+}
+
 
 void StrictModuleChecker_Free(StrictModuleChecker* checker) {
   delete reinterpret_cast<strictmod::compiler::ModuleLoader*>(checker);
@@ -107,8 +115,10 @@ static bool getAnalyzedResult(
   *out_error_count = analyzedModule == nullptr
       ? 0
       : analyzedModule->getErrorSink().getErrorCount();
-  bool is_strict =
-      analyzedModule != nullptr && analyzedModule->getModuleValue() != nullptr;
+  // modules restored from the analysis cache were strict when analyzed
+  bool is_strict = analyzedModule != nullptr &&
+      (analyzedModule->getModuleValue() != nullptr ||
+       analyzedModule->isRestored());
   return is_strict;
 }
 
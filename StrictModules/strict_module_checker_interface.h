@@ -64,6 +64,14 @@ int StrictModuleChecker_LoadStrictModuleBuiltins(StrictModuleChecker* checker);
 
 int StrictModuleChecker_EnableVerboseLogging(StrictModuleChecker* checker);
 
+/** Reuse analysis results stored under `cache_dir` across processes.
+ *  An empty string disables the cache.
+ *  return 0 for success and -1 for failure
+ */
+int StrictModuleChecker_SetAnalysisCacheDir(
+    StrictModuleChecker* checker,
+    const char* cache_dir);
+
 void StrictModuleChecker_Free(StrictModuleChecker* checker);
 
 /** Return the analyzed module